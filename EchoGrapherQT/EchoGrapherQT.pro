@@ -1,10 +1,17 @@
-QT       += core gui widgets
+QT       += core gui widgets concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 LIBS += -lportaudio
 LIBS += -lfftw3f
+
+# FLAC recording is built in when pkg-config finds libFLAC
+packagesExist(flac) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += flac
+    DEFINES += ECHOGRAPHER_FLAC
+}
 RESOURCES += resources.qrc
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -12,12 +19,68 @@ RESOURCES += resources.qrc
 
 SOURCES += \
     audioprocessor.cpp \
+    audiosource.cpp \
+    clockdriftmonitor.cpp \
+    colormap.cpp \
+    dspkernels.cpp \
+    fftplancache.cpp \
+    fixedframeprocessor.cpp \
+    flacwriter.cpp \
+    frameassembler.cpp \
+    frameprocessor.cpp \
+    frameworkerpool.cpp \
+    latencyhistogram.cpp \
     main.cpp \
-    mainwindow.cpp
+    logmelscale.cpp \
+    mainwindow.cpp \
+    mappedwavfile.cpp \
+    melfilterbank.cpp \
+    pipelinestats.cpp \
+    recordingwriter.cpp \
+    spectrogramblockqueue.cpp \
+    spectrogrambrowser.cpp \
+    spectrogrampyramid.cpp \
+    spectrogramrenderer.cpp \
+    spectrogramstore.cpp \
+    spectrogramtiles.cpp \
+    statspanel.cpp \
+    syntheticsource.cpp \
+    wavfilesource.cpp \
+    wavreader.cpp \
+    wavwriter.cpp
 
 HEADERS += \
     audioprocessor.h \
-    mainwindow.h
+    audiosource.h \
+    clockdriftmonitor.h \
+    colormap.h \
+    dspkernels.h \
+    fftplancache.h \
+    fixedframeprocessor.h \
+    flacwriter.h \
+    frameassembler.h \
+    frameprocessor.h \
+    frameworkerpool.h \
+    latencyhistogram.h \
+    logmelscale.h \
+    mainwindow.h \
+    mappedwavfile.h \
+    melfilterbank.h \
+    pipelinestats.h \
+    recordingwriter.h \
+    spectrogramblock.h \
+    spectrogramblockqueue.h \
+    spectrogrambrowser.h \
+    spectrogrampyramid.h \
+    spectrogramrenderer.h \
+    spectrogramstore.h \
+    spectrogramtiles.h \
+    spscringbuffer.h \
+    statspanel.h \
+    syntheticsource.h \
+    wavfilesource.h \
+    wavreader.h \
+    wavwriter.h
 
 FORMS += \
     mainwindow.ui
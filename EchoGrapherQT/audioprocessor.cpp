@@ -1,8 +1,15 @@
 #include "audioprocessor.h"
+#include "dspkernels.h"
 #include <portaudio.h>
 #include <QStandardPaths>
 #include <QDataStream>
+#include <QElapsedTimer>
+#include <QMetaMethod>
 #include <QDateTime>
+#include <QtConcurrent>
+#include <QStringList>
+#include <QVarLengthArray>
+#include <algorithm>
 #include <iostream>
 #include <QFile>
 #include <QDir>
@@ -12,28 +19,35 @@ using namespace std;
 AudioProcessor::AudioProcessor(QObject *parent)
     : QObject(parent),
 
-      paStream(nullptr),
       stopFlag(false),
-      audioInputThread(nullptr),
       audioProcessingThread(nullptr)
 {
 }
 
 AudioProcessor::~AudioProcessor() {}
 
+void AudioProcessor::setAudioSource(std::unique_ptr<AudioSource> source)
+{
+    customSources.clear();
+    addAudioSource(std::move(source));
+}
+
+void AudioProcessor::addAudioSource(std::unique_ptr<AudioSource> source)
+{
+    if (source)
+    {
+        customSources.push_back(std::move(source));
+    }
+}
+
 void AudioProcessor::stopProcessing()
 {
 
     //    cout << "STop it ......." << endl;
     stopFlag.store(true);
 
-    if (audioInputThread)
-    {
-        audioInputThread->quit(); // Request the thread to stop
-        audioInputThread->wait(); // Wait for the thread to finish
-        delete audioInputThread;  // Clean up the thread
-        audioInputThread = nullptr;
-    }
+    // Capture first, every device's input thread or stream, so nothing pushes into the rings any more
+    closeDevices();
 
     if (audioProcessingThread)
     {
@@ -42,133 +56,466 @@ void AudioProcessor::stopProcessing()
         delete audioProcessingThread;  // Clean up the thread
         audioProcessingThread = nullptr;
     }
+    lanes.clear(); // Stops their frame worker pools
+
+    // Capture has stopped, so the writers can drain what is left and patch the headers
+    finishRecording();
 }
 
-void AudioProcessor::startProcessing()
+// Returns false, with errorOccurred emitted and nothing left open, when a source, recording,
+// store or FFT plan cannot be set up
+bool AudioProcessor::startProcessing()
 {
 
     //    cout << "Start it ..." << endl;
     stopFlag.store(false);
 
-    // Start the audio input thread
-    audioInputThread = QThread::create([this]
-                                       { this->audioInputThreadFunction(); });
-    connect(audioInputThread, &QThread::finished, audioInputThread, &QObject::deleteLater);
-    audioInputThread->start();
+    pipelineStats.reset();
+    reportedWriters.clear();
+    timingEnabled = collectStats;
 
-    uint32_t actualSampleRate = 44100;
-    audioProcessingThread = QThread::create([this, actualSampleRate]
-                                            { this->audioProcessingThreadFunction(actualSampleRate); });
-    connect(audioProcessingThread, &QThread::finished, audioProcessingThread, &QObject::deleteLater);
+    activeCaptureMode = customSources.empty() ? captureMode : BlockingCapture; // Only a device has a callback to hook into
+    if (!openDevices())
+    {
+        return false;
+    }
+    if ((storeSpectrogram && !openSpectrogramStores()) || !createLanes())
+    {
+        closeDevices(); // Nothing has been captured yet
+        finishRecording();
+        return false;
+    }
+
+    // Start one audio input thread per device. They can finish on their own when a source runs
+    // out, so they are deleted by stopProcessing() only, never by deleteLater behind the pointer's
+    // back. In callback mode PortAudio's own threads feed the rings instead.
+    if (activeCaptureMode == BlockingCapture)
+    {
+        for (std::unique_ptr<CaptureDevice> &device : devices)
+        {
+            CaptureDevice *capture = device.get();
+            capture->inputThread = QThread::create([this, capture]
+                                                   { this->audioInputThreadFunction(*capture); });
+            capture->inputThread->start();
+        }
+    }
+
+    audioProcessingThread = QThread::create([this]
+                                            { this->audioProcessingThreadFunction(); });
     audioProcessingThread->start();
+    return true;
 }
 
-void AudioProcessor::audioInputThreadFunction()
+// Opens every stream of the run: each custom source, or else each selected input device (the
+// default one if none is selected). Streams are opened here rather than on the input threads, so
+// processing knows every sample rate and channel count up front. On failure nothing is left open.
+bool AudioProcessor::openDevices()
 {
-    PaError err = paNoError;
-    PaStreamParameters inputParameters;
-    const PaDeviceInfo *deviceInfo;
-    inputParameters.device = Pa_GetDefaultInputDevice();
+    devices.clear();
+    recordingName = "output_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"); // Get the current date and time
 
-    deviceInfo = Pa_GetDeviceInfo(inputParameters.device);
+    QVector<PaDeviceIndex> inputs;
+    if (customSources.empty())
+    {
+        inputs = inputDevices.isEmpty() ? QVector<PaDeviceIndex>{paNoDevice} : inputDevices;
+    }
+    const int count = customSources.empty() ? inputs.size() : static_cast<int>(customSources.size());
 
-    // Check and set the sample rate based on device capability
-    uint32_t desiredSampleRate = 44100;
-    uint32_t actualSampleRate = min(deviceInfo->defaultSampleRate, static_cast<double>(desiredSampleRate));
+    // Device sources are recreated whenever the selection or the channel count changed
+    if (customSources.empty() && activeCaptureMode == BlockingCapture)
+    {
+        bool same = static_cast<int>(deviceSources.size()) == count;
+        for (int i = 0; same && i < count; ++i)
+        {
+            same = deviceSources[i]->deviceIndex() == inputs[i] && deviceSources[i]->channelCount() == qMax(1, inputChannels);
+        }
+        if (!same)
+        {
+            deviceSources.clear();
+            for (PaDeviceIndex input : inputs)
+            {
+                deviceSources.emplace_back(new PortAudioSource(input, 44100, inputChannels));
+            }
+        }
+    }
 
-    inputParameters.channelCount = 1;         // Mono input
-    inputParameters.sampleFormat = paFloat32; // 32-bit floating point input
-    inputParameters.suggestedLatency = deviceInfo->defaultLowInputLatency;
-    inputParameters.hostApiSpecificStreamInfo = nullptr;
+    activeChannels = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        devices.emplace_back(new CaptureDevice());
+        CaptureDevice &device = *devices.back();
+        device.owner = this;
+        device.index = i;
+        device.recording = RecordingWriter::Create(recordingFormat, recordingBitDepth);
+        if (WavWriter *wav = dynamic_cast<WavWriter *>(device.recording.get()))
+        {
+            wav->setSegmentLimits(recordingSegmentSeconds, recordingSegmentBytes); // Files are numbered _001, _002, ...
+        }
 
-    err = Pa_OpenStream(
-        &paStream,
-        &inputParameters,
-        nullptr,          // No output parameters for recording only
-        actualSampleRate, // Sample rate
-        windowSize,       // Frames per buffer
-        paClipOff,        // We won't output out-of-range samples so don't bother clipping them
-        nullptr,          // No callback, use blocking API
-        nullptr);         // No data for the callback since we're not using one
-    if (err != paNoError)
+        bool opened = false;
+        if (activeCaptureMode == CallbackCapture)
+        {
+            opened = startCallbackCapture(device, inputs[i]);
+        }
+        else
+        {
+            device.source = customSources.empty() ? static_cast<AudioSource *>(deviceSources[i].get()) : customSources[i].get();
+            opened = openSource(device);
+        }
+        if (!opened)
+        {
+            devices.pop_back();
+            closeDevices();
+            finishRecording();
+            return false;
+        }
+        device.firstLane = activeChannels;
+        activeChannels += device.channels;
+    }
+    return true;
+}
+
+// Stops capture on every device. Called with the processing thread still running, so whatever
+// is in the rings can still be drained.
+void AudioProcessor::closeDevices()
+{
+    for (std::unique_ptr<CaptureDevice> &device : devices)
     {
-        emit errorOccurred(QString("PortAudio error: open stream: %1").arg(Pa_GetErrorText(err)));
-        return; // Stop the function if stream opening fails
+        if (device->inputThread)
+        {
+            device->inputThread->quit(); // Request the thread to stop
+            device->inputThread->wait(); // Wait for the thread to finish, it closes the source on its way out
+            delete device->inputThread;  // Clean up the thread
+            device->inputThread = nullptr;
+        }
+        else if (device->source && activeCaptureMode == BlockingCapture)
+        {
+            device->source->close(); // Opened, but its input thread never started
+        }
+        device->source = nullptr;
+
+        // In callback mode the stream lives on without a thread of its own
+        if (device->stream)
+        {
+            Pa_StopStream(device->stream);
+            Pa_CloseStream(device->stream);
+            device->stream = nullptr;
+        }
     }
+}
 
-    // Constants for Hanning window and frame processing
-    //    const int windowSize = 512 by default;
-    QVector<float> window(windowSize);
+// Sizes the rings before anything touches them: captureQueueMs of audio, and never less than a
+// handful of blocks so a short scheduling hiccup in processing does not overflow them
+void AudioProcessor::resetCaptureRings(CaptureDevice &device)
+{
+    const int ringFrames = qMax<int>(qint64(device.sampleRate) * qMax(0, captureQueueMs) / 1000, qMax(windowSize, captureBlockSize) * 8);
+    device.ring.reset(ringFrames * device.channels);
+    device.pushStamps.reset(ringFrames / qMax(1, captureBlockSize / 4) + 64); // Callback buffers can be shorter than a block
+    device.pushedSamples = 0;
+    device.inputFinished.store(false);
+    device.clock.reset(device.sampleRate);
+}
 
-    // Hanning window
-    for (int i = 0; i < windowSize; ++i)
+bool AudioProcessor::openSource(CaptureDevice &device)
+{
+    AudioSource *source = device.source;
+    if (!source->open(captureBlockSize))
     {
-        window[i] = 0.5 * (1 - cos(2 * M_PI * i / (windowSize - 1)));
+        emit errorOccurred(source->errorString());
+        device.source = nullptr;
+        return false;
     }
+    device.sampleRate = source->sampleRate();
+    device.channels = source->channelCount();
+    resetCaptureRings(device);
 
-    // Prepare the WAVHeader for 32-bit float format
-    WAVHeader header;
-    header.numChannels = inputParameters.channelCount;
-    header.sampleRate = actualSampleRate;
-    header.bitsPerSample = 32; // For 32-bit float data
-    header.audioFormat = 3;    // IEEE float
-    header.byteRate = header.sampleRate * header.numChannels * header.bitsPerSample / 8;
-    header.blockAlign = header.numChannels * header.bitsPerSample / 8;
+    // One interleaved file for every channel, the same layout the source delivers
+    if (!openRecording(device))
+    {
+        source->close();
+        device.source = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool AudioProcessor::openRecording(CaptureDevice &device)
+{
+    if (!recordInput)
+    {
+        return true;
+    }
 
     // Initialize file for writing
     QString localOutputPath;
     {
         QMutexLocker locker(&pathMutex); // Lock the mutex before reading the path
-        // Get the current date and time
-        QString dateTimeStr = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
-        QString filename = "/output_" + dateTimeStr + ".wav";
-        localOutputPath = outputPath + filename;
+        // Every device after the first records next to it, one file per sample clock
+        QString filename = "/" + recordingName;
+        if (device.index > 0)
+        {
+            filename += QString("_device%1").arg(device.index + 1);
+        }
+        localOutputPath = outputPath + filename + device.recording->fileExtension();
         locker.unlock(); // Unlock the mutex
     }
 
-    QFile file(localOutputPath);
-    if (!file.open(QIODevice::WriteOnly))
+    // The writer stages samples in a lock-free ring and writes them from its own thread
+    if (!device.recording->open(localOutputPath, device.sampleRate, device.channels))
     {
-        emit errorOccurred("Error: Could not open file for writing.");
-        return;
+        emit errorOccurred("Error: Could not open file for writing: " + device.recording->errorString());
+        return false;
+    }
+    return true;
+}
+
+// Every frame a lane computes is kept in output_<date>.egspec, or output_<date>_ch<N>.egspec
+// with several channels, so a session can be reopened without recomputing its FFTs. Opened with
+// the devices, before capture starts; on failure nothing is left open.
+bool AudioProcessor::openSpectrogramStores()
+{
+    QString path;
+    {
+        QMutexLocker locker(&pathMutex);
+        path = outputPath + "/" + recordingName;
+    }
+    const int hopSize = qBound(1, windowSize - static_cast<int>(windowSize * windowOverlap), qMax(windowSize, 1)); // As the lane assemblers clamp it
+
+    spectrogramStores.clear();
+    for (const std::unique_ptr<CaptureDevice> &device : devices)
+    {
+        for (int c = 0; c < device->channels; ++c)
+        {
+            const int channel = device->firstLane + c;
+            const QString lanePath = activeChannels > 1 ? path + QString("_ch%1").arg(channel + 1) : path;
+
+            std::unique_ptr<SpectrogramStoreWriter> store(new SpectrogramStoreWriter(windowSize, hopSize, spectrogramStoreFormat));
+            store->setScale(decibelFloor, decibelReference, normalizeSpectrogram);
+            if (!store->open(lanePath + store->fileExtension(), device->sampleRate, numMelFilters))
+            {
+                emit errorOccurred("Error: Could not open the spectrogram store: " + store->errorString());
+                spectrogramStores.clear();
+                return false;
+            }
+            spectrogramStores.push_back(std::move(store));
+        }
+    }
+    return true;
+}
+
+void AudioProcessor::finishRecording()
+{
+    for (std::unique_ptr<CaptureDevice> &device : devices)
+    {
+        device->recording->close(); // Flushes what is queued and finishes the file headers
+    }
+    for (std::unique_ptr<SpectrogramStoreWriter> &store : spectrogramStores)
+    {
+        store->close(); // Appends the seek index
+    }
+    reportWriteFailures(); // Finishing a file can fail too
+    spectrogramStores.clear();
+}
+
+// A recording or store whose writer thread hit a write error (a full disk, say) stops growing
+// while capture goes on, so each one is counted in RecordingErrors and reported once per run.
+// The reports go out last: a receiver may stop processing, which closes the writers.
+void AudioProcessor::reportWriteFailures()
+{
+    quint64 failed = 0;
+    QStringList reports;
+    auto check = [this, &failed, &reports](const RecordingWriter &writer)
+    {
+        if (!writer.hasFailed())
+        {
+            return;
+        }
+        ++failed;
+        if (std::find(reportedWriters.begin(), reportedWriters.end(), &writer) == reportedWriters.end())
+        {
+            reportedWriters.push_back(&writer);
+            reports.append("Error: Could not write " + writer.fileName() + ": " + writer.errorString());
+        }
+    };
+    for (const std::unique_ptr<CaptureDevice> &device : devices)
+    {
+        check(*device->recording);
+    }
+    for (const std::unique_ptr<SpectrogramStoreWriter> &store : spectrogramStores)
+    {
+        check(*store);
+    }
+    pipelineStats.set(PipelineStats::RecordingErrors, failed);
+
+    for (const QString &report : reports)
+    {
+        emit errorOccurred(report);
+    }
+}
+
+qint64 AudioProcessor::recordingBacklog() const
+{
+    qint64 backlog = 0;
+    for (const std::unique_ptr<CaptureDevice> &device : devices)
+    {
+        backlog += device->recording->backlogSamples();
+    }
+    return backlog;
+}
+
+quint64 AudioProcessor::recordingDropCount() const
+{
+    quint64 dropped = 0;
+    for (const std::unique_ptr<CaptureDevice> &device : devices)
+    {
+        dropped += device->recording->droppedSamples();
     }
+    return dropped;
+}
 
-    // Placeholder for header, we'll write the actual header later
-    file.write(reinterpret_cast<const char *>(&header), sizeof(WAVHeader));
+bool AudioProcessor::startCallbackCapture(CaptureDevice &device, PaDeviceIndex inputDevice)
+{
+    // PortAudio does not call back before Pa_StartStream(), so the rings can be sized for the
+    // rate the device actually opened with
+    device.channels = qMax(1, inputChannels);
+    PaError err = PortAudioSource::OpenInputStream(&device.stream, inputDevice, 44100, device.channels, captureBlockSize,
+                                                   &AudioProcessor::captureCallback, &device, &device.sampleRate);
+    if (err != paNoError)
+    {
+        device.stream = nullptr;
+        emit errorOccurred(QString("PortAudio error: open stream: %1").arg(Pa_GetErrorText(err)));
+        return false;
+    }
+    resetCaptureRings(device);
 
-    Pa_StartStream(paStream);
-    QVector<float> audioChunk(windowSize); // Temporary buffer to hold the audio chunk
+    if (!openRecording(device))
+    {
+        Pa_CloseStream(device.stream);
+        device.stream = nullptr;
+        return false;
+    }
+
+    err = Pa_StartStream(device.stream);
+    if (err != paNoError)
+    {
+        emit errorOccurred(QString("PortAudio error: start stream: %1").arg(Pa_GetErrorText(err)));
+        Pa_CloseStream(device.stream);
+        device.stream = nullptr;
+        device.recording->close();
+        return false;
+    }
+    return true;
+}
+
+// Runs on PortAudio's real-time thread: no locks, no allocation, no I/O.
+// The capture ring and the writer's ring are both wait-free for a single producer, and every
+// stream calls back with its own device, so devices never share a producer side.
+int AudioProcessor::captureCallback(const void *input, void *output, unsigned long frameCount,
+                                    const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags,
+                                    void *userData)
+{
+    Q_UNUSED(output);
+    Q_UNUSED(timeInfo);
+    CaptureDevice &device = *static_cast<CaptureDevice *>(userData);
+    AudioProcessor *self = device.owner;
+    const float *samples = static_cast<const float *>(input);
+    const qint64 arrivedNs = self->pipelineStats.now();
+
+    if (statusFlags & paInputOverflow)
+    {
+        self->pipelineStats.add(PipelineStats::InputOverflows);
+    }
+    if (samples)
+    {
+        device.clock.addFrames(static_cast<int>(frameCount), arrivedNs);
+
+        // The real-time thread cannot wait for room, so a block that does not fit misses the
+        // spectrogram; the recording below still gets it
+        if (!self->pushCaptured(device, samples, static_cast<int>(frameCount), arrivedNs))
+        {
+            self->pipelineStats.add(PipelineStats::CaptureOverflows);
+        }
+        if (device.recording->isOpen())
+        {
+            device.recording->write(samples, static_cast<int>(frameCount) * device.channels); // Counts its own drops
+        }
+    }
+    return self->stopFlag.load(std::memory_order_relaxed) ? paComplete : paContinue;
+}
+
+void AudioProcessor::audioInputThreadFunction(CaptureDevice &device)
+{
+    AudioSource &source = *device.source; // Opened by startProcessing()
+    const bool live = source.isLive();
+    const bool recording = device.recording->isOpen();
+    const int channels = device.channels;
+
+    QVector<float> audioChunk(captureBlockSize * channels); // Temporary buffer to hold the audio chunk, interleaved
+    quint64 reportedOverflows = 0;                          // Devices share the counter, so each adds its own increase
     while (!stopFlag.load())
     {
-        err = Pa_ReadStream(paStream, audioChunk.data(), windowSize);
-        if (err)
+        const int frames = source.read(audioChunk.data(), captureBlockSize);
+        const qint64 arrivedNs = pipelineStats.now();
+        const quint64 overflows = source.overflowCount();
+        pipelineStats.add(PipelineStats::InputOverflows, overflows - reportedOverflows);
+        reportedOverflows = overflows;
+        if (frames < 0)
         {
-            emit errorOccurred(QString("PortAudio error: read stream: %1").arg(Pa_GetErrorText(err)));
+            emit errorOccurred(source.errorString());
             break;
         }
-        else
+        if (frames == 0)
         {
-            // Write float data directly to file
-            file.write(reinterpret_cast<const char *>(audioChunk.constData()), audioChunk.size() * sizeof(float));
-            // Lock mutex before accessing shared data
-            QMutexLocker locker(&dataMutex); // Lock the mutex
-            dataQueue.enqueue(audioChunk);   // Push the data into the queue
-            locker.unlock();                 // Unlock the mutex
-            dataCondition.wakeOne();         // Wake one waiting thread
+            device.inputFinished.store(true); // The processing thread reports the end once it has drained every ring
+            break;
+        }
+        if (live)
+        {
+            // Only a device's clock can drift; replayed and generated input keeps the host's
+            device.clock.addFrames(frames, arrivedNs);
         }
-        audioChunk.fill(0); // Reset all values to 0 without changing the size
-    }
-    Pa_CloseStream(paStream);
 
-    // Finalize WAV header and file
-    uint32_t fileDataSize = static_cast<uint32_t>(file.size() - sizeof(WAVHeader));
-    header.subchunk2Size = fileDataSize;
-    header.chunkSize = 36 + header.subchunk2Size;
+        // Queue the block for the writer thread, a slow disk never stalls this loop
+        if (recording)
+        {
+            device.recording->write(audioChunk.constData(), frames * channels);
+        }
 
-    // Go back and update the header with the correct sizes
-    file.seek(0);
-    file.write(reinterpret_cast<const char *>(&header), sizeof(WAVHeader));
-    file.close();
+        // Hand the block to the processing thread without locking. Raw audio is never dropped here:
+        // on a full ring the loop waits for room, so a replay at any speed reaches the spectrogram
+        // sample for sample. A device keeps its own buffer meanwhile and reports an input overflow
+        // if even that runs out, so for live input the wait is counted as a capture overflow.
+        bool waited = false;
+        while (!pushCaptured(device, audioChunk.constData(), frames, arrivedNs) && !stopFlag.load())
+        {
+            if (live && !waited)
+            {
+                pipelineStats.add(PipelineStats::CaptureOverflows);
+            }
+            waited = true;
+            QThread::usleep(200);
+        }
+    }
+    source.close();
+}
+
+// Capture side of a device's hand-off, from its input thread or its PortAudio callback.
+// `frames` frames of the device's interleaved channels go in whole or not at all.
+bool AudioProcessor::pushCaptured(CaptureDevice &device, const float *samples, int frames, qint64 arrivedNs)
+{
+    if (!device.ring.push(samples, frames * device.channels))
+    {
+        return false;
+    }
+    device.pushedSamples += frames;
+    if (timingEnabled)
+    {
+        const qint64 pushedNs = pipelineStats.now();
+        pipelineStats.record(PipelineStats::Capture, pushedNs - arrivedNs);
+        const PushStamp stamp{device.pushedSamples, pushedNs};
+        device.pushStamps.push(&stamp, 1); // If the stamps fall behind, later frames use a later stamp
+    }
+    return true;
 }
 
 QString AudioProcessor::setOutputPath(const QString &path)
@@ -204,185 +551,454 @@ QString AudioProcessor::setOutputPath(const QString &path)
     return outputPath;
 }
 
-void AudioProcessor::audioProcessingThreadFunction(uint32_t sampleRate)
+// One analysis lane per channel of every device, built by startProcessing() before capture
+// starts: a plan that cannot be created stops the run before anything fills the rings. From then
+// on the lanes belong to the processing thread, until stopProcessing() has joined it.
+bool AudioProcessor::createLanes()
 {
+    const int hopSize = windowSize - static_cast<int>(windowSize * windowOverlap);
+
+    // Each lane has its own window, FFT buffers and assembler; the FFTW plan and the filterbank
+    // come from the shared caches, so devices with the same rate share them too. Preset
+    // configurations get a compile-time specialised processor.
+    lanes = std::vector<ChannelLane>(activeChannels);
+    interleaved.clear();
+
+    // Frame workers are split evenly between the lanes; a lane with more than one hands its hops
+    // out to its own pool and takes the results back in order
+    const int totalWorkers = frameWorkers > 0 ? frameWorkers : qMax(1, QThread::idealThreadCount());
+    const int laneWorkers = qMax(1, totalWorkers / qMax(1, activeChannels));
+    maxBlockFrames = 1;
+    for (std::unique_ptr<CaptureDevice> &device : devices)
+    {
+        const uint32_t sampleRate = device->sampleRate;
 
-    // Variables for FFTW
-    fftwf_complex *in, *out;
-    fftwf_plan plan_forward;
-    QVector<float> window(windowSize);
+        // Frames are collected into one contiguous block per lane and handed on once per delivery interval
+        const int blockFrames = qMax(1, static_cast<int>(qint64(deliveryIntervalMs) * sampleRate / (1000 * qMax(1, hopSize))) + 1);
+        maxBlockFrames = qMax(maxBlockFrames, blockFrames);
 
-    // Initialize Hanning window
-    for (int i = 0; i < windowSize; ++i)
-    {
-        window[i] = 0.5 * (1 - cos(2 * M_PI * i / (windowSize - 1)));
-    }
+        for (int c = 0; c < device->channels; ++c)
+        {
+            ChannelLane &lane = lanes[device->firstLane + c];
+            lane.channel = device->firstLane + c;
+            lane.device = device.get();
+            lane.takesStamps = c == 0;
+            lane.processor = FrameProcessor::Create(windowSize, numMelFilters, sampleRate, fftPlanRigor);
+            if (!lane.processor->isValid())
+            {
+                emit errorOccurred(tr("Error: FFTW plan creation failed."));
+                lanes.clear();
+                return false;
+            }
+            if (laneWorkers > 1)
+            {
+                lane.workers = std::make_unique<FrameWorkerPool>();
+                if (!lane.workers->start(windowSize, numMelFilters, sampleRate, fftPlanRigor, laneWorkers))
+                {
+                    emit errorOccurred(tr("Error: FFTW plan creation failed."));
+                    lanes.clear();
+                    return false;
+                }
+                lane.workers->setStats(timingEnabled ? &pipelineStats : nullptr);
+            }
 
-    in = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * windowSize);
-    out = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * windowSize);
-    if (!in || !out)
-    {
-        emit errorOccurred("Failed to allocate memory for FFTW.");
-        fftwf_free(in);
-        fftwf_free(out);
-        fftwf_cleanup();
-        return;
+            // Log-mel output in dB; the running range relaxes by about 10 dB per second of audio
+            LogMelScale &scale = lane.processor->scale();
+            scale.setFloorDb(decibelFloor);
+            scale.setReferencePower(decibelReference);
+            scale.setNormalize(normalizeSpectrogram);
+            scale.setReleaseDbPerFrame(10.0f * hopSize / sampleRate);
+
+            // Circular frame assembly: samples are copied once into the lane and every hop is just an
+            // index advance, with the window applied on the way into the FFT input
+            lane.assembler.configure(windowSize, hopSize);
+
+            lane.block.channel = lane.channel;
+            lane.block.bands = lane.processor->numMelFilters();
+            lane.block.sampleRate = sampleRate;
+            lane.block.hopSize = lane.assembler.hopSize();
+            lane.block.reserve(blockFrames);
+            lane.store = spectrogramStores.empty() ? nullptr : spectrogramStores[lane.channel].get();
+
+            // Several channels arrive interleaved and are split into the lanes in batches of up to
+            // one assembler's worth of frames; a single channel is pulled straight from the ring
+            if (device->channels > 1)
+            {
+                lane.samples.resize(lane.assembler.capacity());
+                interleaved.resize(qMax(interleaved.size(), lane.assembler.capacity() * device->channels));
+            }
+        }
     }
+    return true;
+}
+
+void AudioProcessor::audioProcessingThreadFunction()
+{
+    lanePool.setMaxThreadCount(qMin(activeChannels, qMax(1, QThread::idealThreadCount())));
 
-    plan_forward = fftwf_plan_dft_1d(windowSize, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
-    if (!plan_forward)
+    // When the rings are empty, sleep for about half a capture block before polling them again
+    // (a source replaying faster than real time fills its ring that much sooner)
+    double speed = 1000.0; // Unthrottled sources poll at the lower bound
+    uint32_t slowestRate = 0;
+    for (const std::unique_ptr<CaptureDevice> &device : devices)
     {
-        emit errorOccurred(tr("Error: FFTW plan creation failed."));
-        fftwf_free(in);
-        fftwf_free(out);
-        fftwf_cleanup();
-        return;
+        const double deviceSpeed = !device->source || device->source->isLive() ? 1.0 : device->source->speed();
+        speed = qMin(speed, deviceSpeed > 0.0 ? deviceSpeed : 1000.0);
+        slowestRate = slowestRate == 0 ? device->sampleRate : qMin(slowestRate, device->sampleRate);
     }
+    unsigned long idleWaitUs = qBound(100UL, static_cast<unsigned long>(500000.0 * captureBlockSize / (qMax<uint32_t>(1, slowestRate) * speed)), 5000UL);
 
-    // Initialize these as member variables or parameters
-
-    int overlapSamples = static_cast<int>(windowSize * windowOverlap);
-    int hopSize = windowSize - overlapSamples;
+    // Coalescing may grow the newest waiting block of a lane to what a full queue would hold
+    renderQueue.configure(renderQueueBlocks * activeChannels, renderOverflowPolicy, maxBlockFrames * qMax(1, renderQueueBlocks));
+    const QMetaMethod perFrameSignal = QMetaMethod::fromSignal(&AudioProcessor::newLogMelSpectrogram);
+    QElapsedTimer deliveryTimer;
+    deliveryTimer.start();
 
-    QVector<float> audioBuffer; // This buffer will hold a large enough sample of audio to apply the window and overlap
     while (!stopFlag.load())
     { // Use load() to read the atomic variable
 
-        QMutexLocker locker(&dataMutex); // Lock the mutex
-        while (dataQueue.empty() && !stopFlag.load())
+        // Drain everything every device has captured so far, one batch per ring
+        updateDeviceGauges();
+        int pulled = 0;
+        for (std::unique_ptr<CaptureDevice> &device : devices)
         {
-            dataCondition.wait(&dataMutex); // Wait for the condition
+            pulled += feedLanes(*device, lanes, interleaved);
         }
-        if (stopFlag.load())
+
+        bool frameReady = false;
+        for (const ChannelLane &lane : lanes)
         {
-            break;
+            frameReady = frameReady || lane.assembler.frameReady();
         }
-        audioBuffer.append(dataQueue.dequeue()); // Dequeue the chunk and append to buffer
-        locker.unlock();                         // Unlock the mutex
-
-        while (audioBuffer.size() >= windowSize)
+        if (pulled == 0 && !frameReady)
         {
-            if (stopFlag.load())
+            // The flags are set after the last push, so empty rings now mean every source is done
+            bool finished = true;
+            for (const std::unique_ptr<CaptureDevice> &device : devices)
             {
-                break;
+                finished = finished && device->inputFinished.load() && device->ring.readAvailable() == 0;
             }
-            // Now process the audioBuffer from index 0 to windowSize
-            for (int i = 0; ((i < windowSize) && !stopFlag.load()); ++i)
+            if (finished)
             {
-                in[i][0] = audioBuffer[i] * window[i]; // Apply window function
-                in[i][1] = 0.0;
+                deliverLaneBlocks(lanes);
+                emit sourceFinished();
+                break;
             }
+            QThread::usleep(idleWaitUs);
+            continue;
+        }
 
-            fftwf_execute(plan_forward);
+        // FFT, Mel spectrum and dB conversion, straight into the blocks; the lanes of a
+        // multi-channel or multi-device input run side by side on the pool
+        const bool perFrame = isSignalConnected(perFrameSignal);
+        if (lanes.size() == 1)
+        {
+            processLane(lanes[0], perFrame);
+        }
+        else
+        {
+            QtConcurrent::blockingMap(&lanePool, lanes, [this, perFrame](ChannelLane &lane)
+                                      { processLane(lane, perFrame && lane.channel == 0); });
+        }
 
-            // Convert the FFT data to the Mel spectrum
-            QVector<float> melSpectrum = ConvertToMelSpectrum(out, windowSize, sampleRate);
-            emit newLogMelSpectrogram(melSpectrum);
-            // Remove the processed frame considering the overlap
-            audioBuffer.remove(0, hopSize);
+        bool computed = false;
+        for (const ChannelLane &lane : lanes)
+        {
+            computed = computed || !lane.block.isEmpty();
+        }
+        if (computed && deliveryTimer.elapsed() >= deliveryIntervalMs)
+        {
+            deliverLaneBlocks(lanes);
+            deliveryTimer.restart();
         }
     }
 
-    // Clean up FFTW resources
-    fftwf_destroy_plan(plan_forward);
-    fftwf_free(in);
-    fftwf_free(out);
-    fftwf_cleanup();
+    // Hand on whatever was computed since the last delivery
+    deliverLaneBlocks(lanes);
 }
 
-QVector<float> AudioProcessor::ConvertToMelSpectrum(fftwf_complex *fftData, int dataSize, int sampleRate)
+// Moves what the device's ring holds into its lanes' assemblers, as far as they have room.
+// Every lane of a device is fed and drained alike, so its first one speaks for all of them.
+// Returns the frames taken.
+int AudioProcessor::feedLanes(CaptureDevice &device, std::vector<ChannelLane> &lanes, QVector<float> &interleaved)
 {
-    // DataSize is even and greater than 0 to avoid division by zero
-    if (dataSize <= 0 || dataSize % 2 != 0)
+    ChannelLane &first = lanes[device.firstLane];
+    const int channels = device.channels;
+    if (channels == 1)
     {
-        emit errorOccurred("Invalid dataSize provided to ConvertToMelSpectrum.");
-        return {};
+        return first.assembler.pull(device.ring);
     }
 
-    // Compute the Mel filterbank
-    QVector<QVector<float>> melFilterbank = CreateMelFilterbank(numMelFilters, dataSize, sampleRate);
-
-    // Initialize the Mel spectrum vector
-    QVector<float> melSpectrum(numMelFilters, 0.0f);
-
-    // Convert each FFT bin to power
-    QVector<float> powerSpectrum(dataSize / 2);
-    for (int i = 0; i < dataSize / 2; ++i)
+    const int frames = qMin(device.ring.readAvailable() / channels, first.assembler.freeSpace());
+    if (frames > 0)
     {
-        powerSpectrum[i] = fftData[i][0] * fftData[i][0] + fftData[i][1] * fftData[i][1];
+        QVarLengthArray<float *, 16> outputs(channels); // Never allocates for up to 16 channels
+        for (int c = 0; c < channels; ++c)
+        {
+            outputs[c] = lanes[device.firstLane + c].samples.data();
+        }
+        device.ring.pop(interleaved.data(), frames * channels);
+        DspKernels::Active().deinterleave(interleaved.constData(), channels, frames, outputs.constData());
+        for (int c = 0; c < channels; ++c)
+        {
+            ChannelLane &lane = lanes[device.firstLane + c];
+            lane.assembler.write(lane.samples.constData(), frames);
+        }
     }
+    return frames;
+}
 
-    // Apply the filterbank to the power spectrum
-    for (int filterNum = 0; filterNum < numMelFilters; ++filterNum)
+// The gauges and counters that sum over every device, and the clock drift between the devices
+void AudioProcessor::updateDeviceGauges()
+{
+    PipelineStats &stats = pipelineStats;
+    qint64 queued = 0;
+    double fastest = 0.0;
+    double slowest = 0.0;
+    bool measured = false;
+    for (const std::unique_ptr<CaptureDevice> &device : devices)
     {
-        float melEnergy = 0.0f;
-        for (int bin = 0; bin < dataSize / 2; ++bin)
+        queued += device->ring.readAvailable() / device->channels;
+        if (device->clock.isMeasured())
         {
-            melEnergy += powerSpectrum[bin] * melFilterbank[filterNum][bin];
+            const double drift = device->clock.driftPpm();
+            fastest = measured ? qMax(fastest, drift) : drift;
+            slowest = measured ? qMin(slowest, drift) : drift;
+            measured = true;
         }
-        melSpectrum[filterNum] = melEnergy; // Adding a small value to prevent log(0) can be done if log is taken later
     }
-
-    return melSpectrum;
+    stats.setGauge(PipelineStats::CaptureQueue, queued);
+    stats.setGauge(PipelineStats::RecordingBacklog, recordingBacklog());
+    stats.set(PipelineStats::RecordingDrops, recordingDropCount());
+    stats.setGauge(PipelineStats::ClockDrift, qRound64(fastest - slowest));
+    reportWriteFailures();
 }
 
-QVector<QVector<float>> AudioProcessor::CreateMelFilterbank(int numFilters, int fftSize, int sampleRate)
+// Computes every frame buffered in the lane into its block. Lanes may run concurrently: the
+// stats are lock-free, only the first lane of each device takes that device's push stamps, and
+// only the very first lane feeds the per-frame signal.
+void AudioProcessor::processLane(ChannelLane &lane, bool emitPerFrame)
 {
-    QVector<QVector<float>> filterbank;
-    filterbank.reserve(numFilters);
+    if (lane.workers)
+    {
+        processLaneParallel(lane, emitPerFrame);
+        return;
+    }
 
-    // Compute the Mel frequency limits
-    const float lowerMelFreq = FrequencyToMel(0);
-    const float upperMelFreq = FrequencyToMel(sampleRate / 2);
-    const float melStep = (upperMelFreq - lowerMelFreq) / (numFilters + 1);
+    PipelineStats &stats = pipelineStats;
+    FrameProcessor &frameProcessor = *lane.processor;
+    FrameAssembler &assembler = lane.assembler;
+    SpectrogramBlock &block = lane.block;
 
-    QVector<float> melPoints;
-    melPoints.reserve(numFilters + 2);
+    qint64 framePosition = assembler.nextFramePosition();
+    while (assembler.nextFrame(frameProcessor.window(), frameProcessor.input()))
+    {
+        if (stopFlag.load())
+        {
+            break;
+        }
 
-    QVector<float> binFrequencies;
-    binFrequencies.reserve(numFilters + 2);
+        float *melSpectrum = block.appendFrame(framePosition);
+        if (timingEnabled)
+        {
+            const qint64 startNs = stats.now();
+            recordQueueWait(lane, framePosition, startNs);
+
+            frameProcessor.transform();
+            const qint64 fftDoneNs = stats.now();
+            frameProcessor.melFromSpectrum(melSpectrum);
+            const qint64 melDoneNs = stats.now();
+            stats.record(PipelineStats::Fft, fftDoneNs - startNs);
+            stats.record(PipelineStats::Mel, melDoneNs - fftDoneNs);
+            if (block.frameCount() == 1)
+            {
+                block.firstFrameReadyNs = melDoneNs;
+            }
+        }
+        else
+        {
+            frameProcessor.process(melSpectrum);
+        }
+        stats.add(PipelineStats::FramesProcessed);
+        framePosition = assembler.nextFramePosition();
+
+        // Legacy per-frame signal, costs one allocation and one event per frame when used
+        if (emitPerFrame)
+        {
+            emit newLogMelSpectrogram(QVector<float>(melSpectrum, melSpectrum + block.bands));
+        }
+    }
+}
 
-    QVector<int> bins;
-    bins.reserve(numFilters + 2);
+// processLane() on the lane's worker pool: every ready hop is windowed into a free slot and
+// handed out, and the reorder stage puts the finished frames through the dB scale and into the
+// block in time order, so the output is the same as computing them one after the other.
+// Returns once the assembler is drained and nothing is in flight.
+void AudioProcessor::processLaneParallel(ChannelLane &lane, bool emitPerFrame)
+{
+    PipelineStats &stats = pipelineStats;
+    FrameWorkerPool &workers = *lane.workers;
+    FrameAssembler &assembler = lane.assembler;
+    LogMelScale &scale = lane.processor->scale();
+    SpectrogramBlock &block = lane.block;
 
-    for (int i = 0; i <= numFilters + 1; ++i)
+    while (!stopFlag.load())
     {
-        float melPoint = lowerMelFreq + i * melStep;
-        melPoints.push_back(melPoint);
-        binFrequencies.push_back(MelToFrequency(melPoint));
-        bins.push_back(static_cast<int>(floor((fftSize + 1) * binFrequencies.last() / sampleRate)));
+        float *input = nullptr;
+        while (assembler.frameReady() && (input = workers.nextInput()) != nullptr)
+        {
+            const qint64 framePosition = assembler.nextFramePosition();
+            if (timingEnabled)
+            {
+                recordQueueWait(lane, framePosition, stats.now());
+            }
+            assembler.nextFrame(lane.processor->window(), input);
+            workers.submit(framePosition);
+        }
+        if (workers.inFlight() == 0)
+        {
+            break;
+        }
+
+        qint64 framePosition = 0;
+        float *melEnergies = nullptr;
+        if (!workers.takeCompleted(&framePosition, &melEnergies))
+        {
+            workers.waitForOldest();
+            continue;
+        }
+        do
+        {
+            float *melSpectrum = block.appendFrame(framePosition);
+            std::copy(melEnergies, melEnergies + block.bands, melSpectrum);
+            workers.release();
+            scale.apply(melSpectrum, block.bands);
+            if (timingEnabled && block.frameCount() == 1)
+            {
+                block.firstFrameReadyNs = stats.now();
+            }
+            stats.add(PipelineStats::FramesProcessed);
+
+            if (emitPerFrame)
+            {
+                emit newLogMelSpectrogram(QVector<float>(melSpectrum, melSpectrum + block.bands));
+            }
+        } while (workers.takeCompleted(&framePosition, &melEnergies));
     }
+}
 
-    for (int i = 1; i <= numFilters; ++i)
+// How long the frame ending past framePosition + windowSize waited since its last samples were
+// pushed, for the lanes that follow their device's push stamps
+void AudioProcessor::recordQueueWait(ChannelLane &lane, qint64 framePosition, qint64 nowNs)
+{
+    if (!lane.takesStamps)
     {
-        QVector<float> filter(fftSize / 2, 0.0f);
-        int startBin = bins[i - 1];
-        int centerBin = bins[i];
-        int endBin = bins[i + 1];
+        return;
+    }
+    PushStamp &stamp = lane.stamp;
+    const qint64 frameEnd = framePosition + windowSize;
+    while (stamp.endPosition < frameEnd && lane.device->pushStamps.pop(&stamp, 1) == 1)
+    {
+    }
+    if (stamp.endPosition >= frameEnd)
+    {
+        pipelineStats.record(PipelineStats::QueueWait, nowNs - stamp.time);
+    }
+}
 
-        for (int j = startBin; j < centerBin; ++j)
+void AudioProcessor::deliverLaneBlocks(std::vector<ChannelLane> &lanes)
+{
+    for (ChannelLane &lane : lanes)
+    {
+        if (!lane.block.isEmpty())
         {
-            filter[j] = (j - startBin) / static_cast<float>(centerBin - startBin);
+            if (lane.store)
+            {
+                lane.store->write(lane.block); // Before delivery, which may hand the rows on to the GUI
+            }
+            deliverSpectrogramBlock(lane.block);
         }
-        for (int j = centerBin; j < endBin; ++j)
+    }
+}
+
+void AudioProcessor::deliverSpectrogramBlock(SpectrogramBlock &block)
+{
+    if (SpectrogramSink *sink = spectrogramSink.load())
+    {
+        sink->consumeSpectrogramBlock(block);
+    }
+    pipelineStats.add(PipelineStats::BlocksDelivered);
+    const int frames = block.frameCount();
+
+    // Queue only while someone drains it, otherwise the blocks would just be dropped later
+    if (isSignalConnected(QMetaMethod::fromSignal(&AudioProcessor::spectrogramBlocksReady)))
+    {
+        // Only this thread drops or coalesces, so the differences are this push's doing
+        const quint64 droppedBefore = renderQueue.droppedFrames();
+        const quint64 coalescedBefore = renderQueue.coalescedBlocks();
+        const bool wake = renderQueue.push(block); // Leaves `block` empty on recycled storage
+        pipelineStats.add(PipelineStats::RenderDrops, renderQueue.droppedFrames() - droppedBefore);
+        pipelineStats.add(PipelineStats::RenderCoalesced, renderQueue.coalescedBlocks() - coalescedBefore);
+        pipelineStats.setGauge(PipelineStats::BlockBacklog, renderQueue.size());
+        if (wake)
         {
-            filter[j] = (1.0f - (j - centerBin) / static_cast<float>(endBin - centerBin));
+            emit spectrogramBlocksReady(); // One queued event per empty-to-non-empty transition
         }
+    }
+
+    block.clear();
+    block.reserve(frames);
+}
+
+bool AudioProcessor::takeSpectrogramBlock(SpectrogramBlock &block)
+{
+    if (!renderQueue.pop(block))
+    {
+        return false;
+    }
+    pipelineStats.setGauge(PipelineStats::BlockBacklog, renderQueue.size());
+    return true;
+}
 
-        filterbank.push_back(std::move(filter)); // Use move semantics to avoid copying
+QVector<float> AudioProcessor::ConvertToMelSpectrum(fftwf_complex *fftData, int dataSize, int sampleRate)
+{
+    // DataSize is even and greater than 0 to avoid division by zero
+    if (dataSize <= 0 || dataSize % 2 != 0)
+    {
+        emit errorOccurred("Invalid dataSize provided to ConvertToMelSpectrum.");
+        return {};
+    }
+
+    // The filterbank only depends on the analysis settings, so rebuild it only when they change
+    if (!melFilterbank.matches(dataSize, numMelFilters, sampleRate))
+    {
+        melFilterbank.build(dataSize, numMelFilters, sampleRate);
     }
 
-    return filterbank;
+    // Convert each FFT bin to power
+    powerSpectrum.resize(dataSize / 2);
+    FrameProcessor::PowerSpectrum(fftData, dataSize / 2, powerSpectrum.data());
+
+    // Apply the sparse filterbank to the power spectrum
+    QVector<float> melSpectrum(melFilterbank.numFilters(), 0.0f);
+    melFilterbank.apply(powerSpectrum.constData(), melSpectrum.data());
+
+    return melSpectrum;
+}
+
+QVector<QVector<float>> AudioProcessor::CreateMelFilterbank(int numFilters, int fftSize, int sampleRate)
+{
+    return MelFilterbank(fftSize, numFilters, sampleRate).toDense();
 }
 
 // Helper function to convert Mel to frequency
 float AudioProcessor::MelToFrequency(float mel)
 {
-    return 700.0f * (pow(10.0f, mel / 2595.0f) - 1.0f);
+    return MelFilterbank::MelToFrequency(mel);
 }
 
 // Helper function to convert frequency to Mel scale
 float AudioProcessor::FrequencyToMel(float frequency)
 {
-    return 2595.0f * log10(1.0f + frequency / 700.0f);
+    return MelFilterbank::FrequencyToMel(frequency);
 }
@@ -1,75 +1,231 @@
 #ifndef AUDIOPROCESSOR_H
 #define AUDIOPROCESSOR_H
 
+#include "audiosource.h"
+#include "clockdriftmonitor.h"
+#include "fftplancache.h"
+#include "frameassembler.h"
+#include "frameprocessor.h"
+#include "frameworkerpool.h"
+#include "melfilterbank.h"
+#include "pipelinestats.h"
+#include "recordingwriter.h"
+#include "spectrogramblock.h"
+#include "spectrogramblockqueue.h"
+#include "spectrogramstore.h"
+#include "spscringbuffer.h"
+#include "wavwriter.h"
+
 #include <fftw3.h>
 #include <portaudio.h>
 
 #include <mutex>
+#include <memory>
 #include <queue>
 #include <vector>
 #include <atomic>
 #include <QMutex>
-#include <QQueue>
 #include <fstream>
 #include <QObject>
 #include <QThread>
+#include <QThreadPool>
 #include <QVector>
-#include <QWaitCondition>
 #include <condition_variable>
 
-struct WAVHeader
-{
-    char chunkID[4] = {'R', 'I', 'F', 'F'};
-    uint32_t chunkSize; // Size of the entire file in bytes minus 8 bytes
-    char format[4] = {'W', 'A', 'V', 'E'};
-    char subchunk1ID[4] = {'f', 'm', 't', ' '};
-    uint32_t subchunk1Size = 16; // PCM header size
-    uint16_t audioFormat = 3;    // PCM = 1 | 3 - IEEE float
-    uint16_t numChannels;        // Mono = 1
-    uint32_t sampleRate;
-    uint32_t byteRate;           // sampleRate * numChannels * bitsPerSample/8
-    uint16_t blockAlign;         // numChannels * bitsPerSample/8
-    uint16_t bitsPerSample = 32; // 8 bits = 8, 16 bits = 16, etc.
-    char subchunk2ID[4] = {'d', 'a', 't', 'a'};
-    uint32_t subchunk2Size; // numSamples * numChannels * bitsPerSample/8
-};
-
 class AudioProcessor : public QObject
 {
     Q_OBJECT
     friend class TestAudioProcessor;
+    friend class PipelineBenchmark;
+    friend class TestMainWindow;
 
 public:
+    enum CaptureMode
+    {
+        BlockingCapture, // Pa_ReadStream on a dedicated input thread
+        CallbackCapture  // PortAudio callback pushes straight into the rings, no input thread; device input only
+    };
+
     int numMelFilters = 25;
     int windowSize = 512;      // window size
     float windowOverlap = 0.5; // 50% overlap
+    FftPlanCache::PlanRigor fftPlanRigor = FftPlanCache::Estimate; // Measure/Patient pay off once wisdom is saved
+    float decibelFloor = -80.0f;      // Lowest level of the log-mel output, in dB
+    float decibelReference = 1.0f;    // Mel energy that maps to 0 dB
+    bool normalizeSpectrogram = true; // Scale the dB output to [0, 1] by its running min/max, for display
+    CaptureMode captureMode = BlockingCapture;
+    int captureBlockSize = 256; // Frames per PortAudio buffer, independent of windowSize
+    int inputChannels = 1;      // Channels opened on each input device; replayed and generated sources bring their own
+    QVector<int> inputDevices;  // PortAudio devices captured side by side in one run, empty for the default input device
+    int deliveryIntervalMs = 50; // Frames are batched into one SpectrogramBlock per interval, 0 delivers every frame
+    bool recordInput = true;     // Write the input of each run to a file in the output path
+    RecordingWriter::Format recordingFormat = RecordingWriter::Wav; // Flac needs libFLAC at build time
+    int recordingBitDepth = 24;  // Sample depth of formats that quantise the float input (FLAC)
+    double recordingSegmentSeconds = 0.0; // WAV: start a new file after this much audio, 0 for one file per run
+    qint64 recordingSegmentBytes = 0;     // WAV: ...or before a file would grow past this size
+    bool collectStats = true;    // Per-frame latency timing into stats(); counters and gauges are always kept
+    int frameWorkers = 1;        // Threads computing frames, split between the lanes; 1 computes each lane in order, 0 uses every core
+    bool storeSpectrogram = false; // Also write every frame of each channel to an .egspec store in the output path
+    SpectrogramStoreWriter::ValueFormat spectrogramStoreFormat = SpectrogramStoreWriter::Float32;
+
+    // Every hop between threads is bounded. Capture to processing never drops raw audio: a full
+    // ring makes the input thread wait and counts a capture overflow (CallbackCapture cannot wait,
+    // so there the block is only recorded). Processing to the GUI holds at most renderQueueBlocks
+    // blocks and sheds load by renderOverflowPolicy.
+    int captureQueueMs = 500;  // Capture ring size, in milliseconds of audio
+    int renderQueueBlocks = 8; // Blocks waiting for the GUI before the overflow policy applies
+    SpectrogramBlockQueue::OverflowPolicy renderOverflowPolicy = SpectrogramBlockQueue::DropOldest;
 
     explicit AudioProcessor(QObject *parent = nullptr);
     ~AudioProcessor();
 
     QString setOutputPath(const QString &path); // Method to set the output path
-    void startProcessing();
+    bool startProcessing(); // False if the run could not start, see errorOccurred
     void stopProcessing();
 
+    // Direct, same-thread delivery of every block; set before startProcessing(), nullptr to disable
+    void setSpectrogramSink(SpectrogramSink *sink) { spectrogramSink.store(sink); }
+
+    // GUI side of the render queue: takes the oldest waiting block into `block`, reusing its storage.
+    // Call until it returns false after each spectrogramBlocksReady().
+    bool takeSpectrogramBlock(SpectrogramBlock &block);
+
+    // Where samples come from; set before startProcessing(), nullptr for the input devices.
+    // addAudioSource() captures one more source side by side with those already set.
+    void setAudioSource(std::unique_ptr<AudioSource> source);
+    void addAudioSource(std::unique_ptr<AudioSource> source);
+    AudioSource *audioSource() const { return customSources.empty() ? nullptr : customSources.front().get(); }
+
+    // Channels captured, recorded and analysed in the current or last run, set by startProcessing(),
+    // counted across all devices in order. Each gets its own analysis lane and its own spectrogram
+    // blocks (SpectrogramBlock::channel).
+    int channelCount() const { return activeChannels; }
+
+    // Devices or sources captured in the current or last run, each with its own stream, capture
+    // ring, recording and sample clock
+    int deviceCount() const { return static_cast<int>(devices.size()); }
+    int deviceChannelCount(int device) const { return devices[device]->channels; }
+    int deviceSampleRate(int device) const { return static_cast<int>(devices[device]->sampleRate); }
+
+    // How fast the sample clock of a live device runs against the host clock, in ppm, once a few
+    // seconds have been measured (0 before, and for replayed or generated input). Devices that
+    // drift apart slowly misalign their spectrograms; the ClockDrift gauge tracks the worst pair.
+    double clockDriftPpm(int device) const { return devices[device]->clock.driftPpm(); }
+    bool isClockDriftMeasured(int device) const { return devices[device]->clock.isMeasured(); }
+
+    // Latency histograms, counters and gauges of the current or last run; reset by startProcessing().
+    // The GUI records the render stage into it too.
+    PipelineStats &stats() { return pipelineStats; }
+    const PipelineStats &stats() const { return pipelineStats; }
+
+    quint64 captureOverflowCount() const { return pipelineStats.counter(PipelineStats::CaptureOverflows); } // Blocks that waited for, or in callback mode missed, room in the DSP ring
+    quint64 inputOverflowCount() const { return pipelineStats.counter(PipelineStats::InputOverflows); }     // Blocks PortAudio reported as overflowed
+    qint64 recordingBacklog() const;    // Samples not yet on disk, over every device's recording
+    quint64 recordingDropCount() const;
+
 signals:
-    void newLogMelSpectrogram(const QVector<float> &spectrum);
+    void spectrogramBlocksReady(); // The render queue went from empty to non-empty; drain it with takeSpectrogramBlock()
+    void newLogMelSpectrogram(const QVector<float> &spectrum); // Per frame of channel 0, only emitted while something is connected
     void errorOccurred(const QString &errorMessage); // Signal to report errors
+    void sourceFinished(); // The audio source ran out, e.g. a replayed file ended, and all of it has been delivered
 
 private:
-    PaStream *paStream;                // Initialize to nullptr
     std::atomic<bool> stopFlag{false}; // Ensure it is initialized
-    QThread *audioInputThread;         // Separate thread for audio input
     QThread *audioProcessingThread;    // Separate thread for audio processing
+    int activeChannels = 1;            // Lanes over all devices, latched by startProcessing()
+
+    // When each pushed block became available, so processing can tell how long a frame waited
+    struct PushStamp
+    {
+        qint64 endPosition; // Stream position just past the block's last sample
+        qint64 time;        // PipelineStats::now() at the push
+    };
+
+    // One stream captured this run: an input device or a custom source. Everything on the capture
+    // side is per device, since devices run on clocks of their own and cannot share a ring or a file.
+    struct CaptureDevice
+    {
+        AudioProcessor *owner = nullptr; // For the PortAudio callback
+        int index = 0;                   // Position in `devices`
+        int channels = 1;
+        uint32_t sampleRate = 44100;
+        int firstLane = 0;               // Lane of the device's first channel
+
+        AudioSource *source = nullptr; // Read by the input thread, BlockingCapture
+        PaStream *stream = nullptr;    // Driving the callback, CallbackCapture
+        QThread *inputThread = nullptr;
+        std::atomic<bool> inputFinished{false}; // Set by the input thread after its last push
+
+        SpscRingBuffer<float> ring;           // Lock-free hand-off of interleaved samples from capture to processing
+        SpscRingBuffer<PushStamp> pushStamps;
+        qint64 pushedSamples = 0; // Frames pushed so far, capture side only
+        std::unique_ptr<RecordingWriter> recording; // Writes this device's file on its own thread
+        ClockDriftMonitor clock;  // Live input only
+    };
+    std::vector<std::unique_ptr<CaptureDevice>> devices; // Rebuilt by startProcessing(), kept for queries until the next run
 
-    QMutex dataMutex;                 // Mutex for synchronizing access to the dataQueue
-    QWaitCondition dataCondition;     // Condition variable for data availability
-    QQueue<QVector<float>> dataQueue; // Queue to hold chunks of audio data
+    PipelineStats pipelineStats;
+    bool timingEnabled = true; // collectStats latched by startProcessing()
+
+    CaptureMode activeCaptureMode = BlockingCapture; // captureMode latched by startProcessing()
+    std::atomic<SpectrogramSink *> spectrogramSink{nullptr};
+    SpectrogramBlockQueue renderQueue; // Bounded hand-off of blocks to the GUI thread
+
+    std::vector<std::unique_ptr<AudioSource>> customSources;     // Set by setAudioSource() and addAudioSource()
+    std::vector<std::unique_ptr<PortAudioSource>> deviceSources; // Input devices, used when there is no custom source
 
     QString outputPath; // Member variable to hold the output path
+    QString recordingName; // output_<date> of the current run, shared by the files of all devices
     QMutex pathMutex;   // Mutex to protect access to outputPath
 
-    void audioInputThreadFunction();
-    void audioProcessingThreadFunction(uint32_t sampleRate);
+    // One analysis pipeline per input channel, owned by the processing thread
+    struct ChannelLane
+    {
+        int channel = 0;                 // Across all devices
+        CaptureDevice *device = nullptr; // Whose ring feeds the lane
+        bool takesStamps = false;        // The device's first lane follows its push stamps for QueueWait
+        PushStamp stamp{-1, 0};          // Latest stamp taken, if takesStamps
+        std::unique_ptr<FrameProcessor> processor;
+        std::unique_ptr<FrameWorkerPool> workers; // Set when the lane has more than one frame worker
+        SpectrogramStoreWriter *store = nullptr; // Set when storeSpectrogram, one of spectrogramStores
+        FrameAssembler assembler;
+        SpectrogramBlock block;
+        QVector<float> samples; // This channel's share of the latest batch from the ring
+    };
+    std::vector<ChannelLane> lanes; // Built by createLanes() before capture starts
+    QVector<float> interleaved;     // Batch popped from a multi-channel ring, sized for the widest device
+    int maxBlockFrames = 1;         // Largest block a lane collects per delivery interval
+    std::vector<const RecordingWriter *> reportedWriters; // Failed writers errorOccurred has named this run
+    std::vector<std::unique_ptr<SpectrogramStoreWriter>> spectrogramStores; // One per lane when storeSpectrogram, opened before capture starts
+    QThreadPool lanePool; // One worker pool for the lanes of every channel of every device
+
+    MelFilterbank melFilterbank; // Built once per (windowSize, numMelFilters, sampleRate), reused every frame
+    QVector<float> powerSpectrum; // Scratch buffer for the per-frame power spectrum
+
+    void audioInputThreadFunction(CaptureDevice &device);
+    void audioProcessingThreadFunction();
+
+    bool openDevices();
+    void closeDevices();
+    bool openSource(CaptureDevice &device);
+    bool startCallbackCapture(CaptureDevice &device, PaDeviceIndex inputDevice);
+    bool openRecording(CaptureDevice &device);
+    void finishRecording();
+    bool openSpectrogramStores();
+    bool createLanes();
+    int feedLanes(CaptureDevice &device, std::vector<ChannelLane> &lanes, QVector<float> &interleaved);
+    void processLane(ChannelLane &lane, bool emitPerFrame);
+    void processLaneParallel(ChannelLane &lane, bool emitPerFrame);
+    void recordQueueWait(ChannelLane &lane, qint64 framePosition, qint64 nowNs);
+    void deliverLaneBlocks(std::vector<ChannelLane> &lanes);
+    void deliverSpectrogramBlock(SpectrogramBlock &block);
+    void resetCaptureRings(CaptureDevice &device);
+    bool pushCaptured(CaptureDevice &device, const float *samples, int frames, qint64 arrivedNs);
+    void updateDeviceGauges();
+    void reportWriteFailures();
+    static int captureCallback(const void *input, void *output, unsigned long frameCount,
+                               const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags,
+                               void *userData);
 
     // Helper functions
     QVector<QVector<float>> CreateMelFilterbank(int numFilters, int fftSize, int sampleRate);
@@ -0,0 +1,134 @@
+#include "audiosource.h"
+
+#include <QThread>
+#include <algorithm>
+
+void AudioSource::startClock()
+{
+    clock.start();
+}
+
+void AudioSource::pace(qint64 position)
+{
+    if (playbackSpeed <= 0.0 || !clock.isValid())
+    {
+        return; // Unthrottled
+    }
+    const qint64 dueNs = static_cast<qint64>(position * 1e9 / (sampleRate() * playbackSpeed));
+    const qint64 aheadNs = dueNs - clock.nsecsElapsed();
+    if (aheadNs > 0)
+    {
+        QThread::usleep(static_cast<unsigned long>(aheadNs / 1000));
+    }
+}
+
+PortAudioSource::PortAudioSource(PaDeviceIndex device, int desiredSampleRate, int channels)
+    : device(device), desiredSampleRate(desiredSampleRate), channels(qMax(1, channels)), rate(desiredSampleRate)
+{
+}
+
+PortAudioSource::~PortAudioSource()
+{
+    close();
+}
+
+PaError PortAudioSource::OpenInputStream(PaStream **stream, PaDeviceIndex device, int desiredSampleRate, int channels, unsigned long blockSize,
+                                         PaStreamCallback *callback, void *userData, uint32_t *sampleRate)
+{
+    PaStreamParameters inputParameters;
+    inputParameters.device = device == paNoDevice ? Pa_GetDefaultInputDevice() : device;
+    if (inputParameters.device == paNoDevice)
+    {
+        return paDeviceUnavailable;
+    }
+
+    const PaDeviceInfo *deviceInfo = Pa_GetDeviceInfo(inputParameters.device);
+    if (!deviceInfo)
+    {
+        return paInvalidDevice;
+    }
+    if (channels < 1 || channels > deviceInfo->maxInputChannels)
+    {
+        return paInvalidChannelCount;
+    }
+
+    // Check and set the sample rate based on device capability
+    *sampleRate = std::min(deviceInfo->defaultSampleRate, static_cast<double>(desiredSampleRate));
+
+    inputParameters.channelCount = channels;  // Interleaved, one sample per channel per frame
+    inputParameters.sampleFormat = paFloat32; // 32-bit floating point input
+    inputParameters.suggestedLatency = deviceInfo->defaultLowInputLatency;
+    inputParameters.hostApiSpecificStreamInfo = nullptr;
+
+    return Pa_OpenStream(
+        stream,
+        &inputParameters,
+        nullptr,     // No output parameters for recording only
+        *sampleRate, // Sample rate
+        blockSize,   // Frames per buffer, independent of the analysis window
+        paClipOff,   // We won't output out-of-range samples so don't bother clipping them
+        callback,    // Nullptr selects the blocking API
+        userData);   // Handed back to the callback
+}
+
+bool PortAudioSource::open(int blockSize)
+{
+    close();
+    overflows.store(0);
+
+    uint32_t actualRate = 0;
+    PaError err = OpenInputStream(&stream, device, desiredSampleRate, channels, blockSize, nullptr, nullptr, &actualRate);
+    if (err == paNoError)
+    {
+        rate = static_cast<int>(actualRate);
+        err = Pa_StartStream(stream);
+        if (err != paNoError)
+        {
+            Pa_CloseStream(stream);
+        }
+    }
+    if (err != paNoError)
+    {
+        stream = nullptr;
+        lastError = QString("PortAudio error: open stream: %1").arg(Pa_GetErrorText(err));
+        return false;
+    }
+    return true;
+}
+
+void PortAudioSource::close()
+{
+    if (stream)
+    {
+        Pa_StopStream(stream);
+        Pa_CloseStream(stream);
+        stream = nullptr;
+    }
+}
+
+QString PortAudioSource::description() const
+{
+    const PaDeviceIndex index = device == paNoDevice ? Pa_GetDefaultInputDevice() : device;
+    const PaDeviceInfo *info = index == paNoDevice ? nullptr : Pa_GetDeviceInfo(index);
+    if (!info)
+    {
+        return QString("Input device: none");
+    }
+    return channels > 1 ? QString("Input device: %1, %2 channels").arg(info->name).arg(channels) : QString("Input device: %1").arg(info->name);
+}
+
+int PortAudioSource::read(float *buffer, int frames)
+{
+    PaError err = Pa_ReadStream(stream, buffer, frames);
+    if (err == paInputOverflowed)
+    {
+        overflows.fetch_add(1, std::memory_order_relaxed); // Data is still valid, just late
+        err = paNoError;
+    }
+    if (err != paNoError)
+    {
+        lastError = QString("PortAudio error: read stream: %1").arg(Pa_GetErrorText(err));
+        return -1;
+    }
+    return frames;
+}
@@ -0,0 +1,82 @@
+#ifndef AUDIOSOURCE_H
+#define AUDIOSOURCE_H
+
+#include <portaudio.h>
+
+#include <atomic>
+#include <QElapsedTimer>
+#include <QString>
+
+// Where AudioProcessor's input thread gets its samples from.
+// A live source (the sound card) produces samples on its own clock and loses them if they are
+// not read in time. Any other source produces them on demand, paced to the wall clock at
+// speed() times real time or as fast as they are read, and the reader may make it wait.
+class AudioSource
+{
+public:
+    virtual ~AudioSource() = default;
+
+    // Prepares a run of reads of about blockSize frames. False, with errorString() set, on failure.
+    // A source can be opened again after close() and starts from the beginning.
+    virtual bool open(int blockSize) = 0;
+    virtual void close() = 0;
+    virtual int sampleRate() const = 0;
+    virtual int channelCount() const { return 1; } // Samples per frame; fixed once open() succeeded
+    virtual bool isLive() const { return false; }
+    virtual QString description() const = 0;
+
+    // Fills up to `frames` frames of channelCount() interleaved samples, waiting as long as the
+    // source's clock demands. Returns the number of frames written, 0 once the source is
+    // exhausted, -1 on error.
+    virtual int read(float *buffer, int frames) = 0;
+
+    QString errorString() const { return lastError; }
+    quint64 overflowCount() const { return overflows.load(); } // Blocks a live source lost before they were read
+
+    // 1 = real time, N = N times real time, 0 = as fast as possible. Live sources ignore it.
+    void setSpeed(double factor) { playbackSpeed = qMax(0.0, factor); }
+    double speed() const { return playbackSpeed; }
+
+protected:
+    void startClock();          // Call from open(): position 0 is now
+    void pace(qint64 position); // Sleeps until `position` samples are due at speed()
+
+    QString lastError;
+    std::atomic<quint64> overflows{0};
+
+private:
+    double playbackSpeed = 1.0;
+    QElapsedTimer clock;
+};
+
+// The sound card, through PortAudio's blocking API. Pa_Initialize() must have been called.
+class PortAudioSource : public AudioSource
+{
+public:
+    // paNoDevice selects the default input device
+    explicit PortAudioSource(PaDeviceIndex device = paNoDevice, int desiredSampleRate = 44100, int channels = 1);
+    ~PortAudioSource() override;
+
+    bool open(int blockSize) override;
+    void close() override;
+    int sampleRate() const override { return rate; }
+    int channelCount() const override { return channels; }
+    bool isLive() const override { return true; }
+    QString description() const override;
+    int read(float *buffer, int frames) override;
+    PaDeviceIndex deviceIndex() const { return device; } // As given, paNoDevice for the default device
+
+    // Opens an interleaved float32 input stream of `channels` channels, blocking if callback is
+    // nullptr. Also used by AudioProcessor's callback capture, which runs without an input thread.
+    static PaError OpenInputStream(PaStream **stream, PaDeviceIndex device, int desiredSampleRate, int channels, unsigned long blockSize,
+                                   PaStreamCallback *callback, void *userData, uint32_t *sampleRate);
+
+private:
+    PaDeviceIndex device;
+    int desiredSampleRate;
+    int channels;
+    int rate;
+    PaStream *stream = nullptr;
+};
+
+#endif // AUDIOSOURCE_H
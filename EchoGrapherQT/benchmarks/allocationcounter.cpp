@@ -0,0 +1,106 @@
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<quint64> allocations{0};
+
+inline void Count()
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+}
+}
+
+quint64 AllocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+
+// glibc lets the executable interpose the malloc family; the real implementations stay
+// reachable under their __libc_ names. operator new ends up here as well.
+extern "C"
+{
+    void *__libc_malloc(std::size_t size);
+    void *__libc_calloc(std::size_t count, std::size_t size);
+    void *__libc_realloc(void *memory, std::size_t size);
+
+    void *malloc(std::size_t size)
+    {
+        Count();
+        return __libc_malloc(size);
+    }
+
+    void *calloc(std::size_t count, std::size_t size)
+    {
+        Count();
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *memory, std::size_t size)
+    {
+        Count();
+        return __libc_realloc(memory, size);
+    }
+}
+
+bool AllocationCountIncludesMalloc()
+{
+    return true;
+}
+
+#else
+
+namespace
+{
+void *CountedNew(std::size_t size)
+{
+    Count();
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+}
+
+void *operator new(std::size_t size)
+{
+    return CountedNew(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return CountedNew(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+bool AllocationCountIncludesMalloc()
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// Number of heap allocations made by the whole process so far.
+// allocationcounter.cpp replaces the global allocation functions to count them, so only
+// link it into the benchmark binary. On glibc malloc itself is wrapped, which also catches
+// Qt containers; elsewhere only operator new is counted.
+quint64 AllocationCount();
+
+// True when AllocationCount() sees malloc as well as operator new
+bool AllocationCountIncludesMalloc();
+
+#endif // ALLOCATIONCOUNTER_H
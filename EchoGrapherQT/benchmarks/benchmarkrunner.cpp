@@ -0,0 +1,96 @@
+// Benchmark driver for the EchoGrapher DSP pipeline.
+// Prints a table and optionally writes every result as JSON for tracking between releases.
+
+#include "allocationcounter.h"
+#include "dspkernels.h"
+#include "pipelinebenchmark.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QThread>
+#include <QFile>
+#include <cstdio>
+
+namespace
+{
+QString Describe(const QJsonObject &parameters)
+{
+    QStringList parts;
+    for (auto it = parameters.constBegin(); it != parameters.constEnd(); ++it)
+    {
+        parts.append(it.key() + "=" + it.value().toVariant().toString());
+    }
+    return parts.join(' ');
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("EchoGrapherBenchmarks");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the EchoGrapher DSP pipeline on synthetic audio.");
+    parser.addHelpOption();
+    QCommandLineOption jsonOption({"j", "json"}, "Write results as JSON to this file.", "file");
+    QCommandLineOption minTimeOption({"t", "min-time"}, "Minimum measuring time per case.", "seconds", "0.25");
+    QCommandLineOption filterOption({"f", "filter"}, "Only run cases whose name contains this.", "name");
+    QCommandLineOption quickOption({"q", "quick"}, "A reduced grid: 512/2048 samples, 50% overlap, 40 bands.");
+    parser.addOptions({jsonOption, minTimeOption, filterOption, quickOption});
+    parser.process(app);
+
+    PipelineBenchmark::Settings settings;
+    settings.minSeconds = qMax(0.01, parser.value(minTimeOption).toDouble());
+    settings.filter = parser.value(filterOption);
+    if (parser.isSet(quickOption))
+    {
+        settings.windowSizes = {512, 2048};
+        settings.overlaps = {0.5f};
+        settings.bandCounts = {40};
+    }
+
+    std::printf("SIMD kernels: %s, allocations counted: %s\n\n", qPrintable(DspKernels::IsaName(DspKernels::Active().isa)),
+                AllocationCountIncludesMalloc() ? "malloc and new" : "operator new only");
+    std::printf("%-24s %-60s %14s %12s %10s\n", "benchmark", "parameters", "ns/frame", "allocs/frame", "RTF");
+
+    PipelineBenchmark benchmark(settings);
+    const QVector<BenchmarkResult> results = benchmark.runAll([](const BenchmarkResult &result)
+                                                              {
+                                                                  std::printf("%-24s %-60s %14.1f %12.3f %10.1f\n", qPrintable(result.name),
+                                                                              qPrintable(Describe(result.parameters)), result.nsPerFrame,
+                                                                              result.allocationsPerFrame, result.realTimeFactor);
+                                                                  std::fflush(stdout);
+                                                              });
+
+    if (parser.isSet(jsonOption))
+    {
+        QJsonArray entries;
+        for (const BenchmarkResult &result : results)
+        {
+            entries.append(result.toJson());
+        }
+        QJsonObject report;
+        report["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        report["qt_version"] = QString(qVersion());
+        report["cpu"] = QSysInfo::currentCpuArchitecture();
+        report["threads"] = QThread::idealThreadCount();
+        report["simd"] = DspKernels::IsaName(DspKernels::Active().isa);
+        report["allocations_include_malloc"] = AllocationCountIncludesMalloc();
+        report["sample_rate"] = settings.sampleRate;
+        report["min_seconds"] = settings.minSeconds;
+        report["results"] = entries;
+
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(QJsonDocument(report).toJson()) < 0)
+        {
+            std::fprintf(stderr, "Error: could not write %s\n", qPrintable(file.fileName()));
+            return 1;
+        }
+        std::printf("\nResults written to %s\n", qPrintable(file.fileName()));
+    }
+    return 0;
+}
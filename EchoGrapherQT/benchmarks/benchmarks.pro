@@ -0,0 +1,65 @@
+TEMPLATE = app
+CONFIG += console c++17 release
+CONFIG -= app_bundle debug
+QT = core concurrent
+
+TARGET = EchoGrapherBenchmarks
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += $$PWD/.. # The EchoGrapherQT sources under test
+
+SOURCES += benchmarkrunner.cpp \
+           pipelinebenchmark.cpp \
+           allocationcounter.cpp \
+           ../audioprocessor.cpp \
+           ../audiosource.cpp \
+           ../clockdriftmonitor.cpp \
+           ../dspkernels.cpp \
+           ../fftplancache.cpp \
+           ../fixedframeprocessor.cpp \
+           ../flacwriter.cpp \
+           ../frameassembler.cpp \
+           ../frameprocessor.cpp \
+           ../frameworkerpool.cpp \
+           ../latencyhistogram.cpp \
+           ../logmelscale.cpp \
+           ../melfilterbank.cpp \
+           ../pipelinestats.cpp \
+           ../recordingwriter.cpp \
+           ../spectrogramblockqueue.cpp \
+           ../spectrogramstore.cpp \
+           ../wavwriter.cpp
+
+HEADERS += pipelinebenchmark.h \
+           allocationcounter.h \
+           ../audioprocessor.h \
+           ../audiosource.h \
+           ../clockdriftmonitor.h \
+           ../dspkernels.h \
+           ../fftplancache.h \
+           ../fixedframeprocessor.h \
+           ../flacwriter.h \
+           ../frameassembler.h \
+           ../frameprocessor.h \
+           ../frameworkerpool.h \
+           ../latencyhistogram.h \
+           ../logmelscale.h \
+           ../melfilterbank.h \
+           ../pipelinestats.h \
+           ../recordingwriter.h \
+           ../spectrogramblock.h \
+           ../spectrogramblockqueue.h \
+           ../spectrogramstore.h \
+           ../spscringbuffer.h \
+           ../wavwriter.h
+
+LIBS += -lportaudio
+LIBS += -lfftw3f
+
+# FLAC recording is built in when pkg-config finds libFLAC
+packagesExist(flac) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += flac
+    DEFINES += ECHOGRAPHER_FLAC
+}
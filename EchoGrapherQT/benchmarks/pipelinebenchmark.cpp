@@ -0,0 +1,265 @@
+#include "pipelinebenchmark.h"
+#include "allocationcounter.h"
+
+#include "audioprocessor.h"
+#include "fftplancache.h"
+#include "frameassembler.h"
+#include "frameprocessor.h"
+#include "spectrogramblock.h"
+#include "spscringbuffer.h"
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <cmath>
+
+namespace
+{
+const int FramesPerRun = 64; // Per-frame component benchmarks repeat this many frames per timed run
+
+// Keeps results alive so the optimiser cannot drop the work that produced them
+volatile float sink;
+}
+
+QJsonObject BenchmarkResult::toJson() const
+{
+    QJsonObject object;
+    object["name"] = name;
+    object["parameters"] = parameters;
+    object["frames"] = frames;
+    object["ns_per_frame"] = nsPerFrame;
+    object["allocations_per_frame"] = allocationsPerFrame;
+    if (realTimeFactor > 0.0)
+    {
+        object["real_time_factor"] = realTimeFactor;
+    }
+    return object;
+}
+
+PipelineBenchmark::PipelineBenchmark(const Settings &settings) : settings(settings)
+{
+}
+
+bool PipelineBenchmark::selected(const QString &name) const
+{
+    return settings.filter.isEmpty() || name.contains(settings.filter);
+}
+
+QVector<BenchmarkResult> PipelineBenchmark::runAll(const std::function<void(const BenchmarkResult &)> &progress)
+{
+    QVector<BenchmarkResult> results;
+    auto record = [&](const BenchmarkResult &result)
+    {
+        results.append(result);
+        if (progress)
+        {
+            progress(result);
+        }
+    };
+
+    for (int windowSize : settings.windowSizes)
+    {
+        if (selected("fft_execution"))
+        {
+            record(fftExecution(windowSize));
+        }
+        for (int bands : settings.bandCounts)
+        {
+            if (selected("create_mel_filterbank"))
+            {
+                record(createMelFilterbank(windowSize, bands));
+            }
+            if (selected("convert_to_mel_spectrum"))
+            {
+                record(convertToMelSpectrum(windowSize, bands));
+            }
+        }
+        for (float overlap : settings.overlaps)
+        {
+            if (selected("frame_assembly"))
+            {
+                record(frameAssembly(windowSize, overlap));
+            }
+            for (int bands : settings.bandCounts)
+            {
+                if (selected("end_to_end"))
+                {
+                    record(endToEnd(windowSize, overlap, bands));
+                }
+            }
+        }
+    }
+    return results;
+}
+
+BenchmarkResult PipelineBenchmark::measure(const QString &name, const QJsonObject &parameters, qint64 framesPerRun,
+                                           double audioSecondsPerRun, const std::function<void()> &run) const
+{
+    run(); // Warm-up: caches, lazily built tables, FFTW plans
+
+    const quint64 allocationsBefore = AllocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    qint64 runs = 0;
+    do
+    {
+        run();
+        ++runs;
+    } while (timer.nsecsElapsed() < static_cast<qint64>(settings.minSeconds * 1e9));
+    const double elapsedNs = static_cast<double>(timer.nsecsElapsed());
+    const quint64 allocations = AllocationCount() - allocationsBefore;
+
+    BenchmarkResult result;
+    result.name = name;
+    result.parameters = parameters;
+    result.frames = runs * framesPerRun;
+    result.nsPerFrame = elapsedNs / result.frames;
+    result.allocationsPerFrame = static_cast<double>(allocations) / result.frames;
+    result.realTimeFactor = audioSecondsPerRun > 0.0 ? runs * audioSecondsPerRun / (elapsedNs * 1e-9) : 0.0;
+    return result;
+}
+
+BenchmarkResult PipelineBenchmark::createMelFilterbank(int windowSize, int bands)
+{
+    AudioProcessor processor;
+    const int sampleRate = settings.sampleRate;
+    return measure("create_mel_filterbank", {{"window_size", windowSize}, {"bands", bands}}, 1, 0.0, [&]()
+                   { sink = processor.CreateMelFilterbank(bands, windowSize, sampleRate).size(); });
+}
+
+BenchmarkResult PipelineBenchmark::convertToMelSpectrum(int windowSize, int bands)
+{
+    AudioProcessor processor;
+    processor.numMelFilters = bands;
+    const int sampleRate = settings.sampleRate;
+
+    // One real spectrum, converted over and over
+    FrameProcessor frame(windowSize, bands, sampleRate);
+    QVector<float> mel(bands);
+    frame.processSamples(SyntheticSignal(windowSize, sampleRate).constData(), mel.data());
+    fftwf_complex *spectrum = const_cast<fftwf_complex *>(frame.spectrum());
+
+    // Audio per frame assumes the default 50% overlap
+    const double audioSeconds = double(FramesPerRun) * HopSize(windowSize, 0.5f) / sampleRate;
+    return measure("convert_to_mel_spectrum", {{"window_size", windowSize}, {"bands", bands}, {"overlap", 0.5}},
+                   FramesPerRun, audioSeconds, [&]()
+                   {
+                       for (int i = 0; i < FramesPerRun; ++i)
+                       {
+                           sink = processor.ConvertToMelSpectrum(spectrum, windowSize, sampleRate).constFirst();
+                       }
+                   });
+}
+
+BenchmarkResult PipelineBenchmark::fftExecution(int windowSize)
+{
+    const int sampleRate = settings.sampleRate;
+    fftwf_plan plan = FftPlanCache::shared().forwardPlan(windowSize);
+    float *in = fftwf_alloc_real(windowSize);
+    fftwf_complex *out = fftwf_alloc_complex(windowSize / 2 + 1);
+    const QVector<float> signal = SyntheticSignal(windowSize, sampleRate);
+    std::copy(signal.constBegin(), signal.constEnd(), in);
+
+    const double audioSeconds = double(FramesPerRun) * HopSize(windowSize, 0.5f) / sampleRate;
+    BenchmarkResult result = measure("fft_execution", {{"window_size", windowSize}, {"overlap", 0.5}}, FramesPerRun, audioSeconds, [&]()
+                                     {
+                                         for (int i = 0; i < FramesPerRun; ++i)
+                                         {
+                                             fftwf_execute_dft_r2c(plan, in, out);
+                                         }
+                                         sink = out[1][0];
+                                     });
+    fftwf_free(in);
+    fftwf_free(out);
+    return result;
+}
+
+BenchmarkResult PipelineBenchmark::frameAssembly(int windowSize, float overlap)
+{
+    const int sampleRate = settings.sampleRate;
+    const int blockSize = settings.captureBlockSize;
+    const int hopSize = HopSize(windowSize, overlap);
+    const QVector<float> signal = SyntheticSignal(sampleRate, sampleRate); // One second
+    const QVector<float> window(windowSize, 1.0f);
+    QVector<float> frame(windowSize);
+    FrameAssembler assembler(windowSize, hopSize, blockSize * 2);
+
+    const qint64 framesPerRun = (signal.size() - windowSize) / hopSize + 1;
+    return measure("frame_assembly", {{"window_size", windowSize}, {"overlap", overlap}, {"block_size", blockSize}},
+                   framesPerRun, 1.0, [&]()
+                   {
+                       assembler.clear();
+                       for (int offset = 0; offset < signal.size(); offset += blockSize)
+                       {
+                           assembler.write(signal.constData() + offset, qMin(blockSize, signal.size() - offset));
+                           while (assembler.nextFrame(window.constData(), frame.data()))
+                           {
+                           }
+                       }
+                       sink = frame[0];
+                   });
+}
+
+BenchmarkResult PipelineBenchmark::endToEnd(int windowSize, float overlap, int bands)
+{
+    const int sampleRate = settings.sampleRate;
+    const int blockSize = settings.captureBlockSize;
+    const int hopSize = HopSize(windowSize, overlap);
+    const QVector<float> signal = SyntheticSignal(sampleRate, sampleRate); // One second
+
+    // Same path as AudioProcessor::audioProcessingThreadFunction, minus the threads:
+    // capture ring -> frame assembler -> frame processor -> spectrogram block
+    SpscRingBuffer<float> ring(qMax(sampleRate / 2, qMax(windowSize, blockSize) * 8));
+    FrameAssembler assembler(windowSize, hopSize);
+    std::unique_ptr<FrameProcessor> processor = FrameProcessor::Create(windowSize, bands, sampleRate);
+    processor->scale().setNormalize(true);
+    SpectrogramBlock block;
+    block.bands = bands;
+    block.sampleRate = sampleRate;
+    block.hopSize = hopSize;
+    const int framesPerBlock = qMax(1, sampleRate / (20 * hopSize)); // 50 ms delivery interval
+    block.reserve(framesPerBlock);
+
+    const qint64 framesPerRun = (signal.size() - windowSize) / hopSize + 1;
+    return measure("end_to_end", {{"window_size", windowSize}, {"overlap", overlap}, {"bands", bands},
+                                  {"specialized", processor->isSpecialized()}},
+                   framesPerRun, 1.0, [&]()
+                   {
+                       assembler.clear();
+                       for (int offset = 0; offset < signal.size(); offset += blockSize)
+                       {
+                           ring.push(signal.constData() + offset, qMin(blockSize, signal.size() - offset));
+                           assembler.pull(ring);
+                           qint64 position = assembler.nextFramePosition();
+                           while (assembler.nextFrame(processor->window(), processor->input()))
+                           {
+                               processor->process(block.appendFrame(position));
+                               position = assembler.nextFramePosition();
+                               if (block.frameCount() == framesPerBlock)
+                               {
+                                   sink = block.values.constLast();
+                                   block.clear();
+                               }
+                           }
+                       }
+                   });
+}
+
+QVector<float> PipelineBenchmark::SyntheticSignal(int samples, int sampleRate)
+{
+    QRandomGenerator random(1234);
+    QVector<float> signal(samples);
+    const double duration = double(samples) / sampleRate;
+    for (int i = 0; i < samples; ++i)
+    {
+        // 100 Hz to 8 kHz exponential sweep over the buffer
+        const double t = double(i) / sampleRate;
+        const double phase = 2 * M_PI * 100.0 * duration / std::log(80.0) * (std::pow(80.0, t / duration) - 1.0);
+        signal[i] = 0.5f * static_cast<float>(std::sin(phase)) + 0.01f * static_cast<float>(random.generateDouble() - 0.5);
+    }
+    return signal;
+}
+
+int PipelineBenchmark::HopSize(int windowSize, float overlap)
+{
+    return qMax(1, windowSize - static_cast<int>(windowSize * overlap));
+}
@@ -0,0 +1,60 @@
+#ifndef PIPELINEBENCHMARK_H
+#define PIPELINEBENCHMARK_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+struct BenchmarkResult
+{
+    QString name;
+    QJsonObject parameters;
+    qint64 frames = 0;             // Work items measured: frames, or calls for setup benchmarks
+    double nsPerFrame = 0.0;
+    double allocationsPerFrame = 0.0;
+    double realTimeFactor = 0.0;   // Seconds of audio handled per second of wall time, 0 if not applicable
+
+    QJsonObject toJson() const;
+};
+
+// Times the DSP pipeline stage by stage and end to end on synthetic audio.
+// Every case is warmed up once, then repeated until it has run for at least minSeconds.
+// Runs single-threaded so the numbers measure the code, not the scheduler.
+class PipelineBenchmark
+{
+public:
+    struct Settings
+    {
+        double minSeconds = 0.25;
+        int sampleRate = 44100;
+        int captureBlockSize = 256;
+        QVector<int> windowSizes{256, 512, 1024, 2048, 4096};
+        QVector<float> overlaps{0.0f, 0.5f, 0.75f};
+        QVector<int> bandCounts{20, 40, 128};
+        QString filter; // Only cases whose name contains this
+    };
+
+    explicit PipelineBenchmark(const Settings &settings);
+
+    QVector<BenchmarkResult> runAll(const std::function<void(const BenchmarkResult &)> &progress = nullptr);
+
+    BenchmarkResult createMelFilterbank(int windowSize, int bands);
+    BenchmarkResult convertToMelSpectrum(int windowSize, int bands);
+    BenchmarkResult fftExecution(int windowSize);
+    BenchmarkResult frameAssembly(int windowSize, float overlap);
+    BenchmarkResult endToEnd(int windowSize, float overlap, int bands);
+
+    // A swept sine with a little noise, deterministic across runs
+    static QVector<float> SyntheticSignal(int samples, int sampleRate);
+    static int HopSize(int windowSize, float overlap);
+
+private:
+    BenchmarkResult measure(const QString &name, const QJsonObject &parameters, qint64 framesPerRun,
+                            double audioSecondsPerRun, const std::function<void()> &run) const;
+    bool selected(const QString &name) const;
+
+    Settings settings;
+};
+
+#endif // PIPELINEBENCHMARK_H
@@ -0,0 +1,51 @@
+#include "clockdriftmonitor.h"
+
+void ClockDriftMonitor::reset(double nominalRate)
+{
+    nominal = nominalRate;
+    startNs = -1;
+    originNs = -1;
+    framesSeen = 0;
+    points = 0.0;
+    meanTime = 0.0;
+    meanFrames = 0.0;
+    timeMoment = 0.0;
+    crossMoment = 0.0;
+    drift.store(0.0, std::memory_order_relaxed);
+    measured.store(false, std::memory_order_relaxed);
+}
+
+void ClockDriftMonitor::addFrames(int frames, qint64 nowNs)
+{
+    framesSeen += frames;
+    if (startNs < 0)
+    {
+        startNs = nowNs;
+    }
+    if (nowNs - startNs < WarmupNs || nominal <= 0.0)
+    {
+        return;
+    }
+
+    // Relative to the first point of the fit, so the sums stay small for runs of any length
+    if (originNs < 0)
+    {
+        originNs = nowNs;
+    }
+    const double time = (nowNs - originNs) * 1e-9;
+    const double frameCount = static_cast<double>(framesSeen);
+
+    points += 1.0;
+    const double timeDelta = time - meanTime;
+    meanTime += timeDelta / points;
+    meanFrames += (frameCount - meanFrames) / points;
+    timeMoment += timeDelta * (time - meanTime);
+    crossMoment += timeDelta * (frameCount - meanFrames);
+
+    if (nowNs - originNs >= MinSpanNs && timeMoment > 0.0)
+    {
+        const double rate = crossMoment / timeMoment;
+        drift.store((rate / nominal - 1.0) * 1e6, std::memory_order_relaxed);
+        measured.store(true, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef CLOCKDRIFTMONITOR_H
+#define CLOCKDRIFTMONITOR_H
+
+#include <QtGlobal>
+
+#include <atomic>
+
+// Measures how fast a capture stream's sample clock runs against the host's monotonic clock.
+// Every delivered block adds a point (arrival time, frames so far) and the least-squares slope
+// through them is the stream's real rate, so the jitter of single block arrivals averages out
+// instead of showing up as drift. Two devices that both run 20 ppm fast stay aligned; one at
+// +20 and one at -20 ppm slide apart by 40 us every second.
+// Fed by the one capture thread or callback of the stream without locking or allocating, read
+// from any thread.
+class ClockDriftMonitor
+{
+public:
+    static constexpr qint64 WarmupNs = 1000000000; // Start-up bursts of the stream are left out
+    static constexpr qint64 MinSpanNs = 2000000000; // Points the estimate needs before it is published
+
+    void reset(double nominalRate);
+    void addFrames(int frames, qint64 nowNs);
+
+    bool isMeasured() const { return measured.load(std::memory_order_relaxed); }
+    double driftPpm() const { return drift.load(std::memory_order_relaxed); } // (measured / nominal rate - 1) * 1e6, 0 until measured
+
+private:
+    double nominal = 0.0;
+    qint64 startNs = -1;   // First block, the warm-up is counted from here
+    qint64 originNs = -1;  // First point of the fit
+    qint64 framesSeen = 0; // Since reset()
+
+    // Running means and co-moments of the fit (Welford), in seconds and frames since the origin
+    double points = 0.0;
+    double meanTime = 0.0;
+    double meanFrames = 0.0;
+    double timeMoment = 0.0;
+    double crossMoment = 0.0;
+
+    std::atomic<double> drift{0.0};
+    std::atomic<bool> measured{false};
+};
+
+#endif // CLOCKDRIFTMONITOR_H
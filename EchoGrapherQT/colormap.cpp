@@ -0,0 +1,113 @@
+#include "colormap.h"
+
+#include <QVarLengthArray>
+#include <QVector>
+#include <array>
+
+namespace
+{
+using ColorTable = std::array<QRgb, Colormap::TableSize>;
+
+// Linear interpolation between evenly spaced colour stops
+ColorTable Interpolate(std::initializer_list<QRgb> stopList)
+{
+    const QVector<QRgb> stops(stopList);
+    const int lastStop = stops.size() - 1;
+
+    ColorTable table;
+    for (int i = 0; i < Colormap::TableSize; ++i)
+    {
+        const float position = static_cast<float>(i) * lastStop / (Colormap::TableSize - 1);
+        const int index = qMin(static_cast<int>(position), lastStop - 1);
+        const float t = position - index;
+        const QRgb from = stops[index];
+        const QRgb to = stops[index + 1];
+        table[i] = qRgb(qRound(qRed(from) + t * (qRed(to) - qRed(from))),
+                        qRound(qGreen(from) + t * (qGreen(to) - qGreen(from))),
+                        qRound(qBlue(from) + t * (qBlue(to) - qBlue(from))));
+    }
+    return table;
+}
+}
+
+Colormap::Colormap(Palette palette)
+{
+    setPalette(palette);
+}
+
+void Colormap::setPalette(Palette palette)
+{
+    currentPalette = palette;
+    lut = Table(palette);
+}
+
+void Colormap::setRange(float minimum, float maximum)
+{
+    rangeMin = minimum;
+    rangeMax = maximum > minimum ? maximum : minimum + 1e-6f;
+    scale = (TableSize - 1) / (rangeMax - rangeMin);
+}
+
+void Colormap::mapColumn(const float *values, int bands, const int *rowBands, int rows,
+                         uchar *firstPixel, qsizetype bytesPerLine) const
+{
+    // Quantise every band once; rows then only copy a colour
+    QVarLengthArray<QRgb, 256> bandColors(bands);
+    for (int band = 0; band < bands; ++band)
+    {
+        bandColors[band] = lut[Quantize(values[band], rangeMin, scale)];
+    }
+
+    const QRgb *colors = bandColors.constData();
+    uchar *pixel = firstPixel;
+    for (int y = 0; y < rows; ++y, pixel += bytesPerLine)
+    {
+        *reinterpret_cast<QRgb *>(pixel) = colors[rowBands[y]];
+    }
+}
+
+QString Colormap::PaletteName(Palette palette)
+{
+    switch (palette)
+    {
+    case Classic:
+        return QStringLiteral("Classic");
+    case Viridis:
+        return QStringLiteral("Viridis");
+    case Magma:
+        return QStringLiteral("Magma");
+    case Grayscale:
+        return QStringLiteral("Grayscale");
+    }
+    return QString();
+}
+
+QStringList Colormap::PaletteNames()
+{
+    return {PaletteName(Classic), PaletteName(Viridis), PaletteName(Magma), PaletteName(Grayscale)};
+}
+
+const QRgb *Colormap::Table(Palette palette)
+{
+    // Built on first use and shared by every Colormap
+    static const ColorTable classic = Interpolate({qRgb(0, 0, 128), qRgb(0, 0, 255), qRgb(0, 255, 255),
+                                                   qRgb(0, 255, 0), qRgb(255, 255, 0), qRgb(255, 0, 0)});
+    static const ColorTable viridis = Interpolate({0x440154, 0x482878, 0x3e4989, 0x31688e, 0x26828e,
+                                                   0x1f9e89, 0x35b779, 0x6ece58, 0xb5de2b, 0xfde725});
+    static const ColorTable magma = Interpolate({0x000004, 0x180f3d, 0x440f76, 0x721f81, 0x9e2f7f,
+                                                 0xcd4071, 0xf1605d, 0xfd9668, 0xfeca8d, 0xfcfdbf});
+    static const ColorTable grayscale = Interpolate({qRgb(0, 0, 0), qRgb(255, 255, 255)});
+
+    switch (palette)
+    {
+    case Viridis:
+        return viridis.data();
+    case Magma:
+        return magma.data();
+    case Grayscale:
+        return grayscale.data();
+    case Classic:
+    default:
+        return classic.data();
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include <QRgb>
+#include <QStringList>
+
+// Precomputed ARGB lookup tables for colouring spectrogram values.
+// Each palette is interpolated once into TableSize entries; colouring a value is then a
+// scale, a clamp and a table load, with no QColor, QBrush or gradient involved.
+class Colormap
+{
+public:
+    enum Palette
+    {
+        Classic,  // The original dark blue to red ramp
+        Viridis,
+        Magma,
+        Grayscale
+    };
+
+    static constexpr int TableSize = 1024;
+
+    explicit Colormap(Palette palette = Classic);
+
+    void setPalette(Palette palette);
+    Palette palette() const { return currentPalette; }
+
+    // Values are mapped linearly from [minimum, maximum] onto the table and clamped at both ends
+    void setRange(float minimum, float maximum);
+    float minimum() const { return rangeMin; }
+    float maximum() const { return rangeMax; }
+
+    const QRgb *table() const { return lut; }
+    QRgb color(float value) const { return lut[Quantize(value, rangeMin, scale)]; }
+
+    // Column kernel: quantises `bands` values once, then stores one pixel per row.
+    // `rowBands[y]` is the band shown on row y; `firstPixel` points at the column in row 0
+    // and consecutive rows are `bytesPerLine` apart, as in QImage::scanLine().
+    void mapColumn(const float *values, int bands, const int *rowBands, int rows,
+                   uchar *firstPixel, qsizetype bytesPerLine) const;
+
+    static QString PaletteName(Palette palette);
+    static QStringList PaletteNames(); // In enum order, for populating a selector
+
+private:
+    static int Quantize(float value, float minimum, float scale)
+    {
+        const float position = (value - minimum) * scale;
+        // Written so NaN falls through to entry 0
+        return position > 0.0f ? (position < TableSize - 1 ? static_cast<int>(position) : TableSize - 1) : 0;
+    }
+    static const QRgb *Table(Palette palette);
+
+    Palette currentPalette;
+    const QRgb *lut;
+    float rangeMin = 0.0f;
+    float rangeMax = 1.0f;
+    float scale = TableSize - 1;
+};
+
+#endif // COLORMAP_H
@@ -0,0 +1,724 @@
+#include "dspkernels.h"
+
+#include <QtGlobal>
+#include <cfloat>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ECHOGRAPHER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile each SIMD function for its own target; MSVC accepts the intrinsics as is
+#if defined(__GNUC__)
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define KERNEL_TARGET(isa)
+#endif
+
+namespace
+{
+const float DecibelsPerNeper = 4.342944819f; // 10 / ln(10)
+const float Ln2 = 0.693147181f;
+const float Sqrt2 = 1.414213562f;
+
+// ---------------------------------------------------------------------------------------------
+// Scalar reference
+
+void ApplyWindowScalar(const float *samples, const float *window, float *out, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        out[i] = samples[i] * window[i];
+    }
+}
+
+void MagnitudeSquaredScalar(const float *complexBins, float *power, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        power[i] = complexBins[2 * i] * complexBins[2 * i] + complexBins[2 * i + 1] * complexBins[2 * i + 1];
+    }
+}
+
+float DotScalar(const float *a, const float *b, int count)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+float WeightedPowerScalar(const float *complexBins, const float *weights, int count)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i)
+    {
+        sum += (complexBins[2 * i] * complexBins[2 * i] + complexBins[2 * i + 1] * complexBins[2 * i + 1]) * weights[i];
+    }
+    return sum;
+}
+
+// ln(x) = e * ln(2) + ln(m) with m in [sqrt(1/2), sqrt(2)), and
+// ln(m) = 2 * atanh(s) = 2 * (s + s^3/3 + s^5/5 + s^7/7 + s^9/9), s = (m - 1) / (m + 1), |s| < 0.172
+inline float LogOne(float x)
+{
+    quint32 bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127;
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+    if (mantissa >= Sqrt2)
+    {
+        mantissa *= 0.5f;
+        ++exponent;
+    }
+
+    const float s = (mantissa - 1.0f) / (mantissa + 1.0f);
+    const float s2 = s * s;
+    const float series = 1.0f + s2 * (1.0f / 3 + s2 * (1.0f / 5 + s2 * (1.0f / 7 + s2 * (1.0f / 9))));
+    return exponent * Ln2 + 2.0f * s * series;
+}
+
+inline float DecibelsOne(float value, float floorPower, float offsetDb)
+{
+    return LogOne(value > floorPower ? value : floorPower) * DecibelsPerNeper - offsetDb;
+}
+
+void LogScalar(const float *input, float *output, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        output[i] = LogOne(input[i]);
+    }
+}
+
+// Tails of the SIMD variants go through here too
+void DecibelsTail(float *values, int count, float floorPower, float offsetDb, float &minDb, float &maxDb)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const float decibels = DecibelsOne(values[i], floorPower, offsetDb);
+        values[i] = decibels;
+        minDb = qMin(minDb, decibels);
+        maxDb = qMax(maxDb, decibels);
+    }
+}
+
+void DecibelsScalar(float *values, int count, float floorPower, float offsetDb, float *minDb, float *maxDb)
+{
+    *minDb = FLT_MAX;
+    *maxDb = -FLT_MAX;
+    DecibelsTail(values, count, floorPower, offsetDb, *minDb, *maxDb);
+}
+
+// Frames [first, frames), for the tails of the SIMD variants
+void DeinterleaveTail(const float *interleaved, int channels, int first, int frames, float *const *outputs)
+{
+    for (int c = 0; c < channels; ++c)
+    {
+        float *out = outputs[c];
+        for (int i = first; i < frames; ++i)
+        {
+            out[i] = interleaved[i * channels + c];
+        }
+    }
+}
+
+void DeinterleaveScalar(const float *interleaved, int channels, int frames, float *const *outputs)
+{
+    if (channels == 1)
+    {
+        std::memcpy(outputs[0], interleaved, frames * sizeof(float));
+        return;
+    }
+    DeinterleaveTail(interleaved, channels, 0, frames, outputs);
+}
+
+#if defined(ECHOGRAPHER_X86)
+
+// ---------------------------------------------------------------------------------------------
+// SSE2, 4 lanes
+
+KERNEL_TARGET("sse2") inline float HorizontalSum(__m128 v)
+{
+    const __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+// Power of 4 interleaved bins, in bin order
+KERNEL_TARGET("sse2") inline __m128 Power4(const float *complexBins)
+{
+    const __m128 a = _mm_loadu_ps(complexBins);     // r0 i0 r1 i1
+    const __m128 b = _mm_loadu_ps(complexBins + 4); // r2 i2 r3 i3
+    const __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    return _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+}
+
+KERNEL_TARGET("sse2") inline __m128 Log4(__m128 x)
+{
+    const __m128i bits = _mm_castps_si128(x);
+    __m128i exponent = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xFF)), _mm_set1_epi32(127));
+    __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+    // SSE2 has no blend: select with and/andnot; a true mask is -1, so subtracting it adds one
+    const __m128 high = _mm_cmpge_ps(mantissa, _mm_set1_ps(Sqrt2));
+    mantissa = _mm_or_ps(_mm_and_ps(high, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f))), _mm_andnot_ps(high, mantissa));
+    exponent = _mm_sub_epi32(exponent, _mm_castps_si128(high));
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 s = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+    const __m128 s2 = _mm_mul_ps(s, s);
+    __m128 series = _mm_add_ps(_mm_mul_ps(s2, _mm_set1_ps(1.0f / 9)), _mm_set1_ps(1.0f / 7));
+    series = _mm_add_ps(_mm_mul_ps(s2, series), _mm_set1_ps(1.0f / 5));
+    series = _mm_add_ps(_mm_mul_ps(s2, series), _mm_set1_ps(1.0f / 3));
+    series = _mm_add_ps(_mm_mul_ps(s2, series), one);
+    return _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(exponent), _mm_set1_ps(Ln2)), _mm_mul_ps(_mm_add_ps(s, s), series));
+}
+
+KERNEL_TARGET("sse2") void ApplyWindowSse2(const float *samples, const float *window, float *out, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(window + i)));
+    }
+    ApplyWindowScalar(samples + i, window + i, out + i, count - i);
+}
+
+KERNEL_TARGET("sse2") void MagnitudeSquaredSse2(const float *complexBins, float *power, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(power + i, Power4(complexBins + 2 * i));
+    }
+    MagnitudeSquaredScalar(complexBins + 2 * i, power + i, count - i);
+}
+
+KERNEL_TARGET("sse2") float DotSse2(const float *a, const float *b, int count)
+{
+    __m128 sum = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    return HorizontalSum(sum) + DotScalar(a + i, b + i, count - i);
+}
+
+KERNEL_TARGET("sse2") float WeightedPowerSse2(const float *complexBins, const float *weights, int count)
+{
+    __m128 sum = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        sum = _mm_add_ps(sum, _mm_mul_ps(Power4(complexBins + 2 * i), _mm_loadu_ps(weights + i)));
+    }
+    return HorizontalSum(sum) + WeightedPowerScalar(complexBins + 2 * i, weights + i, count - i);
+}
+
+KERNEL_TARGET("sse2") void LogSse2(const float *input, float *output, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(output + i, Log4(_mm_loadu_ps(input + i)));
+    }
+    LogScalar(input + i, output + i, count - i);
+}
+
+KERNEL_TARGET("sse2") void DecibelsSse2(float *values, int count, float floorPower, float offsetDb, float *minDb, float *maxDb)
+{
+    const __m128 floor4 = _mm_set1_ps(floorPower);
+    const __m128 scale4 = _mm_set1_ps(DecibelsPerNeper);
+    const __m128 offset4 = _mm_set1_ps(offsetDb);
+    __m128 min4 = _mm_set1_ps(FLT_MAX);
+    __m128 max4 = _mm_set1_ps(-FLT_MAX);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        // max(x, floor) returns floor for NaN, so the log only ever sees normal positive floats
+        const __m128 power = _mm_max_ps(_mm_loadu_ps(values + i), floor4);
+        const __m128 decibels = _mm_sub_ps(_mm_mul_ps(Log4(power), scale4), offset4);
+        _mm_storeu_ps(values + i, decibels);
+        min4 = _mm_min_ps(min4, decibels);
+        max4 = _mm_max_ps(max4, decibels);
+    }
+    min4 = _mm_min_ps(min4, _mm_movehl_ps(min4, min4));
+    min4 = _mm_min_ss(min4, _mm_shuffle_ps(min4, min4, 1));
+    max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+    max4 = _mm_max_ss(max4, _mm_shuffle_ps(max4, max4, 1));
+    *minDb = _mm_cvtss_f32(min4);
+    *maxDb = _mm_cvtss_f32(max4);
+    DecibelsTail(values + i, count - i, floorPower, offsetDb, *minDb, *maxDb);
+}
+
+// Stereo by shuffles, multiples of four channels by 4x4 transposes, anything else scalar
+KERNEL_TARGET("sse2") void DeinterleaveSse2(const float *interleaved, int channels, int frames, float *const *outputs)
+{
+    int i = 0;
+    if (channels == 1)
+    {
+        DeinterleaveScalar(interleaved, channels, frames, outputs);
+        return;
+    }
+    if (channels == 2)
+    {
+        for (; i + 4 <= frames; i += 4)
+        {
+            const __m128 a = _mm_loadu_ps(interleaved + 2 * i);     // frames 0-1
+            const __m128 b = _mm_loadu_ps(interleaved + 2 * i + 4); // frames 2-3
+            _mm_storeu_ps(outputs[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(outputs[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+    }
+    else if (channels % 4 == 0)
+    {
+        for (; i + 4 <= frames; i += 4)
+        {
+            const float *row = interleaved + i * channels;
+            for (int c = 0; c < channels; c += 4)
+            {
+                __m128 r0 = _mm_loadu_ps(row + c);
+                __m128 r1 = _mm_loadu_ps(row + channels + c);
+                __m128 r2 = _mm_loadu_ps(row + 2 * channels + c);
+                __m128 r3 = _mm_loadu_ps(row + 3 * channels + c);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(outputs[c] + i, r0);
+                _mm_storeu_ps(outputs[c + 1] + i, r1);
+                _mm_storeu_ps(outputs[c + 2] + i, r2);
+                _mm_storeu_ps(outputs[c + 3] + i, r3);
+            }
+        }
+    }
+    DeinterleaveTail(interleaved, channels, i, frames, outputs);
+}
+
+// ---------------------------------------------------------------------------------------------
+// AVX2 + FMA, 8 lanes
+
+KERNEL_TARGET("avx2,fma") inline float HorizontalSum(__m256 v)
+{
+    return HorizontalSum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+KERNEL_TARGET("avx2,fma") inline __m256 Power8(const float *complexBins)
+{
+    const __m256 a = _mm256_loadu_ps(complexBins);     // bins 0-3
+    const __m256 b = _mm256_loadu_ps(complexBins + 8); // bins 4-7
+    // In-lane shuffles give bins in 64-bit pairs (0 1 | 4 5 | 2 3 | 6 7); the permute restores order
+    const __m256 re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), 0xD8));
+    const __m256 im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), 0xD8));
+    return _mm256_fmadd_ps(re, re, _mm256_mul_ps(im, im));
+}
+
+KERNEL_TARGET("avx2,fma") inline __m256 Log8(__m256 x)
+{
+    const __m256i bits = _mm256_castps_si256(x);
+    __m256i exponent = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xFF)), _mm256_set1_epi32(127));
+    __m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+
+    const __m256 high = _mm256_cmp_ps(mantissa, _mm256_set1_ps(Sqrt2), _CMP_GE_OQ);
+    mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5f)), high);
+    exponent = _mm256_sub_epi32(exponent, _mm256_castps_si256(high));
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 s = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+    const __m256 s2 = _mm256_mul_ps(s, s);
+    __m256 series = _mm256_fmadd_ps(s2, _mm256_set1_ps(1.0f / 9), _mm256_set1_ps(1.0f / 7));
+    series = _mm256_fmadd_ps(s2, series, _mm256_set1_ps(1.0f / 5));
+    series = _mm256_fmadd_ps(s2, series, _mm256_set1_ps(1.0f / 3));
+    series = _mm256_fmadd_ps(s2, series, one);
+    return _mm256_fmadd_ps(_mm256_cvtepi32_ps(exponent), _mm256_set1_ps(Ln2), _mm256_mul_ps(_mm256_add_ps(s, s), series));
+}
+
+KERNEL_TARGET("avx2,fma") void ApplyWindowAvx2(const float *samples, const float *window, float *out, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), _mm256_loadu_ps(window + i)));
+    }
+    ApplyWindowScalar(samples + i, window + i, out + i, count - i);
+}
+
+KERNEL_TARGET("avx2,fma") void MagnitudeSquaredAvx2(const float *complexBins, float *power, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(power + i, Power8(complexBins + 2 * i));
+    }
+    MagnitudeSquaredScalar(complexBins + 2 * i, power + i, count - i);
+}
+
+KERNEL_TARGET("avx2,fma") float DotAvx2(const float *a, const float *b, int count)
+{
+    __m256 sum = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum);
+    }
+    return HorizontalSum(sum) + DotScalar(a + i, b + i, count - i);
+}
+
+KERNEL_TARGET("avx2,fma") float WeightedPowerAvx2(const float *complexBins, const float *weights, int count)
+{
+    __m256 sum = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        sum = _mm256_fmadd_ps(Power8(complexBins + 2 * i), _mm256_loadu_ps(weights + i), sum);
+    }
+    return HorizontalSum(sum) + WeightedPowerScalar(complexBins + 2 * i, weights + i, count - i);
+}
+
+KERNEL_TARGET("avx2,fma") void LogAvx2(const float *input, float *output, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(output + i, Log8(_mm256_loadu_ps(input + i)));
+    }
+    LogScalar(input + i, output + i, count - i);
+}
+
+KERNEL_TARGET("avx2,fma") void DecibelsAvx2(float *values, int count, float floorPower, float offsetDb, float *minDb, float *maxDb)
+{
+    const __m256 floor8 = _mm256_set1_ps(floorPower);
+    const __m256 scale8 = _mm256_set1_ps(DecibelsPerNeper);
+    const __m256 offset8 = _mm256_set1_ps(offsetDb);
+    __m256 min8 = _mm256_set1_ps(FLT_MAX);
+    __m256 max8 = _mm256_set1_ps(-FLT_MAX);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 power = _mm256_max_ps(_mm256_loadu_ps(values + i), floor8);
+        const __m256 decibels = _mm256_fmsub_ps(Log8(power), scale8, offset8);
+        _mm256_storeu_ps(values + i, decibels);
+        min8 = _mm256_min_ps(min8, decibels);
+        max8 = _mm256_max_ps(max8, decibels);
+    }
+    __m128 min4 = _mm_min_ps(_mm256_castps256_ps128(min8), _mm256_extractf128_ps(min8, 1));
+    __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(max8), _mm256_extractf128_ps(max8, 1));
+    min4 = _mm_min_ps(min4, _mm_movehl_ps(min4, min4));
+    min4 = _mm_min_ss(min4, _mm_shuffle_ps(min4, min4, 1));
+    max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+    max4 = _mm_max_ss(max4, _mm_shuffle_ps(max4, max4, 1));
+    *minDb = _mm_cvtss_f32(min4);
+    *maxDb = _mm_cvtss_f32(max4);
+    DecibelsTail(values + i, count - i, floorPower, offsetDb, *minDb, *maxDb);
+}
+
+// Stereo like the (re, im) split of Power8, any other count by gathering every channels-th sample
+KERNEL_TARGET("avx2,fma") void DeinterleaveAvx2(const float *interleaved, int channels, int frames, float *const *outputs)
+{
+    int i = 0;
+    if (channels == 1)
+    {
+        DeinterleaveScalar(interleaved, channels, frames, outputs);
+        return;
+    }
+    if (channels == 2)
+    {
+        for (; i + 8 <= frames; i += 8)
+        {
+            const __m256 a = _mm256_loadu_ps(interleaved + 2 * i);
+            const __m256 b = _mm256_loadu_ps(interleaved + 2 * i + 8);
+            _mm256_storeu_ps(outputs[0] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), 0xD8)));
+            _mm256_storeu_ps(outputs[1] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), 0xD8)));
+        }
+    }
+    else
+    {
+        const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(channels));
+        for (; i + 8 <= frames; i += 8)
+        {
+            const float *row = interleaved + i * channels;
+            for (int c = 0; c < channels; ++c)
+            {
+                _mm256_storeu_ps(outputs[c] + i, _mm256_i32gather_ps(row + c, offsets, 4));
+            }
+        }
+    }
+    DeinterleaveTail(interleaved, channels, i, frames, outputs);
+}
+
+// ---------------------------------------------------------------------------------------------
+// AVX-512F, 16 lanes
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12's avx512fintrin.h leaves an undefined __Y operand in several inlined intrinsics, a header false positive
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+KERNEL_TARGET("avx512f") inline __m512 Power16(const float *complexBins)
+{
+    const __m512 a = _mm512_loadu_ps(complexBins);      // bins 0-7
+    const __m512 b = _mm512_loadu_ps(complexBins + 16); // bins 8-15
+    const __m512i evens = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i odds = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    const __m512 re = _mm512_permutex2var_ps(a, evens, b);
+    const __m512 im = _mm512_permutex2var_ps(a, odds, b);
+    return _mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im));
+}
+
+KERNEL_TARGET("avx512f") inline __m512 Log16(__m512 x)
+{
+    const __m512i bits = _mm512_castps_si512(x);
+    __m512i exponent = _mm512_sub_epi32(_mm512_and_si512(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(0xFF)), _mm512_set1_epi32(127));
+    __m512 mantissa = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F800000)));
+
+    const __mmask16 high = _mm512_cmp_ps_mask(mantissa, _mm512_set1_ps(Sqrt2), _CMP_GE_OQ);
+    mantissa = _mm512_mask_mul_ps(mantissa, high, mantissa, _mm512_set1_ps(0.5f));
+    exponent = _mm512_mask_add_epi32(exponent, high, exponent, _mm512_set1_epi32(1));
+
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 s = _mm512_div_ps(_mm512_sub_ps(mantissa, one), _mm512_add_ps(mantissa, one));
+    const __m512 s2 = _mm512_mul_ps(s, s);
+    __m512 series = _mm512_fmadd_ps(s2, _mm512_set1_ps(1.0f / 9), _mm512_set1_ps(1.0f / 7));
+    series = _mm512_fmadd_ps(s2, series, _mm512_set1_ps(1.0f / 5));
+    series = _mm512_fmadd_ps(s2, series, _mm512_set1_ps(1.0f / 3));
+    series = _mm512_fmadd_ps(s2, series, one);
+    return _mm512_fmadd_ps(_mm512_cvtepi32_ps(exponent), _mm512_set1_ps(Ln2), _mm512_mul_ps(_mm512_add_ps(s, s), series));
+}
+
+KERNEL_TARGET("avx512f") void ApplyWindowAvx512(const float *samples, const float *window, float *out, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(samples + i), _mm512_loadu_ps(window + i)));
+    }
+    ApplyWindowScalar(samples + i, window + i, out + i, count - i);
+}
+
+KERNEL_TARGET("avx512f") void MagnitudeSquaredAvx512(const float *complexBins, float *power, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm512_storeu_ps(power + i, Power16(complexBins + 2 * i));
+    }
+    MagnitudeSquaredScalar(complexBins + 2 * i, power + i, count - i);
+}
+
+KERNEL_TARGET("avx512f") float DotAvx512(const float *a, const float *b, int count)
+{
+    __m512 sum = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        sum = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum);
+    }
+    return _mm512_reduce_add_ps(sum) + DotScalar(a + i, b + i, count - i);
+}
+
+KERNEL_TARGET("avx512f") float WeightedPowerAvx512(const float *complexBins, const float *weights, int count)
+{
+    __m512 sum = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        sum = _mm512_fmadd_ps(Power16(complexBins + 2 * i), _mm512_loadu_ps(weights + i), sum);
+    }
+    return _mm512_reduce_add_ps(sum) + WeightedPowerScalar(complexBins + 2 * i, weights + i, count - i);
+}
+
+KERNEL_TARGET("avx512f") void LogAvx512(const float *input, float *output, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm512_storeu_ps(output + i, Log16(_mm512_loadu_ps(input + i)));
+    }
+    LogScalar(input + i, output + i, count - i);
+}
+
+KERNEL_TARGET("avx512f") void DecibelsAvx512(float *values, int count, float floorPower, float offsetDb, float *minDb, float *maxDb)
+{
+    const __m512 floor16 = _mm512_set1_ps(floorPower);
+    const __m512 scale16 = _mm512_set1_ps(DecibelsPerNeper);
+    const __m512 offset16 = _mm512_set1_ps(offsetDb);
+    __m512 min16 = _mm512_set1_ps(FLT_MAX);
+    __m512 max16 = _mm512_set1_ps(-FLT_MAX);
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m512 power = _mm512_max_ps(_mm512_loadu_ps(values + i), floor16);
+        const __m512 decibels = _mm512_fmsub_ps(Log16(power), scale16, offset16);
+        _mm512_storeu_ps(values + i, decibels);
+        min16 = _mm512_min_ps(min16, decibels);
+        max16 = _mm512_max_ps(max16, decibels);
+    }
+    *minDb = _mm512_reduce_min_ps(min16);
+    *maxDb = _mm512_reduce_max_ps(max16);
+    DecibelsTail(values + i, count - i, floorPower, offsetDb, *minDb, *maxDb);
+}
+
+KERNEL_TARGET("avx512f") void DeinterleaveAvx512(const float *interleaved, int channels, int frames, float *const *outputs)
+{
+    int i = 0;
+    if (channels == 1)
+    {
+        DeinterleaveScalar(interleaved, channels, frames, outputs);
+        return;
+    }
+    const __m512i offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(channels));
+    for (; i + 16 <= frames; i += 16)
+    {
+        const float *row = interleaved + i * channels;
+        for (int c = 0; c < channels; ++c)
+        {
+            _mm512_storeu_ps(outputs[c] + i, _mm512_i32gather_ps(offsets, row + c, 4));
+        }
+    }
+    DeinterleaveTail(interleaved, channels, i, frames, outputs);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // ECHOGRAPHER_X86
+
+const DspKernels ScalarKernels = {DspKernels::Scalar, ApplyWindowScalar, MagnitudeSquaredScalar, DotScalar,
+                                  WeightedPowerScalar, LogScalar, DecibelsScalar, DeinterleaveScalar};
+#if defined(ECHOGRAPHER_X86)
+const DspKernels Sse2Kernels = {DspKernels::Sse2, ApplyWindowSse2, MagnitudeSquaredSse2, DotSse2,
+                                WeightedPowerSse2, LogSse2, DecibelsSse2, DeinterleaveSse2};
+const DspKernels Avx2Kernels = {DspKernels::Avx2, ApplyWindowAvx2, MagnitudeSquaredAvx2, DotAvx2,
+                                WeightedPowerAvx2, LogAvx2, DecibelsAvx2, DeinterleaveAvx2};
+const DspKernels Avx512Kernels = {DspKernels::Avx512, ApplyWindowAvx512, MagnitudeSquaredAvx512, DotAvx512,
+                                  WeightedPowerAvx512, LogAvx512, DecibelsAvx512, DeinterleaveAvx512};
+#endif
+
+#if defined(ECHOGRAPHER_X86) && defined(_MSC_VER)
+// CPUID feature bit plus, for AVX, the OS saving the wider registers (XGETBV)
+bool MsvcSupports(DspKernels::Isa isa)
+{
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse2 = info[3] & (1 << 26);
+    const bool fma = info[2] & (1 << 12);
+    const bool osxsave = info[2] & (1 << 27);
+    if (isa == DspKernels::Sse2)
+    {
+        return sse2;
+    }
+    if (!osxsave || maxLeaf < 7)
+    {
+        return false;
+    }
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if (isa == DspKernels::Avx2)
+    {
+        return (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) && fma;
+    }
+    return (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16));
+}
+#endif
+}
+
+bool DspKernels::Supported(Isa isa)
+{
+    switch (isa)
+    {
+    case Scalar:
+        return true;
+#if defined(ECHOGRAPHER_X86) && defined(__GNUC__)
+    case Sse2:
+        return __builtin_cpu_supports("sse2");
+    case Avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case Avx512:
+        return __builtin_cpu_supports("avx512f");
+#elif defined(ECHOGRAPHER_X86) && defined(_MSC_VER)
+    case Sse2:
+    case Avx2:
+    case Avx512:
+        return MsvcSupports(isa);
+#endif
+    default:
+        return false;
+    }
+}
+
+const DspKernels *DspKernels::ForIsa(Isa isa)
+{
+    if (!Supported(isa))
+    {
+        return nullptr;
+    }
+    switch (isa)
+    {
+#if defined(ECHOGRAPHER_X86)
+    case Sse2:
+        return &Sse2Kernels;
+    case Avx2:
+        return &Avx2Kernels;
+    case Avx512:
+        return &Avx512Kernels;
+#endif
+    case Scalar:
+    default:
+        return &ScalarKernels;
+    }
+}
+
+const DspKernels &DspKernels::Active()
+{
+    static const DspKernels &active = []() -> const DspKernels &
+    {
+        // Optional cap for comparisons and troubleshooting
+        Isa limit = Avx512;
+        const QString requested = qEnvironmentVariable("ECHOGRAPHER_SIMD").toLower();
+        for (Isa isa : {Scalar, Sse2, Avx2, Avx512})
+        {
+            if (requested == IsaName(isa).toLower())
+            {
+                limit = isa;
+            }
+        }
+
+        for (int isa = limit; isa > Scalar; --isa)
+        {
+            if (const DspKernels *kernels = ForIsa(static_cast<Isa>(isa)))
+            {
+                return *kernels;
+            }
+        }
+        return ScalarKernels;
+    }();
+    return active;
+}
+
+QString DspKernels::IsaName(Isa isa)
+{
+    switch (isa)
+    {
+    case Sse2:
+        return QStringLiteral("SSE2");
+    case Avx2:
+        return QStringLiteral("AVX2");
+    case Avx512:
+        return QStringLiteral("AVX512");
+    case Scalar:
+    default:
+        return QStringLiteral("Scalar");
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef DSPKERNELS_H
+#define DSPKERNELS_H
+
+#include <QString>
+
+// The per-frame loops that remain after the FFT, as one table of function pointers per
+// instruction set. Active() picks the best table the CPU supports on first use (CPUID via
+// the compiler's builtins), so one binary runs everywhere and still uses AVX2/AVX-512 where
+// present. The SIMD variants are compiled with per-function target attributes and need no
+// global compiler flags. ECHOGRAPHER_SIMD=scalar|sse2|avx2|avx512 caps the selection.
+struct DspKernels
+{
+    enum Isa
+    {
+        Scalar,
+        Sse2,
+        Avx2, // Also requires FMA
+        Avx512
+    };
+
+    Isa isa;
+
+    // out[i] = samples[i] * window[i]
+    void (*applyWindow)(const float *samples, const float *window, float *out, int count);
+    // power[i] = re * re + im * im of `count` interleaved (re, im) bins
+    void (*magnitudeSquared)(const float *complexBins, float *power, int count);
+    // sum(a[i] * b[i])
+    float (*dot)(const float *a, const float *b, int count);
+    // sum((re * re + im * im) * weights[i]) over `count` interleaved bins: one sparse mel filter
+    float (*weightedPower)(const float *complexBins, const float *weights, int count);
+    // output[i] = ln(input[i]) for positive, normal floats
+    void (*log)(const float *input, float *output, int count);
+    // In place: values[i] = 10 * log10(max(values[i], floorPower)) - offsetDb, NaN -> floor;
+    // the smallest and largest results are written to *minDb and *maxDb
+    void (*decibels)(float *values, int count, float floorPower, float offsetDb, float *minDb, float *maxDb);
+    // outputs[c][i] = interleaved[i * channels + c] for `frames` frames of `channels` samples
+    void (*deinterleave)(const float *interleaved, int channels, int frames, float *const *outputs);
+
+    // Kernels for the best instruction set available, chosen once
+    static const DspKernels &Active();
+    // Kernels for one instruction set, or nullptr if this CPU or build cannot run them
+    static const DspKernels *ForIsa(Isa isa);
+    static bool Supported(Isa isa);
+    static QString IsaName(Isa isa);
+};
+
+#endif // DSPKERNELS_H
@@ -0,0 +1,195 @@
+#include "fftplancache.h"
+
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+
+namespace
+{
+    unsigned plannerFlags(FftPlanCache::PlanRigor rigor)
+    {
+        switch (rigor)
+        {
+        case FftPlanCache::Measure:
+            return FFTW_MEASURE;
+        case FftPlanCache::Patient:
+            return FFTW_PATIENT;
+        case FftPlanCache::Estimate:
+        default:
+            return FFTW_ESTIMATE;
+        }
+    }
+}
+
+FftPlanCache &FftPlanCache::shared()
+{
+    static FftPlanCache cache;
+    return cache;
+}
+
+bool FftPlanCache::RigorFromName(const QString &name, PlanRigor *rigor)
+{
+    const QString lower = name.toLower();
+    if (lower == "estimate")
+    {
+        *rigor = Estimate;
+    }
+    else if (lower == "measure")
+    {
+        *rigor = Measure;
+    }
+    else if (lower == "patient")
+    {
+        *rigor = Patient;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+FftPlanCache::FftPlanCache()
+{
+    QString configPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    if (configPath.isEmpty())
+    {
+        configPath = QDir::cleanPath(QStandardPaths::writableLocation(QStandardPaths::HomeLocation) + "/EchoGrapher");
+    }
+    wisdomFile = QDir::cleanPath(configPath + "/fftw-wisdom.dat");
+}
+
+FftPlanCache::~FftPlanCache()
+{
+    clear();
+    fftwf_cleanup();
+}
+
+fftwf_plan FftPlanCache::forwardPlan(int size, PlanRigor rigor)
+{
+    if (size <= 0)
+    {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&mutex);
+
+    auto it = plans.find(size);
+    if (it != plans.end() && it->rigor >= rigor)
+    {
+        return it->plan;
+    }
+
+    if (!wisdomLoaded)
+    {
+        loadWisdomLocked();
+    }
+
+    // Measured planning overwrites its arrays, so plan on scratch buffers rather than on live data.
+    // fftwf_malloc gives every buffer the same alignment, which is what the new-array interface requires.
+    float *in = fftwf_alloc_real(size);
+    fftwf_complex *out = fftwf_alloc_complex(size / 2 + 1);
+    if (!in || !out)
+    {
+        fftwf_free(in);
+        fftwf_free(out);
+        return nullptr;
+    }
+
+    fftwf_plan plan = fftwf_plan_dft_r2c_1d(size, in, out, plannerFlags(rigor));
+    fftwf_free(in);
+    fftwf_free(out);
+    if (!plan)
+    {
+        return nullptr;
+    }
+
+    if (it != plans.end())
+    {
+        retiredPlans.append(it->plan);
+    }
+    plans.insert(size, {plan, rigor});
+
+    if (rigor != Estimate)
+    {
+        saveWisdomLocked(); // Only measured plans produce wisdom worth keeping
+    }
+
+    return plan;
+}
+
+void FftPlanCache::setWisdomPath(const QString &path)
+{
+    QMutexLocker locker(&mutex);
+    if (wisdomFile != path)
+    {
+        wisdomFile = path;
+        wisdomLoaded = false; // Picked up on the next planning call
+    }
+}
+
+QString FftPlanCache::wisdomPath() const
+{
+    QMutexLocker locker(&mutex);
+    return wisdomFile;
+}
+
+bool FftPlanCache::loadWisdom()
+{
+    QMutexLocker locker(&mutex);
+    return loadWisdomLocked();
+}
+
+bool FftPlanCache::saveWisdom()
+{
+    QMutexLocker locker(&mutex);
+    return saveWisdomLocked();
+}
+
+bool FftPlanCache::loadWisdomLocked()
+{
+    wisdomLoaded = true;
+    if (wisdomFile.isEmpty() || !QFileInfo::exists(wisdomFile))
+    {
+        return false;
+    }
+    return fftwf_import_wisdom_from_filename(QFile::encodeName(wisdomFile).constData()) != 0;
+}
+
+bool FftPlanCache::saveWisdomLocked()
+{
+    if (wisdomFile.isEmpty())
+    {
+        return false;
+    }
+
+    // Ensure the directory exists or create it
+    QDir dir;
+    if (!dir.mkpath(QFileInfo(wisdomFile).absolutePath()))
+    {
+        return false;
+    }
+    return fftwf_export_wisdom_to_filename(QFile::encodeName(wisdomFile).constData()) != 0;
+}
+
+int FftPlanCache::size() const
+{
+    QMutexLocker locker(&mutex);
+    return plans.size();
+}
+
+void FftPlanCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    for (const Entry &entry : std::as_const(plans))
+    {
+        fftwf_destroy_plan(entry.plan);
+    }
+    for (fftwf_plan plan : std::as_const(retiredPlans))
+    {
+        fftwf_destroy_plan(plan);
+    }
+    plans.clear();
+    retiredPlans.clear();
+}
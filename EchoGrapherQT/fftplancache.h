@@ -0,0 +1,64 @@
+#ifndef FFTPLANCACHE_H
+#define FFTPLANCACHE_H
+
+#include <fftw3.h>
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// Process-wide cache of real-to-complex FFTW plans keyed by window size.
+// The FFTW planner (and its wisdom) is global and not thread-safe, so every plan is created
+// here under one mutex. Plans are created on scratch arrays and must be run through the
+// new-array interface, fftwf_execute_dft_r2c(plan, in, out), on fftwf_malloc'd buffers;
+// that call is thread-safe, so a single cached plan can serve any number of threads.
+class FftPlanCache
+{
+public:
+    enum PlanRigor
+    {
+        Estimate, // FFTW_ESTIMATE: no measurement, instant planning
+        Measure,  // FFTW_MEASURE: times a few algorithms, usually well under a second
+        Patient   // FFTW_PATIENT: exhaustive search, only worth it together with wisdom
+    };
+
+    static FftPlanCache &shared();
+    static bool RigorFromName(const QString &name, PlanRigor *rigor); // "estimate", "measure" or "patient"
+
+    // Returns a forward plan for `size` real samples -> size / 2 + 1 complex bins.
+    // A cached plan is reused unless it was created with a lower rigor than requested.
+    fftwf_plan forwardPlan(int size, PlanRigor rigor = Estimate);
+
+    // Wisdom lets measured planning be paid for once per machine instead of once per run
+    void setWisdomPath(const QString &path);
+    QString wisdomPath() const;
+    bool loadWisdom();
+    bool saveWisdom();
+
+    int size() const;
+    void clear();
+
+private:
+    struct Entry
+    {
+        fftwf_plan plan;
+        PlanRigor rigor;
+    };
+
+    FftPlanCache();
+    ~FftPlanCache();
+    FftPlanCache(const FftPlanCache &) = delete;
+    FftPlanCache &operator=(const FftPlanCache &) = delete;
+
+    bool loadWisdomLocked();
+    bool saveWisdomLocked();
+
+    mutable QMutex mutex;
+    QHash<int, Entry> plans;
+    QList<fftwf_plan> retiredPlans; // Superseded plans may still be executing on another thread
+    QString wisdomFile;
+    bool wisdomLoaded = false;
+};
+
+#endif // FFTPLANCACHE_H
@@ -0,0 +1,60 @@
+#include "fixedframeprocessor.h"
+
+namespace
+{
+// Runtime switch over the presets, one level per template parameter.
+// Keep the cases in step with FixedWindowSizes, FixedBandCounts and FixedSampleRates.
+template <int N, int Bands>
+std::unique_ptr<FrameProcessor> ForSampleRate(int sampleRate, FftPlanCache::PlanRigor rigor)
+{
+    switch (sampleRate)
+    {
+    case 44100:
+        return std::make_unique<FixedFrameProcessor<N, Bands, 44100>>(rigor);
+    case 48000:
+        return std::make_unique<FixedFrameProcessor<N, Bands, 48000>>(rigor);
+    default:
+        return nullptr;
+    }
+}
+
+template <int N>
+std::unique_ptr<FrameProcessor> ForBandCount(int numMelFilters, int sampleRate, FftPlanCache::PlanRigor rigor)
+{
+    switch (numMelFilters)
+    {
+    case 20:
+        return ForSampleRate<N, 20>(sampleRate, rigor);
+    case 40:
+        return ForSampleRate<N, 40>(sampleRate, rigor);
+    case 64:
+        return ForSampleRate<N, 64>(sampleRate, rigor);
+    case 80:
+        return ForSampleRate<N, 80>(sampleRate, rigor);
+    case 128:
+        return ForSampleRate<N, 128>(sampleRate, rigor);
+    default:
+        return nullptr;
+    }
+}
+}
+
+std::unique_ptr<FrameProcessor> CreateFixedFrameProcessor(int windowSize, int numMelFilters, int sampleRate,
+                                                          FftPlanCache::PlanRigor rigor)
+{
+    switch (windowSize)
+    {
+    case 256:
+        return ForBandCount<256>(numMelFilters, sampleRate, rigor);
+    case 512:
+        return ForBandCount<512>(numMelFilters, sampleRate, rigor);
+    case 1024:
+        return ForBandCount<1024>(numMelFilters, sampleRate, rigor);
+    case 2048:
+        return ForBandCount<2048>(numMelFilters, sampleRate, rigor);
+    case 4096:
+        return ForBandCount<4096>(numMelFilters, sampleRate, rigor);
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,240 @@
+#ifndef FIXEDFRAMEPROCESSOR_H
+#define FIXEDFRAMEPROCESSOR_H
+
+#include "frameprocessor.h"
+
+#include <array>
+#include <utility>
+
+// Compile-time tables for FixedFrameProcessor. The maths reproduces MelFilterbank and the
+// generic Hann window step by step (float operations rounded the same way), so a specialised
+// processor computes the same filterbank as the generic one.
+namespace FixedTables
+{
+constexpr double Pi = 3.14159265358979323846;
+constexpr double Ln2 = 0.69314718055994530942;
+constexpr double Ln10 = 2.30258509299404568402;
+
+constexpr double Log(double x)
+{
+    // x = m * 2^e with m in [sqrt(1/2), sqrt(2)), then ln(m) = 2 * atanh((m - 1) / (m + 1))
+    int exponent = 0;
+    while (x >= 1.41421356237309504880)
+    {
+        x *= 0.5;
+        ++exponent;
+    }
+    while (x < 0.70710678118654752440)
+    {
+        x *= 2.0;
+        --exponent;
+    }
+    const double s = (x - 1.0) / (x + 1.0);
+    const double s2 = s * s;
+    double term = s;
+    double sum = 0.0;
+    for (int k = 1; k < 40; k += 2)
+    {
+        sum += term / k;
+        term *= s2;
+    }
+    return exponent * Ln2 + 2.0 * sum;
+}
+
+constexpr double Exp(double x)
+{
+    // x = k * ln(2) + r with |r| <= ln(2) / 2, then a Taylor series for e^r
+    const int k = static_cast<int>(x / Ln2 + (x < 0 ? -0.5 : 0.5));
+    const double r = x - k * Ln2;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 30; ++n)
+    {
+        term *= r / n;
+        sum += term;
+    }
+    for (int i = 0; i < k; ++i)
+    {
+        sum *= 2.0;
+    }
+    for (int i = 0; i > k; --i)
+    {
+        sum *= 0.5;
+    }
+    return sum;
+}
+
+constexpr double Cos(double x)
+{
+    while (x > Pi)
+    {
+        x -= 2 * Pi;
+    }
+    while (x < -Pi)
+    {
+        x += 2 * Pi;
+    }
+    const double x2 = x * x;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 2; n < 60; n += 2)
+    {
+        term *= -x2 / ((n - 1) * n);
+        sum += term;
+    }
+    return sum;
+}
+
+// MelFilterbank::FrequencyToMel / MelToFrequency in float
+constexpr float FrequencyToMel(float frequency)
+{
+    return 2595.0f * static_cast<float>(Log(static_cast<float>(1.0f + frequency / 700.0f)) / Ln10);
+}
+
+constexpr float MelToFrequency(float mel)
+{
+    return 700.0f * (static_cast<float>(Exp(static_cast<float>(mel / 2595.0f) * Ln10)) - 1.0f);
+}
+
+template <int N>
+constexpr std::array<float, N> HannWindow()
+{
+    std::array<float, N> window{};
+    for (int i = 0; i < N; ++i)
+    {
+        window[i] = static_cast<float>(0.5 * (1 - Cos(2 * Pi * i / (N - 1))));
+    }
+    return window;
+}
+
+// Triangle edge bins, exactly as MelFilterbank::build() places them
+template <int N, int Bands, int SampleRate>
+constexpr std::array<int, Bands + 2> EdgeBins()
+{
+    std::array<int, Bands + 2> bins{};
+    const float lowerMelFreq = FrequencyToMel(0);
+    const float upperMelFreq = FrequencyToMel(SampleRate / 2);
+    const float melStep = (upperMelFreq - lowerMelFreq) / (Bands + 1);
+    for (int i = 0; i <= Bands + 1; ++i)
+    {
+        const float binFrequency = MelToFrequency(lowerMelFreq + i * melStep);
+        const float position = (N + 1) * binFrequency / SampleRate;
+        int bin = static_cast<int>(position);
+        bin -= (position < bin) ? 1 : 0; // floor
+        bins[i] = bin < 0 ? 0 : (bin > N / 2 ? N / 2 : bin);
+    }
+    return bins;
+}
+
+template <int N, int Bands, int SampleRate>
+struct MelLayout
+{
+    static constexpr std::array<int, Bands + 2> Edges = EdgeBins<N, Bands, SampleRate>();
+    static constexpr int WeightCount = Edges[Bands + 1] - Edges[0] + Edges[Bands] - Edges[1];
+
+    // Offset of each filter's first weight
+    static constexpr std::array<int, Bands> Offsets()
+    {
+        std::array<int, Bands> offsets{};
+        int offset = 0;
+        for (int f = 0; f < Bands; ++f)
+        {
+            offsets[f] = offset;
+            offset += Edges[f + 2] - Edges[f];
+        }
+        return offsets;
+    }
+
+    static constexpr std::array<float, (WeightCount > 0 ? WeightCount : 1)> Weights()
+    {
+        std::array<float, (WeightCount > 0 ? WeightCount : 1)> weights{};
+        int w = 0;
+        for (int f = 1; f <= Bands; ++f)
+        {
+            const int startBin = Edges[f - 1];
+            const int centerBin = Edges[f];
+            const int endBin = Edges[f + 1];
+            for (int j = startBin; j < centerBin; ++j)
+            {
+                weights[w++] = (j - startBin) / static_cast<float>(centerBin - startBin);
+            }
+            for (int j = centerBin; j < endBin; ++j)
+            {
+                weights[w++] = 1.0f - (j - centerBin) / static_cast<float>(endBin - centerBin);
+            }
+        }
+        return weights;
+    }
+};
+}
+
+// FrameProcessor with the window size, band count and sample rate fixed at compile time.
+// The window table and filterbank layout are constexpr data, and every filter is its own loop
+// with constant bounds, so the compiler can unroll and vectorise each one completely.
+template <int N, int Bands, int SampleRate>
+class FixedFrameProcessor : public FrameProcessor
+{
+    using Layout = FixedTables::MelLayout<N, Bands, SampleRate>;
+
+public:
+    static constexpr std::array<float, N> Window = FixedTables::HannWindow<N>();
+    static constexpr std::array<int, Bands> Offsets = Layout::Offsets();
+    static constexpr auto Weights = Layout::Weights();
+
+    explicit FixedFrameProcessor(FftPlanCache::PlanRigor rigor = FftPlanCache::Estimate)
+        : FrameProcessor(N, Bands, SampleRate, rigor, Window.data())
+    {
+    }
+
+    bool isSpecialized() const override { return true; }
+
+    void processSamples(const float *samples, float *melSpectrum) override
+    {
+        for (int i = 0; i < N; ++i)
+        {
+            in[i] = samples[i] * Window[i];
+        }
+        process(melSpectrum);
+    }
+
+protected:
+    void applyFilterbank(float *melSpectrum) override
+    {
+        ApplyFilters(reinterpret_cast<const float *>(out), melSpectrum, std::make_integer_sequence<int, Bands>());
+    }
+
+private:
+    template <int... Filter>
+    static void ApplyFilters(const float *complexBins, float *melSpectrum, std::integer_sequence<int, Filter...>)
+    {
+        ((melSpectrum[Filter] = FilterEnergy<Filter>(complexBins)), ...);
+    }
+
+    // Power and weighting of one triangle, fused, over a constant range of bins
+    template <int Filter>
+    static float FilterEnergy(const float *complexBins)
+    {
+        constexpr int startBin = Layout::Edges[Filter];
+        constexpr int endBin = Layout::Edges[Filter + 2];
+        constexpr int offset = Offsets[Filter];
+        float melEnergy = 0.0f;
+        for (int bin = startBin; bin < endBin; ++bin)
+        {
+            const float re = complexBins[2 * bin];
+            const float im = complexBins[2 * bin + 1];
+            melEnergy += (re * re + im * im) * Weights[offset + bin - startBin];
+        }
+        return melEnergy;
+    }
+};
+
+// Window sizes, band counts and sample rates with a FixedFrameProcessor instantiation
+constexpr int FixedWindowSizes[] = {256, 512, 1024, 2048, 4096};
+constexpr int FixedBandCounts[] = {20, 40, 64, 80, 128};
+constexpr int FixedSampleRates[] = {44100, 48000};
+
+// The specialised processor for this configuration, or nullptr if it is not a preset
+std::unique_ptr<FrameProcessor> CreateFixedFrameProcessor(int windowSize, int numMelFilters, int sampleRate,
+                                                          FftPlanCache::PlanRigor rigor);
+
+#endif // FIXEDFRAMEPROCESSOR_H
@@ -0,0 +1,173 @@
+#include "flacwriter.h"
+
+#include <cmath>
+
+namespace
+{
+    constexpr int BlockFrames = 4096; // Frames handed to the encoder at a time, libFLAC's default block size
+}
+
+FlacWriter::FlacWriter(int bitDepth, int compressionLevel)
+    : depth(qBound(MinBitDepth, bitDepth, MaxBitDepth)),
+      compression(qBound(0, compressionLevel, 8))
+{
+}
+
+FlacWriter::~FlacWriter()
+{
+    close();
+}
+
+bool FlacWriter::IsAvailable()
+{
+#ifdef ECHOGRAPHER_FLAC
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FlacWriter::Quantise(const float *samples, int count, int bitDepth, qint32 *out)
+{
+    const float scale = static_cast<float>(1 << (bitDepth - 1));
+    const float lowest = -scale;
+    const float highest = scale - 1.0f;
+    for (int i = 0; i < count; ++i)
+    {
+        // Clamp before converting, NaN and out-of-range input must not wrap around
+        const float value = std::nearbyint(samples[i] * scale);
+        out[i] = static_cast<qint32>(value > highest ? highest : (value >= lowest ? value : lowest));
+    }
+}
+
+#ifdef ECHOGRAPHER_FLAC
+
+bool FlacWriter::openFile(const QString &path, uint32_t sampleRate, int channels)
+{
+    if (channels < 1 || channels > MaxChannels)
+    {
+        lastError = QString("FLAC supports 1 to %1 channels, not %2.").arg(MaxChannels).arg(channels);
+        return false;
+    }
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        lastError = file.errorString();
+        return false;
+    }
+
+    channelCount = channels;
+    staging.resize(BlockFrames * channels);
+    pcm.resize(BlockFrames * channels);
+    failed = false;
+
+    encoder = FLAC__stream_encoder_new();
+    if (!encoder)
+    {
+        lastError = "Could not create the FLAC encoder.";
+        return false;
+    }
+    FLAC__stream_encoder_set_channels(encoder, channels);
+    FLAC__stream_encoder_set_bits_per_sample(encoder, depth);
+    FLAC__stream_encoder_set_sample_rate(encoder, sampleRate);
+    FLAC__stream_encoder_set_compression_level(encoder, compression);
+    FLAC__stream_encoder_set_blocksize(encoder, BlockFrames);
+
+    // Through QFile rather than init_file(), so fileName() and the error strings stay the same as for WAV
+    const FLAC__StreamEncoderInitStatus status = FLAC__stream_encoder_init_stream(
+        encoder, &FlacWriter::WriteCallback, &FlacWriter::SeekCallback, &FlacWriter::TellCallback, nullptr, this);
+    if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK)
+    {
+        lastError = QString("FLAC encoder: %1").arg(FLAC__StreamEncoderInitStatusString[status]);
+        FLAC__stream_encoder_delete(encoder);
+        encoder = nullptr;
+        return false;
+    }
+    return true;
+}
+
+int FlacWriter::drain()
+{
+    // Whole frames only; every write() pushes whole frames, so none is ever split
+    const int frames = qMin(ring.readAvailable() / channelCount, BlockFrames);
+    if (frames == 0)
+    {
+        return 0;
+    }
+    const int count = ring.pop(staging.data(), frames * channelCount);
+
+    if (!failed)
+    {
+        Quantise(staging.constData(), count, depth, pcm.data());
+        static_assert(sizeof(FLAC__int32) == sizeof(qint32), "FLAC samples are 32-bit");
+        if (!FLAC__stream_encoder_process_interleaved(encoder, reinterpret_cast<const FLAC__int32 *>(pcm.constData()),
+                                                      frames))
+        {
+            setWriteError(QString("FLAC encoder: %1")
+                              .arg(FLAC__StreamEncoderStateString[FLAC__stream_encoder_get_state(encoder)]));
+            failed = true;
+        }
+    }
+    writtenSamples.fetch_add(count); // Handed to the encoder, or discarded after a failure
+    return count;
+}
+
+void FlacWriter::finishFile()
+{
+    if (!encoder)
+    {
+        return;
+    }
+    if (!FLAC__stream_encoder_finish(encoder) && !failed)
+    {
+        setWriteError(QString("FLAC encoder: %1")
+                          .arg(FLAC__StreamEncoderStateString[FLAC__stream_encoder_get_state(encoder)]));
+    }
+    FLAC__stream_encoder_delete(encoder);
+    encoder = nullptr;
+}
+
+FLAC__StreamEncoderWriteStatus FlacWriter::WriteCallback(const FLAC__StreamEncoder *, const FLAC__byte buffer[],
+                                                         size_t bytes, uint32_t, uint32_t, void *clientData)
+{
+    QFile &file = static_cast<FlacWriter *>(clientData)->file;
+    const qint64 size = static_cast<qint64>(bytes);
+    return file.write(reinterpret_cast<const char *>(buffer), size) == size ? FLAC__STREAM_ENCODER_WRITE_STATUS_OK
+                                                                            : FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+}
+
+FLAC__StreamEncoderSeekStatus FlacWriter::SeekCallback(const FLAC__StreamEncoder *, FLAC__uint64 absoluteByteOffset,
+                                                       void *clientData)
+{
+    QFile &file = static_cast<FlacWriter *>(clientData)->file;
+    return file.seek(static_cast<qint64>(absoluteByteOffset)) ? FLAC__STREAM_ENCODER_SEEK_STATUS_OK
+                                                              : FLAC__STREAM_ENCODER_SEEK_STATUS_ERROR;
+}
+
+FLAC__StreamEncoderTellStatus FlacWriter::TellCallback(const FLAC__StreamEncoder *, FLAC__uint64 *absoluteByteOffset,
+                                                       void *clientData)
+{
+    QFile &file = static_cast<FlacWriter *>(clientData)->file;
+    *absoluteByteOffset = static_cast<FLAC__uint64>(file.pos());
+    return FLAC__STREAM_ENCODER_TELL_STATUS_OK;
+}
+
+#else
+
+bool FlacWriter::openFile(const QString &, uint32_t, int)
+{
+    lastError = "This build has no FLAC support (libFLAC was not found).";
+    return false;
+}
+
+int FlacWriter::drain()
+{
+    return 0; // Never opened
+}
+
+void FlacWriter::finishFile()
+{
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef FLACWRITER_H
+#define FLACWRITER_H
+
+#include "recordingwriter.h"
+
+#include <QVector>
+
+#ifdef ECHOGRAPHER_FLAC
+#include <FLAC/stream_encoder.h>
+#endif
+
+// Streams a lossless FLAC file from a background thread (see RecordingWriter).
+// The writer thread quantises the float capture to bitDepth() integer samples and runs the
+// libFLAC encoder on them, so encoding costs the capture side nothing; the STREAMINFO block
+// with the final length is rewritten when the file is closed. Typically a third to a quarter
+// of the size of the float WAV.
+// Builds without libFLAC compile this in as well, but open() then fails (see IsAvailable()).
+class FlacWriter : public RecordingWriter
+{
+public:
+    static constexpr int MinBitDepth = 8;
+    static constexpr int MaxBitDepth = 24;
+    static constexpr int MaxChannels = 8;        // FLAC's own limit
+    static constexpr int DefaultCompression = 5; // libFLAC's default level, well within real time
+
+    explicit FlacWriter(int bitDepth = 24, int compressionLevel = DefaultCompression);
+    ~FlacWriter() override;
+
+    static bool IsAvailable(); // Built with libFLAC
+
+    int bitDepth() const { return depth; }
+    QString fileExtension() const override { return ".flac"; }
+
+    // Scales [-1, 1) floats to signed bitDepth-bit integers, rounding and clipping at full scale
+    static void Quantise(const float *samples, int count, int bitDepth, qint32 *out);
+
+protected:
+    bool openFile(const QString &path, uint32_t sampleRate, int channels) override;
+    int drain() override;
+    void finishFile() override; // Encodes the last block and rewrites STREAMINFO
+
+private:
+    const int depth;
+    const int compression;
+    int channelCount = 1;
+    QVector<float> staging; // One encoder block popped from the ring
+    QVector<qint32> pcm;    // The same block quantised
+
+#ifdef ECHOGRAPHER_FLAC
+    FLAC__StreamEncoder *encoder = nullptr;
+    bool failed = false; // The encoder stopped on an error, the rest of the ring is discarded
+
+    static FLAC__StreamEncoderWriteStatus WriteCallback(const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[],
+                                                        size_t bytes, uint32_t samples, uint32_t currentFrame,
+                                                        void *clientData);
+    static FLAC__StreamEncoderSeekStatus SeekCallback(const FLAC__StreamEncoder *encoder, FLAC__uint64 absoluteByteOffset,
+                                                      void *clientData);
+    static FLAC__StreamEncoderTellStatus TellCallback(const FLAC__StreamEncoder *encoder, FLAC__uint64 *absoluteByteOffset,
+                                                      void *clientData);
+#endif
+};
+
+#endif // FLACWRITER_H
@@ -0,0 +1,81 @@
+#include "frameassembler.h"
+#include "dspkernels.h"
+
+#include <cstring>
+
+FrameAssembler::FrameAssembler(int windowSize, int hopSize, int minCapacity)
+{
+    configure(windowSize, hopSize, minCapacity);
+}
+
+void FrameAssembler::configure(int windowSize, int hopSize, int minCapacity)
+{
+    frameSize = qMax(windowSize, 0);
+    hop = qBound(1, hopSize, qMax(frameSize, 1));
+
+    int size = 1;
+    while (size < qMax(2 * frameSize, minCapacity))
+    {
+        size <<= 1;
+    }
+    buffer.fill(0.0f, size);
+    mask = size - 1;
+    clear();
+}
+
+void FrameAssembler::clear()
+{
+    readPos = 0;
+    writePos = 0;
+}
+
+int FrameAssembler::write(const float *samples, int count)
+{
+    int written = 0;
+    while (written < count && freeSpace() > 0)
+    {
+        const int start = static_cast<int>(writePos & mask);
+        const int chunk = qMin(qMin(count - written, freeSpace()), capacity() - start);
+        std::memcpy(buffer.data() + start, samples + written, chunk * sizeof(float));
+        writePos += chunk;
+        written += chunk;
+    }
+    return written;
+}
+
+int FrameAssembler::pull(SpscRingBuffer<float> &ring)
+{
+    int pulled = 0;
+    while (freeSpace() > 0)
+    {
+        const int start = static_cast<int>(writePos & mask);
+        const int contiguous = qMin(freeSpace(), capacity() - start);
+        const int count = ring.pop(buffer.data() + start, contiguous);
+        writePos += count;
+        pulled += count;
+        if (count < contiguous)
+        {
+            break; // Ring is empty
+        }
+    }
+    return pulled;
+}
+
+bool FrameAssembler::nextFrame(const float *window, float *out)
+{
+    if (!frameReady())
+    {
+        return false;
+    }
+
+    // The frame may wrap around the end of the storage, so window it in at most two runs
+    const float *data = buffer.constData();
+    const int start = static_cast<int>(readPos & mask);
+    const int firstPart = qMin(frameSize, capacity() - start);
+    const DspKernels &kernels = DspKernels::Active();
+    kernels.applyWindow(data + start, window, out, firstPart);
+    kernels.applyWindow(data, window + firstPart, out + firstPart, frameSize - firstPart);
+
+    readPos += hop;
+    return true;
+}
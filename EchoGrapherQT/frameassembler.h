@@ -0,0 +1,49 @@
+#ifndef FRAMEASSEMBLER_H
+#define FRAMEASSEMBLER_H
+
+#include "spscringbuffer.h"
+
+#include <QVector>
+
+// Fixed-capacity circular buffer that turns a sample stream into overlapping analysis frames.
+// Samples are written once into power-of-two storage; frames are read by index arithmetic and
+// multiplied by the window straight into the FFT input, so advancing by a hop costs nothing
+// instead of memmoving the remaining buffer.
+class FrameAssembler
+{
+public:
+    FrameAssembler() = default;
+    FrameAssembler(int windowSize, int hopSize, int minCapacity = 0);
+
+    // Hop is clamped to [1, windowSize]; capacity is at least twice the window
+    void configure(int windowSize, int hopSize, int minCapacity = 0);
+    void clear();
+
+    int windowSize() const { return frameSize; }
+    int hopSize() const { return hop; }
+    int capacity() const { return buffer.size(); }
+    int bufferedSamples() const { return static_cast<int>(writePos - readPos); }
+    int freeSpace() const { return capacity() - bufferedSamples(); }
+
+    // Stream position (in samples) of the first sample of the next frame
+    qint64 nextFramePosition() const { return readPos; }
+
+    // Appends up to `count` samples and returns how many fit
+    int write(const float *samples, int count);
+    // Drains as much of `ring` as fits directly into the circular storage
+    int pull(SpscRingBuffer<float> &ring);
+
+    bool frameReady() const { return frameSize > 0 && bufferedSamples() >= frameSize; }
+    // Writes window[i] * sample[i] of the next frame into `out` and advances by one hop
+    bool nextFrame(const float *window, float *out);
+
+private:
+    QVector<float> buffer;
+    int mask = 0;
+    int frameSize = 0;
+    int hop = 0;
+    qint64 readPos = 0;  // Absolute stream index of the next frame start
+    qint64 writePos = 0; // Absolute stream index one past the last written sample
+};
+
+#endif // FRAMEASSEMBLER_H
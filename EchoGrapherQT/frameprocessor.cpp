@@ -0,0 +1,112 @@
+#include "frameprocessor.h"
+#include "dspkernels.h"
+#include "fixedframeprocessor.h"
+
+#include <cmath>
+
+FrameProcessor::FrameProcessor(int windowSize, int numMelFilters, int sampleRate, FftPlanCache::PlanRigor rigor)
+    : size(windowSize),
+      bands(numMelFilters),
+      rate(sampleRate),
+      hannWindow(qMax(windowSize, 0)),
+      filterbank(MelFilterbank::Shared(windowSize, numMelFilters, sampleRate))
+{
+    windowTable = hannWindow.constData();
+    if (windowSize < 2)
+    {
+        return;
+    }
+
+    // Initialize Hanning window
+    for (int i = 0; i < windowSize; ++i)
+    {
+        hannWindow[i] = 0.5 * (1 - std::cos(2 * M_PI * i / (windowSize - 1)));
+    }
+
+    allocate(rigor);
+}
+
+FrameProcessor::FrameProcessor(int windowSize, int numMelFilters, int sampleRate, FftPlanCache::PlanRigor rigor,
+                               const float *fixedWindow)
+    : size(windowSize),
+      bands(numMelFilters),
+      rate(sampleRate),
+      windowTable(fixedWindow)
+{
+    allocate(rigor);
+}
+
+void FrameProcessor::allocate(FftPlanCache::PlanRigor rigor)
+{
+    // Audio is real, so a real-to-complex transform only needs windowSize / 2 + 1 output bins
+    in = fftwf_alloc_real(size);
+    out = fftwf_alloc_complex(size / 2 + 1);
+    if (in && out)
+    {
+        // Plans are cached per window size, so building a processor again does not plan again
+        plan = FftPlanCache::shared().forwardPlan(size, rigor);
+    }
+}
+
+std::unique_ptr<FrameProcessor> FrameProcessor::Create(int windowSize, int numMelFilters, int sampleRate,
+                                                       FftPlanCache::PlanRigor rigor)
+{
+    if (std::unique_ptr<FrameProcessor> fixed = CreateFixedFrameProcessor(windowSize, numMelFilters, sampleRate, rigor))
+    {
+        return fixed;
+    }
+    return std::make_unique<FrameProcessor>(windowSize, numMelFilters, sampleRate, rigor);
+}
+
+FrameProcessor::~FrameProcessor()
+{
+    // The plan stays in the cache for the next processor
+    fftwf_free(in);
+    fftwf_free(out);
+}
+
+void FrameProcessor::processSamples(const float *samples, float *melSpectrum)
+{
+    DspKernels::Active().applyWindow(samples, windowTable, in, size); // Apply window function
+    process(melSpectrum);
+}
+
+void FrameProcessor::process(float *melSpectrum)
+{
+    transform();
+    melFromSpectrum(melSpectrum);
+}
+
+void FrameProcessor::processLinear(float *melSpectrum)
+{
+    transform();
+    applyFilterbank(melSpectrum);
+}
+
+void FrameProcessor::transform()
+{
+    fftwf_execute_dft_r2c(plan, in, out);
+}
+
+void FrameProcessor::transform(const float *input)
+{
+    // New-array execution of the same plan; an out-of-place r2c transform leaves its input alone
+    fftwf_execute_dft_r2c(plan, const_cast<float *>(input), out);
+}
+
+void FrameProcessor::melFromSpectrum(float *melSpectrum)
+{
+    applyFilterbank(melSpectrum);
+    logScale.apply(melSpectrum, bands);
+}
+
+void FrameProcessor::applyFilterbank(float *melSpectrum)
+{
+    filterbank.applyToComplex(reinterpret_cast<const float *>(out), melSpectrum);
+}
+
+void FrameProcessor::PowerSpectrum(const fftwf_complex *fftData, int bins, float *powerSpectrum)
+{
+    // Convert each FFT bin to power
+    DspKernels::Active().magnitudeSquared(reinterpret_cast<const float *>(fftData), powerSpectrum, bins);
+}
@@ -0,0 +1,84 @@
+#ifndef FRAMEPROCESSOR_H
+#define FRAMEPROCESSOR_H
+
+#include "fftplancache.h"
+#include "logmelscale.h"
+#include "melfilterbank.h"
+
+#include <QVector>
+#include <memory>
+
+// Per-frame analysis shared by the live pipeline and the offline batch tool:
+// Hann window -> real FFT -> power and sparse mel filterbank in one pass -> log/dB scale.
+// Owns its FFT buffers and scratch space, so one instance per thread; the FFTW plan
+// itself comes from FftPlanCache and is shared.
+// This is the generic path for any configuration; FixedFrameProcessor specialises common
+// presets at compile time and Create() picks whichever applies.
+class FrameProcessor
+{
+public:
+    FrameProcessor(int windowSize, int numMelFilters, int sampleRate,
+                   FftPlanCache::PlanRigor rigor = FftPlanCache::Estimate);
+    virtual ~FrameProcessor();
+
+    // A compile-time specialised processor for preset configurations, the generic one otherwise
+    static std::unique_ptr<FrameProcessor> Create(int windowSize, int numMelFilters, int sampleRate,
+                                                  FftPlanCache::PlanRigor rigor = FftPlanCache::Estimate);
+
+    FrameProcessor(const FrameProcessor &) = delete;
+    FrameProcessor &operator=(const FrameProcessor &) = delete;
+
+    bool isValid() const { return plan != nullptr; }
+    int windowSize() const { return size; }
+    int numMelFilters() const { return bands; }
+    int sampleRate() const { return rate; }
+    virtual bool isSpecialized() const { return false; }
+
+    const float *window() const { return windowTable; }
+    float *input() { return in; } // windowSize samples, already windowed (see FrameAssembler::nextFrame)
+    const fftwf_complex *spectrum() const { return out; }
+
+    // dB floor, reference and normalisation of the output; reset() it between streams
+    LogMelScale &scale() { return logScale; }
+    const LogMelScale &scale() const { return logScale; }
+
+    // Windows `samples` into the FFT input and runs process()
+    virtual void processSamples(const float *samples, float *melSpectrum);
+    // Transforms input() and writes numMelFilters() log-mel values (see scale()) to melSpectrum
+    void process(float *melSpectrum);
+    // Same as process() but stops at linear mel energies
+    void processLinear(float *melSpectrum);
+
+    // The two halves of process(), for callers that time them separately
+    void transform();                         // FFT of input() into spectrum()
+    void transform(const float *input);       // FFT of the caller's windowSize samples, fftwf-aligned like input()
+    void melFromSpectrum(float *melSpectrum); // Filterbank and dB scale of spectrum()
+    void linearMelFromSpectrum(float *melSpectrum) { applyFilterbank(melSpectrum); } // Filterbank only
+
+    static void PowerSpectrum(const fftwf_complex *fftData, int bins, float *powerSpectrum);
+
+protected:
+    // For specialisations that bring their own window table and filterbank layout
+    FrameProcessor(int windowSize, int numMelFilters, int sampleRate, FftPlanCache::PlanRigor rigor,
+                   const float *fixedWindow);
+
+    // Linear mel energies of spectrum()
+    virtual void applyFilterbank(float *melSpectrum);
+
+    float *in = nullptr;
+    fftwf_complex *out = nullptr;
+    fftwf_plan plan = nullptr;
+
+private:
+    void allocate(FftPlanCache::PlanRigor rigor);
+
+    int size;
+    int bands;
+    int rate;
+    QVector<float> hannWindow;
+    MelFilterbank filterbank;
+    const float *windowTable;
+    LogMelScale logScale;
+};
+
+#endif // FRAMEPROCESSOR_H
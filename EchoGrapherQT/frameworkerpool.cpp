@@ -0,0 +1,230 @@
+#include "frameworkerpool.h"
+
+FrameWorkerPool::~FrameWorkerPool()
+{
+    stop();
+}
+
+bool FrameWorkerPool::start(int windowSize, int numMelFilters, int sampleRate, FftPlanCache::PlanRigor rigor,
+                            int threads, int slotsPerThread)
+{
+    stop();
+    threads = qMax(1, threads);
+
+    for (int i = 0; i < threads; ++i)
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->processor = FrameProcessor::Create(windowSize, numMelFilters, sampleRate, rigor);
+        if (!worker->processor->isValid())
+        {
+            workers.clear();
+            return false;
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    const int slotTotal = threads * qMax(1, slotsPerThread);
+    for (int i = 0; i < slotTotal; ++i)
+    {
+        auto slot = std::make_unique<Slot>();
+        slot->input = fftwf_alloc_real(windowSize);
+        slot->mel.resize(numMelFilters);
+        frames.push_back(std::move(slot));
+    }
+    for (std::unique_ptr<Worker> &worker : workers)
+    {
+        worker->queue.items.assign(slotTotal, -1); // Room for every slot, so a push never fails
+    }
+
+    stopping.store(false);
+    for (int i = 0; i < threads; ++i)
+    {
+        workers[i]->thread = QThread::create([this, i]()
+                                             { workerLoop(i); });
+        workers[i]->thread->start();
+    }
+    return true;
+}
+
+void FrameWorkerPool::stop()
+{
+    {
+        QMutexLocker locker(&wakeMutex);
+        stopping.store(true);
+        workAvailable.wakeAll();
+    }
+    {
+        QMutexLocker locker(&doneMutex);
+        frameDone.wakeAll();
+    }
+    for (std::unique_ptr<Worker> &worker : workers)
+    {
+        if (worker->thread)
+        {
+            worker->thread->wait();
+            delete worker->thread;
+        }
+    }
+    workers.clear();
+
+    for (std::unique_ptr<Slot> &slot : frames)
+    {
+        fftwf_free(slot->input);
+    }
+    frames.clear();
+    submitted = 0;
+    taken = 0;
+    queued.store(0);
+}
+
+float *FrameWorkerPool::nextInput()
+{
+    if (frames.empty() || inFlight() >= slotCount())
+    {
+        return nullptr;
+    }
+    return frames[submitted % frames.size()]->input;
+}
+
+void FrameWorkerPool::submit(qint64 position, qint64 submittedNs)
+{
+    const int index = static_cast<int>(submitted % frames.size());
+    Slot &slot = *frames[index];
+    slot.position = position;
+    slot.submittedNs = submittedNs;
+    slot.state.store(Queued, std::memory_order_release);
+
+    // Dealt round-robin, so neighbouring hops start on different workers
+    WorkQueue &queue = workers[submitted % workers.size()]->queue;
+    {
+        QMutexLocker locker(&queue.mutex);
+        queue.items[(queue.head + queue.count) % queue.items.size()] = index;
+        ++queue.count;
+    }
+    ++submitted;
+
+    queued.fetch_add(1);
+    QMutexLocker locker(&wakeMutex);
+    workAvailable.wakeOne();
+}
+
+bool FrameWorkerPool::takeCompleted(qint64 *position, float **melEnergies, qint64 *submittedNs)
+{
+    if (taken == submitted)
+    {
+        return false;
+    }
+    Slot &slot = *frames[taken % frames.size()];
+    if (slot.state.load(std::memory_order_acquire) != Done)
+    {
+        return false; // A later frame may be done already, but the order is kept
+    }
+    *position = slot.position;
+    *melEnergies = slot.mel.data();
+    if (submittedNs)
+    {
+        *submittedNs = slot.submittedNs;
+    }
+    return true;
+}
+
+void FrameWorkerPool::release()
+{
+    frames[taken % frames.size()]->state.store(Free, std::memory_order_relaxed);
+    ++taken;
+}
+
+void FrameWorkerPool::waitForOldest()
+{
+    if (taken == submitted)
+    {
+        return;
+    }
+    Slot &slot = *frames[taken % frames.size()];
+    QMutexLocker locker(&doneMutex);
+    while (slot.state.load(std::memory_order_acquire) != Done && !stopping.load())
+    {
+        frameDone.wait(&doneMutex);
+    }
+}
+
+void FrameWorkerPool::workerLoop(int index)
+{
+    Worker &worker = *workers[index];
+    while (true)
+    {
+        int slot = -1;
+        if (takeWork(index, &slot))
+        {
+            compute(worker, *frames[slot]);
+            continue;
+        }
+
+        QMutexLocker locker(&wakeMutex);
+        while (queued.load() == 0 && !stopping.load())
+        {
+            workAvailable.wait(&wakeMutex);
+        }
+        if (stopping.load())
+        {
+            return;
+        }
+    }
+}
+
+// The oldest frame of the worker's own queue first, as the reorder stage waits on the oldest;
+// failing that the newest of another queue, which its owner would have reached last
+bool FrameWorkerPool::takeWork(int index, int *slot)
+{
+    const int count = static_cast<int>(workers.size());
+    for (int i = 0; i < count; ++i)
+    {
+        WorkQueue &queue = workers[(index + i) % count]->queue;
+        QMutexLocker locker(&queue.mutex);
+        if (queue.count == 0)
+        {
+            continue;
+        }
+
+        const int size = static_cast<int>(queue.items.size());
+        if (i == 0)
+        {
+            *slot = queue.items[queue.head];
+            queue.head = (queue.head + 1) % size;
+        }
+        else
+        {
+            *slot = queue.items[(queue.head + queue.count - 1) % size];
+            stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+        --queue.count;
+        queued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void FrameWorkerPool::compute(Worker &worker, Slot &slot)
+{
+    FrameProcessor &processor = *worker.processor;
+
+    // Transformed straight out of the slot, which is aligned like the processor's own input
+    if (PipelineStats *pipelineStats = stats.load())
+    {
+        const qint64 startNs = pipelineStats->now();
+        processor.transform(slot.input);
+        const qint64 fftDoneNs = pipelineStats->now();
+        processor.linearMelFromSpectrum(slot.mel.data());
+        pipelineStats->record(PipelineStats::Fft, fftDoneNs - startNs);
+        pipelineStats->record(PipelineStats::Mel, pipelineStats->now() - fftDoneNs);
+    }
+    else
+    {
+        processor.transform(slot.input);
+        processor.linearMelFromSpectrum(slot.mel.data());
+    }
+
+    slot.state.store(Done, std::memory_order_release);
+    QMutexLocker locker(&doneMutex);
+    frameDone.wakeOne(); // Only the reorder stage waits here
+}
@@ -0,0 +1,112 @@
+#ifndef FRAMEWORKERPOOL_H
+#define FRAMEWORKERPOOL_H
+
+#include "fftplancache.h"
+#include "frameprocessor.h"
+#include "pipelinestats.h"
+
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Computes the frames of one stream on several threads, for windows too large or hops too
+// short for a single thread to keep up with.
+// The producer windows each hop straight into a free slot and submits it; slots are dealt
+// round-robin onto per-worker queues, and a worker whose queue runs dry steals from the far end
+// of another's. Every worker has its own FrameProcessor, so its own FFT buffers and scratch
+// (the plan itself is shared, see FftPlanCache). Workers stop at linear mel energies: the dB
+// scale keeps a running range, so the producer takes the frames back strictly in submission
+// order and scales them itself.
+class FrameWorkerPool
+{
+public:
+    FrameWorkerPool() = default;
+    ~FrameWorkerPool();
+
+    FrameWorkerPool(const FrameWorkerPool &) = delete;
+    FrameWorkerPool &operator=(const FrameWorkerPool &) = delete;
+
+    // Starts `threads` workers with up to slotsPerThread frames in flight each. False if a
+    // processor could not be created.
+    bool start(int windowSize, int numMelFilters, int sampleRate, FftPlanCache::PlanRigor rigor, int threads,
+               int slotsPerThread = 4);
+    void stop(); // Waits for the workers; frames still in flight are discarded
+
+    int threadCount() const { return static_cast<int>(workers.size()); }
+    int slotCount() const { return static_cast<int>(frames.size()); }
+    int inFlight() const { return static_cast<int>(submitted - taken); }
+
+    // Producer side, one thread. nextInput() is the windowSize samples of the next free slot,
+    // nullptr while every slot is in flight; fill it, then submit() it.
+    float *nextInput();
+    void submit(qint64 position, qint64 submittedNs = -1);
+
+    // Reorder stage, same thread as the producer: the oldest frame in flight if it is done,
+    // in submission order. Its mel energies stay valid until release().
+    bool takeCompleted(qint64 *position, float **melEnergies, qint64 *submittedNs = nullptr);
+    void release();
+    void waitForOldest(); // Blocks until the oldest frame in flight is done
+
+    // Workers record the Fft and Mel stages of every frame here while set; nullptr for none
+    void setStats(PipelineStats *pipelineStats) { stats.store(pipelineStats); }
+
+    quint64 stolenFrames() const { return stolen.load(std::memory_order_relaxed); } // Taken from another worker's queue
+
+private:
+    enum SlotState
+    {
+        Free,
+        Queued,
+        Done
+    };
+
+    struct Slot
+    {
+        float *input = nullptr; // Windowed samples, fftwf-aligned
+        QVector<float> mel;     // Linear mel energies
+        qint64 position = 0;
+        qint64 submittedNs = -1;
+        std::atomic<int> state{Free};
+    };
+
+    // A worker's queue of slot indices: its owner takes from the front, thieves from the back
+    struct WorkQueue
+    {
+        QMutex mutex;
+        std::vector<int> items; // Circular, one entry per slot
+        int head = 0;
+        int count = 0;
+    };
+
+    struct Worker
+    {
+        std::unique_ptr<FrameProcessor> processor;
+        WorkQueue queue;
+        QThread *thread = nullptr;
+    };
+
+    void workerLoop(int index);
+    bool takeWork(int index, int *slot);
+    void compute(Worker &worker, Slot &slot);
+
+    std::vector<std::unique_ptr<Slot>> frames;
+    std::vector<std::unique_ptr<Worker>> workers;
+    quint64 submitted = 0; // Producer side
+    quint64 taken = 0;     // Reorder side, the oldest frame in flight is frames[taken % slotCount()]
+
+    std::atomic<int> queued{0}; // Submitted, not picked up by a worker yet
+    std::atomic<bool> stopping{false};
+    std::atomic<quint64> stolen{0};
+    QMutex wakeMutex;
+    QWaitCondition workAvailable;
+    QMutex doneMutex;
+    QWaitCondition frameDone;
+    std::atomic<PipelineStats *> stats{nullptr};
+};
+
+#endif // FRAMEWORKERPOOL_H
@@ -0,0 +1,122 @@
+#include "latencyhistogram.h"
+
+#include <limits>
+
+namespace
+{
+int HighestBit(quint64 value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::atomic<quint64> &bucket : buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    smallest.store(std::numeric_limits<qint64>::max(), std::memory_order_relaxed);
+    largest.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::BucketFor(qint64 nanoseconds)
+{
+    if (nanoseconds < SubBuckets)
+    {
+        return static_cast<int>(qMax<qint64>(0, nanoseconds)); // Exact below 32 ns
+    }
+    const int exponent = HighestBit(static_cast<quint64>(nanoseconds));
+    if (exponent > MaxExponent)
+    {
+        return BucketCount - 1;
+    }
+    const int subBucket = static_cast<int>(nanoseconds >> (exponent - SubBucketBits)) - SubBuckets;
+    return (exponent - SubBucketBits + 1) * SubBuckets + subBucket;
+}
+
+qint64 LatencyHistogram::BucketLowerBound(int bucket)
+{
+    if (bucket < SubBuckets)
+    {
+        return bucket;
+    }
+    const int exponent = bucket / SubBuckets + SubBucketBits - 1;
+    return static_cast<qint64>(SubBuckets + bucket % SubBuckets) << (exponent - SubBucketBits);
+}
+
+qint64 LatencyHistogram::BucketUpperBound(int bucket)
+{
+    if (bucket < SubBuckets)
+    {
+        return bucket + 1;
+    }
+    const int exponent = bucket / SubBuckets + SubBucketBits - 1;
+    return BucketLowerBound(bucket) + (qint64(1) << (exponent - SubBucketBits));
+}
+
+void LatencyHistogram::record(qint64 nanoseconds)
+{
+    nanoseconds = qMax<qint64>(0, nanoseconds);
+    buckets[BucketFor(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    // Only contended while a new extreme is being set, which is rare after the first few values
+    qint64 current = smallest.load(std::memory_order_relaxed);
+    while (nanoseconds < current && !smallest.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+    current = largest.load(std::memory_order_relaxed);
+    while (nanoseconds > current && !largest.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+qint64 LatencyHistogram::min() const
+{
+    const qint64 value = smallest.load(std::memory_order_relaxed);
+    return value == std::numeric_limits<qint64>::max() ? 0 : value;
+}
+
+double LatencyHistogram::mean() const
+{
+    const quint64 n = count();
+    return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+qint64 LatencyHistogram::percentile(double percentile) const
+{
+    const quint64 n = count();
+    if (n == 0)
+    {
+        return 0;
+    }
+    // Rank of the wanted value, 1-based, then the bucket that holds it
+    const quint64 rank = qBound<quint64>(1, static_cast<quint64>(percentile / 100.0 * n + 0.5), n);
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < BucketCount; ++bucket)
+    {
+        seen += bucketCount(bucket);
+        if (seen >= rank)
+        {
+            // Middle of the bucket, but never outside what was actually recorded
+            const qint64 middle = (BucketLowerBound(bucket) + BucketUpperBound(bucket) - 1) / 2;
+            return qBound(min(), middle, max());
+        }
+    }
+    return max();
+}
@@ -0,0 +1,45 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Log-linear latency histogram in the style of HdrHistogram: every power of two is split
+// into 32 linear sub-buckets, so any recorded value is known to within about 3%, from 1 ns
+// up to about half an hour, in a fixed array of counters. record() is lock-free and can be
+// called from any thread, including real-time ones; readers see a consistent-enough view
+// while recording goes on.
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 5;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+    static constexpr int MaxExponent = 40; // Values from 2^41 ns land in the last bucket
+    static constexpr int BucketCount = (MaxExponent - SubBucketBits + 2) * SubBuckets;
+
+    LatencyHistogram();
+
+    void record(qint64 nanoseconds);
+    void reset();
+
+    quint64 count() const { return total.load(std::memory_order_relaxed); }
+    qint64 min() const;
+    qint64 max() const { return largest.load(std::memory_order_relaxed); }
+    double mean() const;
+    // The value below which `percentile` percent of the recorded values fall, 0 if empty
+    qint64 percentile(double percentile) const;
+
+    quint64 bucketCount(int bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+    static int BucketFor(qint64 nanoseconds);
+    static qint64 BucketLowerBound(int bucket);
+    static qint64 BucketUpperBound(int bucket); // Exclusive
+
+private:
+    std::atomic<quint64> buckets[BucketCount];
+    std::atomic<quint64> total{0};
+    std::atomic<qint64> sum{0};
+    std::atomic<qint64> smallest;
+    std::atomic<qint64> largest{0};
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,88 @@
+#include "logmelscale.h"
+#include "dspkernels.h"
+
+#include <QtGlobal>
+#include <cfloat>
+#include <cmath>
+
+LogMelScale::LogMelScale(float floorDb, float referencePower, bool normalize, float releaseDbPerFrame)
+    : floor(floorDb),
+      reference(referencePower),
+      normalizeOutput(normalize),
+      release(releaseDbPerFrame)
+{
+    updateConstants();
+}
+
+void LogMelScale::setFloorDb(float floorDb)
+{
+    floor = floorDb;
+    updateConstants();
+}
+
+void LogMelScale::setReferencePower(float referencePower)
+{
+    reference = referencePower;
+    updateConstants();
+}
+
+void LogMelScale::updateConstants()
+{
+    if (!(reference > 0.0f))
+    {
+        reference = 1.0f;
+    }
+    offsetDb = 10.0f * std::log10(reference);
+    // Clamping to a normal float keeps the fast log valid for zero and denormal energies
+    floorPower = qMax(reference * std::pow(10.0f, floor / 10.0f), FLT_MIN);
+    reset();
+}
+
+void LogMelScale::reset()
+{
+    runningMin = floor;
+    runningMax = floor;
+    rangeValid = false;
+}
+
+void LogMelScale::apply(float *values, int count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    // One pass: clamp to the floor power (so every log input is a normal positive float),
+    // take the log, scale to dB and track the frame's extremes
+    float frameMin;
+    float frameMax;
+    DspKernels::Active().decibels(values, count, floorPower, offsetDb, &frameMin, &frameMax);
+
+    // Running range: jumps out to new extremes immediately, drifts back in by `release` per frame
+    if (!rangeValid)
+    {
+        runningMin = frameMin;
+        runningMax = frameMax;
+        rangeValid = true;
+    }
+    else
+    {
+        runningMax = qMax(frameMax, runningMax - release);
+        runningMin = qMin(frameMin, runningMin + release);
+    }
+
+    if (normalizeOutput)
+    {
+        const float low = qMax(qMin(runningMin, runningMax - MinimumRangeDb), floor);
+        const float scale = 1.0f / qMax(runningMax - low, 1e-6f);
+        for (int i = 0; i < count; ++i)
+        {
+            values[i] = qBound(0.0f, (values[i] - low) * scale, 1.0f);
+        }
+    }
+}
+
+void LogMelScale::FastLog(const float *input, float *output, int count)
+{
+    DspKernels::Active().log(input, output, count);
+}
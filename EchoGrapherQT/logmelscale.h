@@ -0,0 +1,52 @@
+#ifndef LOGMELSCALE_H
+#define LOGMELSCALE_H
+
+// Converts mel energies to decibels, with a floor, a reference level and optional running
+// min/max normalisation to [0, 1] for display.
+// The logarithm is the vectorised series approximation in DspKernels, accurate to well
+// under 0.001 dB, so the per-frame cost is a handful of vector instructions instead of one
+// std::log call per band.
+class LogMelScale
+{
+public:
+    explicit LogMelScale(float floorDb = -80.0f, float referencePower = 1.0f, bool normalize = false,
+                         float releaseDbPerFrame = 0.05f);
+
+    void setFloorDb(float floorDb);
+    void setReferencePower(float referencePower);
+    void setNormalize(bool normalize) { normalizeOutput = normalize; }
+    // How fast the running range shrinks back after a loud or quiet frame
+    void setReleaseDbPerFrame(float releaseDbPerFrame) { release = releaseDbPerFrame; }
+
+    float floorDb() const { return floor; }
+    float referencePower() const { return reference; }
+    bool normalize() const { return normalizeOutput; }
+    float runningMinDb() const { return runningMin; }
+    float runningMaxDb() const { return runningMax; }
+
+    // Forgets the running range, e.g. when a new stream starts
+    void reset();
+
+    // In place: values[i] = max(10 * log10(values[i] / reference), floor), then normalised if enabled
+    void apply(float *values, int count);
+
+    // Natural logarithm of `count` positive, normal floats
+    static void FastLog(const float *input, float *output, int count);
+
+    static constexpr float MinimumRangeDb = 20.0f; // Normalisation never stretches less than this to [0, 1]
+
+private:
+    void updateConstants();
+
+    float floor;
+    float reference;
+    bool normalizeOutput;
+    float release;
+    float floorPower = 0.0f; // Linear power that maps to the floor, keeps the log away from zero
+    float offsetDb = 0.0f;   // 10 * log10(reference)
+    float runningMin = 0.0f;
+    float runningMax = 0.0f;
+    bool rangeValid = false;
+};
+
+#endif // LOGMELSCALE_H
@@ -1,13 +1,169 @@
+#include "flacwriter.h"
 #include "mainwindow.h"
+#include "syntheticsource.h"
+#include "wavfilesource.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QMessageBox>
+
+#include <cstdio>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
     QApplication::setWindowIcon(QIcon(":/assets/appicon.png"));
     a.setStyleSheet("QWidget { background-color: #232633; }");
+
+    // Optional non-device input, for reproducing a recording or running without a sound card
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption replayOption("replay", "Replay a WAV file instead of the input device; repeat to replay several side by side.", "file");
+    QCommandLineOption synthOption("synthetic", "Use a generated signal instead of the input device: tone, chirp or noise.", "waveform");
+    QCommandLineOption speedOption("speed", "Replay speed, 1 = real time, 0 = as fast as possible.", "factor", "1");
+    QCommandLineOption loopOption("loop", "Replay the WAV file in a loop.");
+    QCommandLineOption channelsOption("channels", "Input channels to capture and analyse; above 1 a replayed file keeps all of its own.", "count", "1");
+    QCommandLineOption devicesOption("devices", "Comma-separated input devices to capture side by side, see --list-devices.", "indices");
+    QCommandLineOption listDevicesOption("list-devices", "List the input devices and exit.");
+    QCommandLineOption frameWorkersOption("frame-workers", "Threads computing spectrogram frames, 1 = one per channel, 0 = every core.", "count", "1");
+    QCommandLineOption fftRigorOption("fft-rigor", "FFT planning: estimate, measure or patient; measured plans are saved as FFTW wisdom.", "rigor", "estimate");
+    QCommandLineOption recordFormatOption("record-format", "Recording format: wav (32-bit float) or flac (lossless, needs libFLAC).", "format", "wav");
+    QCommandLineOption recordBitsOption("record-bits", "Bit depth of FLAC recordings, 8 to 24.", "bits", "24");
+    QCommandLineOption segmentMinutesOption("segment-minutes", "Start a new WAV recording file every this many minutes.", "minutes", "0");
+    QCommandLineOption segmentMbOption("segment-mb", "Start a new WAV recording file before one grows past this many MB.", "megabytes", "0");
+    QCommandLineOption storeOption("store-spectrogram", "Also keep every spectrogram frame in an .egspec store, with 32 or 16-bit values.", "bits");
+    QCommandLineOption browseOption("browse", "Open a stored .egspec spectrogram in the history window.", "file");
+    parser.addOptions({replayOption, synthOption, speedOption, loopOption, channelsOption, devicesOption, listDevicesOption,
+                       frameWorkersOption, fftRigorOption, recordFormatOption, recordBitsOption, segmentMinutesOption,
+                       segmentMbOption, storeOption, browseOption});
+    parser.process(a);
+
+    if (parser.isSet(listDevicesOption))
+    {
+        Pa_Initialize();
+        for (PaDeviceIndex device = 0; device < Pa_GetDeviceCount(); ++device)
+        {
+            const PaDeviceInfo *info = Pa_GetDeviceInfo(device);
+            if (info && info->maxInputChannels > 0)
+            {
+                printf("%d: %s (%d channels, %.0f Hz)\n", device, info->name, info->maxInputChannels, info->defaultSampleRate);
+            }
+        }
+        Pa_Terminate();
+        return 0;
+    }
+
+    QVector<int> devices;
+    for (const QString &index : parser.value(devicesOption).split(',', Qt::SkipEmptyParts))
+    {
+        bool ok = false;
+        devices.append(index.trimmed().toInt(&ok));
+        if (!ok || devices.last() < 0)
+        {
+            QMessageBox::critical(nullptr, "EchoGrapher", "Invalid device index: " + index);
+            return 1;
+        }
+    }
+
+    const int channels = parser.value(channelsOption).toInt();
+    if (channels < 1)
+    {
+        QMessageBox::critical(nullptr, "EchoGrapher", "Invalid channel count: " + parser.value(channelsOption));
+        return 1;
+    }
+
+    const int frameWorkers = parser.value(frameWorkersOption).toInt();
+    if (frameWorkers < 0)
+    {
+        QMessageBox::critical(nullptr, "EchoGrapher", "Invalid frame worker count: " + parser.value(frameWorkersOption));
+        return 1;
+    }
+
+    FftPlanCache::PlanRigor fftRigor = FftPlanCache::Estimate;
+    if (!FftPlanCache::RigorFromName(parser.value(fftRigorOption), &fftRigor))
+    {
+        QMessageBox::critical(nullptr, "EchoGrapher", "Unknown FFT planning rigor: " + parser.value(fftRigorOption));
+        return 1;
+    }
+
+    RecordingWriter::Format recordFormat = RecordingWriter::Wav;
+    if (!RecordingWriter::FormatFromName(parser.value(recordFormatOption), &recordFormat))
+    {
+        QMessageBox::critical(nullptr, "EchoGrapher", "Unknown recording format: " + parser.value(recordFormatOption));
+        return 1;
+    }
+    if (!RecordingWriter::IsAvailable(recordFormat))
+    {
+        QMessageBox::critical(nullptr, "EchoGrapher", "This build has no FLAC support (libFLAC was not found).");
+        return 1;
+    }
+    const int recordBits = parser.value(recordBitsOption).toInt();
+    if (recordBits < FlacWriter::MinBitDepth || recordBits > FlacWriter::MaxBitDepth)
+    {
+        QMessageBox::critical(nullptr, "EchoGrapher", "Invalid recording bit depth: " + parser.value(recordBitsOption));
+        return 1;
+    }
+
+    const double segmentMinutes = parser.value(segmentMinutesOption).toDouble();
+    const qint64 segmentMb = parser.value(segmentMbOption).toLongLong();
+    if (segmentMinutes < 0.0 || segmentMb < 0)
+    {
+        QMessageBox::critical(nullptr, "EchoGrapher", "Invalid recording segment length.");
+        return 1;
+    }
+
+    const QString storeBits = parser.value(storeOption);
+    if (parser.isSet(storeOption) && storeBits != "32" && storeBits != "16")
+    {
+        QMessageBox::critical(nullptr, "EchoGrapher", "Invalid spectrogram store precision: " + storeBits);
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<AudioSource>> sources;
+    for (const QString &file : parser.values(replayOption))
+    {
+        sources.emplace_back(new WavFileSource(file, parser.isSet(loopOption), channels == 1));
+    }
+    if (sources.empty() && parser.isSet(synthOption))
+    {
+        SyntheticSource::Settings settings;
+        if (!SyntheticSource::WaveformFromName(parser.value(synthOption), &settings.waveform))
+        {
+            QMessageBox::critical(nullptr, "EchoGrapher", "Unknown waveform: " + parser.value(synthOption));
+            return 1;
+        }
+        settings.frequency = settings.waveform == SyntheticSource::Chirp ? 100.0 : 440.0;
+        settings.channels = channels;
+        sources.emplace_back(new SyntheticSource(settings));
+    }
+    for (std::unique_ptr<AudioSource> &source : sources)
+    {
+        source->setSpeed(parser.value(speedOption).toDouble());
+    }
+
     MainWindow w;
+    w.setInputChannels(channels);
+    w.setInputDevices(devices);
+    w.setFrameWorkers(frameWorkers);
+    w.setFftPlanRigor(fftRigor);
+    w.setRecordingFormat(recordFormat, recordBits);
+    w.setRecordingSegments(segmentMinutes * 60.0, segmentMb << 20);
+    w.setSpectrogramStore(parser.isSet(storeOption), storeBits == "16" ? SpectrogramStoreWriter::Float16 : SpectrogramStoreWriter::Float32);
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        if (i == 0)
+        {
+            w.setAudioSource(std::move(sources[i]));
+        }
+        else
+        {
+            w.addAudioSource(std::move(sources[i])); // Replayed side by side, like several devices
+        }
+    }
     w.show();
+    if (parser.isSet(browseOption) && !w.openSpectrogramStore(parser.value(browseOption)))
+    {
+        return 1;
+    }
     return a.exec();
 }
@@ -1,13 +1,16 @@
 #include <portaudio.h>
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "spectrogrambrowser.h"
+#include "spectrogramrenderer.h"
+#include "statspanel.h"
 
 #include <QTimer>
+#include <QDateTime>
 #include <iostream>
 #include <QFileDialog>
 #include <QMessageBox>
-#include <QLinearGradient>
-#include <QGraphicsRectItem>
+#include <QTransform>
 
 #include <cstdio>
 #if defined(_WIN32)
@@ -121,13 +124,25 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent),
     ui->graphicsView->setScene(new QGraphicsScene(this));
     ui->graphicsView->scene()->setBackgroundBrush(QBrush(Qt::black));
 
+    // The spectrogram is a single item kept in the scene for the lifetime of the window
+    spectrogramItem = new SpectrogramItem();
+    spectrogramItem->setStats(&audioProcessor->stats()); // Paints close the render stage
+    ui->graphicsView->scene()->addItem(spectrogramItem);
+    channelItems.append(spectrogramItem);
+    statsPanel = new StatsPanel(&audioProcessor->stats(), this);
+    historyBrowser = new SpectrogramBrowser(this);
+
+    // Palettes are listed in Colormap::Palette order, so the index is the palette
+    ui->paletteComboBox->addItems(Colormap::PaletteNames());
+
     // Connect the buttons to the slots in the MainWindow constructor
     connect(ui->startButton, &QPushButton::clicked, this, &MainWindow::startProcessing);
     connect(ui->stopButton, &QPushButton::clicked, this, &MainWindow::stopProcessing);
 
     // Connect the AudioProcessor signals to the MainWindow slots
-    connect(audioProcessor, &AudioProcessor::newLogMelSpectrogram, this, &MainWindow::onNewSpectrogram);
+    connect(audioProcessor, &AudioProcessor::spectrogramBlocksReady, this, &MainWindow::onSpectrogramBlocksReady);
     connect(audioProcessor, &AudioProcessor::errorOccurred, this, &MainWindow::onErrorOccurred);
+    connect(audioProcessor, &AudioProcessor::sourceFinished, this, &MainWindow::stopProcessing); // End of a replayed file
 }
 
 MainWindow::~MainWindow()
@@ -246,7 +261,13 @@ void MainWindow::startProcessing()
 {
     emit processingStarted(); // Emit the signal to notify other parts of the app
     this->setFocus(Qt::OtherFocusReason);
-    audioProcessor->startProcessing();  // Start with desired sample rate
+    if (!audioProcessor->startProcessing())
+    {
+        return; // Already reported, and the window stays in the stopped state
+    }
+    setupChannelItems(audioProcessor->channelCount());
+    historyBrowser->reset(audioProcessor->channelCount());
+    historyBrowser->showChannel(qMax(0, ui->channelComboBox->currentIndex() - 1));
     ui->startButton->setEnabled(false); // Disable start button
     ui->startButton->setStyleSheet("QPushButton { color: gray; }");
     ui->stopButton->setEnabled(true); // Enable stop button
@@ -262,7 +283,14 @@ void MainWindow::stopProcessing()
 {
     emit processingStopped();
     this->setFocus(Qt::OtherFocusReason);
+    const bool wasProcessing = ui->stopButton->isEnabled();
     audioProcessor->stopProcessing();  // Stop processing
+    if (wasProcessing && statsPanel->exportOnStop())
+    {
+        // Next to the recording of the same run
+        const QString dateTimeStr = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+        statsPanel->exportTo(ui->outputPathLineEdit->text() + "/stats_" + dateTimeStr + ".json");
+    }
     ui->startButton->setEnabled(true); // Re-enable start button
     ui->startButton->setStyleSheet("QPushButton { color: white; }");
     ui->stopButton->setEnabled(false); // Disable stop button
@@ -274,75 +302,142 @@ void MainWindow::stopProcessing()
     ui->overlapSlider->setEnabled(true);
 }
 
-void MainWindow::onNewSpectrogram(const QVector<float> &spectrum)
+void MainWindow::onSpectrogramBlocksReady()
 {
-    // Append the new spectrum data to the buffer instead of updating the UI directly
-    spectrumBuffer.append(spectrum);
+    // Everything queued so far, however far the GUI fell behind; the queue itself is bounded
+    while (audioProcessor->takeSpectrogramBlock(receivedBlock))
+    {
+        onNewSpectrogramBlock(receivedBlock);
+    }
 }
 
-void MainWindow::updateSpectrogram()
+void MainWindow::onNewSpectrogramBlock(const SpectrogramBlock &block)
 {
-    if (!spectrumBuffer.isEmpty())
+    // One event carries every frame computed since the last delivery; each becomes one column
+    if (block.channel < 0 || block.channel >= channelItems.size())
+    {
+        return; // From a run with more channels than the display was set up for
+    }
+    SpectrogramItem *item = channelItems[block.channel];
+    item->renderer().appendBlock(block);
+    historyBrowser->appendBlock(block);
+    spectrogramDirty = spectrogramDirty || !block.isEmpty();
+
+    PipelineStats &stats = audioProcessor->stats();
+    const qint64 receivedNs = stats.now();
+    stats.add(PipelineStats::BlocksReceived);
+    if (block.firstFrameReadyNs >= 0)
     {
-        // Dimensions for spectrogram
-        int spectrogramWidth = 800;  // Width of the spectrogram image
-        int spectrogramHeight = 500; // Height of the spectrogram image
+        stats.record(PipelineStats::Delivery, receivedNs - block.firstFrameReadyNs);
+    }
+    item->markPending(receivedNs, block.frameCount());
+}
 
-        static QImage spectrogramImage(spectrogramWidth, spectrogramHeight, QImage::Format_RGB32);
-        QPainter painter(&spectrogramImage);
+void MainWindow::updateSpectrogram()
+{
+    // Columns are already in the images, so a repaint of the items is all that is left
+    if (spectrogramDirty)
+    {
+        for (SpectrogramItem *item : channelItems)
+        {
+            item->update();
+        }
+        spectrogramDirty = false;
+    }
+}
 
-        // Shift the spectrogram image left by one column width to make space for new data
-        QImage temp = spectrogramImage.copy(1, 0, spectrogramWidth - 1, spectrogramHeight);
-        spectrogramImage.fill(Qt::black); // Fill the image with black
-        painter.drawImage(0, 0, temp);    // Draw the shifted image onto the original image
+void MainWindow::setupChannelItems(int channels)
+{
+    channels = qMax(1, channels);
 
-        // The x position for the new data (rightmost column)
-        int xPosition = spectrogramImage.width() - 1;
+    // Channel 0 keeps the persistent item; every further channel gets one of its own
+    while (channelItems.size() > channels)
+    {
+        delete channelItems.takeLast(); // Also removes it from the scene
+    }
+    const int palette = qMax(0, ui->paletteComboBox->currentIndex());
+    while (channelItems.size() < channels)
+    {
+        SpectrogramItem *item = new SpectrogramItem();
+        item->setStats(&audioProcessor->stats());
+        item->renderer().colormap().setPalette(static_cast<Colormap::Palette>(palette));
+        ui->graphicsView->scene()->addItem(item);
+        channelItems.append(item);
+    }
 
-        // Draw each new column from the buffer onto the spectrogram image
-        for (const QVector<float> &spectrum : spectrumBuffer)
+    // "All channels" stacks them, any other entry shows that channel alone. Channels are counted
+    // across the devices of the run, so with several devices each entry names its device too.
+    ui->channelComboBox->blockSignals(true);
+    ui->channelComboBox->clear();
+    if (channels > 1)
+    {
+        ui->channelComboBox->addItem("All channels");
+        const int devices = audioProcessor->deviceCount();
+        for (int d = 0; devices > 1 && d < devices; ++d)
         {
-            for (int i = 0; i < spectrum.size(); ++i)
+            for (int c = 0; c < audioProcessor->deviceChannelCount(d); ++c)
             {
-                int barHeight = std::max(0.0f, spectrum[i]) * spectrogramHeight;
-                QLinearGradient gradient(0, spectrogramHeight - barHeight, 0, spectrogramHeight);
-                gradient.setColorAt(0.0, Qt::darkBlue);
-                gradient.setColorAt(0.2, Qt::blue);
-                gradient.setColorAt(0.4, Qt::cyan);
-                gradient.setColorAt(0.6, Qt::green);
-                gradient.setColorAt(0.8, Qt::yellow);
-                gradient.setColorAt(1.0, Qt::red);
-                painter.setBrush(gradient);
-                painter.setPen(Qt::NoPen);
-                // Draw the bar at the current column
-                painter.drawRect(xPosition, spectrogramHeight - barHeight, 1, barHeight);
+                ui->channelComboBox->addItem(QString("Device %1, channel %2").arg(d + 1).arg(c + 1));
             }
         }
-
-        // Finish painting
-        painter.end();
-
-        // Now update the UI with the image
-        QGraphicsScene *scene = ui->graphicsView->scene();
-        if (!scene)
+        for (int c = 0; devices <= 1 && c < channels; ++c)
         {
-            scene = new QGraphicsScene(this);
-            ui->graphicsView->setScene(scene);
+            ui->channelComboBox->addItem(QString("Channel %1").arg(c + 1));
         }
-        else
+    }
+    ui->channelComboBox->setEnabled(channels > 1);
+    ui->channelComboBox->blockSignals(false);
+    layoutChannelItems();
+}
+
+void MainWindow::layoutChannelItems()
+{
+    // Visible channels share the height of one spectrogram, top to bottom in channel order
+    const int selected = ui->channelComboBox->currentIndex() - 1; // -1 for all channels
+    int visible = 0;
+    for (int c = 0; c < channelItems.size(); ++c)
+    {
+        visible += (selected < 0 || selected == c) ? 1 : 0;
+    }
+
+    int row = 0;
+    for (int c = 0; c < channelItems.size(); ++c)
+    {
+        SpectrogramItem *item = channelItems[c];
+        const bool shown = selected < 0 || selected == c;
+        item->setVisible(shown);
+        if (shown)
         {
-            scene->clear(); // Clear the previous scene
+            const qreal height = item->boundingRect().height() / visible;
+            item->setTransform(QTransform::fromScale(1.0, 1.0 / visible));
+            item->setPos(0, row * height);
+            ++row;
         }
+    }
+}
 
-        // Add the updated spectrogram image to the scene
-        scene->addPixmap(QPixmap::fromImage(spectrogramImage));
+void MainWindow::on_statsButton_clicked()
+{
+    statsPanel->show();
+    statsPanel->raise();
+    statsPanel->activateWindow();
+}
 
-        // Ensure the latest column is visible
-        ui->graphicsView->ensureVisible(scene->sceneRect());
+void MainWindow::on_historyButton_clicked()
+{
+    historyBrowser->show();
+    historyBrowser->raise();
+    historyBrowser->activateWindow();
+}
 
-        // Clear the buffer after it has been processed
-        spectrumBuffer.clear();
+bool MainWindow::openSpectrogramStore(const QString &path)
+{
+    if (!historyBrowser->openStore(path))
+    {
+        return false;
     }
+    on_historyButton_clicked();
+    return true;
 }
 
 void MainWindow::onErrorOccurred(const QString &errorMessage)
@@ -359,6 +454,62 @@ void MainWindow::on_selectOutputPathButton_clicked()
     setOutputPath(dir);
 }
 
+void MainWindow::setAudioSource(std::unique_ptr<AudioSource> source)
+{
+    const QString description = source ? source->description() : QString("Default input device");
+    audioProcessor->setAudioSource(std::move(source));
+    ui->labelStatus->setText("Status: Ready - " + description);
+}
+
+void MainWindow::addAudioSource(std::unique_ptr<AudioSource> source)
+{
+    if (!source)
+    {
+        return;
+    }
+    const QString description = source->description();
+    audioProcessor->addAudioSource(std::move(source));
+    ui->labelStatus->setText(ui->labelStatus->text() + ", " + description);
+}
+
+void MainWindow::setInputDevices(const QVector<int> &devices)
+{
+    audioProcessor->inputDevices = devices;
+}
+
+void MainWindow::setInputChannels(int channels)
+{
+    audioProcessor->inputChannels = qMax(1, channels);
+}
+
+void MainWindow::setFrameWorkers(int threads)
+{
+    audioProcessor->frameWorkers = qMax(0, threads);
+}
+
+void MainWindow::setFftPlanRigor(FftPlanCache::PlanRigor rigor)
+{
+    audioProcessor->fftPlanRigor = rigor;
+}
+
+void MainWindow::setRecordingFormat(RecordingWriter::Format format, int bitDepth)
+{
+    audioProcessor->recordingFormat = format;
+    audioProcessor->recordingBitDepth = bitDepth;
+}
+
+void MainWindow::setRecordingSegments(double seconds, qint64 bytes)
+{
+    audioProcessor->recordingSegmentSeconds = seconds;
+    audioProcessor->recordingSegmentBytes = bytes;
+}
+
+void MainWindow::setSpectrogramStore(bool enabled, SpectrogramStoreWriter::ValueFormat format)
+{
+    audioProcessor->storeSpectrogram = enabled;
+    audioProcessor->spectrogramStoreFormat = format;
+}
+
 void MainWindow::setOutputPath(const QString &path)
 {
     ui->outputPathLineEdit->setText(path);
@@ -401,6 +552,30 @@ void MainWindow::on_resetZoomButton_clicked()
     ui->graphicsView->resetTransform();
 }
 
+void MainWindow::on_paletteComboBox_currentIndexChanged(int index)
+{
+    if (index < 0)
+    {
+        return;
+    }
+    // Applies to the columns drawn from now on, on every channel
+    for (SpectrogramItem *item : channelItems)
+    {
+        item->renderer().colormap().setPalette(static_cast<Colormap::Palette>(index));
+    }
+    historyBrowser->setPalette(static_cast<Colormap::Palette>(index));
+}
+
+void MainWindow::on_channelComboBox_currentIndexChanged(int index)
+{
+    if (index < 0)
+    {
+        return;
+    }
+    layoutChannelItems();
+    historyBrowser->showChannel(qMax(0, index - 1)); // "All channels" browses the first one
+}
+
 void MainWindow::customizeSliders()
 {
     // Customize the window size slider
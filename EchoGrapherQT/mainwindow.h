@@ -7,6 +7,10 @@
 #include <QMouseEvent>
 #include <QLabel>
 
+class SpectrogramBrowser;
+class SpectrogramItem;
+class StatsPanel;
+
 QT_BEGIN_NAMESPACE
 namespace Ui
 {
@@ -25,12 +29,23 @@ public:
     void InitializePortAudio();
     void customizeSliders();
     void setOutputPath(const QString &path);
+    void setAudioSource(std::unique_ptr<AudioSource> source); // nullptr for the input devices
+    void addAudioSource(std::unique_ptr<AudioSource> source); // Captured side by side with the ones already set
+    void setInputDevices(const QVector<int> &devices);        // PortAudio input devices, empty for the default one
+    void setInputChannels(int channels);                      // Channels captured from each input device
+    void setFrameWorkers(int threads);                        // Threads computing frames, 0 for every core
+    void setFftPlanRigor(FftPlanCache::PlanRigor rigor);      // Measured plans are kept in the FFTW wisdom file
+    void setRecordingFormat(RecordingWriter::Format format, int bitDepth); // bitDepth applies to FLAC only
+    void setRecordingSegments(double seconds, qint64 bytes);  // WAV rotation, 0 for no limit
+    void setSpectrogramStore(bool enabled, SpectrogramStoreWriter::ValueFormat format); // .egspec next to the recording
+    bool openSpectrogramStore(const QString &path);           // Browses a stored session in the history window
 
 private slots:
     void toggleMaximizeRestore();
 
-    // Slot for handling the creation of the spectrogram visualization
-    void onNewSpectrogram(const QVector<float> &spectrum);
+    // Slots for handling the creation of the spectrogram visualization
+    void onSpectrogramBlocksReady();
+    void onNewSpectrogramBlock(const SpectrogramBlock &block);
     void updateSpectrogram();
     void onErrorOccurred(const QString &errorMessage); // Slot to handle errors from the audio processor
     void startProcessing();
@@ -42,6 +57,10 @@ private slots:
     void on_zoomInButton_clicked();
     void on_zoomOutButton_clicked();
     void on_resetZoomButton_clicked();
+    void on_paletteComboBox_currentIndexChanged(int index);
+    void on_channelComboBox_currentIndexChanged(int index);
+    void on_statsButton_clicked();
+    void on_historyButton_clicked();
 
     // UI Slider Options
     void on_windowSizeslider_valueChanged(int value);
@@ -53,9 +72,18 @@ signals:
     void processingStopped();
 
 private:
+    void setupChannelItems(int channels);
+    void layoutChannelItems();
+
     Ui::MainWindow *ui;
     AudioProcessor *audioProcessor; // Pointer to the AudioProcessor class
-    QVector<QVector<float>> spectrumBuffer;
+
+    SpectrogramBlock receivedBlock;         // Reused for every block taken from the render queue
+    SpectrogramItem *spectrogramItem;       // Persistent item drawing the circular spectrogram image of channel 0
+    QVector<SpectrogramItem *> channelItems; // One item per input channel of the current run, spectrogramItem first
+    bool spectrogramDirty = false;          // New columns since the last repaint
+    StatsPanel *statsPanel;                 // Tool window over audioProcessor->stats()
+    SpectrogramBrowser *historyBrowser;     // Tool window over every frame of the run, fed alongside channelItems
     QTimer *updateTimer;
     QPoint dragPosition; // The dragPosition variable
     bool dragging;
@@ -0,0 +1,179 @@
+#include "mappedwavfile.h"
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef Q_OS_UNIX
+    // madvise() wants a page-aligned start; the mapping itself starts on a page
+    void Advise(uchar *mapping, qint64 begin, qint64 end, int advice)
+    {
+        static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+        begin -= begin % pageSize;
+        if (end > begin)
+        {
+            madvise(mapping + begin, static_cast<size_t>(end - begin), advice);
+        }
+    }
+#endif
+}
+
+MappedWavFile::~MappedWavFile()
+{
+    close();
+}
+
+bool MappedWavFile::open(const QString &path, AccessPattern pattern, bool hugePages)
+{
+    close();
+    lastError.clear();
+    if (!ReadWavInfo(path, info, lastError))
+    {
+        return false;
+    }
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        lastError = file.errorString();
+        return false;
+    }
+    mappedBytes = file.size();
+    mapping = mappedBytes > 0 ? file.map(0, mappedBytes) : nullptr;
+    if (!mapping)
+    {
+        lastError = QString("could not map the file: %1").arg(file.errorString());
+        file.close();
+        return false;
+    }
+
+    // The file may have changed since the header was read, never hand out bytes past the mapping
+    if (info.dataOffset > mappedBytes)
+    {
+        close();
+        lastError = "data chunk lies past the end of the file";
+        return false;
+    }
+    info.numFrames = qMin(info.numFrames, (mappedBytes - info.dataOffset) / info.bytesPerFrame());
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    directFloat = info.audioFormat == 3 && info.bitsPerSample == 32 && info.dataOffset % qint64(sizeof(float)) == 0;
+#endif
+
+#ifdef Q_OS_UNIX
+    Advise(mapping, 0, mappedBytes, pattern == Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+#if defined(Q_OS_LINUX) && defined(MADV_HUGEPAGE)
+    hugePagesEnabled = hugePages && madvise(mapping, static_cast<size_t>(mappedBytes), MADV_HUGEPAGE) == 0;
+#else
+    Q_UNUSED(hugePages);
+#endif
+#else
+    Q_UNUSED(pattern);
+    Q_UNUSED(hugePages);
+#endif
+    return true;
+}
+
+void MappedWavFile::close()
+{
+    if (mapping)
+    {
+        file.unmap(mapping);
+        mapping = nullptr;
+    }
+    file.close();
+    mappedBytes = 0;
+    directFloat = false;
+    hugePagesEnabled = false;
+}
+
+qint64 MappedWavFile::availableFrames(qint64 firstFrame, qint64 count) const
+{
+    return mapping ? qBound<qint64>(0, info.numFrames - firstFrame, count) : 0;
+}
+
+const char *MappedWavFile::rawFrames(qint64 firstFrame) const
+{
+    if (!mapping || firstFrame < 0 || firstFrame >= info.numFrames)
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const char *>(mapping) + info.dataOffset + firstFrame * info.bytesPerFrame();
+}
+
+const float *MappedWavFile::floatFrames(qint64 firstFrame) const
+{
+    return directFloat ? reinterpret_cast<const float *>(rawFrames(firstFrame)) : nullptr;
+}
+
+qint64 MappedWavFile::readMono(qint64 firstFrame, qint64 count, float *out) const
+{
+    const qint64 available = firstFrame < 0 ? 0 : availableFrames(firstFrame, count);
+    if (available > 0)
+    {
+        if (directFloat && info.numChannels == 1)
+        {
+            std::copy(floatFrames(firstFrame), floatFrames(firstFrame) + available, out);
+        }
+        else
+        {
+            DecodeMonoFrames(rawFrames(firstFrame), info, available, out);
+        }
+    }
+    std::fill(out + available, out + count, 0.0f);
+    return available;
+}
+
+qint64 MappedWavFile::readInterleaved(qint64 firstFrame, qint64 count, float *out) const
+{
+    const qint64 available = firstFrame < 0 ? 0 : availableFrames(firstFrame, count);
+    if (available > 0)
+    {
+        if (directFloat)
+        {
+            std::copy(floatFrames(firstFrame), floatFrames(firstFrame) + available * info.numChannels, out);
+        }
+        else
+        {
+            DecodeInterleavedFrames(rawFrames(firstFrame), info, available, out);
+        }
+    }
+    std::fill(out + available * info.numChannels, out + count * info.numChannels, 0.0f);
+    return available;
+}
+
+void MappedWavFile::prefetch(qint64 firstFrame, qint64 count) const
+{
+#ifdef Q_OS_UNIX
+    const qint64 available = firstFrame < 0 ? 0 : availableFrames(firstFrame, count);
+    if (available > 0)
+    {
+        const qint64 begin = info.dataOffset + firstFrame * info.bytesPerFrame();
+        Advise(mapping, begin, begin + available * info.bytesPerFrame(), MADV_WILLNEED);
+    }
+#else
+    Q_UNUSED(firstFrame);
+    Q_UNUSED(count);
+#endif
+}
+
+void MappedWavFile::release(qint64 firstFrame, qint64 count) const
+{
+#ifdef Q_OS_UNIX
+    const qint64 available = firstFrame < 0 ? 0 : availableFrames(firstFrame, count);
+    if (available > 0)
+    {
+        // The pages stay in the page cache, only this process lets go of them
+        const qint64 begin = info.dataOffset + firstFrame * info.bytesPerFrame();
+        Advise(mapping, begin, begin + available * info.bytesPerFrame(), MADV_DONTNEED);
+    }
+#else
+    Q_UNUSED(firstFrame);
+    Q_UNUSED(count);
+#endif
+}
@@ -0,0 +1,70 @@
+#ifndef MAPPEDWAVFILE_H
+#define MAPPEDWAVFILE_H
+
+#include "wavreader.h"
+
+#include <QFile>
+#include <QString>
+
+// A WAV recording mapped read-only into memory, for reprocessing long captures at disk speed.
+// The samples are read straight out of the page cache: 32-bit float data (what WavWriter
+// records) is handed out as a pointer into the mapping without any copy, other encodings are
+// decoded from the mapping without the intermediate read buffer QFile would need. The kernel
+// is told how the file will be walked so it reads ahead accordingly.
+class MappedWavFile
+{
+public:
+    enum AccessPattern
+    {
+        Sequential, // Aggressive read-ahead, pages behind the reader may be dropped early
+        Random      // No read-ahead, for seeking around a recording
+    };
+
+    MappedWavFile() = default;
+    ~MappedWavFile();
+
+    MappedWavFile(const MappedWavFile &) = delete;
+    MappedWavFile &operator=(const MappedWavFile &) = delete;
+
+    // Validates the header (see ReadWavInfo) and maps the file. hugePages asks for transparent
+    // huge pages where the kernel supports them for file mappings, and is ignored otherwise.
+    bool open(const QString &path, AccessPattern pattern = Sequential, bool hugePages = false);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+    QString errorString() const { return lastError; }
+
+    const WavInfo &wavInfo() const { return info; }
+    qint64 frameCount() const { return info.numFrames; }
+    bool usesHugePages() const { return hugePagesEnabled; } // The kernel accepted the hint
+
+    // The raw sample bytes from `firstFrame` to the end of the data, nullptr past the end
+    const char *rawFrames(qint64 firstFrame) const;
+
+    // True for little-endian 32-bit float samples on a little-endian host, which floatFrames()
+    // hands out in place. numChannels interleaved samples per frame, frameCount() - firstFrame
+    // frames follow the returned pointer; nullptr for any other encoding or past the end.
+    bool isDirectFloat() const { return directFloat; }
+    const float *floatFrames(qint64 firstFrame) const;
+
+    // Decode `count` frames like ReadMonoSamples and ReadInterleavedSamples, zero-padding past
+    // the end of the data; they return the frames that came from the file
+    qint64 readMono(qint64 firstFrame, qint64 count, float *out) const;
+    qint64 readInterleaved(qint64 firstFrame, qint64 count, float *out) const;
+
+    // Read-ahead a range that is about to be used, or let the kernel drop one that is done with
+    void prefetch(qint64 firstFrame, qint64 count) const;
+    void release(qint64 firstFrame, qint64 count) const;
+
+private:
+    qint64 availableFrames(qint64 firstFrame, qint64 count) const;
+
+    WavInfo info;
+    QString lastError;
+    QFile file;
+    uchar *mapping = nullptr; // The whole file, header included
+    qint64 mappedBytes = 0;
+    bool directFloat = false;
+    bool hugePagesEnabled = false;
+};
+
+#endif // MAPPEDWAVFILE_H
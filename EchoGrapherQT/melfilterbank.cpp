@@ -0,0 +1,134 @@
+#include "melfilterbank.h"
+#include "dspkernels.h"
+
+#include <QMutex>
+
+#include <cmath>
+#include <map>
+#include <tuple>
+
+MelFilterbank::MelFilterbank(int fftSize, int numFilters, int sampleRate)
+{
+    build(fftSize, numFilters, sampleRate);
+}
+
+MelFilterbank MelFilterbank::Shared(int fftSize, int numFilters, int sampleRate)
+{
+    static QMutex mutex;
+    static std::map<std::tuple<int, int, int>, MelFilterbank> filterbanks;
+
+    // Copies are cheap, the implicitly shared vectors are only referenced and never written again
+    QMutexLocker locker(&mutex);
+    auto found = filterbanks.find(std::make_tuple(fftSize, numFilters, sampleRate));
+    if (found == filterbanks.end())
+    {
+        found = filterbanks.emplace(std::make_tuple(fftSize, numFilters, sampleRate), MelFilterbank(fftSize, numFilters, sampleRate)).first;
+    }
+    return found->second;
+}
+
+bool MelFilterbank::matches(int fftSize, int numFilters, int sampleRate) const
+{
+    return !ranges.isEmpty() && size == fftSize && ranges.size() == numFilters && rate == sampleRate;
+}
+
+void MelFilterbank::build(int fftSize, int numFilters, int sampleRate)
+{
+    size = fftSize;
+    rate = sampleRate;
+    ranges.clear();
+    filterWeights.clear();
+
+    if (fftSize <= 0 || numFilters <= 0 || sampleRate <= 0)
+    {
+        return;
+    }
+
+    const int maxBin = fftSize / 2;
+
+    // Compute the Mel frequency limits
+    const float lowerMelFreq = FrequencyToMel(0);
+    const float upperMelFreq = FrequencyToMel(sampleRate / 2);
+    const float melStep = (upperMelFreq - lowerMelFreq) / (numFilters + 1);
+
+    // Edge bins of every triangle, shared between neighbouring filters
+    QVector<int> bins(numFilters + 2);
+    for (int i = 0; i <= numFilters + 1; ++i)
+    {
+        float binFrequency = MelToFrequency(lowerMelFreq + i * melStep);
+        int bin = static_cast<int>(std::floor((fftSize + 1) * binFrequency / sampleRate));
+        bins[i] = qBound(0, bin, maxBin);
+    }
+
+    ranges.reserve(numFilters);
+    filterWeights.reserve(bins[numFilters + 1] - bins[0] + bins[numFilters] - bins[1]);
+
+    for (int i = 1; i <= numFilters; ++i)
+    {
+        const int startBin = bins[i - 1];
+        const int centerBin = bins[i];
+        const int endBin = bins[i + 1];
+
+        ranges.push_back({startBin, endBin, static_cast<int>(filterWeights.size())});
+
+        for (int j = startBin; j < centerBin; ++j)
+        {
+            filterWeights.push_back((j - startBin) / static_cast<float>(centerBin - startBin));
+        }
+        for (int j = centerBin; j < endBin; ++j)
+        {
+            filterWeights.push_back(1.0f - (j - centerBin) / static_cast<float>(endBin - centerBin));
+        }
+    }
+}
+
+void MelFilterbank::apply(const float *powerSpectrum, float *melSpectrum) const
+{
+    // Each filter is a dense dot product over its own run of bins
+    const DspKernels &kernels = DspKernels::Active();
+    const float *weight = filterWeights.constData();
+    for (const FilterRange &range : ranges)
+    {
+        *melSpectrum++ = kernels.dot(powerSpectrum + range.startBin, weight + range.offset, range.endBin - range.startBin);
+    }
+}
+
+void MelFilterbank::applyToComplex(const float *complexBins, float *melSpectrum) const
+{
+    const DspKernels &kernels = DspKernels::Active();
+    const float *weight = filterWeights.constData();
+    for (const FilterRange &range : ranges)
+    {
+        *melSpectrum++ = kernels.weightedPower(complexBins + 2 * range.startBin, weight + range.offset, range.endBin - range.startBin);
+    }
+}
+
+QVector<QVector<float>> MelFilterbank::toDense() const
+{
+    QVector<QVector<float>> filterbank;
+    filterbank.reserve(ranges.size());
+
+    for (const FilterRange &range : ranges)
+    {
+        QVector<float> filter(size / 2, 0.0f);
+        for (int bin = range.startBin; bin < range.endBin; ++bin)
+        {
+            filter[bin] = filterWeights[range.offset + bin - range.startBin];
+        }
+        filterbank.push_back(std::move(filter)); // Use move semantics to avoid copying
+    }
+
+    return filterbank;
+}
+
+// Helper function to convert Mel to frequency
+float MelFilterbank::MelToFrequency(float mel)
+{
+    return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+// Helper function to convert frequency to Mel scale
+float MelFilterbank::FrequencyToMel(float frequency)
+{
+    return 2595.0f * std::log10(1.0f + frequency / 700.0f);
+}
@@ -0,0 +1,58 @@
+#ifndef MELFILTERBANK_H
+#define MELFILTERBANK_H
+
+#include <QVector>
+
+// Sparse, band-limited triangular mel filterbank.
+// Each triangle only touches the bins between its lower and upper edge, so instead of
+// numFilters dense rows of fftSize / 2 floats we keep one [startBin, endBin) range per
+// filter and all of the weights back to back in a single contiguous array.
+class MelFilterbank
+{
+public:
+    struct FilterRange
+    {
+        int startBin; // First bin covered by the filter
+        int endBin;   // One past the last bin covered by the filter
+        int offset;   // Index of the first weight of this filter in weights()
+    };
+
+    MelFilterbank() = default;
+    MelFilterbank(int fftSize, int numFilters, int sampleRate);
+
+    // Process-wide cache: the copy shares its tables with every other lane, device and processor
+    // of the same layout, and is built only once
+    static MelFilterbank Shared(int fftSize, int numFilters, int sampleRate);
+
+    void build(int fftSize, int numFilters, int sampleRate);
+    bool matches(int fftSize, int numFilters, int sampleRate) const;
+    bool isEmpty() const { return ranges.isEmpty(); }
+
+    int fftSize() const { return size; }
+    int numFilters() const { return ranges.size(); }
+    int sampleRate() const { return rate; }
+    int numBins() const { return size / 2; } // Bins the filterbank expects in a power spectrum
+
+    const QVector<FilterRange> &filterRanges() const { return ranges; }
+    const QVector<float> &weights() const { return filterWeights; }
+
+    // melSpectrum[f] = sum(powerSpectrum[bin] * weight) over the bins of filter f
+    void apply(const float *powerSpectrum, float *melSpectrum) const;
+    // Same, but squares the interleaved (re, im) FFT bins on the fly instead of reading a
+    // power spectrum, so the spectrum is read once and no power buffer is written
+    void applyToComplex(const float *complexBins, float *melSpectrum) const;
+
+    // Expands the sparse representation into the dense numFilters x fftSize / 2 layout
+    QVector<QVector<float>> toDense() const;
+
+    static float FrequencyToMel(float frequency);
+    static float MelToFrequency(float mel);
+
+private:
+    int size = 0;
+    int rate = 0;
+    QVector<FilterRange> ranges;
+    QVector<float> filterWeights;
+};
+
+#endif // MELFILTERBANK_H
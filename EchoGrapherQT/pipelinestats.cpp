@@ -0,0 +1,172 @@
+#include "pipelinestats.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+PipelineStats::PipelineStats()
+{
+    clock.start();
+    reset();
+}
+
+void PipelineStats::reset()
+{
+    for (LatencyHistogram &histogram : histograms)
+    {
+        histogram.reset();
+    }
+    for (std::atomic<quint64> &value : counters)
+    {
+        value.store(0, std::memory_order_relaxed);
+    }
+    for (int gauge = 0; gauge < GaugeCount; ++gauge)
+    {
+        gauges[gauge].store(0, std::memory_order_relaxed);
+        gaugeMaxima[gauge].store(0, std::memory_order_relaxed);
+    }
+    runStart.store(now(), std::memory_order_relaxed);
+}
+
+void PipelineStats::setGauge(Gauge gauge, qint64 value)
+{
+    gauges[gauge].store(value, std::memory_order_relaxed);
+    qint64 current = gaugeMaxima[gauge].load(std::memory_order_relaxed);
+    while (value > current && !gaugeMaxima[gauge].compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+QJsonObject PipelineStats::toJson() const
+{
+    QJsonObject stages;
+    for (int stage = 0; stage < StageCount; ++stage)
+    {
+        const LatencyHistogram &h = histograms[stage];
+        QJsonObject entry;
+        entry["count"] = static_cast<qint64>(h.count());
+        entry["min_ns"] = h.min();
+        entry["mean_ns"] = h.mean();
+        entry["p50_ns"] = h.percentile(50.0);
+        entry["p90_ns"] = h.percentile(90.0);
+        entry["p99_ns"] = h.percentile(99.0);
+        entry["p999_ns"] = h.percentile(99.9);
+        entry["max_ns"] = h.max();
+
+        // Non-empty buckets as [lower bound, upper bound, count], enough to merge or re-plot runs
+        QJsonArray buckets;
+        for (int bucket = 0; bucket < LatencyHistogram::BucketCount; ++bucket)
+        {
+            if (const quint64 n = h.bucketCount(bucket))
+            {
+                buckets.append(QJsonArray{LatencyHistogram::BucketLowerBound(bucket), LatencyHistogram::BucketUpperBound(bucket),
+                                          static_cast<qint64>(n)});
+            }
+        }
+        entry["buckets"] = buckets;
+        stages[StageName(static_cast<Stage>(stage))] = entry;
+    }
+
+    QJsonObject counterValues;
+    for (int c = 0; c < CounterCount; ++c)
+    {
+        counterValues[CounterName(static_cast<Counter>(c))] = static_cast<qint64>(counter(static_cast<Counter>(c)));
+    }
+
+    QJsonObject gaugeValues;
+    for (int g = 0; g < GaugeCount; ++g)
+    {
+        gaugeValues[GaugeName(static_cast<Gauge>(g))] = QJsonObject{{"current", gauge(static_cast<Gauge>(g))},
+                                                                    {"max", gaugeMax(static_cast<Gauge>(g))}};
+    }
+
+    QJsonObject root;
+    root["exported"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["run_seconds"] = runNanoseconds() / 1e9;
+    root["stages"] = stages;
+    root["counters"] = counterValues;
+    root["gauges"] = gaugeValues;
+    return root;
+}
+
+bool PipelineStats::writeJson(const QString &path, QString *error) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(QJsonDocument(toJson()).toJson()) < 0)
+    {
+        if (error)
+        {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+QString PipelineStats::StageName(Stage stage)
+{
+    switch (stage)
+    {
+    case Capture:
+        return "capture";
+    case QueueWait:
+        return "queue_wait";
+    case Fft:
+        return "fft";
+    case Mel:
+        return "mel";
+    case Delivery:
+        return "delivery";
+    case Render:
+        return "render";
+    default:
+        return QString();
+    }
+}
+
+QString PipelineStats::CounterName(Counter counter)
+{
+    switch (counter)
+    {
+    case FramesProcessed:
+        return "frames_processed";
+    case BlocksDelivered:
+        return "blocks_delivered";
+    case BlocksReceived:
+        return "blocks_received";
+    case ColumnsRendered:
+        return "columns_rendered";
+    case CaptureOverflows:
+        return "capture_overflows";
+    case InputOverflows:
+        return "input_overflows";
+    case RecordingDrops:
+        return "recording_drops";
+    case RecordingErrors:
+        return "recording_errors";
+    case RenderDrops:
+        return "render_drops";
+    case RenderCoalesced:
+        return "render_coalesced";
+    default:
+        return QString();
+    }
+}
+
+QString PipelineStats::GaugeName(Gauge gauge)
+{
+    switch (gauge)
+    {
+    case CaptureQueue:
+        return "capture_queue_frames"; // Frames, summed over devices with different channel counts
+    case RecordingBacklog:
+        return "recording_backlog_samples";
+    case BlockBacklog:
+        return "block_backlog";
+    case ClockDrift:
+        return "clock_drift_ppm";
+    default:
+        return QString();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef PIPELINESTATS_H
+#define PIPELINESTATS_H
+
+#include "latencyhistogram.h"
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <atomic>
+
+// Where the time goes between a sample arriving and its column reaching the screen.
+// One instance per AudioProcessor. Every thread of the pipeline records into it without
+// locking: latency histograms per stage, frame and drop counters, and queue depth gauges.
+// All timestamps come from now(), one monotonic clock shared by every stage.
+class PipelineStats
+{
+public:
+    enum Stage
+    {
+        Capture,   // Source read returned -> block pushed to the capture ring
+        QueueWait, // Last sample of a frame pushed -> frame taken up by the processing thread
+        Fft,       // FFT of one frame
+        Mel,       // Mel filterbank and dB scale of one frame
+        Delivery,  // Frame computed -> its block received on the GUI thread
+        Render,    // Block received -> painted on screen
+        StageCount
+    };
+
+    enum Counter
+    {
+        FramesProcessed,
+        BlocksDelivered,
+        BlocksReceived,   // Blocks that reached the GUI
+        ColumnsRendered,
+        CaptureOverflows, // Blocks that found the capture ring full
+        InputOverflows,   // Blocks the device reported as overflowed
+        RecordingDrops,   // Samples the recorder had no room for
+        RecordingErrors,  // Recordings and spectrogram stores that stopped on a write error
+        RenderDrops,      // Frames dropped oldest first because the GUI fell behind
+        RenderCoalesced,  // Blocks merged into one already waiting for the GUI
+        CounterCount
+    };
+
+    enum Gauge
+    {
+        CaptureQueue,     // Frames waiting in the capture rings of all devices
+        RecordingBacklog, // Samples queued for the recorder, not yet on disk
+        BlockBacklog,     // Blocks waiting in the render queue for the GUI
+        ClockDrift,       // Spread between the fastest and slowest device sample clock, ppm
+        GaugeCount
+    };
+
+    PipelineStats();
+
+    void reset(); // Clears everything and restarts the run clock
+
+    // Nanoseconds since the stats were created, from the same clock on every thread
+    qint64 now() const { return clock.nsecsElapsed(); }
+    qint64 runNanoseconds() const { return now() - runStart.load(std::memory_order_relaxed); }
+
+    void record(Stage stage, qint64 nanoseconds) { histograms[stage].record(nanoseconds); }
+    void add(Counter counter, quint64 amount = 1) { counters[counter].fetch_add(amount, std::memory_order_relaxed); }
+    void set(Counter counter, quint64 value) { counters[counter].store(value, std::memory_order_relaxed); }
+    void setGauge(Gauge gauge, qint64 value);
+
+    const LatencyHistogram &histogram(Stage stage) const { return histograms[stage]; }
+    quint64 counter(Counter counter) const { return counters[counter].load(std::memory_order_relaxed); }
+    qint64 gauge(Gauge gauge) const { return gauges[gauge].load(std::memory_order_relaxed); }
+    qint64 gaugeMax(Gauge gauge) const { return gaugeMaxima[gauge].load(std::memory_order_relaxed); }
+
+    QJsonObject toJson() const;
+    bool writeJson(const QString &path, QString *error = nullptr) const;
+
+    static QString StageName(Stage stage);
+    static QString CounterName(Counter counter);
+    static QString GaugeName(Gauge gauge);
+
+private:
+    QElapsedTimer clock;
+    std::atomic<qint64> runStart{0};
+    LatencyHistogram histograms[StageCount];
+    std::atomic<quint64> counters[CounterCount];
+    std::atomic<qint64> gauges[GaugeCount];
+    std::atomic<qint64> gaugeMaxima[GaugeCount];
+};
+
+#endif // PIPELINESTATS_H
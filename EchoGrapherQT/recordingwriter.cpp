@@ -0,0 +1,125 @@
+#include "recordingwriter.h"
+#include "flacwriter.h"
+#include "wavwriter.h"
+
+namespace
+{
+    constexpr unsigned long IdleWaitMs = 20; // Writer poll interval while the ring is empty
+}
+
+std::unique_ptr<RecordingWriter> RecordingWriter::Create(Format format, int bitDepth)
+{
+    if (format == Flac)
+    {
+        return std::make_unique<FlacWriter>(bitDepth);
+    }
+    return std::make_unique<WavWriter>();
+}
+
+bool RecordingWriter::IsAvailable(Format format)
+{
+    return format != Flac || FlacWriter::IsAvailable();
+}
+
+bool RecordingWriter::FormatFromName(const QString &name, Format *format)
+{
+    const QString lower = name.toLower();
+    if (lower == "wav")
+    {
+        *format = Wav;
+    }
+    else if (lower == "flac")
+    {
+        *format = Flac;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+RecordingWriter::~RecordingWriter() = default;
+
+bool RecordingWriter::open(const QString &path, uint32_t sampleRate, int channels, double bufferSeconds)
+{
+    close();
+    lastError.clear();
+    writeFailed.store(false);
+    filePath = path;
+    ring.reset(qMax(static_cast<int>(bufferSeconds * frameRate(sampleRate) * channels), minimumRingSamples()));
+    if (!openFile(path, sampleRate, channels))
+    {
+        if (file.isOpen())
+        {
+            file.close();
+        }
+        return false;
+    }
+
+    pushedSamples.store(0);
+    writtenSamples.store(0);
+    dropped.store(0);
+    stopRequested.store(false);
+
+    writerThread = QThread::create([this]
+                                   { this->writerLoop(); });
+    writerThread->start();
+    return true;
+}
+
+void RecordingWriter::close()
+{
+    if (!writerThread)
+    {
+        return;
+    }
+
+    stopRequested.store(true);
+    writerThread->wait(); // The thread drains the ring and flushes before it exits
+    delete writerThread;
+    writerThread = nullptr;
+
+    finishFile();
+    file.close();
+}
+
+void RecordingWriter::setWriteError(const QString &error)
+{
+    if (!writeFailed.load(std::memory_order_relaxed))
+    {
+        lastError = error;
+        writeFailed.store(true, std::memory_order_release); // Publishes lastError to hasFailed() callers
+    }
+}
+
+bool RecordingWriter::write(const float *samples, int count)
+{
+    if (!ring.push(samples, count))
+    {
+        dropped.fetch_add(count, std::memory_order_relaxed);
+        return false;
+    }
+    pushedSamples.fetch_add(count, std::memory_order_relaxed);
+    return true;
+}
+
+void RecordingWriter::writerLoop()
+{
+    while (true)
+    {
+        // Read the flag before draining, so nothing pushed before close() is left behind
+        const bool stopping = stopRequested.load();
+
+        if (drain() == 0)
+        {
+            if (stopping)
+            {
+                break;
+            }
+            QThread::msleep(IdleWaitMs);
+        }
+    }
+
+    flush();
+}
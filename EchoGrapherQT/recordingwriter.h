@@ -0,0 +1,88 @@
+#ifndef RECORDINGWRITER_H
+#define RECORDINGWRITER_H
+
+#include "spscringbuffer.h"
+
+#include <atomic>
+#include <memory>
+#include <QFile>
+#include <QString>
+#include <QThread>
+
+// Records interleaved float audio to a file from a background thread.
+// write() only pushes into a lock-free ring, so it is safe on a capture thread or inside an
+// audio callback. The writer thread drains the ring into the file format, so a slow disk or a
+// slow encoder shows up as backlog instead of as input overflows. WavWriter and FlacWriter
+// supply the format; this class owns the ring, the thread and the counters.
+class RecordingWriter
+{
+public:
+    enum Format
+    {
+        Wav, // 32-bit float, no encoding cost
+        Flac // Lossless, quantised to bitDepth; needs libFLAC at build time
+    };
+
+    // A writer for `format`; bitDepth only applies to formats that quantise
+    static std::unique_ptr<RecordingWriter> Create(Format format, int bitDepth = 24);
+    static bool IsAvailable(Format format);
+    static bool FormatFromName(const QString &name, Format *format); // "wav" or "flac"
+
+    virtual ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter &) = delete;
+    RecordingWriter &operator=(const RecordingWriter &) = delete;
+
+    // bufferSeconds sizes the ring that absorbs disk and encoder stalls
+    bool open(const QString &path, uint32_t sampleRate, int channels, double bufferSeconds = 10.0);
+    void close(); // Drains the ring and finishes the file
+    bool isOpen() const { return writerThread != nullptr; }
+    QString fileName() const { return filePath; } // As given to open(), see WavWriter::SegmentPath() for rotated files
+    QString errorString() const { return lastError; }
+
+    // Whether writing failed on the writer thread after open(); the file then stops growing while
+    // write() keeps accepting samples. errorString() says why, and is stable once this is true.
+    bool hasFailed() const { return writeFailed.load(std::memory_order_acquire); }
+    virtual QString fileExtension() const = 0; // Including the dot
+
+    // Producer side, wait-free. Returns false (and counts the samples as dropped) if the ring is full
+    bool write(const float *samples, int count);
+
+    qint64 backlogSamples() const { return pushedSamples.load() - writtenSamples.load(); } // Queued, not yet in the file
+    qint64 samplesWritten() const { return writtenSamples.load(); }
+    quint64 droppedSamples() const { return dropped.load(); }
+
+protected:
+    RecordingWriter() = default;
+
+    // Format hooks. openFile() runs in open() and opens `file` itself, so each format picks its
+    // own mode; the ring is already sized by then. drain() and flush() run on the writer thread;
+    // finishFile() runs in close() once the writer thread is gone, and `file` is closed after it.
+    // Subclasses call close() in their destructors, the hooks are gone by the time this destructor runs.
+    virtual bool openFile(const QString &path, uint32_t sampleRate, int channels) = 0;
+    virtual int minimumRingSamples() const { return 0; }
+    virtual double frameRate(uint32_t sampleRate) const { return sampleRate; } // Frames of `channels` values per second
+    virtual int drain() = 0;    // Takes what the ring holds, as far as the format has room; returns the samples taken
+    virtual void flush() {}     // Called once the ring is empty for good
+    virtual void finishFile() {}
+
+    // For failures once the file is open: records the first one and trips hasFailed()
+    void setWriteError(const QString &error);
+
+    QFile file;
+    QString lastError;
+    SpscRingBuffer<float> ring;
+    std::atomic<qint64> writtenSamples{0}; // Advanced by the format as samples reach the file or the encoder
+
+private:
+    void writerLoop();
+
+    QString filePath;
+    QThread *writerThread = nullptr;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<qint64> pushedSamples{0};
+    std::atomic<quint64> dropped{0};
+    std::atomic<bool> writeFailed{false};
+};
+
+#endif // RECORDINGWRITER_H
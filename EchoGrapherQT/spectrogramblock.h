@@ -0,0 +1,58 @@
+#ifndef SPECTROGRAMBLOCK_H
+#define SPECTROGRAMBLOCK_H
+
+#include <QMetaType>
+#include <QVector>
+
+// A batch of consecutive spectrogram frames of one input channel, delivered as one contiguous
+// frames x bands matrix
+struct SpectrogramBlock
+{
+    int channel = 0; // Input channel the frames were computed from
+    int bands = 0;
+    int sampleRate = 0;
+    int hopSize = 0;
+    QVector<float> values;           // Row-major, frameCount() rows of `bands` values
+    QVector<qint64> frameTimestamps; // Stream position, in samples, of the first sample of each frame
+    qint64 firstFrameReadyNs = -1;   // PipelineStats::now() when the first frame was computed, -1 if not timed
+
+    int frameCount() const { return frameTimestamps.size(); }
+    bool isEmpty() const { return frameTimestamps.isEmpty(); }
+    const float *frame(int index) const { return values.constData() + qint64(index) * bands; }
+    double frameTime(int index) const { return sampleRate > 0 ? double(frameTimestamps[index]) / sampleRate : 0.0; }
+
+    // Adds a row for a frame starting at `timestamp` and returns it for the caller to fill in
+    float *appendFrame(qint64 timestamp)
+    {
+        frameTimestamps.append(timestamp);
+        values.resize(values.size() + bands);
+        return values.data() + values.size() - bands;
+    }
+
+    void reserve(int frames)
+    {
+        frameTimestamps.reserve(frames);
+        values.reserve(qint64(frames) * bands);
+    }
+
+    // Drops the rows but keeps the layout, releasing any storage shared with a delivered copy
+    void clear()
+    {
+        values.clear();
+        frameTimestamps.clear();
+        firstFrameReadyNs = -1;
+    }
+};
+
+Q_DECLARE_METATYPE(SpectrogramBlock)
+
+// Receives spectrogram blocks directly on the processing thread, without going through the event loop.
+// Implementations must return quickly and copy whatever they want to keep.
+class SpectrogramSink
+{
+public:
+    virtual ~SpectrogramSink() = default;
+    virtual void consumeSpectrogramBlock(const SpectrogramBlock &block) = 0;
+};
+
+#endif // SPECTROGRAMBLOCK_H
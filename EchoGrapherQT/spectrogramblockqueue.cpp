@@ -0,0 +1,135 @@
+#include "spectrogramblockqueue.h"
+
+#include <QtGlobal>
+
+void SpectrogramBlockQueue::configure(int capacity, OverflowPolicy policy, int maxCoalescedFrames)
+{
+    QMutexLocker locker(&mutex);
+    maxBlocks = qMax(1, capacity);
+    overflowPolicy = policy;
+    maxCoalesced = qMax(0, maxCoalescedFrames);
+    pending.clear();
+    pool.clear();
+    dropped = 0;
+    droppedFrameCount = 0;
+    coalesced = 0;
+}
+
+bool SpectrogramBlockQueue::push(SpectrogramBlock &block)
+{
+    if (block.isEmpty())
+    {
+        return false;
+    }
+
+    QMutexLocker locker(&mutex);
+    const bool wasEmpty = pending.empty();
+
+    if (static_cast<int>(pending.size()) >= maxBlocks)
+    {
+        // Full: either fold the rows into the newest waiting block of the channel, or make room at the old end
+        if (overflowPolicy == Coalesce)
+        {
+            for (auto newest = pending.rbegin(); newest != pending.rend(); ++newest)
+            {
+                if (newest->channel != block.channel)
+                {
+                    continue;
+                }
+                if (newest->bands == block.bands && newest->frameCount() + block.frameCount() <= maxCoalesced)
+                {
+                    AppendRows(*newest, block);
+                    ++coalesced;
+                    block.clear(); // The producer keeps its storage
+                    return false;
+                }
+                break;
+            }
+        }
+
+        SpectrogramBlock &oldest = pending.front();
+        ++dropped;
+        droppedFrameCount += oldest.frameCount();
+        recycle(oldest);
+        pending.pop_front();
+    }
+
+    // Swap the filled block for an empty pooled one with the same layout
+    SpectrogramBlock spare;
+    if (!pool.empty())
+    {
+        spare = std::move(pool.back());
+        pool.pop_back();
+    }
+    spare.channel = block.channel;
+    spare.bands = block.bands;
+    spare.sampleRate = block.sampleRate;
+    spare.hopSize = block.hopSize;
+
+    pending.push_back(std::move(block));
+    block = std::move(spare);
+    return wasEmpty;
+}
+
+bool SpectrogramBlockQueue::pop(SpectrogramBlock &block)
+{
+    QMutexLocker locker(&mutex);
+    if (pending.empty())
+    {
+        return false;
+    }
+    recycle(block);
+    block = std::move(pending.front());
+    pending.pop_front();
+    return true;
+}
+
+int SpectrogramBlockQueue::size() const
+{
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(pending.size());
+}
+
+void SpectrogramBlockQueue::clear()
+{
+    QMutexLocker locker(&mutex);
+    while (!pending.empty())
+    {
+        recycle(pending.front());
+        pending.pop_front();
+    }
+}
+
+quint64 SpectrogramBlockQueue::droppedBlocks() const
+{
+    QMutexLocker locker(&mutex);
+    return dropped;
+}
+
+quint64 SpectrogramBlockQueue::droppedFrames() const
+{
+    QMutexLocker locker(&mutex);
+    return droppedFrameCount;
+}
+
+quint64 SpectrogramBlockQueue::coalescedBlocks() const
+{
+    QMutexLocker locker(&mutex);
+    return coalesced;
+}
+
+// Called with the mutex held. Keeps a few blocks' worth of storage, anything beyond is freed.
+void SpectrogramBlockQueue::recycle(SpectrogramBlock &block)
+{
+    block.clear();
+    if (block.values.capacity() > 0 && static_cast<int>(pool.size()) < maxBlocks + 2)
+    {
+        pool.push_back(std::move(block));
+    }
+}
+
+void SpectrogramBlockQueue::AppendRows(SpectrogramBlock &target, const SpectrogramBlock &source)
+{
+    target.values.append(source.values);
+    target.frameTimestamps.append(source.frameTimestamps);
+}
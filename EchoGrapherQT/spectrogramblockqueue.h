@@ -0,0 +1,65 @@
+#ifndef SPECTROGRAMBLOCKQUEUE_H
+#define SPECTROGRAMBLOCKQUEUE_H
+
+#include "spectrogramblock.h"
+
+#include <QMutex>
+#include <deque>
+#include <vector>
+
+// Bounded hand-off of spectrogram blocks from the processing thread to the GUI.
+// At most capacity() blocks wait at a time; when the GUI falls behind, the overflow policy
+// decides what gives, so memory and latency stay bounded however long the GUI stalls.
+// Blocks are moved in and out, never copied, and their storage is pooled and handed back
+// to the producer, so a steady run allocates nothing once the pool is warm.
+class SpectrogramBlockQueue
+{
+public:
+    enum OverflowPolicy
+    {
+        DropOldest, // Discard the oldest waiting block; the display skips ahead to the present
+        Coalesce    // Append to the newest waiting block of the same channel up to maxCoalescedFrames, then drop the oldest
+    };
+
+    SpectrogramBlockQueue() = default;
+
+    SpectrogramBlockQueue(const SpectrogramBlockQueue &) = delete;
+    SpectrogramBlockQueue &operator=(const SpectrogramBlockQueue &) = delete;
+
+    // Empties the queue and the counters; call before the producer's first push
+    void configure(int capacity, OverflowPolicy policy, int maxCoalescedFrames);
+
+    int capacity() const { return maxBlocks; }
+    OverflowPolicy policy() const { return overflowPolicy; }
+
+    // Producer side: moves the rows of `block` into the queue and leaves it empty, with the same
+    // layout, on pooled storage. Returns true if the queue was empty, i.e. the consumer needs waking.
+    bool push(SpectrogramBlock &block);
+
+    // Consumer side: moves the oldest waiting block into `block`, recycling what `block` held.
+    // Returns false if nothing is waiting.
+    bool pop(SpectrogramBlock &block);
+
+    int size() const;
+    void clear(); // Drops everything waiting, without counting it
+
+    quint64 droppedBlocks() const;
+    quint64 droppedFrames() const;   // Frames lost to dropped blocks, under either policy
+    quint64 coalescedBlocks() const; // Blocks appended to a waiting one instead of queued
+
+private:
+    mutable QMutex mutex;
+    std::deque<SpectrogramBlock> pending;
+    std::vector<SpectrogramBlock> pool; // Cleared blocks whose storage is reused
+    int maxBlocks = 8;
+    int maxCoalesced = 0;
+    OverflowPolicy overflowPolicy = DropOldest;
+    quint64 dropped = 0;
+    quint64 droppedFrameCount = 0;
+    quint64 coalesced = 0;
+
+    void recycle(SpectrogramBlock &block);
+    static void AppendRows(SpectrogramBlock &target, const SpectrogramBlock &source);
+};
+
+#endif // SPECTROGRAMBLOCKQUEUE_H
@@ -0,0 +1,306 @@
+#include "spectrogrambrowser.h"
+#include "spectrogramstore.h"
+#include "spectrogramtiles.h"
+
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QGraphicsView>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QWheelEvent>
+#include <cmath>
+
+namespace
+{
+const int RefreshIntervalMs = 100;
+const qint64 LoadChunkFrames = 1 << 16; // Frames of a stored session pooled per event loop pass
+
+QString FormatTime(double seconds)
+{
+    const qint64 tenths = qMax<qint64>(0, qRound64(seconds * 10.0));
+    return QString("%1:%2:%3.%4")
+        .arg(tenths / 36000)
+        .arg(tenths / 600 % 60, 2, 10, QChar('0'))
+        .arg(tenths / 10 % 60, 2, 10, QChar('0'))
+        .arg(tenths % 10);
+}
+}
+
+SpectrogramBrowser::SpectrogramBrowser(QWidget *parent)
+    : QWidget(parent, Qt::Tool)
+{
+    setWindowTitle(tr("Spectrogram History"));
+    setStyleSheet("QWidget { background-color: #232633; color: #FFF; }");
+
+    pyramids.emplace_back(new SpectrogramPyramid());
+    item = new SpectrogramTileItem(pyramids[0].get());
+
+    view = new QGraphicsView(new QGraphicsScene(this), this);
+    view->scene()->setBackgroundBrush(QBrush(Qt::black));
+    view->scene()->addItem(item);
+    view->setDragMode(QGraphicsView::ScrollHandDrag); // Dragging scrubs through the session
+    view->setTransformationAnchor(QGraphicsView::NoAnchor);
+    view->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    view->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view->viewport()->installEventFilter(this);
+    connect(view->horizontalScrollBar(), &QScrollBar::sliderPressed, this, [this]()
+            { followBox->setChecked(false); });
+
+    QPushButton *zoomInButton = new QPushButton(tr("Zoom In"), this);
+    QPushButton *zoomOutButton = new QPushButton(tr("Zoom Out"), this);
+    QPushButton *fitButton = new QPushButton(tr("Fit"), this);
+    QPushButton *openButton = new QPushButton(tr("Open..."), this);
+    openButton->setToolTip(tr("Browse a stored .egspec session"));
+    followBox = new QCheckBox(tr("Follow"), this);
+    followBox->setToolTip(tr("Keep the newest frame in view"));
+    followBox->setChecked(true);
+    positionLabel = new QLabel(this);
+    connect(zoomInButton, &QPushButton::clicked, this, &SpectrogramBrowser::zoomIn);
+    connect(zoomOutButton, &QPushButton::clicked, this, &SpectrogramBrowser::zoomOut);
+    connect(fitButton, &QPushButton::clicked, this, &SpectrogramBrowser::zoomToFit);
+    connect(openButton, &QPushButton::clicked, this, &SpectrogramBrowser::openWithDialog);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    buttons->addWidget(zoomInButton);
+    buttons->addWidget(zoomOutButton);
+    buttons->addWidget(fitButton);
+    buttons->addWidget(followBox);
+    buttons->addStretch();
+    buttons->addWidget(positionLabel);
+    buttons->addStretch();
+    buttons->addWidget(openButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(view);
+    layout->addLayout(buttons);
+    resize(960, 420);
+
+    refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &SpectrogramBrowser::refresh);
+    loadTimer = new QTimer(this);
+    loadTimer->setInterval(0);
+    connect(loadTimer, &QTimer::timeout, this, &SpectrogramBrowser::loadStoreChunk);
+}
+
+SpectrogramBrowser::~SpectrogramBrowser() = default;
+
+void SpectrogramBrowser::reset(int channels)
+{
+    loadTimer->stop();
+    store.reset();
+    storeLoaded = 0;
+    setWindowTitle(tr("Spectrogram History"));
+
+    pyramids.clear();
+    for (int c = 0; c < qMax(1, channels); ++c)
+    {
+        pyramids.emplace_back(new SpectrogramPyramid());
+    }
+    shownChannel = qMin(shownChannel, int(pyramids.size()) - 1);
+    item->tiles().setRange(0.0f, 1.0f); // The live display range
+    item->setPyramid(pyramids[shownChannel].get());
+    followBox->setChecked(true);
+}
+
+void SpectrogramBrowser::appendBlock(const SpectrogramBlock &block)
+{
+    if (store || block.channel < 0 || block.channel >= int(pyramids.size()))
+    {
+        return; // Browsing a stored session, or from a run with more channels than were set up
+    }
+    SpectrogramPyramid &pyramid = *pyramids[block.channel];
+    if (block.bands != pyramid.bands() && block.channel == shownChannel)
+    {
+        item->tiles().clear(); // The pyramid starts over
+    }
+    pyramid.appendBlock(block);
+}
+
+bool SpectrogramBrowser::openStore(const QString &path)
+{
+    std::unique_ptr<SpectrogramStore> opened(new SpectrogramStore());
+    if (!opened->open(path))
+    {
+        QMessageBox::warning(this, tr("Open Spectrogram"), tr("Could not open %1: %2").arg(path, opened->errorString()));
+        return false;
+    }
+
+    reset(1);
+    store = std::move(opened);
+    setWindowTitle(tr("Spectrogram History - %1").arg(QFileInfo(path).fileName()));
+
+    // Built from the store's own frames, so the finest levels come straight out of its mapping
+    SpectrogramPyramid &pyramid = *pyramids[0];
+    pyramid.reset(store->bands());
+    pyramid.setFrameSeconds(double(store->hopSize()) / qMax(1, store->sampleRate()));
+    pyramid.setArchive(store.get());
+    const SpectrogramStoreHeader &header = store->header();
+    if (header.flags & SpectrogramStoreWriter::NormalizedFlag)
+    {
+        item->tiles().setRange(0.0f, 1.0f);
+    }
+    else
+    {
+        item->tiles().setRange(header.floorDb, 0.0f); // dB relative to the reference power
+    }
+    followBox->setChecked(false);
+    loadTimer->start();
+    return true;
+}
+
+bool SpectrogramBrowser::isLoading() const
+{
+    return loadTimer->isActive();
+}
+
+void SpectrogramBrowser::loadStoreChunk()
+{
+    const qint64 count = store ? qMin(LoadChunkFrames, store->frameCount() - storeLoaded) : 0;
+    if (count <= 0)
+    {
+        loadTimer->stop();
+        refresh();
+        zoomToFit();
+        return;
+    }
+
+    // Float32 frames are pooled in place, half floats are widened a chunk at a time
+    const float *values = store->frame(storeLoaded);
+    if (!values)
+    {
+        loadBuffer.resize(count * store->bands());
+        store->readFrames(storeLoaded, count, loadBuffer.data());
+        values = loadBuffer.constData();
+    }
+    pyramids[0]->appendFrames(values, count);
+    storeLoaded += count;
+}
+
+void SpectrogramBrowser::openWithDialog()
+{
+    const QString path = QFileDialog::getOpenFileName(this, tr("Open Spectrogram"), QString(), tr("Spectrogram stores (*.egspec)"));
+    if (!path.isEmpty())
+    {
+        openStore(path);
+    }
+}
+
+void SpectrogramBrowser::showChannel(int channel)
+{
+    channel = qBound(0, channel, int(pyramids.size()) - 1);
+    if (channel != shownChannel)
+    {
+        shownChannel = channel;
+        item->setPyramid(pyramids[shownChannel].get());
+        refresh();
+    }
+}
+
+void SpectrogramBrowser::setPalette(Colormap::Palette palette)
+{
+    item->tiles().setPalette(palette);
+    item->update();
+}
+
+void SpectrogramBrowser::refresh()
+{
+    item->sync();
+    view->setSceneRect(item->boundingRect()); // The scene would otherwise never shrink after a reset
+    if (followBox->isChecked())
+    {
+        view->horizontalScrollBar()->setValue(view->horizontalScrollBar()->maximum());
+    }
+
+    const SpectrogramPyramid &shown = pyramid();
+    const double centerFrame = view->mapToScene(view->viewport()->rect().center()).x();
+    positionLabel->setText(tr("%1 of %2 | level %3 | %4 MB")
+                               .arg(FormatTime(qMax(0.0, centerFrame) * shown.frameSeconds()))
+                               .arg(FormatTime(shown.frameCount() * shown.frameSeconds()))
+                               .arg(item->paintedLevel())
+                               .arg(shown.memoryBytes() / double(1 << 20), 0, 'f', 1));
+}
+
+void SpectrogramBrowser::applyTransform()
+{
+    // Horizontal zoom only; the bands always fill the height of the view
+    const double scaleY = double(qMax(1, view->viewport()->height())) / SpectrogramTileItem::Height;
+    view->setTransform(QTransform::fromScale(scaleX, scaleY));
+}
+
+void SpectrogramBrowser::zoomAround(double factor, double viewportX)
+{
+    // Zoomed out no further than the whole session across the view
+    const qint64 frames = qMax<qint64>(1, pyramid().frameCount());
+    const double minScale = qMin(MaxPixelsPerFrame, double(qMax(1, view->viewport()->width())) / frames);
+    const double sceneX = view->mapToScene(QPoint(qRound(viewportX), 0)).x();
+    scaleX = qBound(minScale, scaleX * factor, MaxPixelsPerFrame);
+    applyTransform();
+
+    QScrollBar *scrollBar = view->horizontalScrollBar();
+    scrollBar->setValue(scrollBar->value() + view->mapFromScene(QPointF(sceneX, 0)).x() - qRound(viewportX));
+    refresh();
+}
+
+void SpectrogramBrowser::setPixelsPerFrame(double pixelsPerFrame)
+{
+    zoomAround(pixelsPerFrame / scaleX, view->viewport()->width() / 2.0);
+}
+
+void SpectrogramBrowser::zoomIn()
+{
+    zoomAround(2.0, view->viewport()->width() / 2.0);
+}
+
+void SpectrogramBrowser::zoomOut()
+{
+    zoomAround(0.5, view->viewport()->width() / 2.0);
+}
+
+void SpectrogramBrowser::zoomToFit()
+{
+    zoomAround(0.0, 0.0); // Clamped to the whole session
+}
+
+bool SpectrogramBrowser::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == view->viewport())
+    {
+        if (event->type() == QEvent::Wheel)
+        {
+            QWheelEvent *wheel = static_cast<QWheelEvent *>(event);
+            zoomAround(std::pow(1.25, wheel->angleDelta().y() / 120.0), wheel->position().x());
+            return true;
+        }
+        if (event->type() == QEvent::MouseButtonPress)
+        {
+            followBox->setChecked(false); // Scrubbing by hand
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void SpectrogramBrowser::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    applyTransform();
+    refresh();
+    refreshTimer->start(RefreshIntervalMs);
+}
+
+void SpectrogramBrowser::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    refreshTimer->stop();
+}
+
+void SpectrogramBrowser::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    applyTransform();
+}
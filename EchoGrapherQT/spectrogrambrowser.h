@@ -0,0 +1,85 @@
+#ifndef SPECTROGRAMBROWSER_H
+#define SPECTROGRAMBROWSER_H
+
+#include "colormap.h"
+#include "spectrogramblock.h"
+#include "spectrogrampyramid.h"
+
+#include <QWidget>
+#include <memory>
+#include <vector>
+
+class QCheckBox;
+class QGraphicsView;
+class QLabel;
+class QTimer;
+class SpectrogramStore;
+class SpectrogramTileItem;
+
+// Tool window for scrolling and zooming through everything a session has recorded so far, or
+// through a stored .egspec session. Every channel of the run feeds a SpectrogramPyramid as its
+// blocks arrive; the view shows the selected one through a SpectrogramTileItem. The wheel zooms
+// around the pointer, dragging scrubs, and "Follow" keeps the newest frame in view.
+class SpectrogramBrowser : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr double MaxPixelsPerFrame = 16.0;
+
+    explicit SpectrogramBrowser(QWidget *parent = nullptr);
+    ~SpectrogramBrowser() override;
+
+    // A new live run with one pyramid per channel; closes any stored session
+    void reset(int channels);
+    void appendBlock(const SpectrogramBlock &block);
+
+    // Opens a .egspec store and builds its pyramid a chunk per event loop pass, so the window
+    // stays usable while a long session loads. Raw frames are read back from the store.
+    bool openStore(const QString &path);
+    bool isLoading() const;
+
+    void showChannel(int channel);
+    void setPalette(Colormap::Palette palette);
+
+    const SpectrogramPyramid &pyramid() const { return *pyramids[shownChannel]; }
+    SpectrogramTileItem *tileItem() const { return item; }
+    double pixelsPerFrame() const { return scaleX; }
+    void setPixelsPerFrame(double pixelsPerFrame); // Keeps the frame in the middle of the view where it is
+
+public slots:
+    void refresh();
+    void zoomIn();
+    void zoomOut();
+    void zoomToFit();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void loadStoreChunk();
+    void openWithDialog();
+
+private:
+    void applyTransform();
+    void zoomAround(double factor, double viewportX);
+
+    std::vector<std::unique_ptr<SpectrogramPyramid>> pyramids;
+    int shownChannel = 0;
+    std::unique_ptr<SpectrogramStore> store; // The stored session being browsed, if any
+    qint64 storeLoaded = 0;                  // Its frames in the pyramid so far
+    QVector<float> loadBuffer;
+
+    QGraphicsView *view;
+    SpectrogramTileItem *item;
+    QCheckBox *followBox;
+    QLabel *positionLabel;
+    QTimer *refreshTimer;
+    QTimer *loadTimer;
+    double scaleX = 1.0; // Device pixels per frame
+};
+
+#endif // SPECTROGRAMBROWSER_H
@@ -0,0 +1,275 @@
+#include "spectrogrampyramid.h"
+#include "spectrogramstore.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr qint64 StoredColumnFrames = qint64(1) << SpectrogramPyramid::StoredFromLevel;
+}
+
+SpectrogramPyramid::SpectrogramPyramid(Pooling pooling, int recentFrames)
+    : mode(pooling),
+      // Whole multiples of a stored column, so the frames of one are contiguous in the ring
+      recentCapacity(static_cast<int>((qMax<qint64>(recentFrames, 1) + StoredColumnFrames - 1) / StoredColumnFrames * StoredColumnFrames))
+{
+}
+
+void SpectrogramPyramid::reset(int bands)
+{
+    bandCount = qMax(0, bands);
+    frames = 0;
+    recent.fill(0.0f, qint64(recentCapacity) * bandCount);
+    levels.clear();
+    pending.resize(2 * bandCount);
+    archive = nullptr;
+}
+
+void SpectrogramPyramid::setArchive(const SpectrogramStore *store)
+{
+    archive = store && store->bands() == bandCount ? store : nullptr;
+}
+
+void SpectrogramPyramid::pool(float *out, const float *in, int inputs) const
+{
+    if (out != in)
+    {
+        std::copy(in, in + bandCount, out);
+    }
+    for (int row = 1; row < inputs; ++row)
+    {
+        const float *values = in + qint64(row) * bandCount;
+        for (int b = 0; b < bandCount; ++b)
+        {
+            out[b] = mode == Max ? qMax(out[b], values[b]) : out[b] + values[b];
+        }
+    }
+    if (mode == Mean && inputs > 1)
+    {
+        const float scale = 1.0f / inputs;
+        for (int b = 0; b < bandCount; ++b)
+        {
+            out[b] *= scale;
+        }
+    }
+}
+
+void SpectrogramPyramid::combine(float *out, qint64 outFrames, const float *in, qint64 inFrames) const
+{
+    // Means are weighted by the frames behind them, a partial column counts for what it covers
+    const float total = float(outFrames + inFrames);
+    for (int b = 0; b < bandCount; ++b)
+    {
+        out[b] = mode == Max ? qMax(out[b], in[b]) : (out[b] * outFrames + in[b] * inFrames) / total;
+    }
+}
+
+void SpectrogramPyramid::appendFrame(const float *values)
+{
+    if (bandCount == 0)
+    {
+        return;
+    }
+    std::copy(values, values + bandCount, recent.data() + (frames % recentCapacity) * bandCount);
+    ++frames;
+    if (frames % StoredColumnFrames != 0)
+    {
+        return;
+    }
+
+    // The frames of a new stored column are still in the ring; each level that now has an even
+    // number of columns passes their pair on to the level above
+    pool(pending.data(), recent.constData() + ((frames - StoredColumnFrames) % recentCapacity) * bandCount, StoredColumnFrames);
+    for (int i = 0;; ++i)
+    {
+        if (i == levels.size())
+        {
+            levels.append(QVector<qfloat16>());
+        }
+        QVector<qfloat16> &level = levels[i];
+        const qint64 end = level.size();
+        level.resize(end + bandCount);
+        qFloatToFloat16(level.data() + end, pending.constData(), bandCount);
+        if ((level.size() / bandCount) % 2 != 0)
+        {
+            break;
+        }
+        qFloatFromFloat16(pending.data(), level.constData() + level.size() - 2 * bandCount, 2 * bandCount);
+        pool(pending.data(), pending.constData(), 2);
+    }
+}
+
+void SpectrogramPyramid::appendFrames(const float *values, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i)
+    {
+        appendFrame(values + i * bandCount);
+    }
+}
+
+void SpectrogramPyramid::appendBlock(const SpectrogramBlock &block)
+{
+    if (block.bands != bandCount)
+    {
+        reset(block.bands);
+    }
+    if (block.sampleRate > 0 && block.hopSize > 0)
+    {
+        secondsPerFrame = double(block.hopSize) / block.sampleRate;
+    }
+    appendFrames(block.values.constData(), block.frameCount());
+}
+
+qint64 SpectrogramPyramid::memoryBytes() const
+{
+    qint64 bytes = recent.size() * qint64(sizeof(float));
+    for (const QVector<qfloat16> &level : levels)
+    {
+        bytes += level.size() * qint64(sizeof(qfloat16));
+    }
+    return bytes;
+}
+
+int SpectrogramPyramid::levelCount() const
+{
+    int level = 0;
+    while (((frames - 1) >> level) > 0)
+    {
+        ++level;
+    }
+    return level + 1;
+}
+
+qint64 SpectrogramPyramid::columnCount(int level) const
+{
+    return frames == 0 ? 0 : ((frames - 1) >> level) + 1;
+}
+
+qint64 SpectrogramPyramid::storedColumns(int level) const
+{
+    const int i = level - StoredFromLevel;
+    return i >= 0 && i < levels.size() && bandCount > 0 ? levels[i].size() / bandCount : 0;
+}
+
+bool SpectrogramPyramid::hasFrames(qint64 firstFrame, qint64 count) const
+{
+    if (firstFrame < 0 || count < 0 || firstFrame + count > frames)
+    {
+        return false;
+    }
+    const qint64 recentStart = frames - qMin<qint64>(frames, recentCapacity);
+    return firstFrame >= recentStart || (archive && archive->frameCount() >= qMin(firstFrame + count, recentStart));
+}
+
+qint64 SpectrogramPyramid::readFrames(qint64 firstFrame, qint64 count, float *out) const
+{
+    if (count <= 0 || !hasFrames(firstFrame, count))
+    {
+        return 0;
+    }
+    const qint64 recentStart = frames - qMin<qint64>(frames, recentCapacity);
+    const qint64 archived = qBound<qint64>(0, recentStart - firstFrame, count);
+    if (archived > 0)
+    {
+        archive->readFrames(firstFrame, archived, out);
+    }
+    for (qint64 frame = firstFrame + archived; frame < firstFrame + count;)
+    {
+        const qint64 slot = frame % recentCapacity;
+        const qint64 run = qMin(recentCapacity - slot, firstFrame + count - frame);
+        std::copy(recent.constData() + slot * bandCount, recent.constData() + (slot + run) * bandCount,
+                  out + (frame - firstFrame) * bandCount);
+        frame += run;
+    }
+    return count;
+}
+
+int SpectrogramPyramid::finestLevel(qint64 firstFrame, qint64 count) const
+{
+    firstFrame = qBound<qint64>(0, firstFrame, frames);
+    return hasFrames(firstFrame, qBound<qint64>(0, count, frames - firstFrame)) ? 0 : StoredFromLevel;
+}
+
+qint64 SpectrogramPyramid::poolColumn(int level, qint64 column, float *out) const
+{
+    const qint64 firstFrame = column << level;
+    const qint64 covered = qMin(frames - firstFrame, qint64(1) << level);
+    if (covered <= 0)
+    {
+        return 0;
+    }
+    if (column < storedColumns(level))
+    {
+        qFloatFromFloat16(out, levels[level - StoredFromLevel].constData() + column * bandCount, bandCount);
+        return covered;
+    }
+    if (level == StoredFromLevel)
+    {
+        // The newest, partial stored column: fewer than 16 frames, always still in the ring
+        QVector<float> raw(covered * bandCount);
+        readFrames(firstFrame, covered, raw.data());
+        pool(out, raw.constData(), static_cast<int>(covered));
+        for (int b = 0; b < bandCount; ++b)
+        {
+            out[b] = qfloat16(out[b]); // Rounded like the column will be once it is stored
+        }
+        return covered;
+    }
+
+    // A partial column above: its left half is whole or partial itself, the right one partial or empty
+    const qint64 left = poolColumn(level - 1, 2 * column, out);
+    QVector<float> right(bandCount);
+    const qint64 rightFrames = poolColumn(level - 1, 2 * column + 1, right.data());
+    if (rightFrames > 0)
+    {
+        combine(out, left, right.constData(), rightFrames);
+    }
+    return left + rightFrames;
+}
+
+qint64 SpectrogramPyramid::readColumns(int level, qint64 firstColumn, qint64 count, float *out) const
+{
+    count = firstColumn < 0 || level < 0 ? 0 : qBound<qint64>(0, columnCount(level) - firstColumn, count);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    if (level < StoredFromLevel)
+    {
+        const qint64 firstFrame = firstColumn << level;
+        const qint64 rawFrames = qMin(frames - firstFrame, count << level);
+        QVector<float> raw(rawFrames * bandCount);
+        if (readFrames(firstFrame, rawFrames, raw.data()) == 0)
+        {
+            return 0;
+        }
+        for (qint64 c = 0; c < count; ++c)
+        {
+            const qint64 first = c << level;
+            pool(out + c * bandCount, raw.constData() + first * bandCount, static_cast<int>(qMin(rawFrames - first, qint64(1) << level)));
+        }
+        return count;
+    }
+
+    const qint64 stored = qBound<qint64>(0, storedColumns(level) - firstColumn, count);
+    if (stored > 0)
+    {
+        qFloatFromFloat16(out, levels[level - StoredFromLevel].constData() + firstColumn * bandCount, stored * bandCount);
+    }
+    for (qint64 c = stored; c < count; ++c)
+    {
+        poolColumn(level, firstColumn + c, out + c * bandCount); // Only the newest column is ever partial
+    }
+    return count;
+}
+
+int SpectrogramPyramid::LevelForScale(double pixelsPerFrame)
+{
+    if (pixelsPerFrame <= 0.0 || pixelsPerFrame >= 1.0)
+    {
+        return 0;
+    }
+    return static_cast<int>(std::floor(std::log2(1.0 / pixelsPerFrame) + 1e-9));
+}
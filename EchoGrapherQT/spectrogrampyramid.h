@@ -0,0 +1,91 @@
+#ifndef SPECTROGRAMPYRAMID_H
+#define SPECTROGRAMPYRAMID_H
+
+#include "spectrogramblock.h"
+
+#include <QFloat16>
+#include <QVector>
+
+class SpectrogramStore;
+
+// Mipmap of a whole session's spectrogram, for browsing hours of frames at any zoom.
+// Level L has one column per 2^L frames, pooled by maximum (keeps short events visible when
+// zoomed out) or mean. Columns are pooled the moment their last frame arrives, so appending is
+// constant time per frame and nothing is rebuilt while recording.
+// Only levels from StoredFromLevel up are kept, as half floats: ten hours at the default hop
+// and 25 bands take about 50 MB, recent frames included. The finer levels are pooled on demand
+// from raw frames, which come from the last recentFrames frames held in memory or, further
+// back, from an attached .egspec store; where neither has them, finestLevel() says how close a
+// view can get.
+class SpectrogramPyramid
+{
+public:
+    enum Pooling
+    {
+        Max,
+        Mean
+    };
+
+    static constexpr int StoredFromLevel = 4;          // 16 frames per stored column
+    static constexpr int DefaultRecentFrames = 1 << 17; // About 13 minutes at the default hop
+
+    explicit SpectrogramPyramid(Pooling pooling = Max, int recentFrames = DefaultRecentFrames);
+
+    // Drops every frame; the next ones have `bands` values each
+    void reset(int bands);
+    void setFrameSeconds(double seconds) { secondsPerFrame = seconds; } // Hop duration, for labelling a view
+
+    // Raw frames older than the recent history are read from `store`, which must hold the same
+    // frames from frame 0 on (the store of the same lane, or the one the pyramid was built from).
+    // nullptr detaches; a store with another band count is ignored.
+    void setArchive(const SpectrogramStore *store);
+
+    void appendFrame(const float *values);
+    void appendFrames(const float *values, qint64 count);
+    void appendBlock(const SpectrogramBlock &block); // Resets first if the band count changed
+
+    Pooling pooling() const { return mode; }
+    int bands() const { return bandCount; }
+    double frameSeconds() const { return secondsPerFrame; }
+    qint64 frameCount() const { return frames; }
+    qint64 memoryBytes() const;
+
+    // Levels down to a single column; columns of a level, the newest possibly covering fewer
+    // than 2^level frames
+    int levelCount() const;
+    qint64 columnCount(int level) const;
+
+    // Whether raw frames [firstFrame, firstFrame + count) can still be read
+    bool hasFrames(qint64 firstFrame, qint64 count) const;
+    qint64 readFrames(qint64 firstFrame, qint64 count, float *out) const; // Returns the frames read, 0 if not all are there
+
+    // The finest level the frames of a range can be shown at: 0 while their raw frames are
+    // available, StoredFromLevel once they are gone
+    int finestLevel(qint64 firstFrame, qint64 count) const;
+
+    // Pools `count` columns of `level` from `firstColumn` into `out`, bands values each. Returns
+    // the columns written; 0 when the level is finer than finestLevel() allows for them.
+    qint64 readColumns(int level, qint64 firstColumn, qint64 count, float *out) const;
+
+    // The level with about one column per pixel at `pixelsPerFrame`
+    static int LevelForScale(double pixelsPerFrame);
+
+private:
+    void pool(float *out, const float *in, int inputs) const; // `inputs` consecutive rows into one
+    void combine(float *out, qint64 outFrames, const float *in, qint64 inFrames) const;
+    qint64 storedColumns(int level) const;
+    qint64 poolColumn(int level, qint64 column, float *out) const; // Returns the frames it covers
+
+    const Pooling mode;
+    const int recentCapacity;
+    int bandCount = 0;
+    double secondsPerFrame = 0.0;
+    qint64 frames = 0;
+
+    QVector<float> recent;               // Ring of the last recentCapacity raw frames
+    QVector<QVector<qfloat16>> levels;   // Whole columns of level StoredFromLevel + i
+    QVector<float> pending;              // Scratch for a column being pooled
+    const SpectrogramStore *archive = nullptr;
+};
+
+#endif // SPECTROGRAMPYRAMID_H
@@ -0,0 +1,112 @@
+#include "spectrogramrenderer.h"
+
+#include <QPainter>
+
+SpectrogramRenderer::SpectrogramRenderer(int width, int height)
+{
+    resize(width, height);
+}
+
+void SpectrogramRenderer::resize(int width, int height)
+{
+    ring = QImage(qMax(width, 1), qMax(height, 1), QImage::Format_RGB32);
+    rowBands.clear();
+    clear();
+}
+
+void SpectrogramRenderer::clear()
+{
+    ring.fill(Qt::black);
+    column = 0;
+    written = 0;
+}
+
+void SpectrogramRenderer::mapRowsToBands(int bands)
+{
+    // Row 0 is the top of the image, so the highest band comes first
+    const int rows = ring.height();
+    rowBands.resize(rows);
+    for (int y = 0; y < rows; ++y)
+    {
+        rowBands[y] = static_cast<int>(qint64(rows - 1 - y) * bands / rows);
+    }
+    rowBandCount = bands;
+}
+
+void SpectrogramRenderer::appendColumn(const float *values, int bands)
+{
+    if (bands <= 0)
+    {
+        return;
+    }
+    if (rowBandCount != bands || rowBands.size() != ring.height())
+    {
+        mapRowsToBands(bands);
+    }
+
+    // Straight into scanline memory through the palette lookup table
+    colors.mapColumn(values, bands, rowBands.constData(), ring.height(),
+                     ring.bits() + column * sizeof(QRgb), ring.bytesPerLine());
+
+    column = (column + 1) % ring.width();
+    ++written;
+}
+
+void SpectrogramRenderer::appendBlock(const SpectrogramBlock &block)
+{
+    for (int i = 0; i < block.frameCount(); ++i)
+    {
+        appendColumn(block.frame(i), block.bands);
+    }
+}
+
+void SpectrogramRenderer::paint(QPainter *painter, const QRectF &target) const
+{
+    const qreal scaleX = target.width() / ring.width();
+    const int olderColumns = ring.width() - column;
+
+    // Oldest part: from the write position to the right edge of the ring
+    painter->drawImage(QRectF(target.left(), target.top(), olderColumns * scaleX, target.height()),
+                       ring, QRectF(column, 0, olderColumns, ring.height()));
+
+    // Newest part: from the left edge of the ring up to the write position
+    if (column > 0)
+    {
+        painter->drawImage(QRectF(target.left() + olderColumns * scaleX, target.top(), column * scaleX, target.height()),
+                           ring, QRectF(0, 0, column, ring.height()));
+    }
+}
+
+SpectrogramItem::SpectrogramItem(QGraphicsItem *parent) : QGraphicsItem(parent)
+{
+    setCacheMode(NoCache); // The ring is already the cache
+}
+
+QRectF SpectrogramItem::boundingRect() const
+{
+    return QRectF(0, 0, spectrogram.width(), spectrogram.height());
+}
+
+void SpectrogramItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+    spectrogram.paint(painter, boundingRect());
+
+    if (stats && pendingSinceNs >= 0)
+    {
+        stats->record(PipelineStats::Render, stats->now() - pendingSinceNs);
+        stats->add(PipelineStats::ColumnsRendered, pendingColumns);
+        pendingSinceNs = -1;
+        pendingColumns = 0;
+    }
+}
+
+void SpectrogramItem::markPending(qint64 receivedNs, int columns)
+{
+    if (pendingSinceNs < 0)
+    {
+        pendingSinceNs = receivedNs;
+    }
+    pendingColumns += columns;
+}
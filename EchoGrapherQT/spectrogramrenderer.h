@@ -0,0 +1,76 @@
+#ifndef SPECTROGRAMRENDERER_H
+#define SPECTROGRAMRENDERER_H
+
+#include "colormap.h"
+#include "pipelinestats.h"
+#include "spectrogramblock.h"
+
+#include <QGraphicsItem>
+#include <QImage>
+#include <QVector>
+
+// Keeps the spectrogram image as a circular buffer of columns.
+// Each frame is written once into its own column of scanline memory and the write position
+// advances; nothing is shifted or repainted. Drawing splits the image at the write position
+// so the oldest column appears on the left and the newest on the right.
+class SpectrogramRenderer
+{
+public:
+    SpectrogramRenderer(int width = 800, int height = 500);
+
+    // Reallocates the image and clears it to black
+    void resize(int width, int height);
+    void clear();
+
+    int width() const { return ring.width(); }
+    int height() const { return ring.height(); }
+    int writeColumn() const { return column; } // Next column to be written, also the oldest one
+    qint64 columnsWritten() const { return written; }
+    const QImage &image() const { return ring; }
+
+    // Writes one frame as the newest column; band 0 is drawn at the bottom
+    void appendColumn(const float *values, int bands);
+    void appendBlock(const SpectrogramBlock &block);
+
+    // Draws the ring unrolled into `target`, oldest column first
+    void paint(QPainter *painter, const QRectF &target) const;
+
+    // Palette and value range used for the columns written from now on
+    Colormap &colormap() { return colors; }
+    const Colormap &colormap() const { return colors; }
+
+private:
+    void mapRowsToBands(int bands);
+
+    QImage ring;
+    int column = 0;
+    qint64 written = 0;
+    int rowBandCount = 0;
+    QVector<int> rowBands; // Band shown on each row, rebuilt when the band count changes
+    Colormap colors;
+};
+
+// Persistent scene item that draws a SpectrogramRenderer, so updates only need update()
+class SpectrogramItem : public QGraphicsItem
+{
+public:
+    explicit SpectrogramItem(QGraphicsItem *parent = nullptr);
+
+    SpectrogramRenderer &renderer() { return spectrogram; }
+    const SpectrogramRenderer &renderer() const { return spectrogram; }
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+    // Render-stage timing: columns that arrived at `receivedNs` are counted as on screen at the next paint
+    void setStats(PipelineStats *pipelineStats) { stats = pipelineStats; }
+    void markPending(qint64 receivedNs, int columns);
+
+private:
+    SpectrogramRenderer spectrogram;
+    PipelineStats *stats = nullptr;
+    qint64 pendingSinceNs = -1; // Arrival of the oldest column not painted yet
+    int pendingColumns = 0;
+};
+
+#endif // SPECTROGRAMRENDERER_H
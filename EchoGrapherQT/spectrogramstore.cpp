@@ -0,0 +1,303 @@
+#include "spectrogramstore.h"
+
+#include <QDateTime>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr int DrainFrames = 256; // Frames written per drain() at most
+}
+
+SpectrogramStoreWriter::SpectrogramStoreWriter(int windowSize, int hopSize, ValueFormat format)
+    : window(qMax(1, windowSize)), hop(qMax(1, hopSize)), format(format)
+{
+}
+
+SpectrogramStoreWriter::~SpectrogramStoreWriter()
+{
+    close();
+}
+
+void SpectrogramStoreWriter::setScale(float floorDb, float referencePower, bool normalized)
+{
+    header.floorDb = floorDb;
+    header.referencePower = referencePower;
+    header.flags = normalized ? NormalizedFlag : 0;
+}
+
+bool SpectrogramStoreWriter::openFile(const QString &path, uint32_t sampleRate, int channels)
+{
+    if (channels < 1)
+    {
+        lastError = "A spectrogram store needs at least one band.";
+        return false;
+    }
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        lastError = file.errorString();
+        return false;
+    }
+
+    bands = channels;
+    header.sampleRate = sampleRate;
+    header.windowSize = window;
+    header.hopSize = hop;
+    header.numMelFilters = bands;
+    header.valueFormat = format;
+    header.frameCount = 0;
+    header.indexOffset = 0;
+    header.indexInterval = DefaultIndexInterval;
+    if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header)))
+    {
+        lastError = file.errorString();
+        return false;
+    }
+
+    // The stamps may trail the values by one drain, so they get room for twice the frames
+    stamps.reset(2 * (ring.capacity() / bands + DrainFrames));
+    staging.resize(DrainFrames * bands);
+    halves.resize(format == Float16 ? DrainFrames * bands : 0);
+    index.clear();
+    frames = 0;
+    return true;
+}
+
+bool SpectrogramStoreWriter::write(const SpectrogramBlock &block)
+{
+    const int count = block.frameCount();
+    if (count == 0 || block.bands != bands)
+    {
+        return count == 0;
+    }
+    if (ring.writeAvailable() < count * bands)
+    {
+        return write(block.values.constData(), count * bands); // Fails, and counts the drop
+    }
+
+    // The frames of a block were computed within one delivery interval, close enough to date
+    // them back from now by their hops
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const double hopMs = 1000.0 * hop / qMax<uint32_t>(1, header.sampleRate);
+    for (int i = 0; i < count; ++i)
+    {
+        const SpectrogramStoreIndexEntry stamp{block.frameTimestamps[i], nowMs - qRound64((count - 1 - i) * hopMs)};
+        stamps.push(&stamp, 1);
+    }
+    return write(block.values.constData(), count * bands);
+}
+
+int SpectrogramStoreWriter::drain()
+{
+    const int count = qMin(ring.readAvailable() / bands, DrainFrames);
+    if (count == 0)
+    {
+        return 0;
+    }
+    const int values = ring.pop(staging.data(), count * bands);
+
+    for (int i = 0; i < count; ++i, ++frames)
+    {
+        SpectrogramStoreIndexEntry stamp{0, 0};
+        stamps.pop(&stamp, 1); // Pushed before the values, so it is there
+        if (frames % header.indexInterval == 0)
+        {
+            index.append(stamp);
+        }
+    }
+
+    if (lastError.isEmpty())
+    {
+        const char *data = reinterpret_cast<const char *>(staging.constData());
+        qint64 bytes = qint64(values) * sizeof(float);
+        if (format == Float16)
+        {
+            qFloatToFloat16(halves.data(), staging.constData(), values);
+            data = reinterpret_cast<const char *>(halves.constData());
+            bytes = qint64(values) * sizeof(qfloat16);
+        }
+        // Flushed every time, so a reader mapping the live store sees whole frames
+        if (file.write(data, bytes) != bytes || !file.flush())
+        {
+            setWriteError(file.errorString());
+        }
+    }
+    writtenSamples.fetch_add(values); // Written, or discarded after a failure
+    return values;
+}
+
+void SpectrogramStoreWriter::flush()
+{
+    file.flush();
+}
+
+void SpectrogramStoreWriter::finishFile()
+{
+    if (!lastError.isEmpty())
+    {
+        return; // Leave the file as it is, readers go by its size
+    }
+
+    // The index starts 8-byte aligned, so a reader can use it straight from the mapping
+    const qint64 dataEnd = sizeof(header) + frames * bands * qint64(format == Float16 ? sizeof(qfloat16) : sizeof(float));
+    const qint64 indexOffset = (dataEnd + 7) / 8 * 8;
+    const QByteArray padding(indexOffset - dataEnd, '\0');
+    const qint64 indexBytes = index.size() * qint64(sizeof(SpectrogramStoreIndexEntry));
+    header.frameCount = static_cast<uint64_t>(frames);
+    header.indexOffset = static_cast<uint64_t>(indexOffset);
+    if (file.write(padding) != padding.size() ||
+        file.write(reinterpret_cast<const char *>(index.constData()), indexBytes) != indexBytes ||
+        !file.seek(0) || file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header)))
+    {
+        setWriteError(file.errorString());
+    }
+}
+
+SpectrogramStore::~SpectrogramStore()
+{
+    close();
+}
+
+bool SpectrogramStore::open(const QString &path)
+{
+    close();
+    lastError.clear();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        lastError = file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(fileHeader)) || file.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader)) != qint64(sizeof(fileHeader)) ||
+        memcmp(fileHeader.magic, SpectrogramStoreHeader().magic, sizeof(fileHeader.magic)) != 0)
+    {
+        lastError = "not a spectrogram store";
+        file.close();
+        return false;
+    }
+    const bool half = fileHeader.valueFormat == SpectrogramStoreWriter::Float16;
+    if (fileHeader.version != 1 || fileHeader.numMelFilters == 0 || fileHeader.hopSize == 0 || fileHeader.headerSize < sizeof(fileHeader) ||
+        (!half && fileHeader.valueFormat != SpectrogramStoreWriter::Float32))
+    {
+        lastError = "unsupported spectrogram store version or value format";
+        file.close();
+        return false;
+    }
+
+    mapping = file.map(0, size);
+    if (!mapping)
+    {
+        lastError = QString("could not map the file: %1").arg(file.errorString());
+        file.close();
+        return false;
+    }
+
+    // A finished store says where its frames end; a live or killed one ends after its last whole frame
+    frameBytes = bands() * (half ? int(sizeof(qfloat16)) : int(sizeof(float)));
+    const qint64 dataEnd = fileHeader.indexOffset != 0 ? qMin<qint64>(fileHeader.indexOffset, size) : size;
+    frames = qMax<qint64>(0, dataEnd - fileHeader.headerSize) / frameBytes;
+    if (fileHeader.indexOffset != 0)
+    {
+        frames = qMin<qint64>(frames, fileHeader.frameCount);
+        const qint64 entries = (frames + fileHeader.indexInterval - 1) / qMax<uint32_t>(1, fileHeader.indexInterval);
+        if (fileHeader.indexInterval > 0 && fileHeader.indexOffset % 8 == 0 &&
+            qint64(fileHeader.indexOffset) + entries * qint64(sizeof(SpectrogramStoreIndexEntry)) <= size)
+        {
+            index = reinterpret_cast<const SpectrogramStoreIndexEntry *>(mapping + fileHeader.indexOffset);
+            indexEntries = entries;
+        }
+    }
+    return true;
+}
+
+void SpectrogramStore::close()
+{
+    if (mapping)
+    {
+        file.unmap(mapping);
+        mapping = nullptr;
+    }
+    file.close();
+    fileHeader = SpectrogramStoreHeader();
+    frames = 0;
+    index = nullptr;
+    indexEntries = 0;
+}
+
+const char *SpectrogramStore::rawFrame(qint64 frame) const
+{
+    if (!mapping || frame < 0 || frame >= frames)
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const char *>(mapping) + fileHeader.headerSize + frame * frameBytes;
+}
+
+const float *SpectrogramStore::frame(qint64 frame) const
+{
+    // The header is 64 bytes, so float rows are aligned within the mapping
+    return fileHeader.valueFormat == SpectrogramStoreWriter::Float32 ? reinterpret_cast<const float *>(rawFrame(frame)) : nullptr;
+}
+
+qint64 SpectrogramStore::readFrames(qint64 firstFrame, qint64 count, float *out) const
+{
+    const qint64 available = firstFrame < 0 ? 0 : qBound<qint64>(0, frames - firstFrame, count);
+    if (available == 0)
+    {
+        return 0;
+    }
+    const qint64 values = available * bands();
+    if (fileHeader.valueFormat == SpectrogramStoreWriter::Float16)
+    {
+        qFloatFromFloat16(out, reinterpret_cast<const qfloat16 *>(rawFrame(firstFrame)), values);
+    }
+    else
+    {
+        memcpy(out, rawFrame(firstFrame), values * sizeof(float));
+    }
+    return available;
+}
+
+qint64 SpectrogramStore::framePosition(qint64 frame) const
+{
+    if (indexEntries == 0)
+    {
+        return frame * hopSize();
+    }
+    const qint64 entry = qBound<qint64>(0, frame / fileHeader.indexInterval, indexEntries - 1);
+    return index[entry].framePosition + (frame - entry * fileHeader.indexInterval) * hopSize();
+}
+
+qint64 SpectrogramStore::frameAtPosition(qint64 samplePosition) const
+{
+    qint64 frame = samplePosition / hopSize();
+    if (indexEntries > 0)
+    {
+        // The last indexed frame at or before the position, then whole hops from there
+        const SpectrogramStoreIndexEntry *end = index + indexEntries;
+        const SpectrogramStoreIndexEntry *after = std::upper_bound(index, end, samplePosition, [](qint64 position, const SpectrogramStoreIndexEntry &entry)
+                                                                   { return position < entry.framePosition; });
+        const qint64 entry = qMax<qint64>(0, after - index - 1);
+        frame = entry * fileHeader.indexInterval + (samplePosition - index[entry].framePosition) / hopSize();
+        frame = qMin<qint64>(frame, (entry + 1) * fileHeader.indexInterval - 1); // Inside a gap, the frame before it
+    }
+    return qBound<qint64>(0, frame, qMax<qint64>(0, frames - 1));
+}
+
+qint64 SpectrogramStore::frameAtTime(qint64 wallClockMs) const
+{
+    if (indexEntries == 0)
+    {
+        return -1;
+    }
+    const SpectrogramStoreIndexEntry *end = index + indexEntries;
+    const SpectrogramStoreIndexEntry *after = std::upper_bound(index, end, wallClockMs, [](qint64 time, const SpectrogramStoreIndexEntry &entry)
+                                                               { return time < entry.wallClockMs; });
+    const qint64 entry = qMax<qint64>(0, after - index - 1);
+    const double hopMs = 1000.0 * hopSize() / qMax(1, sampleRate());
+    const qint64 frame = entry * fileHeader.indexInterval + qMax<qint64>(0, qint64((wallClockMs - index[entry].wallClockMs) / hopMs));
+    return qBound<qint64>(0, frame, qMax<qint64>(0, frames - 1));
+}
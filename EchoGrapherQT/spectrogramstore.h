@@ -0,0 +1,141 @@
+#ifndef SPECTROGRAMSTORE_H
+#define SPECTROGRAMSTORE_H
+
+#include "recordingwriter.h"
+#include "spectrogramblock.h"
+
+#include <QFloat16>
+#include <QVector>
+
+// The .egspec spectrogram store: a 64-byte header, then every frame of one channel as a
+// frames x bands row-major matrix of float32 or float16 values, then a seek index. While it is
+// being written the file ends after the last whole frame, so a live or killed recording is read
+// by its size; close() appends the index and records the frame count. Everything is little-endian.
+#pragma pack(push, 1)
+struct SpectrogramStoreHeader
+{
+    char magic[8] = {'E', 'G', 'S', 'P', 'E', 'C', '\r', '\n'};
+    uint32_t version = 1;
+    uint32_t headerSize = 64; // Where the frames start
+    uint32_t sampleRate = 0;
+    uint32_t windowSize = 0;
+    uint32_t hopSize = 0;
+    uint32_t numMelFilters = 0; // Values per frame
+    uint16_t valueFormat = 0;   // SpectrogramStoreWriter::ValueFormat
+    uint16_t flags = 0;         // NormalizedFlag
+    float floorDb = 0.0f;       // The LogMelScale the values came out of
+    float referencePower = 0.0f;
+    uint64_t frameCount = 0;  // 0 until the store is closed
+    uint64_t indexOffset = 0; // 0 until the store is closed
+    uint32_t indexInterval = 0; // Frames per index entry
+};
+#pragma pack(pop)
+static_assert(sizeof(SpectrogramStoreHeader) == 64, "SpectrogramStoreHeader must not be padded");
+
+// One seek index entry, for every indexInterval-th frame
+struct SpectrogramStoreIndexEntry
+{
+    qint64 framePosition; // Stream position, in samples, of the frame's first sample
+    qint64 wallClockMs;   // When the frame was computed, in ms since the epoch
+};
+
+// Appends the frames of one analysis lane to a .egspec store from a background thread (see
+// RecordingWriter). write() takes whole SpectrogramBlocks and only pushes into lock-free rings,
+// so the processing thread never waits for the disk.
+class SpectrogramStoreWriter : public RecordingWriter
+{
+public:
+    enum ValueFormat
+    {
+        Float32,
+        Float16 // Half the size, steps of 0.06 dB near the -80 dB floor
+    };
+    static constexpr int NormalizedFlag = 1;      // Values were scaled to [0, 1] for display, not absolute dB
+    static constexpr int DefaultIndexInterval = 256; // About 3 s at the default hop
+
+    SpectrogramStoreWriter(int windowSize, int hopSize, ValueFormat format = Float32);
+    ~SpectrogramStoreWriter() override;
+
+    QString fileExtension() const override { return ".egspec"; }
+
+    // Set before open(): recorded in the header, so a reader knows what the values mean
+    void setScale(float floorDb, float referencePower, bool normalized);
+
+    // open(path, sampleRate, numMelFilters): `channels` is the number of bands per frame, and
+    // bufferSeconds counts seconds of frames rather than of samples
+    using RecordingWriter::write;
+    bool write(const SpectrogramBlock &block);
+    qint64 framesWritten() const { return samplesWritten() / bands; }
+
+protected:
+    bool openFile(const QString &path, uint32_t sampleRate, int channels) override;
+    double frameRate(uint32_t sampleRate) const override { return double(sampleRate) / hop; }
+    int drain() override;
+    void flush() override;
+    void finishFile() override; // Appends the index and patches the header
+
+private:
+    const int window;
+    const int hop;
+    const ValueFormat format;
+    SpectrogramStoreHeader header;
+    int bands = 1;
+
+    SpscRingBuffer<SpectrogramStoreIndexEntry> stamps; // One per frame in the value ring, pushed first
+    QVector<SpectrogramStoreIndexEntry> index;         // Writer thread
+    QVector<float> staging;                            // Writer thread
+    QVector<qfloat16> halves;
+    qint64 frames = 0; // Frames in the file
+};
+
+// A .egspec store mapped read-only, for reopening a session without recomputing its FFTs.
+// Float32 frames are handed out in place; a store that is still being written is read up to its
+// last whole frame at the time of open().
+class SpectrogramStore
+{
+public:
+    SpectrogramStore() = default;
+    ~SpectrogramStore();
+
+    SpectrogramStore(const SpectrogramStore &) = delete;
+    SpectrogramStore &operator=(const SpectrogramStore &) = delete;
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+    QString errorString() const { return lastError; }
+
+    const SpectrogramStoreHeader &header() const { return fileHeader; }
+    int bands() const { return static_cast<int>(fileHeader.numMelFilters); }
+    int hopSize() const { return static_cast<int>(fileHeader.hopSize); }
+    int sampleRate() const { return static_cast<int>(fileHeader.sampleRate); }
+    qint64 frameCount() const { return frames; }
+    bool isComplete() const { return fileHeader.indexOffset != 0; } // Closed by its writer, with an index
+
+    // Row `frame`, nullptr for a Float16 store or past the end
+    const float *frame(qint64 frame) const;
+
+    // Decodes `count` rows from `firstFrame` into `out`, as far as the store goes; returns the rows read
+    qint64 readFrames(qint64 firstFrame, qint64 count, float *out) const;
+
+    // Stream position of a frame's first sample, and the frame covering a stream position. Exact
+    // at every index entry, so a gap in the stream is caught up with at the next one; frames in
+    // between, and all frames of a store without an index, are taken to be a hop apart
+    qint64 framePosition(qint64 frame) const;
+    qint64 frameAtPosition(qint64 samplePosition) const;
+    qint64 frameAtTime(qint64 wallClockMs) const; // -1 without an index
+
+private:
+    const char *rawFrame(qint64 frame) const;
+
+    SpectrogramStoreHeader fileHeader;
+    QString lastError;
+    QFile file;
+    uchar *mapping = nullptr;
+    qint64 frames = 0;
+    int frameBytes = 0;
+    const SpectrogramStoreIndexEntry *index = nullptr;
+    qint64 indexEntries = 0;
+};
+
+#endif // SPECTROGRAMSTORE_H
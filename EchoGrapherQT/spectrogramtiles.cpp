@@ -0,0 +1,150 @@
+#include "spectrogramtiles.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <cmath>
+
+SpectrogramTileCache::SpectrogramTileCache(const SpectrogramPyramid *pyramid, qint64 budgetBytes)
+    : source(pyramid)
+{
+    cache.setMaxCost(static_cast<int>(qMax<qint64>(1, budgetBytes >> 10)));
+}
+
+void SpectrogramTileCache::setPyramid(const SpectrogramPyramid *pyramid)
+{
+    source = pyramid;
+    clear();
+}
+
+void SpectrogramTileCache::setPalette(Colormap::Palette palette)
+{
+    colors.setPalette(palette);
+    clear();
+}
+
+void SpectrogramTileCache::setRange(float minimum, float maximum)
+{
+    colors.setRange(minimum, maximum);
+    clear();
+}
+
+void SpectrogramTileCache::clear()
+{
+    cache.clear();
+}
+
+const QImage *SpectrogramTileCache::tile(int level, qint64 index)
+{
+    const int bands = source ? source->bands() : 0;
+    const qint64 firstColumn = index * TileColumns;
+    if (bands == 0 || index < 0 || level < 0 || firstColumn >= source->columnCount(level))
+    {
+        return nullptr;
+    }
+
+    // A tile that was rendered before its last frame arrived is redone once the pyramid has grown
+    const qint64 frames = source->frameCount();
+    const qint64 tileEnd = (firstColumn + TileColumns) << level;
+    Tile *cached = cache.object(Key(level, index));
+    if (cached && (cached->renderedFrames >= tileEnd || cached->renderedFrames == frames))
+    {
+        ++cacheHits;
+        return &cached->image;
+    }
+    ++cacheMisses;
+
+    columns.resize(qint64(TileColumns) * bands);
+    const qint64 count = source->readColumns(level, firstColumn, TileColumns, columns.data());
+    if (count == 0)
+    {
+        return nullptr;
+    }
+
+    Tile *rendered = new Tile{QImage(TileColumns, bands, QImage::Format_RGB32), frames};
+    rendered->image.fill(Qt::black);
+    if (rowBands.size() != bands)
+    {
+        rowBands.resize(bands);
+        for (int y = 0; y < bands; ++y)
+        {
+            rowBands[y] = bands - 1 - y; // Highest band on the top row
+        }
+    }
+    for (qint64 x = 0; x < count; ++x)
+    {
+        colors.mapColumn(columns.constData() + x * bands, bands, rowBands.constData(), bands,
+                         rendered->image.bits() + x * sizeof(QRgb), rendered->image.bytesPerLine());
+    }
+
+    const int cost = static_cast<int>(qMax<qint64>(1, rendered->image.sizeInBytes() >> 10));
+    const quint64 key = Key(level, index);
+    if (!cache.insert(key, rendered, cost))
+    {
+        return nullptr; // Larger than the whole budget, and already deleted
+    }
+    return &cache.object(key)->image;
+}
+
+SpectrogramTileItem::SpectrogramTileItem(const SpectrogramPyramid *pyramid, QGraphicsItem *parent)
+    : QGraphicsItem(parent), cache(pyramid)
+{
+    setCacheMode(NoCache); // The tiles are already the cache
+    setFlag(ItemUsesExtendedStyleOption); // Paints get the exposed rectangle, not the whole session
+}
+
+void SpectrogramTileItem::setPyramid(const SpectrogramPyramid *pyramid)
+{
+    cache.setPyramid(pyramid);
+    sync();
+}
+
+void SpectrogramTileItem::sync()
+{
+    const qint64 frames = cache.pyramid() ? cache.pyramid()->frameCount() : 0;
+    if (frames != extent)
+    {
+        prepareGeometryChange();
+        extent = frames;
+    }
+    update();
+}
+
+QRectF SpectrogramTileItem::boundingRect() const
+{
+    return QRectF(0, 0, qMax<qint64>(1, extent), Height);
+}
+
+void SpectrogramTileItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+    const SpectrogramPyramid *pyramid = cache.pyramid();
+    const QRectF exposed = option->exposedRect.intersected(boundingRect());
+    const qint64 frames = pyramid ? qMin(pyramid->frameCount(), extent) : 0;
+    if (frames == 0 || exposed.isEmpty())
+    {
+        return;
+    }
+    const qint64 firstFrame = qBound<qint64>(0, static_cast<qint64>(std::floor(exposed.left())), frames - 1);
+    const qint64 endFrame = qBound<qint64>(firstFrame + 1, static_cast<qint64>(std::ceil(exposed.right())), frames);
+
+    // About one column per device pixel, but no finer than the raw frames still available allow
+    const double pixelsPerFrame = std::abs(painter->worldTransform().m11());
+    int level = qMin(SpectrogramPyramid::LevelForScale(pixelsPerFrame), pyramid->levelCount() - 1);
+    level = qMax(level, pyramid->finestLevel(firstFrame, endFrame - firstFrame));
+    lastLevel = level;
+
+    const qint64 tileFrames = qint64(SpectrogramTileCache::TileColumns) << level;
+    for (qint64 index = firstFrame / tileFrames; index * tileFrames < endFrame; ++index)
+    {
+        const QImage *image = cache.tile(level, index);
+        if (!image)
+        {
+            continue;
+        }
+        // The newest column may cover fewer frames than the others, draw just the part that exists
+        const qint64 tileStart = index * tileFrames;
+        const qint64 covered = qMin(frames - tileStart, tileFrames);
+        painter->drawImage(QRectF(tileStart, 0, covered, Height), *image,
+                           QRectF(0, 0, double(covered) / (qint64(1) << level), image->height()));
+    }
+}
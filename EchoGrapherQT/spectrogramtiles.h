@@ -0,0 +1,86 @@
+#ifndef SPECTROGRAMTILES_H
+#define SPECTROGRAMTILES_H
+
+#include "colormap.h"
+#include "spectrogrampyramid.h"
+
+#include <QCache>
+#include <QGraphicsItem>
+#include <QImage>
+#include <QVector>
+
+// Coloured tiles of a SpectrogramPyramid, TileColumns columns of one level by one row per band,
+// kept in an LRU cache bounded by bytes. A view asks for the handful of tiles it shows; only
+// tiles it has not seen before, or the newest one after it grew, are pooled and coloured.
+class SpectrogramTileCache
+{
+public:
+    static constexpr int TileColumns = 256;
+    static constexpr qint64 DefaultBudgetBytes = qint64(64) << 20;
+
+    explicit SpectrogramTileCache(const SpectrogramPyramid *pyramid, qint64 budgetBytes = DefaultBudgetBytes);
+
+    void setPyramid(const SpectrogramPyramid *pyramid); // Also clears the cache
+    const SpectrogramPyramid *pyramid() const { return source; }
+
+    // Changing the colours drops every tile
+    void setPalette(Colormap::Palette palette);
+    void setRange(float minimum, float maximum);
+    const Colormap &colormap() const { return colors; }
+
+    // Tile `index` of `level`, rendered now if it is not cached or the pyramid has grown into
+    // it since. nullptr past the end, or where the level is finer than the pyramid can still
+    // pool for those frames. The pointer is good until the next call.
+    const QImage *tile(int level, qint64 index);
+    void clear();
+
+    int count() const { return cache.count(); }
+    qint64 hits() const { return cacheHits; }
+    qint64 misses() const { return cacheMisses; }
+
+    static quint64 Key(int level, qint64 index) { return (quint64(level) << 56) | quint64(index); }
+
+private:
+    struct Tile
+    {
+        QImage image;
+        qint64 renderedFrames; // Pyramid frames when it was rendered, tells whether it has grown since
+    };
+
+    const SpectrogramPyramid *source;
+    QCache<quint64, Tile> cache; // Cost in KB
+    Colormap colors;
+    QVector<float> columns; // One tile of pooled values
+    QVector<int> rowBands;
+    qint64 cacheHits = 0;
+    qint64 cacheMisses = 0;
+};
+
+// Scene item for browsing a whole pyramid: one scene unit per frame horizontally, Height units
+// tall. Each paint picks the pyramid level with about one column per device pixel and draws
+// only the tiles that intersect the exposed rectangle, so the cost of a repaint depends on the
+// size of the view and not on the length of the session.
+class SpectrogramTileItem : public QGraphicsItem
+{
+public:
+    static constexpr int Height = 500;
+
+    explicit SpectrogramTileItem(const SpectrogramPyramid *pyramid, QGraphicsItem *parent = nullptr);
+
+    SpectrogramTileCache &tiles() { return cache; }
+    void setPyramid(const SpectrogramPyramid *pyramid);
+
+    // Call after frames were appended: grows the item to the frame count and repaints
+    void sync();
+    int paintedLevel() const { return lastLevel; } // Level of the most recent paint
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    SpectrogramTileCache cache;
+    qint64 extent = 0; // Frames the geometry was last set for
+    int lastLevel = 0;
+};
+
+#endif // SPECTROGRAMTILES_H
@@ -0,0 +1,113 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+// Lock-free single-producer/single-consumer ring buffer.
+// Storage is allocated once by reset(); push() and pop() never allocate, lock or block, so
+// the producer side is safe to call from a capture loop or an audio callback. The producer
+// writes whole blocks and the consumer drains whatever is available in one batch.
+// The two indices live on separate cache lines so the threads do not false-share them.
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    static constexpr std::size_t CacheLineSize = 64;
+
+    SpscRingBuffer() = default;
+    explicit SpscRingBuffer(int minCapacity) { reset(minCapacity); }
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+    // Reallocates and empties the ring, rounding the capacity up to a power of two.
+    // Not thread-safe: only call while neither side is running.
+    void reset(int minCapacity)
+    {
+        std::size_t size = 1;
+        while (size < static_cast<std::size_t>(std::max(minCapacity, 1)))
+        {
+            size <<= 1;
+        }
+        buffer.assign(size, T());
+        mask = size - 1;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        cachedTail = 0;
+        cachedHead = 0;
+    }
+
+    int capacity() const { return static_cast<int>(buffer.size()); }
+
+    // Producer side: free slots. May under-report while the consumer is draining.
+    int writeAvailable() const
+    {
+        return static_cast<int>(buffer.size() - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire)));
+    }
+
+    // Consumer side: readable items. May under-report while the producer is writing.
+    int readAvailable() const
+    {
+        return static_cast<int>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed));
+    }
+
+    // Appends all `count` items or nothing; returns false if there is not enough room
+    bool push(const T *data, int count)
+    {
+        const std::size_t writeIndex = head.load(std::memory_order_relaxed);
+        if (buffer.size() - (writeIndex - cachedTail) < static_cast<std::size_t>(count))
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (buffer.size() - (writeIndex - cachedTail) < static_cast<std::size_t>(count))
+            {
+                return false;
+            }
+        }
+
+        const std::size_t start = writeIndex & mask;
+        const std::size_t firstPart = std::min(static_cast<std::size_t>(count), buffer.size() - start);
+        std::copy(data, data + firstPart, buffer.data() + start);
+        std::copy(data + firstPart, data + count, buffer.data());
+
+        head.store(writeIndex + count, std::memory_order_release);
+        return true;
+    }
+
+    // Removes up to `maxCount` items and returns how many were copied into `data`
+    int pop(T *data, int maxCount)
+    {
+        const std::size_t readIndex = tail.load(std::memory_order_relaxed);
+        std::size_t available = cachedHead - readIndex;
+        if (available < static_cast<std::size_t>(maxCount))
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            available = cachedHead - readIndex;
+        }
+
+        const std::size_t count = std::min(available, static_cast<std::size_t>(std::max(maxCount, 0)));
+        const std::size_t start = readIndex & mask;
+        const std::size_t firstPart = std::min(count, buffer.size() - start);
+        std::copy(buffer.data() + start, buffer.data() + start + firstPart, data);
+        std::copy(buffer.data(), buffer.data() + (count - firstPart), data + firstPart);
+
+        tail.store(readIndex + count, std::memory_order_release);
+        return static_cast<int>(count);
+    }
+
+private:
+    // Written by the producer, read by the consumer
+    alignas(CacheLineSize) std::atomic<std::size_t> head{0};
+    std::size_t cachedTail = 0; // Producer's last view of tail, saves re-reading the shared line
+
+    // Written by the consumer, read by the producer
+    alignas(CacheLineSize) std::atomic<std::size_t> tail{0};
+    std::size_t cachedHead = 0; // Consumer's last view of head
+
+    alignas(CacheLineSize) std::vector<T> buffer;
+    std::size_t mask = 0;
+};
+
+#endif // SPSCRINGBUFFER_H
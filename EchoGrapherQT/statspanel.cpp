@@ -0,0 +1,156 @@
+#include "statspanel.h"
+
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace
+{
+const int RefreshIntervalMs = 500;
+
+void SetCell(QTableWidget *table, int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = table->item(row, column);
+    if (!item)
+    {
+        item = new QTableWidgetItem();
+        item->setTextAlignment(column == 0 ? Qt::AlignLeft | Qt::AlignVCenter : Qt::AlignRight | Qt::AlignVCenter);
+        table->setItem(row, column, item);
+    }
+    item->setText(text);
+}
+
+QTableWidget *CreateTable(const QStringList &headers, int rows, QWidget *parent)
+{
+    QTableWidget *table = new QTableWidget(rows, headers.size(), parent);
+    table->setHorizontalHeaderLabels(headers);
+    table->verticalHeader()->setVisible(false);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionMode(QAbstractItemView::NoSelection);
+    return table;
+}
+}
+
+StatsPanel::StatsPanel(const PipelineStats *stats, QWidget *parent)
+    : QWidget(parent, Qt::Tool), stats(stats)
+{
+    setWindowTitle(tr("Pipeline Stats"));
+    setStyleSheet("QWidget { background-color: #232633; color: #FFF; } QHeaderView::section { background-color: #333; color: #FFF; }");
+
+    stageTable = CreateTable({tr("Stage"), tr("Count"), tr("p50"), tr("p90"), tr("p99"), tr("Max")}, PipelineStats::StageCount, this);
+    counterTable = CreateTable({tr("Counter"), tr("Value"), tr("Max")}, PipelineStats::CounterCount + PipelineStats::GaugeCount, this);
+
+    exportOnStopBox = new QCheckBox(tr("Export on stop"), this);
+    exportOnStopBox->setToolTip(tr("Write the stats as JSON next to the recording whenever processing stops"));
+    exportOnStopBox->setChecked(true);
+    QPushButton *exportButton = new QPushButton(tr("Export..."), this);
+    connect(exportButton, &QPushButton::clicked, this, &StatsPanel::exportWithDialog);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    buttons->addWidget(exportOnStopBox);
+    buttons->addStretch();
+    buttons->addWidget(exportButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(stageTable);
+    layout->addWidget(counterTable);
+    layout->addLayout(buttons);
+    resize(560, 480);
+
+    refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &StatsPanel::refresh);
+    refresh();
+}
+
+bool StatsPanel::exportOnStop() const
+{
+    return exportOnStopBox->isChecked();
+}
+
+bool StatsPanel::exportTo(const QString &path)
+{
+    QString error;
+    if (!stats->writeJson(path, &error))
+    {
+        QMessageBox::warning(this, tr("Export Stats"), tr("Could not write %1: %2").arg(path, error));
+        return false;
+    }
+    return true;
+}
+
+QString StatsPanel::FormatDuration(qint64 nanoseconds)
+{
+    if (nanoseconds < 1000)
+    {
+        return QString("%1 ns").arg(nanoseconds);
+    }
+    if (nanoseconds < 1000000)
+    {
+        return QString("%1 us").arg(nanoseconds / 1e3, 0, 'f', 1);
+    }
+    if (nanoseconds < 1000000000)
+    {
+        return QString("%1 ms").arg(nanoseconds / 1e6, 0, 'f', 2);
+    }
+    return QString("%1 s").arg(nanoseconds / 1e9, 0, 'f', 2);
+}
+
+void StatsPanel::refresh()
+{
+    for (int stage = 0; stage < PipelineStats::StageCount; ++stage)
+    {
+        const LatencyHistogram &h = stats->histogram(static_cast<PipelineStats::Stage>(stage));
+        const bool empty = h.count() == 0;
+        SetCell(stageTable, stage, 0, PipelineStats::StageName(static_cast<PipelineStats::Stage>(stage)));
+        SetCell(stageTable, stage, 1, QString::number(h.count()));
+        SetCell(stageTable, stage, 2, empty ? "-" : FormatDuration(h.percentile(50.0)));
+        SetCell(stageTable, stage, 3, empty ? "-" : FormatDuration(h.percentile(90.0)));
+        SetCell(stageTable, stage, 4, empty ? "-" : FormatDuration(h.percentile(99.0)));
+        SetCell(stageTable, stage, 5, empty ? "-" : FormatDuration(h.max()));
+    }
+
+    int row = 0;
+    for (int c = 0; c < PipelineStats::CounterCount; ++c, ++row)
+    {
+        const PipelineStats::Counter counter = static_cast<PipelineStats::Counter>(c);
+        SetCell(counterTable, row, 0, PipelineStats::CounterName(counter));
+        SetCell(counterTable, row, 1, QString::number(stats->counter(counter)));
+        SetCell(counterTable, row, 2, QString());
+    }
+    for (int g = 0; g < PipelineStats::GaugeCount; ++g, ++row)
+    {
+        const PipelineStats::Gauge gauge = static_cast<PipelineStats::Gauge>(g);
+        SetCell(counterTable, row, 0, PipelineStats::GaugeName(gauge));
+        SetCell(counterTable, row, 1, QString::number(stats->gauge(gauge)));
+        SetCell(counterTable, row, 2, QString::number(stats->gaugeMax(gauge)));
+    }
+}
+
+void StatsPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer->start(RefreshIntervalMs);
+}
+
+void StatsPanel::hideEvent(QHideEvent *event)
+{
+    refreshTimer->stop();
+    QWidget::hideEvent(event);
+}
+
+void StatsPanel::exportWithDialog()
+{
+    const QString path = QFileDialog::getSaveFileName(this, tr("Export Stats"), "pipeline_stats.json", tr("JSON files (*.json)"));
+    if (!path.isEmpty())
+    {
+        exportTo(path);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef STATSPANEL_H
+#define STATSPANEL_H
+
+#include "pipelinestats.h"
+
+#include <QWidget>
+
+class QCheckBox;
+class QTableWidget;
+class QTimer;
+
+// Live view of PipelineStats: one row of percentiles per stage, then counters and queue depths.
+// Refreshes itself while visible and can export the numbers as JSON.
+class StatsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StatsPanel(const PipelineStats *stats, QWidget *parent = nullptr);
+
+    bool exportOnStop() const; // Whether MainWindow should write a stats file when processing stops
+    bool exportTo(const QString &path);
+
+    static QString FormatDuration(qint64 nanoseconds);
+
+public slots:
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void exportWithDialog();
+
+private:
+    const PipelineStats *stats;
+    QTableWidget *stageTable;
+    QTableWidget *counterTable;
+    QCheckBox *exportOnStopBox;
+    QTimer *refreshTimer;
+};
+
+#endif // STATSPANEL_H
@@ -0,0 +1,126 @@
+#include "syntheticsource.h"
+
+#include <cmath>
+
+namespace
+{
+const double TwoPi = 2.0 * M_PI;
+}
+
+SyntheticSource::SyntheticSource() : SyntheticSource(Settings())
+{
+}
+
+SyntheticSource::SyntheticSource(const Settings &settings) : config(settings)
+{
+}
+
+bool SyntheticSource::open(int blockSize)
+{
+    Q_UNUSED(blockSize);
+    if (config.sampleRate <= 0 || config.frequency <= 0.0 || config.channels < 1 ||
+        (config.waveform == Chirp && (config.endFrequency <= 0.0 || config.sweepSeconds <= 0.0)))
+    {
+        lastError = "Error: invalid synthetic signal settings.";
+        return false;
+    }
+    random.seed(config.seed);
+    position = 0;
+    phases.assign(config.channels, 0.0);
+    startClock();
+    return true;
+}
+
+int SyntheticSource::read(float *buffer, int frames)
+{
+    const qint64 total = config.durationSeconds > 0.0 ? static_cast<qint64>(config.durationSeconds * config.sampleRate) : -1;
+    if (total >= 0)
+    {
+        frames = static_cast<int>(qMin<qint64>(frames, total - position));
+        if (frames <= 0)
+        {
+            return 0;
+        }
+    }
+
+    pace(position + frames);
+
+    // Phase is accumulated from the instantaneous frequency, so the sweep restarts without a click
+    const double sweepSamples = config.sweepSeconds * config.sampleRate;
+    const double sweepRatio = config.endFrequency / config.frequency;
+    const int channels = config.channels;
+    for (int i = 0; i < frames; ++i)
+    {
+        double frequency = config.frequency;
+        if (config.waveform == Chirp)
+        {
+            const double t = std::fmod(static_cast<double>(position + i), sweepSamples) / sweepSamples;
+            frequency *= std::pow(sweepRatio, t);
+        }
+        for (int c = 0; c < channels; ++c)
+        {
+            float sample = 0.0f;
+            if (config.waveform == Noise)
+            {
+                sample = config.amplitude * static_cast<float>(2.0 * random.generateDouble() - 1.0);
+            }
+            else
+            {
+                double &phase = phases[c];
+                sample = config.amplitude * static_cast<float>(std::sin(phase));
+                phase = std::fmod(phase + TwoPi * frequency * (c + 1) / config.sampleRate, TwoPi);
+                if (config.noiseLevel > 0.0f)
+                {
+                    sample += config.noiseLevel * static_cast<float>(2.0 * random.generateDouble() - 1.0);
+                }
+            }
+            buffer[i * channels + c] = sample;
+        }
+    }
+    position += frames;
+    return frames;
+}
+
+QString SyntheticSource::description() const
+{
+    QString text;
+    switch (config.waveform)
+    {
+    case Chirp:
+        text = QString("Synthetic chirp %1-%2 Hz").arg(config.frequency).arg(config.endFrequency);
+        break;
+    case Noise:
+        text = QString("Synthetic noise");
+        break;
+    default:
+        text = QString("Synthetic tone %1 Hz").arg(config.frequency);
+        break;
+    }
+    return config.channels > 1 ? QString("%1, %2 channels").arg(text).arg(config.channels) : text;
+}
+
+QString SyntheticSource::WaveformName(Waveform waveform)
+{
+    switch (waveform)
+    {
+    case Chirp:
+        return "chirp";
+    case Noise:
+        return "noise";
+    default:
+        return "tone";
+    }
+}
+
+bool SyntheticSource::WaveformFromName(const QString &name, Waveform *waveform)
+{
+    for (Waveform candidate : {Tone, Chirp, Noise})
+    {
+        if (name.compare(WaveformName(candidate), Qt::CaseInsensitive) == 0)
+        {
+            *waveform = candidate;
+            return true;
+        }
+    }
+    return false;
+}
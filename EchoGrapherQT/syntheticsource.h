@@ -0,0 +1,56 @@
+#ifndef SYNTHETICSOURCE_H
+#define SYNTHETICSOURCE_H
+
+#include "audiosource.h"
+
+#include <QRandomGenerator>
+#include <vector>
+
+// Deterministic test signals: the same settings and seed give the same samples on every run
+// and every machine, so a spectrogram can be compared frame by frame.
+class SyntheticSource : public AudioSource
+{
+public:
+    enum Waveform
+    {
+        Tone,  // Sine at frequency
+        Chirp, // Exponential sweep from frequency to endFrequency over sweepSeconds, repeated
+        Noise  // White noise, uniform in [-amplitude, amplitude]
+    };
+
+    struct Settings
+    {
+        Waveform waveform = Tone;
+        int sampleRate = 44100;
+        double frequency = 440.0;      // Hz; start of the sweep for Chirp
+        double endFrequency = 8000.0;  // Hz; Chirp only
+        double sweepSeconds = 5.0;     // Chirp only
+        float amplitude = 0.5f;
+        float noiseLevel = 0.0f;       // Noise added to Tone and Chirp, as an amplitude
+        double durationSeconds = 0.0;  // 0 never ends
+        quint32 seed = 1;
+        int channels = 1;              // Channel c carries the signal at c + 1 times its frequencies
+    };
+
+    SyntheticSource();
+    explicit SyntheticSource(const Settings &settings);
+
+    bool open(int blockSize) override;
+    void close() override {}
+    int sampleRate() const override { return config.sampleRate; }
+    int channelCount() const override { return config.channels; }
+    QString description() const override;
+    int read(float *buffer, int frames) override;
+
+    const Settings &settings() const { return config; }
+    static QString WaveformName(Waveform waveform);
+    static bool WaveformFromName(const QString &name, Waveform *waveform);
+
+private:
+    Settings config;
+    QRandomGenerator random;
+    qint64 position = 0; // Samples produced since open()
+    std::vector<double> phases; // Per channel, radians, kept in [0, 2 pi)
+};
+
+#endif // SYNTHETICSOURCE_H
@@ -1,6 +1,27 @@
 #include <QTest>
 #include "testaudioprocessor.h"
 #include "testmainwindow.h"
+#include "testmelfilterbank.h"
+#include "testfftplancache.h"
+#include "testspscringbuffer.h"
+#include "testframeassembler.h"
+#include "testwavwriter.h"
+#include "testspectrogramrenderer.h"
+#include "testcolormap.h"
+#include "testlogmelscale.h"
+#include "testframeprocessor.h"
+#include "testdspkernels.h"
+#include "testfixedframeprocessor.h"
+#include "testaudiosource.h"
+#include "testpipelinestats.h"
+#include "testspectrogramblockqueue.h"
+#include "testclockdriftmonitor.h"
+#include "testframeworkerpool.h"
+#include "testflacwriter.h"
+#include "testmappedwavfile.h"
+#include "testspectrogramstore.h"
+#include "testspectrogrampyramid.h"
+#include "testspectrogramtiles.h"
 
 int main(int argc, char **argv)
 {
@@ -13,5 +34,68 @@ int main(int argc, char **argv)
     TestMainWindow testMainWindow;
     status |= QTest::qExec(&testMainWindow, argc, argv);
 
+    TestMelFilterbank testMelFilterbank;
+    status |= QTest::qExec(&testMelFilterbank, argc, argv);
+
+    TestFftPlanCache testFftPlanCache;
+    status |= QTest::qExec(&testFftPlanCache, argc, argv);
+
+    TestSpscRingBuffer testSpscRingBuffer;
+    status |= QTest::qExec(&testSpscRingBuffer, argc, argv);
+
+    TestFrameAssembler testFrameAssembler;
+    status |= QTest::qExec(&testFrameAssembler, argc, argv);
+
+    TestWavWriter testWavWriter;
+    status |= QTest::qExec(&testWavWriter, argc, argv);
+
+    TestSpectrogramRenderer testSpectrogramRenderer;
+    status |= QTest::qExec(&testSpectrogramRenderer, argc, argv);
+
+    TestColormap testColormap;
+    status |= QTest::qExec(&testColormap, argc, argv);
+
+    TestLogMelScale testLogMelScale;
+    status |= QTest::qExec(&testLogMelScale, argc, argv);
+
+    TestFrameProcessor testFrameProcessor;
+    status |= QTest::qExec(&testFrameProcessor, argc, argv);
+
+    TestDspKernels testDspKernels;
+    status |= QTest::qExec(&testDspKernels, argc, argv);
+
+    TestFixedFrameProcessor testFixedFrameProcessor;
+    status |= QTest::qExec(&testFixedFrameProcessor, argc, argv);
+
+    TestAudioSource testAudioSource;
+    status |= QTest::qExec(&testAudioSource, argc, argv);
+
+    TestPipelineStats testPipelineStats;
+    status |= QTest::qExec(&testPipelineStats, argc, argv);
+
+    TestSpectrogramBlockQueue testSpectrogramBlockQueue;
+    status |= QTest::qExec(&testSpectrogramBlockQueue, argc, argv);
+
+    TestClockDriftMonitor testClockDriftMonitor;
+    status |= QTest::qExec(&testClockDriftMonitor, argc, argv);
+
+    TestFrameWorkerPool testFrameWorkerPool;
+    status |= QTest::qExec(&testFrameWorkerPool, argc, argv);
+
+    TestFlacWriter testFlacWriter;
+    status |= QTest::qExec(&testFlacWriter, argc, argv);
+
+    TestMappedWavFile testMappedWavFile;
+    status |= QTest::qExec(&testMappedWavFile, argc, argv);
+
+    TestSpectrogramStore testSpectrogramStore;
+    status |= QTest::qExec(&testSpectrogramStore, argc, argv);
+
+    TestSpectrogramPyramid testSpectrogramPyramid;
+    status |= QTest::qExec(&testSpectrogramPyramid, argc, argv);
+
+    TestSpectrogramTiles testSpectrogramTiles;
+    status |= QTest::qExec(&testSpectrogramTiles, argc, argv);
+
     return status;
 }
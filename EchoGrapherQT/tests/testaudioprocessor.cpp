@@ -1,4 +1,8 @@
 #include "testaudioprocessor.h"
+#include "../syntheticsource.h"
+#include "../wavreader.h"
+#include <QDir>
+#include <QTemporaryDir>
 #include <cstdio>
 #if defined(_WIN32)
 #include <io.h>
@@ -112,10 +116,10 @@ void TestAudioProcessor::testMelFrequencyConversion()
 
 void TestAudioProcessor::testStartProcessing()
 {
-    processor->startProcessing(); // Call startProcessing
+    QVERIFY(processor->startProcessing());
 
     QVERIFY(!processor->stopFlag.load());
-    QVERIFY(processor->audioInputThread->isRunning());
+    QVERIFY(processor->devices[0]->inputThread->isRunning());
     QVERIFY(processor->audioProcessingThread->isRunning());
 
     processor->stopProcessing();
@@ -123,10 +127,10 @@ void TestAudioProcessor::testStartProcessing()
 
 void TestAudioProcessor::testStopProcessing()
 {
-    processor->startProcessing(); // Call startProcessing
+    QVERIFY(processor->startProcessing());
 
     QVERIFY(!processor->stopFlag.load());
-    QVERIFY(processor->audioInputThread->isRunning());
+    QVERIFY(processor->devices[0]->inputThread->isRunning());
     QVERIFY(processor->audioProcessingThread->isRunning());
 
     processor->stopProcessing();
@@ -134,6 +138,330 @@ void TestAudioProcessor::testStopProcessing()
     QVERIFY(processor->stopFlag.load());
 }
 
+void TestAudioProcessor::testCallbackCaptureMode()
+{
+    processor->captureMode = AudioProcessor::CallbackCapture;
+    processor->captureBlockSize = 64; // Independent of the 512-sample analysis window
+    QVERIFY(processor->startProcessing());
+
+    // PortAudio drives capture itself, so no input thread is created
+    QCOMPARE(processor->deviceCount(), 1);
+    QVERIFY(processor->devices[0]->inputThread == nullptr);
+    QVERIFY(processor->devices[0]->ring.capacity() >= processor->captureBlockSize * 8);
+
+    processor->stopProcessing();
+    QVERIFY(processor->stopFlag.load());
+    QVERIFY(processor->devices[0]->stream == nullptr);
+
+    processor->captureMode = AudioProcessor::BlockingCapture;
+    processor->captureBlockSize = 256;
+}
+
+namespace
+{
+// Records what the processing thread hands to a direct sink
+class RecordingSink : public SpectrogramSink
+{
+public:
+    void consumeSpectrogramBlock(const SpectrogramBlock &block) override
+    {
+        frames += block.frameCount();
+        lastTimestamp = block.frameTimestamps.last();
+        if (block.channel >= 0 && block.channel < MaxChannels)
+        {
+            channelFrames[block.channel] += block.frameCount();
+        }
+    }
+    static constexpr int MaxChannels = 4;
+    int frames = 0;
+    int channelFrames[MaxChannels] = {};
+    qint64 lastTimestamp = -1;
+};
+
+// Keeps every row and timestamp of one channel
+class ValueSink : public SpectrogramSink
+{
+public:
+    void consumeSpectrogramBlock(const SpectrogramBlock &block) override
+    {
+        values.append(block.values);
+        timestamps.append(block.frameTimestamps);
+    }
+    QVector<float> values;
+    QVector<qint64> timestamps;
+};
+
+ValueSink RunChirp(int frameWorkers)
+{
+    SyntheticSource::Settings settings;
+    settings.waveform = SyntheticSource::Chirp;
+    settings.durationSeconds = 1.0;
+    std::unique_ptr<SyntheticSource> source(new SyntheticSource(settings));
+    source->setSpeed(0.0);
+
+    AudioProcessor runner;
+    runner.recordInput = false;
+    runner.windowSize = 2048;
+    runner.windowOverlap = 0.875f;
+    runner.frameWorkers = frameWorkers;
+    runner.setAudioSource(std::move(source));
+    ValueSink sink;
+    runner.setSpectrogramSink(&sink);
+    QSignalSpy finishedSpy(&runner, &AudioProcessor::sourceFinished);
+    QVERIFY(runner.startProcessing());
+    finishedSpy.wait(10000);
+    runner.stopProcessing();
+    return sink;
+}
+}
+
+void TestAudioProcessor::testSpectrogramBlockDelivery()
+{
+    RecordingSink sink;
+    processor->setSpectrogramSink(&sink);
+    QSignalSpy readySpy(processor, &AudioProcessor::spectrogramBlocksReady);
+
+    SpectrogramBlock block;
+    block.bands = 4;
+    block.sampleRate = 1000;
+    block.hopSize = 250;
+    std::fill_n(block.appendFrame(0), 4, 1.0f);
+    std::fill_n(block.appendFrame(250), 4, 2.0f);
+    QCOMPARE(block.frameCount(), 2);
+    QCOMPARE(block.frame(1)[3], 2.0f);
+    QCOMPARE(block.frameTime(1), 0.25);
+
+    processor->deliverSpectrogramBlock(block);
+
+    // The sink and the render queue both see the whole batch, and the block is ready for the next one
+    QCOMPARE(sink.frames, 2);
+    QCOMPARE(sink.lastTimestamp, qint64(250));
+    QCOMPARE(readySpy.count(), 1);
+    QVERIFY(block.isEmpty());
+    QCOMPARE(block.bands, 4);
+
+    // A second block while the first is still waiting does not wake the GUI again
+    std::fill_n(block.appendFrame(500), 4, 3.0f);
+    processor->deliverSpectrogramBlock(block);
+    QCOMPARE(readySpy.count(), 1);
+
+    SpectrogramBlock received;
+    QVERIFY(processor->takeSpectrogramBlock(received));
+    QCOMPARE(received.frameCount(), 2);
+    QCOMPARE(received.frame(1)[3], 2.0f);
+    QVERIFY(processor->takeSpectrogramBlock(received));
+    QCOMPARE(received.frameTimestamps.first(), qint64(500));
+    QVERIFY(!processor->takeSpectrogramBlock(received));
+
+    processor->setSpectrogramSink(nullptr);
+}
+
+void TestAudioProcessor::testSyntheticSourceRun()
+{
+    // Headless: one second of a generated chirp, as fast as the pipeline can take it
+    SyntheticSource::Settings settings;
+    settings.waveform = SyntheticSource::Chirp;
+    settings.frequency = 100.0;
+    settings.durationSeconds = 1.0;
+    std::unique_ptr<SyntheticSource> source(new SyntheticSource(settings));
+    source->setSpeed(0.0);
+
+    AudioProcessor runner;
+    runner.recordInput = false;
+    runner.setAudioSource(std::move(source));
+    RecordingSink sink;
+    runner.setSpectrogramSink(&sink);
+    QSignalSpy finishedSpy(&runner, &AudioProcessor::sourceFinished);
+
+    QVERIFY(runner.startProcessing());
+    QVERIFY(finishedSpy.wait(10000));
+    runner.stopProcessing();
+
+    // A source that is not live is never dropped from: every sample reaches a frame
+    const int hopSize = runner.windowSize - static_cast<int>(runner.windowSize * runner.windowOverlap);
+    QCOMPARE(sink.frames, (44100 - runner.windowSize) / hopSize + 1);
+    QCOMPARE(runner.captureOverflowCount(), quint64(0));
+
+    // Every frame went through the timed path
+    const PipelineStats &stats = runner.stats();
+    QCOMPARE(stats.counter(PipelineStats::FramesProcessed), quint64(sink.frames));
+    QCOMPARE(stats.histogram(PipelineStats::Fft).count(), quint64(sink.frames));
+    QCOMPARE(stats.histogram(PipelineStats::Mel).count(), quint64(sink.frames));
+    QVERIFY(stats.histogram(PipelineStats::QueueWait).count() > 0);
+    QVERIFY(stats.histogram(PipelineStats::Capture).count() > 0);
+}
+
+void TestAudioProcessor::testMultiChannelRun()
+{
+    // Three channels of a generated tone, each through its own lane
+    SyntheticSource::Settings settings;
+    settings.durationSeconds = 1.0;
+    settings.channels = 3;
+    std::unique_ptr<SyntheticSource> source(new SyntheticSource(settings));
+    source->setSpeed(0.0);
+
+    AudioProcessor runner;
+    runner.recordInput = false;
+    runner.setAudioSource(std::move(source));
+    RecordingSink sink;
+    runner.setSpectrogramSink(&sink);
+    QSignalSpy finishedSpy(&runner, &AudioProcessor::sourceFinished);
+
+    QVERIFY(runner.startProcessing());
+    QCOMPARE(runner.channelCount(), 3);
+    QVERIFY(finishedSpy.wait(10000));
+    runner.stopProcessing();
+
+    // Every channel sees every frame, none of them is dropped from
+    const int hopSize = runner.windowSize - static_cast<int>(runner.windowSize * runner.windowOverlap);
+    const int expectedFrames = (44100 - runner.windowSize) / hopSize + 1;
+    for (int c = 0; c < 3; ++c)
+    {
+        QCOMPARE(sink.channelFrames[c], expectedFrames);
+    }
+    QCOMPARE(sink.channelFrames[3], 0);
+    QCOMPARE(runner.stats().counter(PipelineStats::FramesProcessed), quint64(3 * expectedFrames));
+    QCOMPARE(runner.captureOverflowCount(), quint64(0));
+}
+
+void TestAudioProcessor::testMultiDeviceRun()
+{
+    // Two sources at different rates and channel counts, captured side by side in one run
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SyntheticSource::Settings settings;
+    settings.durationSeconds = 1.0;
+    std::unique_ptr<SyntheticSource> mono(new SyntheticSource(settings));
+    settings.sampleRate = 22050;
+    settings.channels = 2;
+    std::unique_ptr<SyntheticSource> stereo(new SyntheticSource(settings));
+    mono->setSpeed(0.0);
+    stereo->setSpeed(0.0);
+
+    AudioProcessor runner;
+    runner.setOutputPath(dir.path());
+    runner.setAudioSource(std::move(mono));
+    runner.addAudioSource(std::move(stereo));
+    RecordingSink sink;
+    runner.setSpectrogramSink(&sink);
+    QSignalSpy finishedSpy(&runner, &AudioProcessor::sourceFinished);
+
+    QVERIFY(runner.startProcessing());
+    QCOMPARE(runner.deviceCount(), 2);
+    QCOMPARE(runner.channelCount(), 3);
+    QCOMPARE(runner.deviceChannelCount(1), 2);
+    QCOMPARE(runner.deviceSampleRate(1), 22050);
+    QVERIFY(finishedSpy.wait(10000));
+    runner.stopProcessing();
+
+    // Lanes are numbered across the devices, each analysed at its own device's rate
+    const int hopSize = runner.windowSize - static_cast<int>(runner.windowSize * runner.windowOverlap);
+    QCOMPARE(sink.channelFrames[0], (44100 - runner.windowSize) / hopSize + 1);
+    QCOMPARE(sink.channelFrames[1], (22050 - runner.windowSize) / hopSize + 1);
+    QCOMPARE(sink.channelFrames[2], sink.channelFrames[1]);
+
+    // One recording per device, since their clocks cannot share a file
+    const QStringList recordings = QDir(dir.path()).entryList({"output_*.wav"}, QDir::Files, QDir::Name);
+    QCOMPARE(recordings.size(), 2);
+    QVERIFY(recordings[1].endsWith("_device2.wav"));
+    WavInfo info;
+    QString error;
+    QVERIFY(ReadWavInfo(dir.filePath(recordings[1]), info, error));
+    QCOMPARE(info.numChannels, uint16_t(2));
+    QCOMPARE(info.sampleRate, uint32_t(22050));
+    QCOMPARE(info.numFrames, qint64(22050));
+
+    // Generated input runs on the host clock, there is nothing to measure
+    QVERIFY(!runner.isClockDriftMeasured(0));
+    QCOMPARE(runner.stats().gauge(PipelineStats::ClockDrift), qint64(0));
+}
+
+void TestAudioProcessor::testParallelFrameWorkers()
+{
+    // Frames computed on four workers come back in time order and match the sequential run,
+    // the running dB range included
+    const ValueSink sequential = RunChirp(1);
+    const ValueSink parallel = RunChirp(4);
+    QVERIFY(!sequential.timestamps.isEmpty());
+    QCOMPARE(parallel.timestamps, sequential.timestamps);
+    QCOMPARE(parallel.values.size(), sequential.values.size());
+    for (int i = 0; i < sequential.values.size(); ++i)
+    {
+        QVERIFY(qAbs(parallel.values[i] - sequential.values[i]) <= 1e-4f);
+    }
+}
+
+void TestAudioProcessor::testSpectrogramStoreRun()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SyntheticSource::Settings settings;
+    settings.waveform = SyntheticSource::Chirp;
+    settings.durationSeconds = 1.0;
+    std::unique_ptr<SyntheticSource> source(new SyntheticSource(settings));
+    source->setSpeed(0.0);
+
+    AudioProcessor runner;
+    runner.recordInput = false;
+    runner.storeSpectrogram = true;
+    runner.setOutputPath(dir.path());
+    runner.setAudioSource(std::move(source));
+    ValueSink sink;
+    runner.setSpectrogramSink(&sink);
+    QSignalSpy finishedSpy(&runner, &AudioProcessor::sourceFinished);
+    QVERIFY(runner.startProcessing());
+    QVERIFY(finishedSpy.wait(10000));
+    runner.stopProcessing();
+
+    // The store holds exactly what was delivered, and is finished once processing stops
+    const QStringList stores = QDir(dir.path()).entryList({"output_*.egspec"}, QDir::Files);
+    QCOMPARE(stores.size(), 1);
+    SpectrogramStore store;
+    QVERIFY2(store.open(dir.filePath(stores[0])), qPrintable(store.errorString()));
+    QVERIFY(store.isComplete());
+    QCOMPARE(store.bands(), runner.numMelFilters);
+    QCOMPARE(store.sampleRate(), 44100);
+    QCOMPARE(store.frameCount(), qint64(sink.timestamps.size()));
+    QCOMPARE(QVector<float>(store.frame(0), store.frame(0) + sink.values.size()), sink.values);
+    for (int i = 0; i < sink.timestamps.size(); ++i)
+    {
+        QCOMPARE(store.framePosition(i), sink.timestamps[i]);
+    }
+}
+
+void TestAudioProcessor::testSpectrogramStoreOpenFailure()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SyntheticSource::Settings settings;
+    settings.durationSeconds = 0.5;
+    std::unique_ptr<SyntheticSource> source(new SyntheticSource(settings));
+    source->setSpeed(0.0);
+
+    AudioProcessor runner;
+    runner.recordInput = false;
+    runner.storeSpectrogram = true;
+    runner.setOutputPath(dir.filePath("missing")); // No such directory, so the store cannot be created
+    runner.setAudioSource(std::move(source));
+    QSignalSpy errorSpy(&runner, &AudioProcessor::errorOccurred);
+    QSignalSpy finishedSpy(&runner, &AudioProcessor::sourceFinished);
+    QVERIFY(!runner.startProcessing());
+
+    // Reported before capture starts, and nothing is left running
+    QCOMPARE(errorSpy.count(), 1);
+    QVERIFY(errorSpy.at(0).at(0).toString().contains("spectrogram store"));
+    runner.stopProcessing();
+    QCOMPARE(finishedSpy.count(), 0);
+
+    // The source was closed again, so the next run can open it
+    runner.setOutputPath(dir.path());
+    QVERIFY(runner.startProcessing());
+    QVERIFY(finishedSpy.wait(10000));
+    runner.stopProcessing();
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(QDir(dir.path()).entryList({"output_*.egspec"}, QDir::Files).size(), 1);
+}
+
 void TestAudioProcessor::testFrequencyToMel()
 {
     // Test with a known frequency to Mel conversion
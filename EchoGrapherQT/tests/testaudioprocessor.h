@@ -26,6 +26,14 @@ private slots:
     void testConvertToMelSpectrum();
     void testStartProcessing();
     void testStopProcessing();
+    void testCallbackCaptureMode();
+    void testSpectrogramBlockDelivery();
+    void testSyntheticSourceRun();
+    void testMultiChannelRun();
+    void testMultiDeviceRun();
+    void testParallelFrameWorkers();
+    void testSpectrogramStoreRun();
+    void testSpectrogramStoreOpenFailure();
     void testFrequencyToMel();
 };
 
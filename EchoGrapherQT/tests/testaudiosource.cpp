@@ -0,0 +1,260 @@
+#include "testaudiosource.h"
+#include "../wavwriter.h"
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
+namespace
+{
+// Reads blocks until the source runs out, at most `limit` samples
+QVector<float> ReadAll(AudioSource &source, int blockSize, int limit)
+{
+    QVector<float> samples;
+    QVector<float> block(blockSize);
+    while (samples.size() < limit)
+    {
+        const int frames = source.read(block.data(), qMin(blockSize, limit - samples.size()));
+        if (frames <= 0)
+        {
+            break;
+        }
+        samples.append(QVector<float>(block.constBegin(), block.constBegin() + frames));
+    }
+    return samples;
+}
+
+// A 16-bit stereo PCM file, written by hand rather than by WavWriter
+bool WriteStereoInt16(const QString &path, const QVector<qint16> &interleaved, uint32_t sampleRate)
+{
+    WAVHeader header;
+    header.audioFormat = 1;
+    header.numChannels = 2;
+    header.sampleRate = sampleRate;
+    header.bitsPerSample = 16;
+    header.blockAlign = 4;
+    header.byteRate = sampleRate * 4;
+    header.subchunk2Size = interleaved.size() * sizeof(qint16);
+    header.chunkSize = 36 + header.subchunk2Size;
+
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) &&
+           file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header) &&
+           file.write(reinterpret_cast<const char *>(interleaved.constData()), header.subchunk2Size) == header.subchunk2Size;
+}
+}
+
+void TestAudioSource::testSyntheticIsDeterministic()
+{
+    SyntheticSource::Settings settings;
+    settings.waveform = SyntheticSource::Chirp;
+    settings.noiseLevel = 0.1f;
+    settings.seed = 42;
+
+    SyntheticSource first(settings);
+    SyntheticSource second(settings);
+    first.setSpeed(0.0);
+    second.setSpeed(0.0);
+    QVERIFY(first.open(256));
+    QVERIFY(second.open(256));
+
+    // Different block sizes, same stream
+    const QVector<float> a = ReadAll(first, 256, 10000);
+    const QVector<float> b = ReadAll(second, 999, 10000);
+    QCOMPARE(a.size(), 10000);
+    QCOMPARE(a, b);
+
+    // Reopening starts over
+    QVERIFY(first.open(256));
+    QCOMPARE(ReadAll(first, 128, 10000), a);
+
+    settings.seed = 43;
+    SyntheticSource other(settings);
+    other.setSpeed(0.0);
+    QVERIFY(other.open(256));
+    QVERIFY(ReadAll(other, 256, 10000) != a);
+}
+
+void TestAudioSource::testSyntheticToneFrequency()
+{
+    SyntheticSource::Settings settings;
+    settings.frequency = 1000.0;
+    settings.amplitude = 0.25f;
+    SyntheticSource source(settings);
+    source.setSpeed(0.0);
+    QVERIFY(source.open(512));
+
+    // One second of a 1 kHz sine crosses zero upwards 1000 times
+    const QVector<float> samples = ReadAll(source, 512, settings.sampleRate);
+    int crossings = 0;
+    float peak = 0.0f;
+    for (int i = 1; i < samples.size(); ++i)
+    {
+        crossings += samples[i - 1] < 0.0f && samples[i] >= 0.0f;
+        peak = qMax(peak, qAbs(samples[i]));
+    }
+    QVERIFY(qAbs(crossings - 1000) <= 1);
+    QVERIFY(qAbs(peak - 0.25f) < 1e-3f);
+}
+
+void TestAudioSource::testSyntheticDuration()
+{
+    SyntheticSource::Settings settings;
+    settings.waveform = SyntheticSource::Noise;
+    settings.sampleRate = 8000;
+    settings.durationSeconds = 0.1;
+    SyntheticSource source(settings);
+    source.setSpeed(0.0);
+    QVERIFY(source.open(256));
+
+    const QVector<float> samples = ReadAll(source, 256, 100000);
+    QCOMPARE(samples.size(), 800);
+    for (float sample : samples)
+    {
+        QVERIFY(qAbs(sample) <= settings.amplitude);
+    }
+    float block[16];
+    QCOMPARE(source.read(block, 16), 0);
+}
+
+void TestAudioSource::testSyntheticPacing()
+{
+    SyntheticSource::Settings settings;
+    settings.sampleRate = 10000;
+    SyntheticSource source(settings);
+    QVERIFY(source.open(100));
+
+    // 0.2 s of audio at real time, then at 4x
+    QElapsedTimer timer;
+    timer.start();
+    ReadAll(source, 100, 2000);
+    QVERIFY(timer.elapsed() >= 180);
+
+    source.setSpeed(4.0);
+    QVERIFY(source.open(100));
+    timer.restart();
+    ReadAll(source, 100, 2000);
+    QVERIFY(timer.elapsed() >= 40);
+    QVERIFY(timer.elapsed() < 180);
+}
+
+void TestAudioSource::testSyntheticChannelsInterleaved()
+{
+    SyntheticSource::Settings settings;
+    settings.frequency = 1000.0;
+    settings.channels = 2;
+    SyntheticSource stereo(settings);
+    stereo.setSpeed(0.0);
+    QVERIFY(stereo.open(512));
+    QCOMPARE(stereo.channelCount(), 2);
+
+    settings.channels = 1;
+    SyntheticSource mono(settings);
+    mono.setSpeed(0.0);
+    QVERIFY(mono.open(512));
+
+    // One second, frames interleaved left/right; the first channel is the mono signal
+    const int frames = settings.sampleRate;
+    QVector<float> interleaved(frames * 2);
+    QVector<float> reference(frames);
+    QCOMPARE(stereo.read(interleaved.data(), frames), frames);
+    QCOMPARE(mono.read(reference.data(), frames), frames);
+
+    int crossings[2] = {0, 0};
+    for (int i = 0; i < frames; ++i)
+    {
+        QCOMPARE(interleaved[i * 2], reference[i]);
+        for (int c = 0; c < 2 && i > 0; ++c)
+        {
+            crossings[c] += interleaved[(i - 1) * 2 + c] < 0.0f && interleaved[i * 2 + c] >= 0.0f;
+        }
+    }
+
+    // The second channel carries twice the frequency
+    QVERIFY(qAbs(crossings[0] - 1000) <= 1);
+    QVERIFY(qAbs(crossings[1] - 2000) <= 1);
+}
+
+void TestAudioSource::testWavReplayMatchesFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("replay.wav");
+
+    QVector<float> written(5000);
+    for (int i = 0; i < written.size(); ++i)
+    {
+        written[i] = std::sin(i * 0.01f);
+    }
+    WavWriter writer;
+    QVERIFY(writer.open(path, 22050, 1));
+    QVERIFY(writer.write(written.constData(), written.size()));
+    writer.close();
+
+    WavFileSource source(path);
+    source.setSpeed(0.0);
+    QVERIFY(source.open(256));
+    QCOMPARE(source.sampleRate(), 22050);
+    QCOMPARE(ReadAll(source, 256, 100000), written);
+    float block[16];
+    QCOMPARE(source.read(block, 16), 0);
+}
+
+void TestAudioSource::testWavReplayMixesIntegerChannels()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("stereo.wav");
+    QVERIFY(WriteStereoInt16(path, {16384, 0, -32768, -32768, 8192, 24576}, 8000));
+
+    WavFileSource source(path);
+    source.setSpeed(0.0);
+    QVERIFY(source.open(64));
+    QCOMPARE(source.wavInfo().numChannels, uint16_t(2));
+    QCOMPARE(ReadAll(source, 64, 100), QVector<float>({0.25f, -1.0f, 0.5f}));
+}
+
+void TestAudioSource::testWavReplayKeepsChannels()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("stereo.wav");
+    QVERIFY(WriteStereoInt16(path, {16384, 0, -32768, -32768, 8192, 24576}, 8000));
+
+    WavFileSource source(path, false, false);
+    source.setSpeed(0.0);
+    QVERIFY(source.open(64));
+    QCOMPARE(source.channelCount(), 2);
+
+    QVector<float> block(64 * 2);
+    QCOMPARE(source.read(block.data(), 64), 3); // Frames, not samples
+    block.resize(3 * 2);
+    QCOMPARE(block, QVector<float>({0.5f, 0.0f, -1.0f, -1.0f, 0.25f, 0.75f}));
+}
+
+void TestAudioSource::testWavReplayLoops()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("loop.wav");
+    QVector<float> written{0.1f, 0.2f, 0.3f, 0.4f, 0.5f};
+    WavWriter writer;
+    QVERIFY(writer.open(path, 1000, 1));
+    QVERIFY(writer.write(written.constData(), written.size()));
+    writer.close();
+
+    WavFileSource source(path, true);
+    source.setSpeed(0.0);
+    QVERIFY(source.open(3));
+    const QVector<float> samples = ReadAll(source, 3, 12);
+    QCOMPARE(samples.size(), 12);
+    for (int i = 0; i < samples.size(); ++i)
+    {
+        QCOMPARE(samples[i], written[i % written.size()]);
+    }
+}
+
+void TestAudioSource::testWavReplayMissingFile()
+{
+    WavFileSource source("/nonexistent/recording.wav");
+    QVERIFY(!source.open(256));
+    QVERIFY(!source.errorString().isEmpty());
+}
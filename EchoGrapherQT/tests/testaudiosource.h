@@ -0,0 +1,25 @@
+#ifndef TESTAUDIOSOURCE_H
+#define TESTAUDIOSOURCE_H
+
+#include <QtTest>
+#include "../syntheticsource.h"
+#include "../wavfilesource.h"
+
+class TestAudioSource : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSyntheticIsDeterministic();
+    void testSyntheticToneFrequency();
+    void testSyntheticDuration();
+    void testSyntheticPacing();
+    void testSyntheticChannelsInterleaved();
+    void testWavReplayMatchesFile();
+    void testWavReplayMixesIntegerChannels();
+    void testWavReplayKeepsChannels();
+    void testWavReplayLoops();
+    void testWavReplayMissingFile();
+};
+
+#endif // TESTAUDIOSOURCE_H
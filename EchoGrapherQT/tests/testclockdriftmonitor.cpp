@@ -0,0 +1,83 @@
+#include "testclockdriftmonitor.h"
+
+namespace
+{
+const int Rate = 48000;
+const int BlockFrames = 256;
+
+// Feeds `seconds` of blocks from a clock running `ppm` off nominal, each arriving up to
+// `jitterNs` late, as a callback woken by the scheduler would
+void Feed(ClockDriftMonitor &monitor, double ppm, double seconds, qint64 jitterNs = 0, qint64 startNs = 0)
+{
+    const double trueRate = Rate * (1.0 + ppm * 1e-6);
+    const int blocks = static_cast<int>(seconds * trueRate / BlockFrames);
+    quint32 random = 12345;
+    for (int i = 1; i <= blocks; ++i)
+    {
+        random = random * 1664525u + 1013904223u;
+        const qint64 lateNs = jitterNs > 0 ? static_cast<qint64>(random >> 8) % jitterNs : 0;
+        monitor.addFrames(BlockFrames, startNs + static_cast<qint64>(i * BlockFrames / trueRate * 1e9) + lateNs);
+    }
+}
+}
+
+void TestClockDriftMonitor::testNominalClock()
+{
+    ClockDriftMonitor monitor;
+    monitor.reset(Rate);
+    QVERIFY(!monitor.isMeasured());
+    QCOMPARE(monitor.driftPpm(), 0.0);
+
+    Feed(monitor, 0.0, 10.0);
+    QVERIFY(monitor.isMeasured());
+    QVERIFY(qAbs(monitor.driftPpm()) < 0.5);
+}
+
+void TestClockDriftMonitor::testFastAndSlowClocks()
+{
+    ClockDriftMonitor fast;
+    fast.reset(Rate);
+    Feed(fast, 50.0, 10.0);
+    QVERIFY(qAbs(fast.driftPpm() - 50.0) < 0.5);
+
+    ClockDriftMonitor slow;
+    slow.reset(Rate);
+    Feed(slow, -120.0, 10.0);
+    QVERIFY(qAbs(slow.driftPpm() + 120.0) < 0.5);
+
+    // Starting over forgets the previous stream
+    slow.reset(Rate);
+    QVERIFY(!slow.isMeasured());
+    Feed(slow, 20.0, 10.0);
+    QVERIFY(qAbs(slow.driftPpm() - 20.0) < 0.5);
+}
+
+void TestClockDriftMonitor::testJitterAveragesOut()
+{
+    // Blocks arriving up to 2 ms late would swing a frames / elapsed ratio by hundreds of ppm
+    // early on; the fit over a minute of them stays within a few ppm
+    ClockDriftMonitor monitor;
+    monitor.reset(Rate);
+    Feed(monitor, 30.0, 60.0, 2000000);
+    QVERIFY(qAbs(monitor.driftPpm() - 30.0) < 3.0);
+}
+
+void TestClockDriftMonitor::testWarmupIsIgnored()
+{
+    // A start-up burst delivers a second of audio at once, then the clock runs true
+    ClockDriftMonitor monitor;
+    monitor.reset(Rate);
+    for (int i = 0; i < Rate / BlockFrames; ++i)
+    {
+        monitor.addFrames(BlockFrames, 1000000);
+    }
+    Feed(monitor, 0.0, 10.0, 0, 1000000);
+    QVERIFY(monitor.isMeasured());
+    QVERIFY(qAbs(monitor.driftPpm()) < 0.5);
+
+    // Nothing is published before the fit spans long enough
+    ClockDriftMonitor early;
+    early.reset(Rate);
+    Feed(early, 100.0, 2.5);
+    QVERIFY(!early.isMeasured());
+}
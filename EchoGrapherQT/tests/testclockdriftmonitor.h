@@ -0,0 +1,18 @@
+#ifndef TESTCLOCKDRIFTMONITOR_H
+#define TESTCLOCKDRIFTMONITOR_H
+
+#include <QtTest>
+#include "../clockdriftmonitor.h"
+
+class TestClockDriftMonitor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testNominalClock();
+    void testFastAndSlowClocks();
+    void testJitterAveragesOut();
+    void testWarmupIsIgnored();
+};
+
+#endif // TESTCLOCKDRIFTMONITOR_H
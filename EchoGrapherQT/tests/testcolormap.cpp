@@ -0,0 +1,64 @@
+#include "testcolormap.h"
+
+#include <QImage>
+#include <limits>
+
+void TestColormap::testTableEndpoints()
+{
+    Colormap colormap(Colormap::Classic);
+    QCOMPARE(colormap.table()[0], qRgb(0, 0, 128));
+    QCOMPARE(colormap.table()[Colormap::TableSize - 1], qRgb(255, 0, 0));
+
+    colormap.setPalette(Colormap::Grayscale);
+    QCOMPARE(colormap.palette(), Colormap::Grayscale);
+    QCOMPARE(colormap.table()[0], qRgb(0, 0, 0));
+    QCOMPARE(colormap.table()[Colormap::TableSize - 1], qRgb(255, 255, 255));
+
+    colormap.setPalette(Colormap::Viridis);
+    QCOMPARE(colormap.table()[Colormap::TableSize - 1], qRgb(0xfd, 0xe7, 0x25));
+}
+
+void TestColormap::testRangeAndClamping()
+{
+    Colormap colormap(Colormap::Grayscale);
+    colormap.setRange(-80.0f, 0.0f);
+
+    QCOMPARE(colormap.color(-80.0f), colormap.table()[0]);
+    QCOMPARE(colormap.color(0.0f), colormap.table()[Colormap::TableSize - 1]);
+    QCOMPARE(colormap.color(-40.0f), colormap.table()[(Colormap::TableSize - 1) / 2]);
+
+    // Out-of-range and invalid values clamp instead of reading past the table
+    QCOMPARE(colormap.color(-200.0f), colormap.table()[0]);
+    QCOMPARE(colormap.color(50.0f), colormap.table()[Colormap::TableSize - 1]);
+    QCOMPARE(colormap.color(std::numeric_limits<float>::quiet_NaN()), colormap.table()[0]);
+
+    // An empty range does not divide by zero
+    colormap.setRange(1.0f, 1.0f);
+    QVERIFY(colormap.maximum() > colormap.minimum());
+}
+
+void TestColormap::testMapColumn()
+{
+    Colormap colormap(Colormap::Magma);
+    QImage image(3, 4, QImage::Format_RGB32);
+    image.fill(Qt::black);
+
+    const float values[] = {0.0f, 1.0f};
+    const int rowBands[] = {1, 1, 0, 0};
+    colormap.mapColumn(values, 2, rowBands, 4, image.bits() + 2 * sizeof(QRgb), image.bytesPerLine());
+
+    // Only column 2 is written, one band per pair of rows
+    QCOMPARE(image.pixel(2, 0), colormap.color(1.0f));
+    QCOMPARE(image.pixel(2, 1), colormap.color(1.0f));
+    QCOMPARE(image.pixel(2, 2), colormap.color(0.0f));
+    QCOMPARE(image.pixel(2, 3), colormap.color(0.0f));
+    QCOMPARE(image.pixel(1, 0), qRgb(0, 0, 0));
+}
+
+void TestColormap::testPaletteNames()
+{
+    const QStringList names = Colormap::PaletteNames();
+    QCOMPARE(names.size(), 4);
+    QCOMPARE(names.at(Colormap::Viridis), QString("Viridis"));
+    QCOMPARE(Colormap::PaletteName(Colormap::Magma), QString("Magma"));
+}
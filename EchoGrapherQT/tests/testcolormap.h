@@ -0,0 +1,18 @@
+#ifndef TESTCOLORMAP_H
+#define TESTCOLORMAP_H
+
+#include <QtTest>
+#include "../colormap.h"
+
+class TestColormap : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testTableEndpoints();
+    void testRangeAndClamping();
+    void testMapColumn();
+    void testPaletteNames();
+};
+
+#endif // TESTCOLORMAP_H
@@ -0,0 +1,209 @@
+#include "testdspkernels.h"
+
+#include <QRandomGenerator>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// Lengths around every vector width, so both the SIMD bodies and the scalar tails run
+const int Lengths[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 33, 100, 257};
+
+// Every SIMD table this machine can run; the scalar table is the reference
+QVector<const DspKernels *> SimdVariants()
+{
+    QVector<const DspKernels *> variants;
+    for (DspKernels::Isa isa : {DspKernels::Sse2, DspKernels::Avx2, DspKernels::Avx512})
+    {
+        if (const DspKernels *kernels = DspKernels::ForIsa(isa))
+        {
+            variants.append(kernels);
+        }
+    }
+    return variants;
+}
+
+const DspKernels &Reference()
+{
+    return *DspKernels::ForIsa(DspKernels::Scalar);
+}
+
+QVector<float> RandomValues(int count, float low, float high)
+{
+    QVector<float> values(count);
+    for (float &value : values)
+    {
+        value = low + static_cast<float>(QRandomGenerator::global()->generateDouble()) * (high - low);
+    }
+    return values;
+}
+
+bool Close(float a, float b, float relative)
+{
+    return qAbs(a - b) <= relative * qMax(1.0f, qMax(qAbs(a), qAbs(b)));
+}
+}
+
+void TestDspKernels::testActiveIsSupported()
+{
+    const DspKernels &active = DspKernels::Active();
+    QVERIFY(DspKernels::Supported(active.isa));
+    QVERIFY(DspKernels::ForIsa(DspKernels::Scalar) != nullptr);
+    QCOMPARE(DspKernels::IsaName(DspKernels::Avx2), QString("AVX2"));
+}
+
+void TestDspKernels::testApplyWindow()
+{
+    for (const DspKernels *kernels : SimdVariants())
+    {
+        for (int length : Lengths)
+        {
+            const QVector<float> samples = RandomValues(length, -1.0f, 1.0f);
+            const QVector<float> window = RandomValues(length, 0.0f, 1.0f);
+            QVector<float> expected(length);
+            QVector<float> actual(length);
+            Reference().applyWindow(samples.constData(), window.constData(), expected.data(), length);
+            kernels->applyWindow(samples.constData(), window.constData(), actual.data(), length);
+            QVERIFY2(actual == expected, qPrintable(DspKernels::IsaName(kernels->isa)));
+        }
+    }
+}
+
+void TestDspKernels::testMagnitudeSquared()
+{
+    for (const DspKernels *kernels : SimdVariants())
+    {
+        for (int length : Lengths)
+        {
+            const QVector<float> bins = RandomValues(2 * length, -100.0f, 100.0f);
+            QVector<float> expected(length);
+            QVector<float> actual(length);
+            Reference().magnitudeSquared(bins.constData(), expected.data(), length);
+            kernels->magnitudeSquared(bins.constData(), actual.data(), length);
+            for (int i = 0; i < length; ++i)
+            {
+                QVERIFY2(Close(actual[i], expected[i], 1e-6f), qPrintable(DspKernels::IsaName(kernels->isa)));
+            }
+        }
+    }
+}
+
+void TestDspKernels::testDot()
+{
+    for (const DspKernels *kernels : SimdVariants())
+    {
+        for (int length : Lengths)
+        {
+            const QVector<float> a = RandomValues(length, 0.0f, 10.0f);
+            const QVector<float> b = RandomValues(length, 0.0f, 1.0f);
+            // Summation order differs between variants, so compare with a relative tolerance
+            QVERIFY2(Close(kernels->dot(a.constData(), b.constData(), length), Reference().dot(a.constData(), b.constData(), length), 1e-5f),
+                     qPrintable(DspKernels::IsaName(kernels->isa)));
+        }
+    }
+}
+
+void TestDspKernels::testWeightedPower()
+{
+    for (const DspKernels *kernels : SimdVariants())
+    {
+        for (int length : Lengths)
+        {
+            const QVector<float> bins = RandomValues(2 * length, -10.0f, 10.0f);
+            const QVector<float> weights = RandomValues(length, 0.0f, 1.0f);
+            QVERIFY2(Close(kernels->weightedPower(bins.constData(), weights.constData(), length),
+                           Reference().weightedPower(bins.constData(), weights.constData(), length), 1e-5f),
+                     qPrintable(DspKernels::IsaName(kernels->isa)));
+        }
+    }
+}
+
+void TestDspKernels::testLog()
+{
+    QVector<const DspKernels *> variants = SimdVariants();
+    variants.prepend(&Reference());
+    for (const DspKernels *kernels : variants)
+    {
+        for (int length : Lengths)
+        {
+            QVector<float> input = RandomValues(length, 0.0f, 1.0f);
+            for (int i = 0; i < length; ++i)
+            {
+                input[i] = std::ldexp(input[i] + 0.5f, i % 200 - 100); // Spread over many exponents
+            }
+            QVector<float> output(length);
+            kernels->log(input.constData(), output.data(), length);
+            for (int i = 0; i < length; ++i)
+            {
+                QVERIFY2(qAbs(output[i] - std::log(input[i])) < 1e-4f, qPrintable(DspKernels::IsaName(kernels->isa)));
+            }
+        }
+    }
+}
+
+void TestDspKernels::testDecibels()
+{
+    const float floorPower = 1e-8f; // -80 dB
+    for (const DspKernels *kernels : SimdVariants())
+    {
+        for (int length : Lengths)
+        {
+            QVector<float> expected = RandomValues(length, 0.0f, 1000.0f);
+            if (length > 2)
+            {
+                expected[1] = 0.0f;
+                expected[2] = std::numeric_limits<float>::quiet_NaN();
+            }
+            QVector<float> actual = expected;
+            float expectedMin = 0.0f, expectedMax = 0.0f, actualMin = 0.0f, actualMax = 0.0f;
+            Reference().decibels(expected.data(), length, floorPower, 3.0f, &expectedMin, &expectedMax);
+            kernels->decibels(actual.data(), length, floorPower, 3.0f, &actualMin, &actualMax);
+
+            for (int i = 0; i < length; ++i)
+            {
+                QVERIFY2(qAbs(actual[i] - expected[i]) < 1e-3f, qPrintable(DspKernels::IsaName(kernels->isa)));
+            }
+            if (length > 0)
+            {
+                QVERIFY(qAbs(actualMin - expectedMin) < 1e-3f);
+                QVERIFY(qAbs(actualMax - expectedMax) < 1e-3f);
+            }
+            if (length > 2)
+            {
+                QVERIFY(qAbs(actual[2] + 83.0f) < 1e-3f); // NaN lands on the floor
+            }
+        }
+    }
+}
+
+void TestDspKernels::testDeinterleave()
+{
+    QVector<const DspKernels *> variants = SimdVariants();
+    variants.prepend(&Reference());
+    for (const DspKernels *kernels : variants)
+    {
+        for (int channels : {1, 2, 3, 4, 8})
+        {
+            for (int length : Lengths)
+            {
+                const QVector<float> interleaved = RandomValues(length * channels, -1.0f, 1.0f);
+                QVector<QVector<float>> lanes(channels, QVector<float>(length));
+                QVector<float *> outputs;
+                for (QVector<float> &lane : lanes)
+                {
+                    outputs.append(lane.data());
+                }
+                kernels->deinterleave(interleaved.constData(), channels, length, outputs.constData());
+
+                // A pure copy, so exact
+                for (int c = 0; c < channels; ++c)
+                {
+                    for (int i = 0; i < length; ++i)
+                    {
+                        QCOMPARE(lanes[c][i], interleaved[i * channels + c]);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef TESTDSPKERNELS_H
+#define TESTDSPKERNELS_H
+
+#include <QtTest>
+#include "../dspkernels.h"
+
+class TestDspKernels : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testActiveIsSupported();
+    void testApplyWindow();
+    void testMagnitudeSquared();
+    void testDot();
+    void testWeightedPower();
+    void testLog();
+    void testDecibels();
+    void testDeinterleave();
+};
+
+#endif // TESTDSPKERNELS_H
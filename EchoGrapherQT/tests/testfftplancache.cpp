@@ -0,0 +1,80 @@
+#include "testfftplancache.h"
+#include <QTemporaryDir>
+#include <cmath>
+
+void TestFftPlanCache::testPlansAreCachedPerSize()
+{
+    FftPlanCache &cache = FftPlanCache::shared();
+
+    fftwf_plan first = cache.forwardPlan(512);
+    QVERIFY(first != nullptr);
+    QCOMPARE(cache.forwardPlan(512), first);               // Same size, same plan
+    QCOMPARE(cache.forwardPlan(512, FftPlanCache::Estimate), first);
+    QVERIFY(cache.forwardPlan(1024) != first);             // Different size, different plan
+    QVERIFY(cache.forwardPlan(0) == nullptr);
+}
+
+void TestFftPlanCache::testRealToComplexMatchesDft()
+{
+    const int size = 64;
+    fftwf_plan plan = FftPlanCache::shared().forwardPlan(size);
+    QVERIFY(plan != nullptr);
+
+    float *in = fftwf_alloc_real(size);
+    fftwf_complex *out = fftwf_alloc_complex(size / 2 + 1);
+    for (int i = 0; i < size; ++i)
+    {
+        in[i] = std::sin(2 * M_PI * 5 * i / size) + 0.25f * std::cos(2 * M_PI * 12 * i / size);
+    }
+
+    fftwf_execute_dft_r2c(plan, in, out);
+
+    // Compare every bin against a direct DFT of the same input
+    for (int k = 0; k <= size / 2; ++k)
+    {
+        double re = 0.0, im = 0.0;
+        for (int n = 0; n < size; ++n)
+        {
+            re += in[n] * std::cos(2 * M_PI * k * n / size);
+            im -= in[n] * std::sin(2 * M_PI * k * n / size);
+        }
+        QVERIFY(qAbs(out[k][0] - re) < 1e-3);
+        QVERIFY(qAbs(out[k][1] - im) < 1e-3);
+    }
+
+    fftwf_free(in);
+    fftwf_free(out);
+}
+
+void TestFftPlanCache::testWisdomRoundTrip()
+{
+    FftPlanCache &cache = FftPlanCache::shared();
+    const QString previousPath = cache.wisdomPath();
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("config/fftw-wisdom.dat");
+
+    cache.setWisdomPath(path);
+    QCOMPARE(cache.wisdomPath(), path);
+
+    // A measured plan is saved straight away so the next run can skip the measurement
+    QVERIFY(cache.forwardPlan(256, FftPlanCache::Measure) != nullptr);
+    QVERIFY(QFileInfo::exists(path));
+    QVERIFY(cache.loadWisdom());
+
+    cache.setWisdomPath(previousPath);
+}
+
+void TestFftPlanCache::testRigorFromName()
+{
+    FftPlanCache::PlanRigor rigor = FftPlanCache::Estimate;
+    QVERIFY(FftPlanCache::RigorFromName("measure", &rigor));
+    QCOMPARE(rigor, FftPlanCache::Measure);
+    QVERIFY(FftPlanCache::RigorFromName("Patient", &rigor));
+    QCOMPARE(rigor, FftPlanCache::Patient);
+    QVERIFY(FftPlanCache::RigorFromName("estimate", &rigor));
+    QCOMPARE(rigor, FftPlanCache::Estimate);
+    QVERIFY(!FftPlanCache::RigorFromName("exhaustive", &rigor));
+    QCOMPARE(rigor, FftPlanCache::Estimate); // Left alone
+}
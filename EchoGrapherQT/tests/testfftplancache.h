@@ -0,0 +1,18 @@
+#ifndef TESTFFTPLANCACHE_H
+#define TESTFFTPLANCACHE_H
+
+#include <QtTest>
+#include "../fftplancache.h"
+
+class TestFftPlanCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testPlansAreCachedPerSize();
+    void testRealToComplexMatchesDft();
+    void testWisdomRoundTrip();
+    void testRigorFromName();
+};
+
+#endif // TESTFFTPLANCACHE_H
@@ -0,0 +1,102 @@
+#include "testfixedframeprocessor.h"
+
+#include <cmath>
+
+namespace
+{
+// Number of filters whose range, offset or weights differ from MelFilterbank
+template <int N, int Bands, int SampleRate>
+int LayoutMismatches()
+{
+    using Fixed = FixedFrameProcessor<N, Bands, SampleRate>;
+    using Layout = FixedTables::MelLayout<N, Bands, SampleRate>;
+    const MelFilterbank generic(N, Bands, SampleRate);
+
+    if (generic.weights().size() != Layout::WeightCount)
+    {
+        return Bands;
+    }
+    int mismatches = 0;
+    for (int f = 0; f < Bands; ++f)
+    {
+        const MelFilterbank::FilterRange &range = generic.filterRanges()[f];
+        bool same = range.startBin == Layout::Edges[f] && range.endBin == Layout::Edges[f + 2] && range.offset == Fixed::Offsets[f];
+        for (int w = range.offset; same && w < range.offset + range.endBin - range.startBin; ++w)
+        {
+            same = generic.weights()[w] == Fixed::Weights[w];
+        }
+        mismatches += same ? 0 : 1;
+    }
+    return mismatches;
+}
+
+template <int N>
+int LayoutMismatchesForWindow()
+{
+    return LayoutMismatches<N, 20, 44100>() + LayoutMismatches<N, 40, 44100>() + LayoutMismatches<N, 64, 44100>() +
+           LayoutMismatches<N, 80, 44100>() + LayoutMismatches<N, 128, 44100>() + LayoutMismatches<N, 20, 48000>() +
+           LayoutMismatches<N, 40, 48000>() + LayoutMismatches<N, 64, 48000>() + LayoutMismatches<N, 80, 48000>() +
+           LayoutMismatches<N, 128, 48000>();
+}
+}
+
+void TestFixedFrameProcessor::testLayoutsMatchGenericFilterbank()
+{
+    // The compile-time tables must reproduce the runtime filterbank bin for bin
+    QCOMPARE(LayoutMismatchesForWindow<256>(), 0);
+    QCOMPARE(LayoutMismatchesForWindow<512>(), 0);
+    QCOMPARE(LayoutMismatchesForWindow<1024>(), 0);
+    QCOMPARE(LayoutMismatchesForWindow<2048>(), 0);
+    QCOMPARE(LayoutMismatchesForWindow<4096>(), 0);
+}
+
+void TestFixedFrameProcessor::testWindowMatchesGeneric()
+{
+    FrameProcessor generic(1024, 40, 44100);
+    const std::array<float, 1024> &window = FixedFrameProcessor<1024, 40, 44100>::Window;
+    for (int i = 0; i < 1024; ++i)
+    {
+        QVERIFY(qAbs(window[i] - generic.window()[i]) < 1e-6f);
+    }
+}
+
+void TestFixedFrameProcessor::testOutputMatchesGeneric()
+{
+    for (int windowSize : FixedWindowSizes)
+    {
+        for (int bands : FixedBandCounts)
+        {
+            FrameProcessor generic(windowSize, bands, 48000);
+            std::unique_ptr<FrameProcessor> fixed = FrameProcessor::Create(windowSize, bands, 48000);
+            QVERIFY(fixed->isSpecialized());
+            QCOMPARE(fixed->numMelFilters(), bands);
+
+            QVector<float> samples(windowSize);
+            for (int i = 0; i < windowSize; ++i)
+            {
+                samples[i] = std::sin(0.05f * i) + 0.3f * std::sin(0.9f * i);
+            }
+            QVector<float> expected(bands);
+            QVector<float> actual(bands);
+            generic.processSamples(samples.constData(), expected.data());
+            fixed->processSamples(samples.constData(), actual.data());
+            for (int band = 0; band < bands; ++band)
+            {
+                QVERIFY(qAbs(actual[band] - expected[band]) < 0.01f); // dB
+            }
+        }
+    }
+}
+
+void TestFixedFrameProcessor::testCreateFallsBack()
+{
+    // Anything off the preset grid takes the generic path
+    std::unique_ptr<FrameProcessor> offGrid = FrameProcessor::Create(600, 25, 44100);
+    QVERIFY(!offGrid->isSpecialized());
+    QVERIFY(offGrid->isValid());
+    QCOMPARE(offGrid->windowSize(), 600);
+    QCOMPARE(offGrid->numMelFilters(), 25);
+
+    QVERIFY(!FrameProcessor::Create(512, 40, 22050)->isSpecialized());
+    QVERIFY(FrameProcessor::Create(512, 40, 44100)->isSpecialized());
+}
@@ -0,0 +1,18 @@
+#ifndef TESTFIXEDFRAMEPROCESSOR_H
+#define TESTFIXEDFRAMEPROCESSOR_H
+
+#include <QtTest>
+#include "../fixedframeprocessor.h"
+
+class TestFixedFrameProcessor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testLayoutsMatchGenericFilterbank();
+    void testWindowMatchesGeneric();
+    void testOutputMatchesGeneric();
+    void testCreateFallsBack();
+};
+
+#endif // TESTFIXEDFRAMEPROCESSOR_H
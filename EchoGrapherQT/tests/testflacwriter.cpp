@@ -0,0 +1,175 @@
+#include "testflacwriter.h"
+#include "../wavwriter.h"
+
+#include <QTemporaryDir>
+#include <cmath>
+#include <limits>
+
+#ifdef ECHOGRAPHER_FLAC
+#include <FLAC/stream_decoder.h>
+
+namespace
+{
+// Collects the interleaved samples of a whole FLAC file
+struct DecodedFlac
+{
+    unsigned channels = 0;
+    unsigned bitsPerSample = 0;
+    unsigned sampleRate = 0;
+    QVector<qint32> samples;
+};
+
+FLAC__StreamDecoderWriteStatus DecodeWrite(const FLAC__StreamDecoder *, const FLAC__Frame *frame,
+                                           const FLAC__int32 *const buffer[], void *clientData)
+{
+    DecodedFlac &decoded = *static_cast<DecodedFlac *>(clientData);
+    for (unsigned i = 0; i < frame->header.blocksize; ++i)
+    {
+        for (unsigned c = 0; c < frame->header.channels; ++c)
+        {
+            decoded.samples.append(buffer[c][i]);
+        }
+    }
+    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+void DecodeMetadata(const FLAC__StreamDecoder *, const FLAC__StreamMetadata *metadata, void *clientData)
+{
+    if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO)
+    {
+        DecodedFlac &decoded = *static_cast<DecodedFlac *>(clientData);
+        decoded.channels = metadata->data.stream_info.channels;
+        decoded.bitsPerSample = metadata->data.stream_info.bits_per_sample;
+        decoded.sampleRate = metadata->data.stream_info.sample_rate;
+    }
+}
+
+void DecodeError(const FLAC__StreamDecoder *, FLAC__StreamDecoderErrorStatus, void *)
+{
+}
+
+bool Decode(const QString &path, DecodedFlac *decoded)
+{
+    FLAC__StreamDecoder *decoder = FLAC__stream_decoder_new();
+    const QByteArray name = path.toLocal8Bit();
+    bool ok = FLAC__stream_decoder_init_file(decoder, name.constData(), DecodeWrite, DecodeMetadata, DecodeError,
+                                             decoded) == FLAC__STREAM_DECODER_INIT_STATUS_OK;
+    ok = ok && FLAC__stream_decoder_process_until_end_of_stream(decoder);
+    FLAC__stream_decoder_delete(decoder);
+    return ok;
+}
+}
+#endif
+
+void TestFlacWriter::testQuantiseRoundsAndClips()
+{
+    const float samples[] = {0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 1.4f / 32768.0f,
+                             std::numeric_limits<float>::quiet_NaN()};
+    qint32 out[9];
+    FlacWriter::Quantise(samples, 9, 16, out);
+    QCOMPARE(out[0], 0);
+    QCOMPARE(out[1], 16384);
+    QCOMPARE(out[2], -16384);
+    QCOMPARE(out[3], 32767); // Full scale clips to the largest code
+    QCOMPARE(out[4], -32768);
+    QCOMPARE(out[5], 32767);
+    QCOMPARE(out[6], -32768);
+    QCOMPARE(out[7], 1); // Rounded, not truncated
+    QVERIFY(out[8] >= -32768 && out[8] <= 32767);
+
+    FlacWriter::Quantise(samples, 5, 24, out);
+    QCOMPARE(out[1], 1 << 22);
+    QCOMPARE(out[3], (1 << 23) - 1);
+    QCOMPARE(out[4], -(1 << 23));
+}
+
+void TestFlacWriter::testCreatePicksFormat()
+{
+    std::unique_ptr<RecordingWriter> wav = RecordingWriter::Create(RecordingWriter::Wav);
+    QVERIFY(dynamic_cast<WavWriter *>(wav.get()) != nullptr);
+    QCOMPARE(wav->fileExtension(), QString(".wav"));
+
+    std::unique_ptr<RecordingWriter> flac = RecordingWriter::Create(RecordingWriter::Flac, 16);
+    FlacWriter *flacWriter = dynamic_cast<FlacWriter *>(flac.get());
+    QVERIFY(flacWriter != nullptr);
+    QCOMPARE(flacWriter->bitDepth(), 16);
+    QCOMPARE(flac->fileExtension(), QString(".flac"));
+    QCOMPARE(FlacWriter(32).bitDepth(), int(FlacWriter::MaxBitDepth));
+
+    RecordingWriter::Format format = RecordingWriter::Wav;
+    QVERIFY(RecordingWriter::FormatFromName("FLAC", &format));
+    QCOMPARE(format, RecordingWriter::Flac);
+    QVERIFY(!RecordingWriter::FormatFromName("mp3", &format));
+    QVERIFY(RecordingWriter::IsAvailable(RecordingWriter::Wav));
+}
+
+void TestFlacWriter::testLosslessRoundTrip()
+{
+#ifndef ECHOGRAPHER_FLAC
+    QSKIP("Built without libFLAC");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("writer.flac");
+
+    // Two channels of a quiet tone in blocks that do not line up with the encoder's blocks
+    const int channels = 2;
+    const int blockFrames = 300;
+    const int blocks = 50;
+    FlacWriter writer(16);
+    QVERIFY(writer.open(path, 48000, channels));
+    QVector<float> all;
+    QVector<float> block(blockFrames * channels);
+    for (int b = 0; b < blocks; ++b)
+    {
+        for (int i = 0; i < blockFrames; ++i)
+        {
+            const double t = (b * blockFrames + i) / 48000.0;
+            block[i * channels] = 0.25f * std::sin(2 * M_PI * 440.0 * t);
+            block[i * channels + 1] = 0.1f * std::sin(2 * M_PI * 1000.0 * t);
+        }
+        QVERIFY(writer.write(block.constData(), block.size()));
+        all.append(block);
+    }
+    writer.close();
+    QCOMPARE(writer.samplesWritten(), qint64(all.size()));
+    QCOMPARE(writer.backlogSamples(), qint64(0));
+    QVERIFY(writer.errorString().isEmpty());
+
+    // Far smaller than the float WAV it replaces
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.read(4), QByteArray("fLaC"));
+    QVERIFY(file.size() < qint64(all.size() * sizeof(float)) / 3);
+    file.close();
+
+    // Bit for bit the quantised input
+    DecodedFlac decoded;
+    QVERIFY(Decode(path, &decoded));
+    QCOMPARE(decoded.channels, 2u);
+    QCOMPARE(decoded.bitsPerSample, 16u);
+    QCOMPARE(decoded.sampleRate, 48000u);
+    QVector<qint32> expected(all.size());
+    FlacWriter::Quantise(all.constData(), all.size(), 16, expected.data());
+    QCOMPARE(decoded.samples, expected);
+#endif
+}
+
+void TestFlacWriter::testUnavailableWithoutLibFlac()
+{
+#ifdef ECHOGRAPHER_FLAC
+    QVERIFY(FlacWriter::IsAvailable());
+    QSKIP("Built with libFLAC");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(!FlacWriter::IsAvailable());
+    QVERIFY(!RecordingWriter::IsAvailable(RecordingWriter::Flac));
+
+    // Fails cleanly, with a reason, instead of writing a file nothing can play
+    FlacWriter writer;
+    QVERIFY(!writer.open(dir.filePath("writer.flac"), 48000, 1));
+    QVERIFY(!writer.isOpen());
+    QVERIFY(!writer.errorString().isEmpty());
+#endif
+}
@@ -0,0 +1,18 @@
+#ifndef TESTFLACWRITER_H
+#define TESTFLACWRITER_H
+
+#include <QtTest>
+#include "../flacwriter.h"
+
+class TestFlacWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testQuantiseRoundsAndClips();
+    void testCreatePicksFormat();
+    void testLosslessRoundTrip();
+    void testUnavailableWithoutLibFlac();
+};
+
+#endif // TESTFLACWRITER_H
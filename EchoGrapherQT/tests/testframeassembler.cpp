@@ -0,0 +1,105 @@
+#include "testframeassembler.h"
+
+void TestFrameAssembler::testConfigure()
+{
+    FrameAssembler assembler(512, 256);
+    QCOMPARE(assembler.windowSize(), 512);
+    QCOMPARE(assembler.hopSize(), 256);
+    QCOMPARE(assembler.capacity(), 1024);
+    QCOMPARE(assembler.freeSpace(), 1024);
+    QVERIFY(!assembler.frameReady());
+
+    // A hop larger than the window is clamped so no sample is skipped
+    assembler.configure(100, 500);
+    QCOMPARE(assembler.hopSize(), 100);
+}
+
+void TestFrameAssembler::testFramesFollowHop()
+{
+    const int windowSize = 8;
+    const int hopSize = 2;
+    FrameAssembler assembler(windowSize, hopSize);
+
+    QVector<float> ramp(12);
+    for (int i = 0; i < ramp.size(); ++i)
+    {
+        ramp[i] = i;
+    }
+    QVector<float> window(windowSize, 1.0f);
+    window[0] = 0.5f;
+    QVector<float> frame(windowSize);
+
+    QCOMPARE(assembler.write(ramp.constData(), ramp.size()), ramp.size());
+
+    // (12 - 8) / 2 + 1 frames fit in the buffered samples
+    int frames = 0;
+    while (assembler.nextFrame(window.constData(), frame.data()))
+    {
+        QCOMPARE(frame[0], 0.5f * frames * hopSize);
+        for (int i = 1; i < windowSize; ++i)
+        {
+            QCOMPARE(frame[i], static_cast<float>(frames * hopSize + i));
+        }
+        ++frames;
+    }
+    QCOMPARE(frames, 3);
+    QCOMPARE(assembler.nextFramePosition(), qint64(6));
+}
+
+void TestFrameAssembler::testFramesWrapAroundStorage()
+{
+    const int windowSize = 4;
+    FrameAssembler assembler(windowSize, 3);
+    QCOMPARE(assembler.capacity(), 8);
+
+    QVector<float> window(windowSize, 1.0f);
+    QVector<float> frame(windowSize);
+    float next = 0.0f;
+    float expectedStart = 0.0f;
+
+    // Keep the stream going long enough to wrap the 8-sample storage several times
+    for (int round = 0; round < 20; ++round)
+    {
+        float chunk[3] = {next, next + 1, next + 2};
+        next += 3;
+        QCOMPARE(assembler.write(chunk, 3), 3);
+
+        while (assembler.nextFrame(window.constData(), frame.data()))
+        {
+            for (int i = 0; i < windowSize; ++i)
+            {
+                QCOMPARE(frame[i], expectedStart + i);
+            }
+            expectedStart += 3;
+        }
+    }
+    QVERIFY(expectedStart > 40.0f);
+}
+
+void TestFrameAssembler::testPullFromRing()
+{
+    SpscRingBuffer<float> ring(64);
+    QVector<float> samples(40);
+    for (int i = 0; i < samples.size(); ++i)
+    {
+        samples[i] = i;
+    }
+    QVERIFY(ring.push(samples.constData(), samples.size()));
+
+    // Only as much as fits is taken, the rest stays in the ring for the next pull
+    FrameAssembler assembler(16, 16);
+    QCOMPARE(assembler.pull(ring), 32);
+    QCOMPARE(ring.readAvailable(), 8);
+
+    QVector<float> window(16, 1.0f);
+    QVector<float> frame(16);
+    QVERIFY(assembler.nextFrame(window.constData(), frame.data()));
+    QCOMPARE(assembler.pull(ring), 8);
+    QVERIFY(assembler.nextFrame(window.constData(), frame.data()));
+    QCOMPARE(frame[0], 16.0f);
+    QCOMPARE(frame[15], 31.0f);
+
+    // Samples 32..39 are buffered but do not make a whole frame yet
+    QCOMPARE(assembler.bufferedSamples(), 8);
+    QVERIFY(!assembler.nextFrame(window.constData(), frame.data()));
+}
@@ -0,0 +1,18 @@
+#ifndef TESTFRAMEASSEMBLER_H
+#define TESTFRAMEASSEMBLER_H
+
+#include <QtTest>
+#include "../frameassembler.h"
+
+class TestFrameAssembler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testConfigure();
+    void testFramesFollowHop();
+    void testFramesWrapAroundStorage();
+    void testPullFromRing();
+};
+
+#endif // TESTFRAMEASSEMBLER_H
@@ -0,0 +1,96 @@
+#include "testframeprocessor.h"
+
+#include <cmath>
+
+namespace
+{
+QVector<float> Sine(int size, float frequency, int sampleRate)
+{
+    QVector<float> samples(size);
+    for (int i = 0; i < size; ++i)
+    {
+        samples[i] = std::sin(2 * M_PI * frequency * i / sampleRate);
+    }
+    return samples;
+}
+}
+
+void TestFrameProcessor::testFusedMelMatchesPowerSpectrum()
+{
+    const int windowSize = 512;
+    const int sampleRate = 16000;
+    FrameProcessor processor(windowSize, 20, sampleRate);
+    QVERIFY(processor.isValid());
+
+    const QVector<float> samples = Sine(windowSize, 1000.0f, sampleRate);
+    QVector<float> fused(20);
+    for (int i = 0; i < windowSize; ++i)
+    {
+        processor.input()[i] = samples[i] * processor.window()[i];
+    }
+    processor.processLinear(fused.data());
+
+    // Reference: explicit power spectrum, then the filterbank
+    QVector<float> power(windowSize / 2);
+    FrameProcessor::PowerSpectrum(processor.spectrum(), windowSize / 2, power.data());
+    QVector<float> reference(20);
+    MelFilterbank(windowSize, 20, sampleRate).apply(power.constData(), reference.data());
+
+    for (int band = 0; band < 20; ++band)
+    {
+        QVERIFY(qAbs(fused[band] - reference[band]) <= 1e-4f * qMax(1.0f, reference[band]));
+    }
+}
+
+void TestFrameProcessor::testDecibelOutput()
+{
+    const int windowSize = 512;
+    const int sampleRate = 16000;
+    FrameProcessor processor(windowSize, 20, sampleRate);
+    processor.scale().setFloorDb(-100.0f);
+
+    const QVector<float> samples = Sine(windowSize, 1000.0f, sampleRate);
+    QVector<float> linear(20);
+    QVector<float> decibels(20);
+    processor.processSamples(samples.constData(), decibels.data());
+    for (int i = 0; i < windowSize; ++i)
+    {
+        processor.input()[i] = samples[i] * processor.window()[i];
+    }
+    processor.processLinear(linear.data());
+
+    for (int band = 0; band < 20; ++band)
+    {
+        const float expected = qMax(10.0f * std::log10(qMax(linear[band], 1e-30f)), -100.0f);
+        QVERIFY(qAbs(decibels[band] - expected) < 0.01f);
+    }
+}
+
+void TestFrameProcessor::testTransformCallerBuffer()
+{
+    const int windowSize = 512;
+    const int sampleRate = 16000;
+    FrameProcessor processor(windowSize, 20, sampleRate);
+    QVERIFY(processor.isValid());
+
+    const QVector<float> samples = Sine(windowSize, 1000.0f, sampleRate);
+    float *buffer = fftwf_alloc_real(windowSize); // Aligned like the processor's own input
+    for (int i = 0; i < windowSize; ++i)
+    {
+        buffer[i] = samples[i] * processor.window()[i];
+        processor.input()[i] = buffer[i];
+    }
+    QVector<float> reference(20);
+    processor.processLinear(reference.data());
+
+    // The same frame transformed where it lies, which stays untouched
+    QVector<float> direct(20);
+    processor.transform(buffer);
+    processor.linearMelFromSpectrum(direct.data());
+    QCOMPARE(direct, reference);
+    for (int i = 0; i < windowSize; ++i)
+    {
+        QCOMPARE(buffer[i], samples[i] * processor.window()[i]);
+    }
+    fftwf_free(buffer);
+}
@@ -0,0 +1,17 @@
+#ifndef TESTFRAMEPROCESSOR_H
+#define TESTFRAMEPROCESSOR_H
+
+#include <QtTest>
+#include "../frameprocessor.h"
+
+class TestFrameProcessor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFusedMelMatchesPowerSpectrum();
+    void testDecibelOutput();
+    void testTransformCallerBuffer();
+};
+
+#endif // TESTFRAMEPROCESSOR_H
@@ -0,0 +1,156 @@
+#include "testframeworkerpool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// A chirp, so every frame has a different spectrum and a swapped pair would show
+QVector<float> Chirp(int size, int sampleRate)
+{
+    QVector<float> samples(size);
+    for (int i = 0; i < size; ++i)
+    {
+        const double t = static_cast<double>(i) / sampleRate;
+        samples[i] = std::sin(2 * M_PI * (200.0 + 2000.0 * t) * t);
+    }
+    return samples;
+}
+
+// Runs every hop of `samples` through the pool and returns the linear mel energies in the order
+// they were taken back, checking the positions along the way
+QVector<float> RunPool(FrameWorkerPool &pool, const FrameProcessor &reference, const QVector<float> &samples,
+                       int hopSize, int bands)
+{
+    const int windowSize = reference.windowSize();
+    const int frames = (samples.size() - windowSize) / hopSize + 1;
+    QVector<float> result;
+    int next = 0;
+    int taken = 0;
+    while (taken < frames)
+    {
+        float *input = nullptr;
+        while (next < frames && (input = pool.nextInput()) != nullptr)
+        {
+            for (int i = 0; i < windowSize; ++i)
+            {
+                input[i] = samples[next * hopSize + i] * reference.window()[i];
+            }
+            pool.submit(qint64(next) * hopSize);
+            ++next;
+        }
+
+        qint64 position = 0;
+        float *mel = nullptr;
+        if (!pool.takeCompleted(&position, &mel))
+        {
+            pool.waitForOldest();
+            continue;
+        }
+        if (position != qint64(taken) * hopSize)
+        {
+            return {}; // Out of order
+        }
+        result.append(QVector<float>(mel, mel + bands));
+        pool.release();
+        ++taken;
+    }
+    return result;
+}
+}
+
+void TestFrameWorkerPool::testMatchesSequentialProcessor()
+{
+    const int windowSize = 1024;
+    const int hopSize = 256;
+    const int bands = 40;
+    const int sampleRate = 44100;
+    const QVector<float> samples = Chirp(sampleRate, sampleRate);
+
+    FrameProcessor reference(windowSize, bands, sampleRate);
+    FrameWorkerPool pool;
+    QVERIFY(pool.start(windowSize, bands, sampleRate, FftPlanCache::Estimate, 4));
+    QCOMPARE(pool.threadCount(), 4);
+
+    const QVector<float> parallel = RunPool(pool, reference, samples, hopSize, bands);
+    const int frames = (samples.size() - windowSize) / hopSize + 1;
+    QCOMPARE(parallel.size(), frames * bands);
+
+    QVector<float> expected(bands);
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        for (int i = 0; i < windowSize; ++i)
+        {
+            reference.input()[i] = samples[frame * hopSize + i] * reference.window()[i];
+        }
+        reference.processLinear(expected.data());
+        for (int band = 0; band < bands; ++band)
+        {
+            const float value = parallel[frame * bands + band];
+            QVERIFY(qAbs(value - expected[band]) <= 1e-5f * qMax(1.0f, expected[band]));
+        }
+    }
+    QCOMPARE(pool.inFlight(), 0);
+}
+
+void TestFrameWorkerPool::testSlotsBoundFramesInFlight()
+{
+    FrameWorkerPool pool;
+    QVERIFY(pool.start(512, 20, 16000, FftPlanCache::Estimate, 2, 3));
+    QCOMPARE(pool.slotCount(), 6);
+
+    // Nothing is taken back, so the producer runs out of slots and has to wait for the oldest
+    for (int i = 0; i < pool.slotCount(); ++i)
+    {
+        float *input = pool.nextInput();
+        QVERIFY(input != nullptr);
+        std::fill_n(input, 512, 0.0f);
+        pool.submit(i);
+    }
+    QVERIFY(pool.nextInput() == nullptr);
+    QCOMPARE(pool.inFlight(), 6);
+
+    pool.waitForOldest();
+    qint64 position = -1;
+    float *mel = nullptr;
+    QVERIFY(pool.takeCompleted(&position, &mel));
+    QCOMPARE(position, qint64(0));
+    pool.release();
+    QVERIFY(pool.nextInput() != nullptr);
+    QCOMPARE(pool.inFlight(), 5);
+}
+
+void TestFrameWorkerPool::testSingleWorker()
+{
+    const int sampleRate = 16000;
+    const QVector<float> samples = Chirp(sampleRate / 2, sampleRate);
+    FrameProcessor reference(512, 20, sampleRate);
+
+    FrameWorkerPool pool;
+    QVERIFY(pool.start(512, 20, sampleRate, FftPlanCache::Estimate, 1));
+    const QVector<float> result = RunPool(pool, reference, samples, 128, 20);
+    QCOMPARE(result.size(), ((samples.size() - 512) / 128 + 1) * 20);
+    QCOMPARE(pool.stolenFrames(), quint64(0)); // Nobody to steal from
+}
+
+void TestFrameWorkerPool::testRestart()
+{
+    const int sampleRate = 16000;
+    const QVector<float> samples = Chirp(sampleRate / 4, sampleRate);
+    FrameProcessor small(256, 16, sampleRate);
+    FrameProcessor large(1024, 32, sampleRate);
+
+    // Frames left in flight are dropped by stop(), and a new layout starts from scratch
+    FrameWorkerPool pool;
+    QVERIFY(pool.start(256, 16, sampleRate, FftPlanCache::Estimate, 3));
+    std::fill_n(pool.nextInput(), 256, 0.0f);
+    pool.submit(0);
+    pool.stop();
+    QCOMPARE(pool.threadCount(), 0);
+    QCOMPARE(pool.inFlight(), 0);
+
+    QVERIFY(pool.start(1024, 32, sampleRate, FftPlanCache::Estimate, 3));
+    QCOMPARE(RunPool(pool, large, samples, 512, 32).size(), ((samples.size() - 1024) / 512 + 1) * 32);
+    QVERIFY(pool.start(256, 16, sampleRate, FftPlanCache::Estimate, 2));
+    QCOMPARE(RunPool(pool, small, samples, 64, 16).size(), ((samples.size() - 256) / 64 + 1) * 16);
+}
@@ -0,0 +1,18 @@
+#ifndef TESTFRAMEWORKERPOOL_H
+#define TESTFRAMEWORKERPOOL_H
+
+#include <QtTest>
+#include "../frameworkerpool.h"
+
+class TestFrameWorkerPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testMatchesSequentialProcessor();
+    void testSlotsBoundFramesInFlight();
+    void testSingleWorker();
+    void testRestart();
+};
+
+#endif // TESTFRAMEWORKERPOOL_H
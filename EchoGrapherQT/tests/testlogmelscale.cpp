@@ -0,0 +1,71 @@
+#include "testlogmelscale.h"
+
+#include <cmath>
+#include <limits>
+
+void TestLogMelScale::testFastLogAccuracy()
+{
+    // Covers the vector body and the scalar tail, across the whole normal float range
+    QVector<float> input;
+    for (float x = 1e-30f; x < 1e30f; x *= 1.37f)
+    {
+        input.append(x);
+    }
+    input.append(1.0f);
+    input.append(1.4142135f);
+    QVector<float> output(input.size());
+
+    LogMelScale::FastLog(input.constData(), output.data(), input.size());
+
+    for (int i = 0; i < input.size(); ++i)
+    {
+        QVERIFY2(qAbs(output[i] - std::log(input[i])) < 1e-4f, qPrintable(QString::number(input[i])));
+    }
+}
+
+void TestLogMelScale::testDecibelsFloorAndReference()
+{
+    LogMelScale scale(-60.0f, 1.0f);
+    float values[] = {0.0f, 1e-9f, 1.0f, 100.0f, std::numeric_limits<float>::quiet_NaN()};
+    scale.apply(values, 5);
+
+    // Silence, values under the floor and invalid input all land on the floor
+    QVERIFY(qAbs(values[0] + 60.0f) < 1e-3f);
+    QVERIFY(qAbs(values[1] + 60.0f) < 1e-3f);
+    QVERIFY(qAbs(values[4] + 60.0f) < 1e-3f);
+    QVERIFY(qAbs(values[2]) < 1e-3f);
+    QVERIFY(qAbs(values[3] - 20.0f) < 1e-3f);
+
+    // The reference level is 0 dB
+    scale.setReferencePower(100.0f);
+    float loud = 100.0f;
+    scale.apply(&loud, 1);
+    QVERIFY(qAbs(loud) < 1e-3f);
+}
+
+void TestLogMelScale::testRunningNormalization()
+{
+    LogMelScale scale(-80.0f, 1.0f, true, 1.0f);
+    float frame[] = {1e-4f, 1e-2f, 1.0f};
+    scale.apply(frame, 3);
+
+    // -40, -20 and 0 dB spread over [0, 1]
+    QVERIFY(qAbs(frame[0]) < 1e-4f);
+    QVERIFY(qAbs(frame[1] - 0.5f) < 1e-4f);
+    QVERIFY(qAbs(frame[2] - 1.0f) < 1e-4f);
+    QVERIFY(qAbs(scale.runningMinDb() + 40.0f) < 1e-3f);
+    QVERIFY(qAbs(scale.runningMaxDb()) < 1e-3f);
+
+    // A quieter frame keeps the old maximum, which only relaxes by the release per frame
+    float quiet[] = {1e-4f, 1e-4f, 1e-2f};
+    scale.apply(quiet, 3);
+    QVERIFY(qAbs(scale.runningMaxDb() + 1.0f) < 1e-3f);
+    QVERIFY(quiet[2] < 0.6f);
+
+    // Near-silence is never stretched over less than MinimumRangeDb
+    scale.reset();
+    float flat[] = {1e-6f, 1e-6f};
+    scale.apply(flat, 2);
+    QVERIFY(qAbs(flat[0] - 1.0f) < 1e-4f);
+    QCOMPARE(scale.runningMinDb(), scale.runningMaxDb());
+}
@@ -0,0 +1,17 @@
+#ifndef TESTLOGMELSCALE_H
+#define TESTLOGMELSCALE_H
+
+#include <QtTest>
+#include "../logmelscale.h"
+
+class TestLogMelScale : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFastLogAccuracy();
+    void testDecibelsFloorAndReference();
+    void testRunningNormalization();
+};
+
+#endif // TESTLOGMELSCALE_H
@@ -1,6 +1,11 @@
 #include "testmainwindow.h"
+#include "../spectrogrambrowser.h"
+#include "../spectrogramrenderer.h"
+#include "../spectrogramtiles.h"
+#include "../syntheticsource.h"
 #include "qgraphicsview.h"
 #include "qpushbutton.h"
+#include <QComboBox>
 #include <QGraphicsRectItem>
 #include <QLinearGradient>
 #include <QFileDialog>
@@ -8,6 +13,7 @@
 #include <QSignalSpy>
 #include <QLineEdit>
 #include <QSlider>
+#include <QTemporaryDir>
 #include <QTimer>
 #include <QLabel>
 #include <QTest>
@@ -37,6 +43,32 @@ void TestMainWindow::testStartStopProcessing()
     QCOMPARE(stopSpy.count(), 1);  // Verify that processing has stopped
 }
 
+void TestMainWindow::testFailedStartStaysStopped()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    MainWindow mainWindow;
+    mainWindow.setOutputPath(dir.filePath("missing")); // No such directory, so the recording cannot be opened
+    SyntheticSource::Settings settings;
+    mainWindow.setAudioSource(std::unique_ptr<AudioSource>(new SyntheticSource(settings)));
+
+    // Dismiss the error box once it is up
+    QTimer::singleShot(0, []()
+                       {
+                           if (QWidget *box = QApplication::activeModalWidget())
+                           {
+                               box->close();
+                           }
+                       });
+    mainWindow.startProcessing();
+
+    // The window never switches to running, so there is no run to stop or export
+    QVERIFY(mainWindow.findChild<QPushButton *>("startButton")->isEnabled());
+    QVERIFY(!mainWindow.findChild<QPushButton *>("stopButton")->isEnabled());
+    QVERIFY(mainWindow.findChild<QSlider *>("windowSizeslider")->isEnabled());
+    QCOMPARE(mainWindow.findChild<QLabel *>("labelStatus")->text(), QString("Status: Stopped"));
+}
+
 void TestMainWindow::testSelectOutputPath()
 {
     MainWindow mainWindow;
@@ -66,10 +98,87 @@ void TestMainWindow::testOnNewSpectrogram()
     MainWindow mainWindow;
     QVector<float> testSpectrumData = {0.0203141, 0.00048133, 0.000669171, 0.00100052, 0.000300419, 0.000367233, 0.000325938, 0.000227044, 0.000233241, 0.000766388, 0.000296657, 0.000189793, 0.00015413, 0.000208378, 0.000153141, 0.000188466, 0.000146239, 0.000158019, 0.000303223, 0.00049933, 0.000510337, 0.000743311, 0.00056952, 0.00062953, 0.000208701};
 
-    mainWindow.onNewSpectrogram(testSpectrumData);
+    SpectrogramBlock block;
+    block.bands = testSpectrumData.size();
+    block.sampleRate = 44100;
+    block.hopSize = 256;
+    std::copy(testSpectrumData.constBegin(), testSpectrumData.constEnd(), block.appendFrame(0));
+    mainWindow.onNewSpectrogramBlock(block);
+
+    // The frame becomes a column straight away, and the history keeps it as it came
+    QCOMPARE(mainWindow.spectrogramItem->renderer().columnsWritten(), qint64(1));
+    QVERIFY(mainWindow.spectrogramDirty);
+    QVector<float> kept(testSpectrumData.size());
+    QCOMPARE(mainWindow.historyBrowser->pyramid().readFrames(0, 1, kept.data()), qint64(1));
+    QCOMPARE(kept, testSpectrumData);
+}
 
-    // Check if the spectrum buffer is updated
-    QCOMPARE(mainWindow.spectrumBuffer.last(), testSpectrumData);
+void TestMainWindow::testRenderQueueBound()
+{
+    MainWindow mainWindow;
+    AudioProcessor &processor = *mainWindow.audioProcessor;
+    processor.renderQueue.configure(4, SpectrogramBlockQueue::DropOldest, 64);
+
+    // Ten blocks from the processing side while the GUI thread is busy: only the newest four wait
+    QThread *producer = QThread::create([&processor]()
+                                        {
+                                            SpectrogramBlock block;
+                                            block.bands = 3;
+                                            block.sampleRate = 44100;
+                                            block.hopSize = 256;
+                                            for (int i = 0; i < 10; ++i)
+                                            {
+                                                std::fill_n(block.appendFrame(i * 256), 3, 0.5f);
+                                                processor.deliverSpectrogramBlock(block);
+                                            }
+                                        });
+    producer->start();
+    QVERIFY(producer->wait(10000));
+    delete producer;
+    PipelineStats &stats = processor.stats();
+    QCOMPARE(stats.counter(PipelineStats::RenderDrops), quint64(6));
+    QCOMPARE(stats.gauge(PipelineStats::BlockBacklog), qint64(4));
+
+    // One wake-up drains what is left
+    const qint64 columnsBefore = mainWindow.spectrogramItem->renderer().columnsWritten();
+    QApplication::processEvents();
+    QCOMPARE(mainWindow.spectrogramItem->renderer().columnsWritten(), columnsBefore + 4);
+    QCOMPARE(stats.counter(PipelineStats::BlocksReceived), quint64(4));
+    QVERIFY(!processor.takeSpectrogramBlock(mainWindow.receivedBlock));
+}
+
+void TestMainWindow::testOnNewSpectrogramBlock()
+{
+    MainWindow mainWindow;
+    SpectrogramBlock block;
+    block.bands = 3;
+    block.sampleRate = 44100;
+    block.hopSize = 256;
+
+    const float first[] = {0.1f, 0.2f, 0.3f};
+    const float second[] = {0.4f, 0.5f, 0.6f};
+    std::copy(first, first + 3, block.appendFrame(0));
+    std::copy(second, second + 3, block.appendFrame(256));
+
+    PipelineStats &stats = mainWindow.audioProcessor->stats();
+    block.firstFrameReadyNs = stats.now();
+
+    const qint64 columnsBefore = mainWindow.spectrogramItem->renderer().columnsWritten();
+    mainWindow.onNewSpectrogramBlock(block);
+
+    // Every frame of the block becomes one column of the spectrogram
+    QCOMPARE(mainWindow.spectrogramItem->renderer().columnsWritten(), columnsBefore + 2);
+    QVERIFY(mainWindow.spectrogramDirty);
+
+    // ...and is kept for the history window
+    QCOMPARE(mainWindow.historyBrowser->pyramid().frameCount(), qint64(2));
+    QCOMPARE(mainWindow.historyBrowser->pyramid().bands(), 3);
+    mainWindow.updateSpectrogram();
+    QVERIFY(!mainWindow.spectrogramDirty);
+
+    // The GUI closes the delivery stage on arrival
+    QCOMPARE(stats.counter(PipelineStats::BlocksReceived), quint64(1));
+    QCOMPARE(stats.histogram(PipelineStats::Delivery).count(), quint64(1));
 }
 
 void TestMainWindow::testUpdateSpectrogram()
@@ -78,15 +187,22 @@ void TestMainWindow::testUpdateSpectrogram()
     mainWindow.show();
     QApplication::processEvents(); // Ensure the UI updates are processed
 
-    // Assuming there's a way to access the spectrumBuffer or manipulate it for the test
     QVector<float> testSpectrumData = {0.0203141, 0.00048133, 0.000669171, 0.00100052, 0.000300419, 0.000367233, 0.000325938, 0.000227044, 0.000233241, 0.000766388, 0.000296657, 0.000189793, 0.00015413, 0.000208378, 0.000153141, 0.000188466, 0.000146239, 0.000158019, 0.000303223, 0.00049933, 0.000510337, 0.000743311, 0.00056952, 0.00062953, 0.000208701};
-
-    mainWindow.spectrumBuffer.append(testSpectrumData);
+    SpectrogramBlock block;
+    block.bands = testSpectrumData.size();
+    block.sampleRate = 44100;
+    block.hopSize = 256;
+    std::copy(testSpectrumData.constBegin(), testSpectrumData.constEnd(), block.appendFrame(0));
+    mainWindow.onNewSpectrogramBlock(block);
 
     mainWindow.updateSpectrogram();
 
-    // Validate that the buffer was cleared after updating the spectrogram
-    QVERIFY(mainWindow.spectrumBuffer.isEmpty());
+    // The tick only repaints what the block already wrote
+    QVERIFY(!mainWindow.spectrogramDirty);
+
+    // The frame was drawn into the persistent item rather than a rebuilt scene
+    QCOMPARE(mainWindow.spectrogramItem->renderer().columnsWritten(), qint64(1));
+    QCOMPARE(mainWindow.findChild<QGraphicsView *>("graphicsView")->scene()->items().size(), 1);
 }
 
 void TestMainWindow::testWindowSizeSlider()
@@ -189,6 +305,62 @@ void TestMainWindow::testMelBandSlider()
     QCOMPARE(melBandFLabel->text(), QString("Mel Bands: %1").arg(testValue));
 }
 
+void TestMainWindow::testPaletteSelection()
+{
+    MainWindow mainWindow;
+    QComboBox *paletteComboBox = mainWindow.findChild<QComboBox *>("paletteComboBox");
+    QVERIFY(paletteComboBox);
+    QCOMPARE(paletteComboBox->count(), Colormap::PaletteNames().size());
+
+    paletteComboBox->setCurrentIndex(Colormap::Magma);
+    QCOMPARE(mainWindow.spectrogramItem->renderer().colormap().palette(), Colormap::Magma);
+    QCOMPARE(mainWindow.historyBrowser->tileItem()->tiles().colormap().palette(), Colormap::Magma);
+}
+
+void TestMainWindow::testChannelDisplay()
+{
+    MainWindow mainWindow;
+    QGraphicsScene *scene = mainWindow.findChild<QGraphicsView *>("graphicsView")->scene();
+    QComboBox *channelComboBox = mainWindow.findChild<QComboBox *>("channelComboBox");
+    QVERIFY(channelComboBox);
+
+    // One item per channel, the first one being the persistent item
+    mainWindow.setupChannelItems(3);
+    QCOMPARE(scene->items().size(), 3);
+    QCOMPARE(mainWindow.channelItems.first(), mainWindow.spectrogramItem);
+    QCOMPARE(channelComboBox->count(), 4); // All channels, then one entry each
+    QVERIFY(channelComboBox->isEnabled());
+
+    // Blocks are drawn into the item of their channel
+    SpectrogramBlock block;
+    block.channel = 2;
+    block.bands = 3;
+    block.sampleRate = 44100;
+    block.hopSize = 256;
+    std::fill_n(block.appendFrame(0), 3, 0.5f);
+    mainWindow.onNewSpectrogramBlock(block);
+    QCOMPARE(mainWindow.channelItems[2]->renderer().columnsWritten(), qint64(1));
+    QCOMPARE(mainWindow.spectrogramItem->renderer().columnsWritten(), qint64(0));
+
+    // Stacked by default, a single selected channel gets the whole height
+    QVERIFY(mainWindow.channelItems[1]->pos().y() > 0.0);
+    channelComboBox->setCurrentIndex(2);
+    QVERIFY(!mainWindow.spectrogramItem->isVisible());
+    QVERIFY(mainWindow.channelItems[1]->isVisible());
+    QCOMPARE(mainWindow.channelItems[1]->pos().y(), 0.0);
+    QCOMPARE(mainWindow.channelItems[1]->transform().m22(), 1.0);
+
+    // Palette changes reach every channel
+    mainWindow.findChild<QComboBox *>("paletteComboBox")->setCurrentIndex(Colormap::Magma);
+    QCOMPARE(mainWindow.channelItems[2]->renderer().colormap().palette(), Colormap::Magma);
+
+    // Back to mono: the extra items go away
+    mainWindow.setupChannelItems(1);
+    QCOMPARE(scene->items().size(), 1);
+    QVERIFY(mainWindow.spectrogramItem->isVisible());
+    QVERIFY(!channelComboBox->isEnabled());
+}
+
 void TestMainWindow::testZoomFunctions()
 {
     MainWindow mainWindow;
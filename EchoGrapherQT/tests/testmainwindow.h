@@ -12,13 +12,18 @@ public:
 
 private slots:
     void testStartStopProcessing(); // Tests the start and stop functionality
+    void testFailedStartStaysStopped();
     void testZoomFunctions();       // Tests the zoom in, zoom out, and reset zoom functionality
     void testWindowSizeSlider();
     void testMelBandSlider();
     void testOverlapSlider();
     void testSelectOutputPath();
     void testOnNewSpectrogram();
+    void testOnNewSpectrogramBlock();
+    void testRenderQueueBound();
     void testUpdateSpectrogram();
+    void testPaletteSelection();
+    void testChannelDisplay();
 };
 
 #endif // TESTMAINWINDOW_H
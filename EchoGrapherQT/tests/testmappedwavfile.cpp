@@ -0,0 +1,160 @@
+#include "testmappedwavfile.h"
+#include "../wavwriter.h"
+
+#include <QTemporaryDir>
+
+namespace
+{
+// A stereo float recording as AudioProcessor writes it
+bool WriteStereoFloat(const QString &path, const QVector<float> &interleaved)
+{
+    WavWriter writer;
+    if (!writer.open(path, 16000, 2))
+    {
+        return false;
+    }
+    const bool ok = writer.write(interleaved.constData(), interleaved.size());
+    writer.close();
+    return ok;
+}
+
+// A 24-bit mono PCM file with the plain 44-byte header
+bool WriteMonoInt24(const QString &path, const QVector<qint32> &samples)
+{
+    WAVHeader header;
+    header.audioFormat = 1;
+    header.numChannels = 1;
+    header.sampleRate = 8000;
+    header.bitsPerSample = 24;
+    header.blockAlign = 3;
+    header.byteRate = 8000 * 3;
+    header.subchunk2Size = samples.size() * 3;
+    header.chunkSize = 36 + header.subchunk2Size;
+
+    QByteArray data;
+    for (qint32 sample : samples)
+    {
+        data.append(static_cast<char>(sample & 0xFF));
+        data.append(static_cast<char>((sample >> 8) & 0xFF));
+        data.append(static_cast<char>((sample >> 16) & 0xFF));
+    }
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) &&
+           file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header) &&
+           file.write(data) == data.size();
+}
+}
+
+void TestMappedWavFile::testFloatFramesPointIntoMapping()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("float.wav");
+    QVector<float> written(2 * 3000);
+    for (int i = 0; i < written.size(); ++i)
+    {
+        written[i] = (i % 200 - 100) / 128.0f;
+    }
+    QVERIFY(WriteStereoFloat(path, written));
+
+    MappedWavFile mapped;
+    QVERIFY2(mapped.open(path), qPrintable(mapped.errorString()));
+    QCOMPARE(mapped.frameCount(), qint64(3000));
+    QCOMPARE(mapped.wavInfo().numChannels, uint16_t(2));
+    QVERIFY(mapped.isDirectFloat());
+
+    // The samples are the file's bytes, not a copy
+    const float *frames = mapped.floatFrames(0);
+    QVERIFY(frames != nullptr);
+    QCOMPARE(reinterpret_cast<const char *>(frames), mapped.rawFrames(0));
+    QCOMPARE(mapped.floatFrames(1000), frames + 2 * 1000);
+    QCOMPARE(QVector<float>(frames, frames + written.size()), written);
+    QVERIFY(mapped.floatFrames(3000) == nullptr);
+
+    QVector<float> mono(10);
+    QCOMPARE(mapped.readMono(1, 10, mono.data()), qint64(10));
+    for (int i = 0; i < 10; ++i)
+    {
+        QCOMPARE(mono[i], (written[2 * (i + 1)] + written[2 * (i + 1) + 1]) * 0.5f);
+    }
+}
+
+void TestMappedWavFile::testDecodesIntegerPcm()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("int24.wav");
+    QVERIFY(WriteMonoInt24(path, {4194304, -8388608, 2097152, 0}));
+
+    MappedWavFile mapped;
+    QVERIFY2(mapped.open(path), qPrintable(mapped.errorString()));
+    QCOMPARE(mapped.frameCount(), qint64(4));
+    QVERIFY(!mapped.isDirectFloat());
+    QVERIFY(mapped.floatFrames(0) == nullptr);
+    QVERIFY(mapped.rawFrames(0) != nullptr);
+
+    QVector<float> samples(4);
+    QCOMPARE(mapped.readMono(0, 4, samples.data()), qint64(4));
+    QCOMPARE(samples, QVector<float>({0.5f, -1.0f, 0.25f, 0.0f}));
+    QCOMPARE(mapped.readInterleaved(2, 2, samples.data()), qint64(2));
+    QCOMPARE(samples[0], 0.25f);
+}
+
+void TestMappedWavFile::testReadPadsPastEnd()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("short.wav");
+    QVERIFY(WriteStereoFloat(path, {0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f}));
+
+    MappedWavFile mapped;
+    QVERIFY(mapped.open(path));
+    QVector<float> samples(2 * 4, 9.0f);
+    QCOMPARE(mapped.readInterleaved(1, 4, samples.data()), qint64(2));
+    QCOMPARE(samples, QVector<float>({0.3f, 0.4f, 0.5f, 0.6f, 0.0f, 0.0f, 0.0f, 0.0f}));
+
+    QVector<float> mono(3, 9.0f);
+    QCOMPARE(mapped.readMono(5, 3, mono.data()), qint64(0));
+    QCOMPARE(mono, QVector<float>({0.0f, 0.0f, 0.0f}));
+}
+
+void TestMappedWavFile::testAccessHints()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("hints.wav");
+    QVector<float> written(2 * 50000, 0.25f);
+    QVERIFY(WriteStereoFloat(path, written));
+
+    // Hints never change what is read, whether or not the kernel takes them
+    MappedWavFile mapped;
+    QVERIFY(mapped.open(path, MappedWavFile::Random, true));
+    mapped.prefetch(1000, 20000);
+    QCOMPARE(mapped.floatFrames(1000)[0], 0.25f);
+    mapped.release(0, 50000);
+    mapped.prefetch(49990, 1000); // Clipped to the data
+    QCOMPARE(mapped.floatFrames(49999)[1], 0.25f);
+
+    mapped.close();
+    QVERIFY(!mapped.isOpen());
+    QVERIFY(!mapped.usesHugePages());
+    QVERIFY(mapped.rawFrames(0) == nullptr);
+}
+
+void TestMappedWavFile::testRejectsInvalidFiles()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    MappedWavFile mapped;
+    QVERIFY(!mapped.open(dir.filePath("missing.wav")));
+    QVERIFY(!mapped.errorString().isEmpty());
+
+    const QString path = dir.filePath("text.wav");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("this is not a recording at all");
+    file.close();
+    QVERIFY(!mapped.open(path));
+    QVERIFY(!mapped.isOpen());
+    QVERIFY(!mapped.errorString().isEmpty());
+}
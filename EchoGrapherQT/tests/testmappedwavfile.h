@@ -0,0 +1,19 @@
+#ifndef TESTMAPPEDWAVFILE_H
+#define TESTMAPPEDWAVFILE_H
+
+#include <QtTest>
+#include "../mappedwavfile.h"
+
+class TestMappedWavFile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFloatFramesPointIntoMapping();
+    void testDecodesIntegerPcm();
+    void testReadPadsPastEnd();
+    void testAccessHints();
+    void testRejectsInvalidFiles();
+};
+
+#endif // TESTMAPPEDWAVFILE_H
@@ -0,0 +1,84 @@
+#include "testmelfilterbank.h"
+#include <QRandomGenerator>
+
+void TestMelFilterbank::testBuild()
+{
+    MelFilterbank filterbank(512, 25, 44100);
+
+    QCOMPARE(filterbank.numFilters(), 25);
+    QCOMPARE(filterbank.fftSize(), 512);
+    QCOMPARE(filterbank.sampleRate(), 44100);
+
+    // Every filter's weights must fit in the contiguous weight array
+    for (const MelFilterbank::FilterRange &range : filterbank.filterRanges())
+    {
+        QVERIFY(range.startBin <= range.endBin);
+        QVERIFY(range.endBin <= 512 / 2);
+        QVERIFY(range.offset + (range.endBin - range.startBin) <= filterbank.weights().size());
+    }
+}
+
+void TestMelFilterbank::testMatches()
+{
+    MelFilterbank filterbank;
+    QVERIFY(filterbank.isEmpty());
+    QVERIFY(!filterbank.matches(512, 25, 44100));
+
+    filterbank.build(512, 25, 44100);
+    QVERIFY(filterbank.matches(512, 25, 44100));
+    QVERIFY(!filterbank.matches(1024, 25, 44100));
+    QVERIFY(!filterbank.matches(512, 40, 44100));
+    QVERIFY(!filterbank.matches(512, 25, 48000));
+}
+
+void TestMelFilterbank::testSharedTables()
+{
+    // Every processor of one layout reads the same weights, built only once
+    const MelFilterbank first = MelFilterbank::Shared(1024, 40, 48000);
+    const MelFilterbank second = MelFilterbank::Shared(1024, 40, 48000);
+    QVERIFY(first.matches(1024, 40, 48000));
+    QCOMPARE(second.weights().constData(), first.weights().constData());
+    QCOMPARE(first.weights(), MelFilterbank(1024, 40, 48000).weights());
+
+    const MelFilterbank other = MelFilterbank::Shared(1024, 40, 44100);
+    QVERIFY(other.matches(1024, 40, 44100));
+    QVERIFY(other.weights().constData() != first.weights().constData());
+}
+
+void TestMelFilterbank::testFiltersAreBandLimited()
+{
+    MelFilterbank filterbank(2048, 40, 44100);
+
+    // The sparse layout must store far fewer weights than the dense numFilters x fftSize / 2 rows
+    QVERIFY(filterbank.weights().size() < 2 * (2048 / 2));
+    QVERIFY(filterbank.weights().size() < 40 * (2048 / 2) / 10);
+}
+
+void TestMelFilterbank::testApplyMatchesDenseProduct()
+{
+    const int fftSize = 1024;
+    const int numFilters = 32;
+    MelFilterbank filterbank(fftSize, numFilters, 48000);
+    QVector<QVector<float>> dense = filterbank.toDense();
+    QCOMPARE(dense.size(), numFilters);
+
+    QRandomGenerator generator(1234);
+    QVector<float> powerSpectrum(fftSize / 2);
+    for (float &value : powerSpectrum)
+    {
+        value = static_cast<float>(generator.generateDouble());
+    }
+
+    QVector<float> melSpectrum(numFilters);
+    filterbank.apply(powerSpectrum.constData(), melSpectrum.data());
+
+    for (int filterNum = 0; filterNum < numFilters; ++filterNum)
+    {
+        float expected = 0.0f;
+        for (int bin = 0; bin < fftSize / 2; ++bin)
+        {
+            expected += powerSpectrum[bin] * dense[filterNum][bin];
+        }
+        QVERIFY(qAbs(melSpectrum[filterNum] - expected) <= 1e-4f * qMax(1.0f, expected));
+    }
+}
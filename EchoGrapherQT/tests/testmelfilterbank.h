@@ -0,0 +1,19 @@
+#ifndef TESTMELFILTERBANK_H
+#define TESTMELFILTERBANK_H
+
+#include <QtTest>
+#include "../melfilterbank.h"
+
+class TestMelFilterbank : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testBuild();
+    void testMatches();
+    void testSharedTables();
+    void testFiltersAreBandLimited();
+    void testApplyMatchesDenseProduct();
+};
+
+#endif // TESTMELFILTERBANK_H
@@ -0,0 +1,138 @@
+#include "testpipelinestats.h"
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <thread>
+#include <vector>
+
+void TestPipelineStats::testBucketBounds()
+{
+    // Every value lands in a bucket that contains it, at most 1/32 of the value wide
+    for (qint64 value : {qint64(0), qint64(1), qint64(31), qint64(32), qint64(33), qint64(63), qint64(64), qint64(1000),
+                         qint64(123456), qint64(999999999), qint64(1) << 39, (qint64(1) << 41) - 1})
+    {
+        const int bucket = LatencyHistogram::BucketFor(value);
+        QVERIFY(bucket >= 0 && bucket < LatencyHistogram::BucketCount);
+        QVERIFY(LatencyHistogram::BucketLowerBound(bucket) <= value);
+        QVERIFY(value < LatencyHistogram::BucketUpperBound(bucket));
+        const qint64 width = LatencyHistogram::BucketUpperBound(bucket) - LatencyHistogram::BucketLowerBound(bucket);
+        QVERIFY(width == 1 || width * 32 <= value);
+    }
+
+    // Buckets tile the range without gaps
+    for (int bucket = 1; bucket < LatencyHistogram::BucketCount; ++bucket)
+    {
+        QCOMPARE(LatencyHistogram::BucketLowerBound(bucket), LatencyHistogram::BucketUpperBound(bucket - 1));
+    }
+
+    // Beyond the range, values are clamped into the last bucket
+    QCOMPARE(LatencyHistogram::BucketFor(qint64(1) << 50), LatencyHistogram::BucketCount - 1);
+}
+
+void TestPipelineStats::testPercentiles()
+{
+    LatencyHistogram histogram;
+    QCOMPARE(histogram.percentile(50.0), qint64(0));
+
+    // 1 us to 10 ms in 1 us steps
+    for (qint64 us = 1; us <= 10000; ++us)
+    {
+        histogram.record(us * 1000);
+    }
+    QCOMPARE(histogram.count(), quint64(10000));
+    QCOMPARE(histogram.min(), qint64(1000));
+    QCOMPARE(histogram.max(), qint64(10000000));
+    QVERIFY(qAbs(histogram.mean() - 5000500.0) < 1.0);
+
+    const double tolerance = 1.0 / 32;
+    QVERIFY(qAbs(histogram.percentile(50.0) / 5000000.0 - 1.0) <= tolerance);
+    QVERIFY(qAbs(histogram.percentile(90.0) / 9000000.0 - 1.0) <= tolerance);
+    QVERIFY(qAbs(histogram.percentile(99.0) / 9900000.0 - 1.0) <= tolerance);
+    QCOMPARE(histogram.percentile(100.0), histogram.max());
+
+    histogram.reset();
+    QCOMPARE(histogram.count(), quint64(0));
+    QCOMPARE(histogram.max(), qint64(0));
+    QCOMPARE(histogram.min(), qint64(0));
+}
+
+void TestPipelineStats::testConcurrentRecording()
+{
+    LatencyHistogram histogram;
+    const int threads = 4;
+    const int perThread = 100000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&histogram, t]()
+                             {
+                                 for (int i = 0; i < perThread; ++i)
+                                 {
+                                     histogram.record(100 * (t + 1));
+                                 }
+                             });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    QCOMPARE(histogram.count(), quint64(threads * perThread));
+    QCOMPARE(histogram.min(), qint64(100));
+    QCOMPARE(histogram.max(), qint64(400));
+    QCOMPARE(histogram.bucketCount(LatencyHistogram::BucketFor(300)), quint64(perThread));
+}
+
+void TestPipelineStats::testCountersAndGauges()
+{
+    PipelineStats stats;
+    stats.add(PipelineStats::FramesProcessed);
+    stats.add(PipelineStats::FramesProcessed, 9);
+    stats.set(PipelineStats::InputOverflows, 3);
+    stats.setGauge(PipelineStats::CaptureQueue, 700);
+    stats.setGauge(PipelineStats::CaptureQueue, 200);
+    stats.record(PipelineStats::Fft, 5000);
+
+    QCOMPARE(stats.counter(PipelineStats::FramesProcessed), quint64(10));
+    QCOMPARE(stats.counter(PipelineStats::InputOverflows), quint64(3));
+    QCOMPARE(stats.gauge(PipelineStats::CaptureQueue), qint64(200));
+    QCOMPARE(stats.gaugeMax(PipelineStats::CaptureQueue), qint64(700));
+    QCOMPARE(stats.histogram(PipelineStats::Fft).count(), quint64(1));
+
+    // The clock keeps running across a reset, everything else starts over
+    const qint64 before = stats.now();
+    stats.reset();
+    QVERIFY(stats.now() >= before);
+    QCOMPARE(stats.counter(PipelineStats::FramesProcessed), quint64(0));
+    QCOMPARE(stats.gaugeMax(PipelineStats::CaptureQueue), qint64(0));
+    QCOMPARE(stats.histogram(PipelineStats::Fft).count(), quint64(0));
+}
+
+void TestPipelineStats::testJsonExport()
+{
+    PipelineStats stats;
+    for (int i = 1; i <= 100; ++i)
+    {
+        stats.record(PipelineStats::Render, i * 100000);
+    }
+    stats.add(PipelineStats::ColumnsRendered, 42);
+    stats.setGauge(PipelineStats::BlockBacklog, 3);
+    stats.setGauge(PipelineStats::CaptureQueue, 512);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("stats.json");
+    QVERIFY(stats.writeJson(path));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    const QJsonObject render = root["stages"].toObject()["render"].toObject();
+    QCOMPARE(render["count"].toInt(), 100);
+    QCOMPARE(render["max_ns"].toDouble(), 10000000.0);
+    QVERIFY(!render["buckets"].toArray().isEmpty());
+    QCOMPARE(root["stages"].toObject().size(), int(PipelineStats::StageCount));
+    QCOMPARE(root["counters"].toObject()["columns_rendered"].toInt(), 42);
+    QCOMPARE(root["gauges"].toObject()["block_backlog"].toObject()["max"].toInt(), 3);
+    QCOMPARE(root["gauges"].toObject()["capture_queue_frames"].toObject()["max"].toInt(), 512);
+}
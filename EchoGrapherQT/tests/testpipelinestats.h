@@ -0,0 +1,19 @@
+#ifndef TESTPIPELINESTATS_H
+#define TESTPIPELINESTATS_H
+
+#include <QtTest>
+#include "../pipelinestats.h"
+
+class TestPipelineStats : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testBucketBounds();
+    void testPercentiles();
+    void testConcurrentRecording();
+    void testCountersAndGauges();
+    void testJsonExport();
+};
+
+#endif // TESTPIPELINESTATS_H
@@ -1,5 +1,5 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++17
 CONFIG -= app_bundle
 
 DEFINES += QT_DEPRECATED_WARNINGS
@@ -11,15 +11,120 @@ INCLUDEPATH += $$PWD/../../build-EchoGrapherQT-Desktop_Qt_6_6_0_GCC_64bit-Debug
 SOURCES += TestRunner.cpp \
            testmainwindow.cpp \
            testaudioprocessor.cpp \
+           testmelfilterbank.cpp \
+           testfftplancache.cpp \
+           testspscringbuffer.cpp \
+           testframeassembler.cpp \
+           testwavwriter.cpp \
+           testspectrogramrenderer.cpp \
+           testcolormap.cpp \
+           testlogmelscale.cpp \
+           testframeprocessor.cpp \
+           testdspkernels.cpp \
+           testfixedframeprocessor.cpp \
+           testaudiosource.cpp \
+           testpipelinestats.cpp \
+           testspectrogramblockqueue.cpp \
+           testclockdriftmonitor.cpp \
+           testframeworkerpool.cpp \
+           testflacwriter.cpp \
+           testmappedwavfile.cpp \
+           testspectrogramstore.cpp \
+           testspectrogrampyramid.cpp \
+           testspectrogramtiles.cpp \
            ../mainwindow.cpp \
-           ../audioprocessor.cpp
+           ../audioprocessor.cpp \
+           ../audiosource.cpp \
+           ../clockdriftmonitor.cpp \
+           ../colormap.cpp \
+           ../dspkernels.cpp \
+           ../fftplancache.cpp \
+           ../fixedframeprocessor.cpp \
+           ../flacwriter.cpp \
+           ../frameassembler.cpp \
+           ../frameprocessor.cpp \
+           ../frameworkerpool.cpp \
+           ../latencyhistogram.cpp \
+           ../logmelscale.cpp \
+           ../mappedwavfile.cpp \
+           ../melfilterbank.cpp \
+           ../pipelinestats.cpp \
+           ../recordingwriter.cpp \
+           ../spectrogramblockqueue.cpp \
+           ../spectrogrambrowser.cpp \
+           ../spectrogrampyramid.cpp \
+           ../spectrogramrenderer.cpp \
+           ../spectrogramstore.cpp \
+           ../spectrogramtiles.cpp \
+           ../statspanel.cpp \
+           ../syntheticsource.cpp \
+           ../wavfilesource.cpp \
+           ../wavreader.cpp \
+           ../wavwriter.cpp
 
 HEADERS += testmainwindow.h \
            testaudioprocessor.h \
+           testmelfilterbank.h \
+           testfftplancache.h \
+           testspscringbuffer.h \
+           testframeassembler.h \
+           testwavwriter.h \
+           testspectrogramrenderer.h \
+           testcolormap.h \
+           testlogmelscale.h \
+           testframeprocessor.h \
+           testdspkernels.h \
+           testfixedframeprocessor.h \
+           testaudiosource.h \
+           testpipelinestats.h \
+           testspectrogramblockqueue.h \
+           testclockdriftmonitor.h \
+           testframeworkerpool.h \
+           testflacwriter.h \
+           testmappedwavfile.h \
+           testspectrogramstore.h \
+           testspectrogrampyramid.h \
+           testspectrogramtiles.h \
            ../mainwindow.h \
-           ../audioprocessor.h
+           ../audioprocessor.h \
+           ../audiosource.h \
+           ../clockdriftmonitor.h \
+           ../colormap.h \
+           ../dspkernels.h \
+           ../fftplancache.h \
+           ../fixedframeprocessor.h \
+           ../flacwriter.h \
+           ../frameassembler.h \
+           ../frameprocessor.h \
+           ../frameworkerpool.h \
+           ../latencyhistogram.h \
+           ../logmelscale.h \
+           ../mappedwavfile.h \
+           ../melfilterbank.h \
+           ../pipelinestats.h \
+           ../recordingwriter.h \
+           ../spectrogramblock.h \
+           ../spectrogramblockqueue.h \
+           ../spectrogrambrowser.h \
+           ../spectrogrampyramid.h \
+           ../spectrogramrenderer.h \
+           ../spectrogramstore.h \
+           ../spectrogramtiles.h \
+           ../spscringbuffer.h \
+           ../statspanel.h \
+           ../syntheticsource.h \
+           ../wavfilesource.h \
+           ../wavreader.h \
+           ../wavwriter.h
 
 # Link to the Qt modules and any additional libraries
-QT += testlib widgets
+QT += testlib widgets concurrent
 LIBS += -lportaudio
 LIBS += -lfftw3f
+
+# FLAC recording is built in when pkg-config finds libFLAC
+packagesExist(flac) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += flac
+    DEFINES += ECHOGRAPHER_FLAC
+}
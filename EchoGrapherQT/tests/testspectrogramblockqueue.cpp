@@ -0,0 +1,122 @@
+#include "testspectrogramblockqueue.h"
+
+namespace
+{
+// `frames` rows of 2 bands starting at stream position `first`, each holding its own timestamp
+void FillBlock(SpectrogramBlock &block, qint64 first, int frames)
+{
+    block.bands = 2;
+    block.sampleRate = 1000;
+    block.hopSize = 1;
+    for (int i = 0; i < frames; ++i)
+    {
+        float *row = block.appendFrame(first + i);
+        row[0] = row[1] = static_cast<float>(first + i);
+    }
+}
+}
+
+void TestSpectrogramBlockQueue::testFifoOrder()
+{
+    SpectrogramBlockQueue queue;
+    queue.configure(4, SpectrogramBlockQueue::DropOldest, 0);
+
+    SpectrogramBlock block;
+    FillBlock(block, 0, 2);
+    QVERIFY(queue.push(block)); // Empty before, the consumer needs waking
+    QVERIFY(block.isEmpty());
+    QCOMPARE(block.bands, 2);
+    FillBlock(block, 10, 2);
+    QVERIFY(!queue.push(block));
+    QCOMPARE(queue.size(), 2);
+
+    SpectrogramBlock received;
+    QVERIFY(queue.pop(received));
+    QCOMPARE(received.frameTimestamps.first(), qint64(0));
+    QVERIFY(queue.pop(received));
+    QCOMPARE(received.frameTimestamps.first(), qint64(10));
+    QCOMPARE(received.frame(1)[1], 11.0f);
+    QVERIFY(!queue.pop(received));
+
+    FillBlock(block, 20, 2);
+    QVERIFY(queue.push(block));
+    QCOMPARE(queue.droppedBlocks(), quint64(0));
+}
+
+void TestSpectrogramBlockQueue::testDropOldest()
+{
+    SpectrogramBlockQueue queue;
+    queue.configure(2, SpectrogramBlockQueue::DropOldest, 0);
+
+    SpectrogramBlock block;
+    for (qint64 first : {0, 10, 20, 30})
+    {
+        FillBlock(block, first, 3);
+        queue.push(block);
+    }
+
+    // The display skips ahead: only the newest blocks are left
+    QCOMPARE(queue.size(), 2);
+    QCOMPARE(queue.droppedBlocks(), quint64(2));
+    QCOMPARE(queue.droppedFrames(), quint64(6));
+    SpectrogramBlock received;
+    QVERIFY(queue.pop(received));
+    QCOMPARE(received.frameTimestamps.first(), qint64(20));
+    QVERIFY(queue.pop(received));
+    QCOMPARE(received.frameTimestamps.first(), qint64(30));
+}
+
+void TestSpectrogramBlockQueue::testCoalesce()
+{
+    SpectrogramBlockQueue queue;
+    queue.configure(2, SpectrogramBlockQueue::Coalesce, 6);
+
+    SpectrogramBlock block;
+    FillBlock(block, 0, 3);
+    queue.push(block);
+    FillBlock(block, 10, 3);
+    queue.push(block);
+    FillBlock(block, 20, 3); // Joins the block from 10, which then holds the limit of 6 frames
+    QVERIFY(!queue.push(block));
+    QVERIFY(block.isEmpty());
+    QCOMPARE(queue.coalescedBlocks(), quint64(1));
+    QCOMPARE(queue.droppedBlocks(), quint64(0));
+
+    FillBlock(block, 30, 3); // No room left to merge, so the oldest goes after all
+    queue.push(block);
+    QCOMPARE(queue.coalescedBlocks(), quint64(1));
+    QCOMPARE(queue.droppedBlocks(), quint64(1));
+    QCOMPARE(queue.droppedFrames(), quint64(3));
+
+    SpectrogramBlock received;
+    QVERIFY(queue.pop(received));
+    QCOMPARE(received.frameCount(), 6);
+    QCOMPARE(received.frameTimestamps.at(2), qint64(12));
+    QCOMPARE(received.frameTimestamps.at(3), qint64(20));
+    QCOMPARE(received.frame(5)[0], 22.0f);
+    QVERIFY(queue.pop(received));
+    QCOMPARE(received.frameTimestamps.first(), qint64(30));
+    QVERIFY(!queue.pop(received));
+}
+
+void TestSpectrogramBlockQueue::testStorageIsPooled()
+{
+    SpectrogramBlockQueue queue;
+    queue.configure(2, SpectrogramBlockQueue::DropOldest, 0);
+
+    SpectrogramBlock block;
+    SpectrogramBlock received;
+    FillBlock(block, 0, 16);
+    queue.push(block);
+    QVERIFY(queue.pop(received)); // The consumer now holds the first block's storage
+    FillBlock(block, 16, 16);
+    queue.push(block);
+    QVERIFY(queue.pop(received)); // ...and hands it back to the pool in exchange for the second
+
+    // The next push leaves the producer on the recycled storage, already big enough
+    FillBlock(block, 32, 16);
+    queue.push(block);
+    QVERIFY(block.isEmpty());
+    QVERIFY(block.values.capacity() >= 16 * 2);
+    QCOMPARE(block.bands, 2);
+}
@@ -0,0 +1,18 @@
+#ifndef TESTSPECTROGRAMBLOCKQUEUE_H
+#define TESTSPECTROGRAMBLOCKQUEUE_H
+
+#include <QtTest>
+#include "../spectrogramblockqueue.h"
+
+class TestSpectrogramBlockQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFifoOrder();
+    void testDropOldest();
+    void testCoalesce();
+    void testStorageIsPooled();
+};
+
+#endif // TESTSPECTROGRAMBLOCKQUEUE_H
@@ -0,0 +1,187 @@
+#include "testspectrogrampyramid.h"
+#include "../spectrogramstore.h"
+
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+
+namespace
+{
+// `frames` rows of `bands` values; every value of frame i is i, plus the band in the second half
+SpectrogramBlock MakeBlock(int bands, qint64 firstFrame, int frames)
+{
+    SpectrogramBlock block;
+    block.bands = bands;
+    block.sampleRate = 16000;
+    block.hopSize = 160;
+    for (int i = 0; i < frames; ++i)
+    {
+        float *row = block.appendFrame((firstFrame + i) * block.hopSize);
+        for (int b = 0; b < bands; ++b)
+        {
+            row[b] = float(firstFrame + i) + (b >= bands / 2 ? b : 0);
+        }
+    }
+    return block;
+}
+
+QVector<float> Columns(const SpectrogramPyramid &pyramid, int level, qint64 first, qint64 count)
+{
+    QVector<float> out(count * pyramid.bands(), -1.0f);
+    const qint64 read = pyramid.readColumns(level, first, count, out.data());
+    out.resize(read * pyramid.bands());
+    return out;
+}
+}
+
+void TestSpectrogramPyramid::testMaxPooling()
+{
+    SpectrogramPyramid pyramid(SpectrogramPyramid::Max);
+    pyramid.appendBlock(MakeBlock(2, 0, 64));
+    QCOMPARE(pyramid.bands(), 2);
+    QCOMPARE(pyramid.frameCount(), qint64(64));
+    QCOMPARE(pyramid.frameSeconds(), 0.01);
+    QCOMPARE(pyramid.levelCount(), 7);
+    QCOMPARE(pyramid.columnCount(0), qint64(64));
+    QCOMPARE(pyramid.columnCount(4), qint64(4));
+    QCOMPARE(pyramid.columnCount(6), qint64(1));
+
+    // Each column holds the largest value of its frames
+    QCOMPARE(Columns(pyramid, 0, 5, 1), QVector<float>({5.0f, 6.0f}));
+    QCOMPARE(Columns(pyramid, 2, 0, 2), QVector<float>({3.0f, 4.0f, 7.0f, 8.0f}));
+    QCOMPARE(Columns(pyramid, 4, 1, 2), QVector<float>({31.0f, 32.0f, 47.0f, 48.0f}));
+    QCOMPARE(Columns(pyramid, 6, 0, 1), QVector<float>({63.0f, 64.0f}));
+
+    // Clipped to the level, nothing past it
+    QCOMPARE(Columns(pyramid, 4, 3, 5).size(), 2);
+    QCOMPARE(Columns(pyramid, 4, 4, 1).size(), 0);
+}
+
+void TestSpectrogramPyramid::testMeanOfPartialColumns()
+{
+    SpectrogramPyramid pyramid(SpectrogramPyramid::Mean);
+    pyramid.appendBlock(MakeBlock(1, 0, 20));
+    QCOMPARE(pyramid.levelCount(), 6);
+    QCOMPARE(pyramid.columnCount(4), qint64(2));
+
+    // The newest column averages only the frames it has so far, and counts for just those above
+    QCOMPARE(Columns(pyramid, 4, 0, 2), QVector<float>({7.5f, 17.5f}));
+    QCOMPARE(Columns(pyramid, 5, 0, 1), QVector<float>({9.5f}));
+    QCOMPARE(Columns(pyramid, 12, 0, 1), QVector<float>({9.5f}));
+    QCOMPARE(Columns(pyramid, 3, 2, 1), QVector<float>({17.5f}));
+
+    pyramid.appendBlock(MakeBlock(1, 20, 12));
+    QCOMPARE(Columns(pyramid, 5, 0, 1), QVector<float>({15.5f}));
+}
+
+void TestSpectrogramPyramid::testMatchesBruteForce()
+{
+    const int bands = 3;
+    const qint64 frames = 5000;
+    QRandomGenerator random(7);
+    QVector<float> values(frames * bands);
+    for (float &value : values)
+    {
+        value = static_cast<float>(random.generateDouble());
+    }
+
+    // Appended in uneven pieces, as blocks arrive
+    SpectrogramPyramid pyramid(SpectrogramPyramid::Max);
+    pyramid.reset(bands);
+    for (qint64 first = 0; first < frames;)
+    {
+        const qint64 count = qMin<qint64>(frames - first, 1 + first % 37);
+        pyramid.appendFrames(values.constData() + first * bands, count);
+        first += count;
+    }
+    QCOMPARE(pyramid.frameCount(), frames);
+
+    // Stored levels round to half floats; the maximum survives that unchanged
+    for (int level = 0; level < pyramid.levelCount(); ++level)
+    {
+        const qint64 columns = pyramid.columnCount(level);
+        const QVector<float> pooled = Columns(pyramid, level, 0, columns);
+        QCOMPARE(pooled.size(), int(columns * bands));
+        for (qint64 c = 0; c < columns; ++c)
+        {
+            for (int b = 0; b < bands; ++b)
+            {
+                float expected = 0.0f;
+                for (qint64 f = c << level; f < qMin(frames, (c + 1) << level); ++f)
+                {
+                    expected = qMax(expected, values[f * bands + b]);
+                }
+                if (level >= SpectrogramPyramid::StoredFromLevel)
+                {
+                    expected = float(qfloat16(expected));
+                }
+                QCOMPARE(pooled[c * bands + b], expected);
+            }
+        }
+    }
+}
+
+void TestSpectrogramPyramid::testRecentHistory()
+{
+    SpectrogramPyramid pyramid(SpectrogramPyramid::Max, 32);
+    pyramid.appendBlock(MakeBlock(2, 0, 100));
+
+    // Only the last 32 raw frames are kept; older ones are down to the stored levels
+    QVERIFY(pyramid.hasFrames(68, 32));
+    QVERIFY(!pyramid.hasFrames(67, 2));
+    QVERIFY(!pyramid.hasFrames(90, 20));
+    QCOMPARE(pyramid.finestLevel(0, 10), int(SpectrogramPyramid::StoredFromLevel));
+    QCOMPARE(pyramid.finestLevel(80, 1000), 0);
+    QCOMPARE(Columns(pyramid, 0, 0, 4).size(), 0);
+    QCOMPARE(Columns(pyramid, 1, 45, 2), QVector<float>({91.0f, 92.0f, 93.0f, 94.0f}));
+    QCOMPARE(Columns(pyramid, 4, 0, 1), QVector<float>({15.0f, 16.0f}));
+
+    // Far less than the frames themselves
+    QVERIFY(pyramid.memoryBytes() < 100 * 2 * qint64(sizeof(float)));
+
+    pyramid.reset(2);
+    QCOMPARE(pyramid.frameCount(), qint64(0));
+    QCOMPARE(pyramid.columnCount(0), qint64(0));
+    QCOMPARE(Columns(pyramid, 4, 0, 1).size(), 0);
+}
+
+void TestSpectrogramPyramid::testArchive()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("take.egspec");
+    const SpectrogramBlock block = MakeBlock(4, 0, 100);
+    SpectrogramStoreWriter writer(400, 160);
+    QVERIFY2(writer.open(path, 16000, 4), qPrintable(writer.errorString()));
+    QVERIFY(writer.write(block));
+    writer.close();
+    SpectrogramStore store;
+    QVERIFY2(store.open(path), qPrintable(store.errorString()));
+
+    // Frames that left the recent history are read back from the store
+    SpectrogramPyramid pyramid(SpectrogramPyramid::Max, 16);
+    pyramid.appendBlock(block);
+    QVERIFY(!pyramid.hasFrames(0, 100));
+    pyramid.setArchive(&store);
+    QVERIFY(pyramid.hasFrames(0, 100));
+    QCOMPARE(pyramid.finestLevel(0, 100), 0);
+    QCOMPARE(Columns(pyramid, 0, 10, 1), QVector<float>(block.frame(10), block.frame(11)));
+    QVector<float> frames(100 * 4);
+    QCOMPARE(pyramid.readFrames(0, 100, frames.data()), qint64(100));
+    QCOMPARE(frames, block.values);
+
+    // A store of other frames is not taken
+    SpectrogramPyramid other(SpectrogramPyramid::Max, 16);
+    other.appendBlock(MakeBlock(3, 0, 100));
+    other.setArchive(&store);
+    QVERIFY(!other.hasFrames(0, 100));
+}
+
+void TestSpectrogramPyramid::testLevelForScale()
+{
+    QCOMPARE(SpectrogramPyramid::LevelForScale(4.0), 0);
+    QCOMPARE(SpectrogramPyramid::LevelForScale(1.0), 0);
+    QCOMPARE(SpectrogramPyramid::LevelForScale(0.5), 1);
+    QCOMPARE(SpectrogramPyramid::LevelForScale(0.3), 1);
+    QCOMPARE(SpectrogramPyramid::LevelForScale(1.0 / 1024), 10);
+    QCOMPARE(SpectrogramPyramid::LevelForScale(0.0), 0);
+}
@@ -0,0 +1,20 @@
+#ifndef TESTSPECTROGRAMPYRAMID_H
+#define TESTSPECTROGRAMPYRAMID_H
+
+#include <QtTest>
+#include "../spectrogrampyramid.h"
+
+class TestSpectrogramPyramid : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testMaxPooling();
+    void testMeanOfPartialColumns();
+    void testMatchesBruteForce();
+    void testRecentHistory();
+    void testArchive();
+    void testLevelForScale();
+};
+
+#endif // TESTSPECTROGRAMPYRAMID_H
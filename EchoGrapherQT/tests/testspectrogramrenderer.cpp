@@ -0,0 +1,76 @@
+#include "testspectrogramrenderer.h"
+
+#include <QPainter>
+
+namespace
+{
+const Colormap classic(Colormap::Classic);
+}
+
+void TestSpectrogramRenderer::testColumnWrittenAtRingPosition()
+{
+    SpectrogramRenderer renderer(4, 2);
+    QCOMPARE(renderer.writeColumn(), 0);
+
+    const float loud[] = {1.0f};
+    renderer.appendColumn(loud, 1);
+
+    // Only the written column changes, everything else stays black
+    QCOMPARE(renderer.image().pixel(0, 0), classic.color(1.0f));
+    QCOMPARE(renderer.image().pixel(0, 1), classic.color(1.0f));
+    QCOMPARE(renderer.image().pixel(1, 0), qRgb(0, 0, 0));
+    QCOMPARE(renderer.writeColumn(), 1);
+    QCOMPARE(renderer.columnsWritten(), qint64(1));
+}
+
+void TestSpectrogramRenderer::testBandsMapToRows()
+{
+    SpectrogramRenderer renderer(2, 4);
+    const float values[] = {0.0f, 1.0f};
+    renderer.appendColumn(values, 2);
+
+    // Band 0 fills the bottom half, band 1 the top half
+    QCOMPARE(renderer.image().pixel(0, 0), classic.color(1.0f));
+    QCOMPARE(renderer.image().pixel(0, 1), classic.color(1.0f));
+    QCOMPARE(renderer.image().pixel(0, 2), classic.color(0.0f));
+    QCOMPARE(renderer.image().pixel(0, 3), classic.color(0.0f));
+}
+
+void TestSpectrogramRenderer::testWrapAround()
+{
+    SpectrogramRenderer renderer(3, 1);
+    SpectrogramBlock block;
+    block.bands = 1;
+    for (int i = 0; i < 4; ++i)
+    {
+        *block.appendFrame(i) = i / 3.0f;
+    }
+    renderer.appendBlock(block);
+
+    // The fourth frame overwrote the oldest column
+    QCOMPARE(renderer.columnsWritten(), qint64(4));
+    QCOMPARE(renderer.writeColumn(), 1);
+    QCOMPARE(renderer.image().pixel(0, 0), classic.color(1.0f));
+    QCOMPARE(renderer.image().pixel(1, 0), classic.color(1 / 3.0f));
+}
+
+void TestSpectrogramRenderer::testPaintUnrollsRing()
+{
+    SpectrogramRenderer renderer(3, 1);
+    const float values[] = {0.0f, 0.5f, 1.0f, 0.2f};
+    for (float value : values)
+    {
+        renderer.appendColumn(&value, 1);
+    }
+
+    QImage target(3, 1, QImage::Format_RGB32);
+    target.fill(Qt::white);
+    QPainter painter(&target);
+    renderer.paint(&painter, QRectF(0, 0, 3, 1));
+    painter.end();
+
+    // Oldest surviving frame on the left, newest on the right
+    QCOMPARE(target.pixel(0, 0), classic.color(0.5f));
+    QCOMPARE(target.pixel(1, 0), classic.color(1.0f));
+    QCOMPARE(target.pixel(2, 0), classic.color(0.2f));
+}
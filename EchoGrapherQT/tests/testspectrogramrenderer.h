@@ -0,0 +1,18 @@
+#ifndef TESTSPECTROGRAMRENDERER_H
+#define TESTSPECTROGRAMRENDERER_H
+
+#include <QtTest>
+#include "../spectrogramrenderer.h"
+
+class TestSpectrogramRenderer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testColumnWrittenAtRingPosition();
+    void testBandsMapToRows();
+    void testWrapAround();
+    void testPaintUnrollsRing();
+};
+
+#endif // TESTSPECTROGRAMRENDERER_H
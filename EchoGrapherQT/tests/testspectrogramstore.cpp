@@ -0,0 +1,179 @@
+#include "testspectrogramstore.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+namespace
+{
+// `frames` rows of `bands` values at hops of `hop` samples from `firstPosition`, each value unique
+SpectrogramBlock MakeBlock(int bands, int hop, qint64 firstPosition, int frames)
+{
+    SpectrogramBlock block;
+    block.bands = bands;
+    block.sampleRate = 16000;
+    block.hopSize = hop;
+    for (int i = 0; i < frames; ++i)
+    {
+        const qint64 position = firstPosition + qint64(i) * hop;
+        float *row = block.appendFrame(position);
+        for (int b = 0; b < bands; ++b)
+        {
+            row[b] = -80.0f + (position / hop % 97) * 0.5f + b * 0.25f;
+        }
+    }
+    return block;
+}
+}
+
+void TestSpectrogramStore::testRoundTripFloat32()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("take.egspec");
+    const SpectrogramBlock first = MakeBlock(8, 160, 0, 100);
+    const SpectrogramBlock second = MakeBlock(8, 160, 100 * 160, 50);
+
+    SpectrogramStoreWriter writer(400, 160);
+    writer.setScale(-70.0f, 2.0f, false);
+    QVERIFY2(writer.open(path, 16000, 8), qPrintable(writer.errorString()));
+    QCOMPARE(writer.fileExtension(), QString(".egspec"));
+    QVERIFY(writer.write(first));
+    QVERIFY(writer.write(second));
+    writer.close();
+    QCOMPARE(writer.framesWritten(), qint64(150));
+    QCOMPARE(writer.droppedSamples(), quint64(0));
+
+    SpectrogramStore store;
+    QVERIFY2(store.open(path), qPrintable(store.errorString()));
+    QVERIFY(store.isComplete());
+    QCOMPARE(store.frameCount(), qint64(150));
+    QCOMPARE(store.bands(), 8);
+    QCOMPARE(store.hopSize(), 160);
+    QCOMPARE(store.sampleRate(), 16000);
+    QCOMPARE(store.header().windowSize, uint32_t(400));
+    QCOMPARE(store.header().floorDb, -70.0f);
+    QCOMPARE(store.header().referencePower, 2.0f);
+    QCOMPARE(int(store.header().flags), 0);
+
+    // Rows come straight from the mapping, one after the other
+    QCOMPARE(QVector<float>(store.frame(0), store.frame(0) + first.values.size()), first.values);
+    QCOMPARE(QVector<float>(store.frame(100), store.frame(100) + second.values.size()), second.values);
+    QCOMPARE(store.frame(1), store.frame(0) + 8);
+    QVERIFY(store.frame(150) == nullptr);
+
+    QVector<float> rows(3 * 8, 1.0f);
+    QCOMPARE(store.readFrames(148, 3, rows.data()), qint64(2));
+    QCOMPARE(rows[0], second.frame(48)[0]);
+    QCOMPARE(rows[2 * 8], 1.0f); // Past the end is left alone
+}
+
+void TestSpectrogramStore::testHalfPrecision()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("half.egspec");
+    const SpectrogramBlock block = MakeBlock(25, 256, 0, 40);
+
+    SpectrogramStoreWriter writer(512, 256, SpectrogramStoreWriter::Float16);
+    writer.setScale(-80.0f, 1.0f, true);
+    QVERIFY(writer.open(path, 16000, 25));
+    QVERIFY(writer.write(block));
+    writer.close();
+    QVERIFY(QFileInfo(path).size() < qint64(64 + 40 * 25 * 4)); // Half the matrix, plus the index
+
+    SpectrogramStore store;
+    QVERIFY(store.open(path));
+    QCOMPARE(store.frameCount(), qint64(40));
+    QCOMPARE(int(store.header().flags), SpectrogramStoreWriter::NormalizedFlag);
+    QVERIFY(store.frame(0) == nullptr); // Decoded only
+
+    QVector<float> values(40 * 25);
+    QCOMPARE(store.readFrames(0, 40, values.data()), qint64(40));
+    for (int i = 0; i < values.size(); ++i)
+    {
+        QVERIFY(qAbs(values[i] - block.values[i]) <= 0.05f); // Within half a step of fp16 near 80
+    }
+}
+
+void TestSpectrogramStore::testSeekIndex()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("gap.egspec");
+
+    // 300 frames, then a gap of 10000 samples, then 300 more
+    const qint64 beforeMs = QDateTime::currentMSecsSinceEpoch();
+    SpectrogramStoreWriter writer(256, 128);
+    QVERIFY(writer.open(path, 16000, 4));
+    QVERIFY(writer.write(MakeBlock(4, 128, 0, 300)));
+    QVERIFY(writer.write(MakeBlock(4, 128, 300 * 128 + 10000, 300)));
+    writer.close();
+
+    SpectrogramStore store;
+    QVERIFY(store.open(path));
+    QCOMPARE(store.frameCount(), qint64(600));
+    QCOMPARE(store.framePosition(0), qint64(0));
+    QCOMPARE(store.framePosition(255), qint64(255 * 128));
+    QCOMPARE(store.frameAtPosition(100 * 128 + 5), qint64(100));
+
+    // The index entry at frame 512 lies after the gap, so positions past it are found exactly
+    QCOMPARE(store.framePosition(512), qint64(512 * 128 + 10000));
+    QCOMPARE(store.frameAtPosition(520 * 128 + 10000), qint64(520));
+    QCOMPARE(store.frameAtPosition(-5), qint64(0));
+    QCOMPARE(store.frameAtPosition(qint64(1) << 40), qint64(599));
+
+    // Wall clock: the whole run was computed just now
+    QCOMPARE(store.frameAtTime(beforeMs - 60000), qint64(0));
+    QCOMPARE(store.frameAtTime(QDateTime::currentMSecsSinceEpoch() + 60000), qint64(599));
+}
+
+void TestSpectrogramStore::testReadsLiveStore()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("live.egspec");
+    const SpectrogramBlock block = MakeBlock(6, 100, 0, 30);
+
+    SpectrogramStoreWriter writer(200, 100);
+    QVERIFY(writer.open(path, 8000, 6));
+    QVERIFY(writer.write(block));
+    QTRY_COMPARE(writer.framesWritten(), qint64(30));
+
+    // Still being written: no index yet, read by its size
+    SpectrogramStore store;
+    QVERIFY(store.open(path));
+    QVERIFY(!store.isComplete());
+    QCOMPARE(store.frameCount(), qint64(30));
+    QCOMPARE(store.frame(29)[5], block.frame(29)[5]);
+    QCOMPARE(store.framePosition(29), qint64(2900));
+    QCOMPARE(store.frameAtTime(0), qint64(-1));
+    store.close();
+    writer.close();
+
+    QVERIFY(store.open(path));
+    QVERIFY(store.isComplete());
+    QCOMPARE(store.frameCount(), qint64(30));
+}
+
+void TestSpectrogramStore::testRejectsOtherFiles()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    SpectrogramStore store;
+    QVERIFY(!store.open(dir.filePath("missing.egspec")));
+    QVERIFY(!store.errorString().isEmpty());
+
+    const QString path = dir.filePath("text.egspec");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(100, 'x'));
+    file.close();
+    QVERIFY(!store.open(path));
+    QVERIFY(!store.isOpen());
+
+    // A block with the wrong number of bands is refused
+    SpectrogramStoreWriter writer(256, 128);
+    QVERIFY(writer.open(dir.filePath("bands.egspec"), 16000, 4));
+    QVERIFY(!writer.write(MakeBlock(5, 128, 0, 3)));
+}
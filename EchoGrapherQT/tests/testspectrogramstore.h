@@ -0,0 +1,19 @@
+#ifndef TESTSPECTROGRAMSTORE_H
+#define TESTSPECTROGRAMSTORE_H
+
+#include <QtTest>
+#include "../spectrogramstore.h"
+
+class TestSpectrogramStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRoundTripFloat32();
+    void testHalfPrecision();
+    void testSeekIndex();
+    void testReadsLiveStore();
+    void testRejectsOtherFiles();
+};
+
+#endif // TESTSPECTROGRAMSTORE_H
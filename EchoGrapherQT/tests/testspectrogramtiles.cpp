@@ -0,0 +1,158 @@
+#include "testspectrogramtiles.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+namespace
+{
+const Colormap classic(Colormap::Classic);
+
+// `frames` frames of two bands: band 0 silent, band 1 at full scale
+void Append(SpectrogramPyramid &pyramid, qint64 frames)
+{
+    const float values[] = {0.0f, 1.0f};
+    if (pyramid.bands() != 2)
+    {
+        pyramid.reset(2);
+    }
+    for (qint64 i = 0; i < frames; ++i)
+    {
+        pyramid.appendFrame(values);
+    }
+}
+}
+
+void TestSpectrogramTiles::testTileColours()
+{
+    SpectrogramPyramid pyramid;
+    Append(pyramid, 300);
+    SpectrogramTileCache cache(&pyramid);
+
+    const QImage *tile = cache.tile(0, 0);
+    QVERIFY(tile);
+    QCOMPARE(tile->width(), SpectrogramTileCache::TileColumns);
+    QCOMPARE(tile->height(), 2);
+    QCOMPARE(tile->pixel(0, 0), classic.color(1.0f)); // Highest band on top
+    QCOMPARE(tile->pixel(0, 1), classic.color(0.0f));
+
+    // The last tile is only coloured as far as there are columns
+    tile = cache.tile(0, 1);
+    QVERIFY(tile);
+    QCOMPARE(tile->pixel(43, 0), classic.color(1.0f));
+    QCOMPARE(tile->pixel(44, 0), qRgb(0, 0, 0));
+    QVERIFY(cache.tile(0, 2) == nullptr);
+    QVERIFY(cache.tile(9, 1) == nullptr);
+}
+
+void TestSpectrogramTiles::testNewestTileGrows()
+{
+    SpectrogramPyramid pyramid;
+    Append(pyramid, 300);
+    SpectrogramTileCache cache(&pyramid);
+    QVERIFY(cache.tile(0, 0));
+    QVERIFY(cache.tile(0, 1));
+    QVERIFY(cache.tile(0, 1));
+    QCOMPARE(cache.misses(), qint64(2));
+    QCOMPARE(cache.hits(), qint64(1));
+
+    // Only the tile the new frame went into is rendered again
+    Append(pyramid, 1);
+    QCOMPARE(cache.tile(0, 1)->pixel(44, 0), classic.color(1.0f));
+    QCOMPARE(cache.misses(), qint64(3));
+    QVERIFY(cache.tile(0, 0));
+    QCOMPARE(cache.hits(), qint64(2));
+}
+
+void TestSpectrogramTiles::testEvictsLeastRecentlyUsed()
+{
+    SpectrogramPyramid pyramid;
+    Append(pyramid, 4 * SpectrogramTileCache::TileColumns);
+    SpectrogramTileCache cache(&pyramid, 4 << 10); // Two tiles of 256 x 2 pixels
+
+    QVERIFY(cache.tile(0, 0));
+    QVERIFY(cache.tile(0, 1));
+    QVERIFY(cache.tile(0, 0)); // Now the most recently used
+    QVERIFY(cache.tile(0, 2));
+    QCOMPARE(cache.count(), 2);
+
+    const qint64 misses = cache.misses();
+    QVERIFY(cache.tile(0, 0));
+    QCOMPARE(cache.misses(), misses);
+    QVERIFY(cache.tile(0, 1));
+    QCOMPARE(cache.misses(), misses + 1);
+}
+
+void TestSpectrogramTiles::testPaletteClearsCache()
+{
+    SpectrogramPyramid pyramid;
+    Append(pyramid, 100);
+    SpectrogramTileCache cache(&pyramid);
+    QVERIFY(cache.tile(0, 0));
+    QCOMPARE(cache.count(), 1);
+
+    cache.setPalette(Colormap::Viridis);
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.tile(0, 0)->pixel(0, 0), Colormap(Colormap::Viridis).color(1.0f));
+
+    cache.setRange(0.0f, 2.0f);
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.tile(0, 0)->pixel(0, 0), Colormap(Colormap::Viridis).color(0.5f));
+}
+
+void TestSpectrogramTiles::testLevelNotAvailable()
+{
+    // With only the last 32 raw frames kept, the start is down to the stored levels
+    SpectrogramPyramid pyramid(SpectrogramPyramid::Max, 32);
+    Append(pyramid, 1000);
+    SpectrogramTileCache cache(&pyramid);
+    QVERIFY(cache.tile(0, 0) == nullptr);
+    QVERIFY(cache.tile(0, 3) == nullptr);
+    QVERIFY(cache.tile(SpectrogramPyramid::StoredFromLevel, 0));
+
+    // An item shows that range at the finest level that is left
+    SpectrogramTileItem item(&pyramid);
+    item.sync();
+    QImage canvas(100, 50, QImage::Format_RGB32);
+    QPainter painter(&canvas);
+    QStyleOptionGraphicsItem option;
+    option.exposedRect = QRectF(0, 0, 100, SpectrogramTileItem::Height);
+    painter.scale(1.0, 0.1);
+    item.paint(&painter, &option, nullptr);
+    QCOMPARE(item.paintedLevel(), int(SpectrogramPyramid::StoredFromLevel));
+}
+
+void TestSpectrogramTiles::testItemPicksLevel()
+{
+    SpectrogramPyramid pyramid;
+    Append(pyramid, 4096);
+    SpectrogramTileItem item(&pyramid);
+    item.sync();
+    QCOMPARE(item.boundingRect(), QRectF(0, 0, 4096, SpectrogramTileItem::Height));
+
+    QImage canvas(256, 50, QImage::Format_RGB32);
+    canvas.fill(Qt::black);
+    QStyleOptionGraphicsItem option;
+
+    // The whole session in 256 pixels: a column per 16 frames, one tile
+    {
+        QPainter painter(&canvas);
+        painter.scale(256.0 / 4096, 0.1);
+        option.exposedRect = item.boundingRect();
+        item.paint(&painter, &option, nullptr);
+    }
+    QCOMPARE(item.paintedLevel(), 4);
+    QCOMPARE(item.tiles().count(), 1);
+    QCOMPARE(canvas.pixel(100, 0), classic.color(1.0f));
+    QCOMPARE(canvas.pixel(100, 49), classic.color(0.0f));
+
+    // Zoomed in on 200 frames: full detail, only the two tiles they fall in
+    {
+        QPainter painter(&canvas);
+        painter.translate(-1000, 0);
+        painter.scale(1.0, 0.1);
+        option.exposedRect = QRectF(1000, 0, 200, SpectrogramTileItem::Height);
+        item.paint(&painter, &option, nullptr);
+    }
+    QCOMPARE(item.paintedLevel(), 0);
+    QCOMPARE(item.tiles().count(), 3);
+}
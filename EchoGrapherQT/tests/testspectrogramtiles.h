@@ -0,0 +1,20 @@
+#ifndef TESTSPECTROGRAMTILES_H
+#define TESTSPECTROGRAMTILES_H
+
+#include <QtTest>
+#include "../spectrogramtiles.h"
+
+class TestSpectrogramTiles : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testTileColours();
+    void testNewestTileGrows();
+    void testEvictsLeastRecentlyUsed();
+    void testPaletteClearsCache();
+    void testLevelNotAvailable();
+    void testItemPicksLevel();
+};
+
+#endif // TESTSPECTROGRAMTILES_H
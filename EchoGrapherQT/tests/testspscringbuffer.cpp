@@ -0,0 +1,89 @@
+#include "testspscringbuffer.h"
+#include <QThread>
+
+void TestSpscRingBuffer::testCapacityIsPowerOfTwo()
+{
+    SpscRingBuffer<float> ring(1000);
+    QCOMPARE(ring.capacity(), 1024);
+    QCOMPARE(ring.readAvailable(), 0);
+    QCOMPARE(ring.writeAvailable(), 1024);
+
+    ring.reset(64);
+    QCOMPARE(ring.capacity(), 64);
+}
+
+void TestSpscRingBuffer::testPushPopWrapsAround()
+{
+    SpscRingBuffer<float> ring(8);
+    const float first[6] = {1, 2, 3, 4, 5, 6};
+    const float second[5] = {7, 8, 9, 10, 11};
+    float out[8] = {};
+
+    QVERIFY(ring.push(first, 6));
+    QCOMPARE(ring.pop(out, 4), 4);
+    QCOMPARE(out[3], 4.0f);
+
+    // The second block straddles the end of the storage
+    QVERIFY(ring.push(second, 5));
+    QCOMPARE(ring.readAvailable(), 7);
+    QCOMPARE(ring.pop(out, 8), 7);
+    const float expected[7] = {5, 6, 7, 8, 9, 10, 11};
+    for (int i = 0; i < 7; ++i)
+    {
+        QCOMPARE(out[i], expected[i]);
+    }
+    QCOMPARE(ring.pop(out, 8), 0);
+}
+
+void TestSpscRingBuffer::testPushFailsWhenFull()
+{
+    SpscRingBuffer<float> ring(4);
+    const float block[3] = {1, 2, 3};
+
+    QVERIFY(ring.push(block, 3));
+    QVERIFY(!ring.push(block, 3)); // All or nothing, the ring is left untouched
+    QCOMPARE(ring.readAvailable(), 3);
+}
+
+void TestSpscRingBuffer::testConcurrentProducerConsumer()
+{
+    const int blockSize = 64;
+    const int totalBlocks = 20000;
+    SpscRingBuffer<int> ring(blockSize * 16);
+
+    QThread *producer = QThread::create([&ring]
+                                        {
+        int block[blockSize];
+        int next = 0;
+        for (int b = 0; b < totalBlocks; ++b)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                block[i] = next + i;
+            }
+            while (!ring.push(block, blockSize))
+            {
+                QThread::yieldCurrentThread();
+            }
+            next += blockSize;
+        } });
+    producer->start();
+
+    // The consumer must see every sample exactly once and in order
+    int expected = 0;
+    bool inOrder = true;
+    int batch[blockSize * 4];
+    while (expected < blockSize * totalBlocks)
+    {
+        int count = ring.pop(batch, blockSize * 4);
+        for (int i = 0; i < count; ++i)
+        {
+            inOrder = inOrder && (batch[i] == expected++);
+        }
+    }
+
+    producer->wait();
+    delete producer;
+    QVERIFY(inOrder);
+    QCOMPARE(ring.readAvailable(), 0);
+}
@@ -0,0 +1,18 @@
+#ifndef TESTSPSCRINGBUFFER_H
+#define TESTSPSCRINGBUFFER_H
+
+#include <QtTest>
+#include "../spscringbuffer.h"
+
+class TestSpscRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCapacityIsPowerOfTwo();
+    void testPushPopWrapsAround();
+    void testPushFailsWhenFull();
+    void testConcurrentProducerConsumer();
+};
+
+#endif // TESTSPSCRINGBUFFER_H
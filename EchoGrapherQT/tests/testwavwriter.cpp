@@ -0,0 +1,225 @@
+#include "testwavwriter.h"
+#include "../wavreader.h"
+
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <cstring>
+
+void TestWavWriter::testWritesHeaderAndSamples()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("writer.wav");
+
+    // A small batch size makes the writer go through several full batches plus a partial one
+    WavWriter writer(8192);
+    QVERIFY(writer.open(path, 48000, 1));
+    QVERIFY(writer.isOpen());
+
+    const int blockSize = 300;
+    const int blocks = 50;
+    QVector<float> block(blockSize);
+    for (int b = 0; b < blocks; ++b)
+    {
+        for (int i = 0; i < blockSize; ++i)
+        {
+            block[i] = b * blockSize + i;
+        }
+        QVERIFY(writer.write(block.constData(), blockSize));
+    }
+    writer.close();
+    QVERIFY(!writer.isOpen());
+    QCOMPARE(writer.samplesWritten(), qint64(blockSize * blocks));
+    QCOMPARE(writer.backlogSamples(), qint64(0));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.size(), qint64(sizeof(Rf64WavHeader) + blockSize * blocks * sizeof(float)));
+
+    // Short enough for plain RIFF, with the ds64 room left as a JUNK chunk
+    Rf64WavHeader header;
+    QCOMPARE(file.read(reinterpret_cast<char *>(&header), sizeof(Rf64WavHeader)), qint64(sizeof(Rf64WavHeader)));
+    QVERIFY(memcmp(header.chunkID, "RIFF", 4) == 0);
+    QVERIFY(memcmp(header.ds64ID, "JUNK", 4) == 0);
+    QCOMPARE(header.sampleRate, 48000u);
+    QCOMPARE(header.numChannels, uint16_t(1));
+    QCOMPARE(header.subchunk2Size, uint32_t(blockSize * blocks * sizeof(float)));
+    QCOMPARE(header.chunkSize, 72 + header.subchunk2Size);
+
+    QVector<float> samples(blockSize * blocks);
+    file.read(reinterpret_cast<char *>(samples.data()), samples.size() * sizeof(float));
+    for (int i = 0; i < samples.size(); ++i)
+    {
+        QCOMPARE(samples[i], static_cast<float>(i));
+    }
+}
+
+void TestWavWriter::testReportsBacklogAndDrops()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    WavWriter writer;
+    QVERIFY(writer.open(dir.filePath("backlog.wav"), 1000, 1, 0.01));
+
+    // Far more than the ring can take in one go: the excess is counted, never blocked on
+    QVector<float> block(1 << 20, 0.5f);
+    writer.write(block.constData(), block.size());
+    QVERIFY(writer.droppedSamples() > 0 || writer.backlogSamples() > 0);
+
+    writer.close();
+    QCOMPARE(writer.backlogSamples(), qint64(0));
+}
+
+void TestWavWriter::testRf64HeaderPastFourGigabytes()
+{
+    const qint64 small = qint64(1000) * 2 * sizeof(float);
+    Rf64WavHeader header = WavWriter::BuildHeader(48000, 2, small);
+    QVERIFY(memcmp(header.chunkID, "RIFF", 4) == 0);
+    QCOMPARE(header.subchunk2Size, uint32_t(small));
+
+    // 5 GiB of stereo float: the 32-bit fields give up, ds64 has the real sizes
+    const qint64 large = qint64(5) << 30;
+    header = WavWriter::BuildHeader(48000, 2, large);
+    QVERIFY(memcmp(header.chunkID, "RF64", 4) == 0);
+    QVERIFY(memcmp(header.ds64ID, "ds64", 4) == 0);
+    QCOMPARE(header.chunkSize, 0xFFFFFFFFu);
+    QCOMPARE(header.subchunk2Size, 0xFFFFFFFFu);
+    QCOMPARE(header.dataSize, uint64_t(large));
+    QCOMPARE(header.riffSize, uint64_t(large + 72));
+    QCOMPARE(header.sampleCount, uint64_t(large / 8));
+
+    // The reader takes the size from ds64; a short file stands in for the long one
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("long.wav");
+    const QVector<float> samples = {0.5f, -0.5f, 0.25f, -0.25f, 0.125f, -0.125f};
+    header.dataSize = samples.size() * sizeof(float);
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(samples.constData()), samples.size() * sizeof(float));
+    file.write(QByteArray(64, '\0')); // Trailing bytes the data size must exclude
+    file.close();
+
+    WavInfo info;
+    QString error;
+    QVERIFY2(ReadWavInfo(path, info, error), qPrintable(error));
+    QCOMPARE(info.numChannels, uint16_t(2));
+    QCOMPARE(info.numFrames, qint64(3));
+}
+
+void TestWavWriter::testRotatesIntoSegments()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("take.wav");
+    QCOMPARE(WavWriter::SegmentPath(path, 2), dir.filePath("take_002.wav"));
+
+    // 10 frames of stereo per segment, so 35 frames make three full segments and a partial one
+    WavWriter writer(8192);
+    writer.setSegmentLimits(0.01, 0);
+    QVERIFY(writer.open(path, 1000, 2));
+    QVector<float> written(35 * 2);
+    for (int i = 0; i < written.size(); ++i)
+    {
+        written[i] = i;
+    }
+    QVERIFY(writer.write(written.constData(), written.size()));
+    writer.close();
+    QCOMPARE(writer.segmentCount(), 4);
+    QCOMPARE(writer.samplesWritten(), qint64(written.size()));
+    QVERIFY(!QFile::exists(path));
+
+    // Back to back, every segment a complete file of its own
+    QVector<float> read;
+    for (int segment = 1; segment <= 4; ++segment)
+    {
+        WavInfo info;
+        QString error;
+        QVERIFY2(ReadWavInfo(WavWriter::SegmentPath(path, segment), info, error), qPrintable(error));
+        QCOMPARE(info.numFrames, qint64(segment < 4 ? 10 : 5));
+        QFile file(info.path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.size(), info.dataOffset + info.numFrames * 8);
+        QVector<float> samples(info.numFrames * 2);
+        QByteArray scratch;
+        QVERIFY(ReadInterleavedSamples(file, info, 0, info.numFrames, samples.data(), scratch));
+        read.append(samples);
+    }
+    QCOMPARE(read, written);
+
+    // A byte limit rounds down to whole frames after the header
+    WavWriter bySize(8192);
+    bySize.setSegmentLimits(0.0, sizeof(Rf64WavHeader) + 20 * 8 + 4);
+    QVERIFY(bySize.open(dir.filePath("sized.wav"), 1000, 2));
+    QVERIFY(bySize.write(written.constData(), written.size()));
+    bySize.close();
+    QCOMPARE(bySize.segmentCount(), 2);
+    QCOMPARE(QFileInfo(WavWriter::SegmentPath(dir.filePath("sized.wav"), 1)).size(), qint64(sizeof(Rf64WavHeader) + 20 * 8));
+}
+
+void TestWavWriter::testHeaderSyncedWhileRecording()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("live.wav");
+
+    // A batch far larger than the audio, so only the sync can put it on disk before close()
+    WavWriter writer;
+    writer.setHeaderSyncInterval(1);
+    QVERIFY(writer.open(path, 8000, 1));
+    const QVector<float> block(800, 0.25f);
+    QVERIFY(writer.write(block.constData(), block.size()));
+
+    // What a killed process would leave behind: a valid file with everything synced so far
+    WavInfo info;
+    QString error;
+    for (int attempt = 0; attempt < 200 && info.numFrames < block.size(); ++attempt)
+    {
+        QThread::msleep(10);
+        Rf64WavHeader header;
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly) && file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header) &&
+            header.subchunk2Size == block.size() * sizeof(float))
+        {
+            QVERIFY2(ReadWavInfo(path, info, error), qPrintable(error));
+        }
+    }
+    QCOMPARE(info.numFrames, qint64(block.size()));
+    QVERIFY(writer.isOpen());
+    writer.close();
+}
+
+void TestWavWriter::testWriteFailureIsReported()
+{
+#ifdef Q_OS_LINUX
+    // Opens like any file, then every write fails with ENOSPC, like a disk that filled up
+    const QString path = "/dev/full";
+    if (!QFileInfo(path).isWritable())
+    {
+        QSKIP("No writable /dev/full");
+    }
+    WavWriter writer(8192);
+    QVERIFY(writer.open(path, 48000, 1));
+    QVERIFY(!writer.hasFailed());
+
+    QVector<float> block(4096, 0.5f);
+    for (int b = 0; b < 8; ++b)
+    {
+        QVERIFY(writer.write(block.constData(), block.size())); // Still accepted into the ring
+    }
+    writer.close();
+    QVERIFY(writer.hasFailed());
+    QVERIFY(!writer.errorString().isEmpty());
+
+    // A new file starts with a clean slate
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(writer.open(dir.filePath("after.wav"), 48000, 1));
+    QVERIFY(!writer.hasFailed());
+    writer.close();
+#else
+    QSKIP("Needs /dev/full");
+#endif
+}
@@ -0,0 +1,20 @@
+#ifndef TESTWAVWRITER_H
+#define TESTWAVWRITER_H
+
+#include <QtTest>
+#include "../wavwriter.h"
+
+class TestWavWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testWritesHeaderAndSamples();
+    void testReportsBacklogAndDrops();
+    void testRf64HeaderPastFourGigabytes();
+    void testRotatesIntoSegments();
+    void testHeaderSyncedWhileRecording();
+    void testWriteFailureIsReported();
+};
+
+#endif // TESTWAVWRITER_H
@@ -0,0 +1,52 @@
+#include "wavfilesource.h"
+
+WavFileSource::WavFileSource(const QString &path, bool loop, bool mixToMono) : path(path), loop(loop), mixToMono(mixToMono)
+{
+}
+
+bool WavFileSource::open(int blockSize)
+{
+    close();
+    Q_UNUSED(blockSize); // Blocks are decoded straight from the mapping, there is nothing to size
+    if (!mapped.open(path, MappedWavFile::Sequential))
+    {
+        lastError = QString("Error: could not read %1: %2").arg(path, mapped.errorString());
+        return false;
+    }
+    info = mapped.wavInfo();
+    position = 0;
+    delivered = 0;
+    startClock();
+    return true;
+}
+
+void WavFileSource::close()
+{
+    mapped.close();
+}
+
+int WavFileSource::read(float *buffer, int frames)
+{
+    if (position >= info.numFrames)
+    {
+        if (!loop || info.numFrames == 0)
+        {
+            return 0;
+        }
+        position = 0;
+    }
+
+    frames = static_cast<int>(qMin<qint64>(frames, info.numFrames - position));
+    pace(delivered + frames);
+    if (mixToMono)
+    {
+        mapped.readMono(position, frames, buffer);
+    }
+    else
+    {
+        mapped.readInterleaved(position, frames, buffer);
+    }
+    position += frames;
+    delivered += frames;
+    return frames;
+}
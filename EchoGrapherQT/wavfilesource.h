@@ -0,0 +1,37 @@
+#ifndef WAVFILESOURCE_H
+#define WAVFILESOURCE_H
+
+#include "audiosource.h"
+#include "mappedwavfile.h"
+
+// Replays a WAV recording, mixed down to mono or with all of its channels, at speed() times
+// real time or unthrottled. Lets a field recording be run through the exact same pipeline as
+// the live input. The file is memory-mapped, so long recordings replay straight from the page
+// cache with read-ahead rather than through read() copies.
+class WavFileSource : public AudioSource
+{
+public:
+    explicit WavFileSource(const QString &path, bool loop = false, bool mixToMono = true);
+
+    bool open(int blockSize) override;
+    void close() override;
+    int sampleRate() const override { return static_cast<int>(info.sampleRate); }
+    int channelCount() const override { return mixToMono ? 1 : info.numChannels; }
+    QString description() const override { return QString("Replay of %1").arg(path); }
+    int read(float *buffer, int frames) override;
+
+    QString fileName() const { return path; }
+    const WavInfo &wavInfo() const { return info; }
+    qint64 framePosition() const { return position; } // Next frame of the file to be read
+
+private:
+    QString path;
+    bool loop;
+    bool mixToMono;
+    WavInfo info;
+    MappedWavFile mapped;
+    qint64 position = 0;  // Within the file
+    qint64 delivered = 0; // Since open(), across loops, for pacing
+};
+
+#endif // WAVFILESOURCE_H
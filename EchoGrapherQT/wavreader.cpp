@@ -0,0 +1,219 @@
+#include "wavreader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+template <typename T>
+T ReadLittleEndian(const char *data)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+// One sample of any supported encoding as float in [-1, 1]
+float DecodeSample(const char *data, uint16_t audioFormat, int bytesPerSample)
+{
+    if (audioFormat == 3)
+    {
+        if (bytesPerSample == 4)
+        {
+            float value;
+            memcpy(&value, data, sizeof(float));
+            return value;
+        }
+        double value;
+        memcpy(&value, data, sizeof(double));
+        return static_cast<float>(value);
+    }
+    if (bytesPerSample == 2)
+    {
+        return static_cast<int16_t>(ReadLittleEndian<uint16_t>(data)) / 32768.0f;
+    }
+    if (bytesPerSample == 3)
+    {
+        // Place the three bytes in the top of an int32 and shift back down to sign-extend
+        int32_t value = static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 8) |
+                                             (static_cast<uint32_t>(static_cast<uint8_t>(data[1])) << 16) |
+                                             (static_cast<uint32_t>(static_cast<uint8_t>(data[2])) << 24)) >> 8;
+        return value / 8388608.0f;
+    }
+    return static_cast<int32_t>(ReadLittleEndian<uint32_t>(data)) / 2147483648.0f;
+}
+
+// Reads the raw bytes of up to `count` frames into `scratch`; returns the frames available, -1 on error
+qint64 ReadRawFrames(QFile &file, const WavInfo &info, qint64 firstFrame, qint64 count, QByteArray &scratch)
+{
+    const int bytesPerFrame = info.bytesPerFrame();
+    const qint64 available = qBound<qint64>(0, info.numFrames - firstFrame, count);
+
+    const qint64 rawBytes = available * bytesPerFrame;
+    if (scratch.size() < rawBytes)
+    {
+        scratch.resize(rawBytes);
+    }
+    if (!file.seek(info.dataOffset + firstFrame * bytesPerFrame) || file.read(scratch.data(), rawBytes) != rawBytes)
+    {
+        return -1;
+    }
+    return available;
+}
+}
+
+bool ReadWavInfo(const QString &path, WavInfo &info, QString &error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        error = file.errorString();
+        return false;
+    }
+
+    char riff[12];
+    const bool isRiff = file.read(riff, 12) == 12 && memcmp(riff + 8, "WAVE", 4) == 0 &&
+                        (memcmp(riff, "RIFF", 4) == 0 || memcmp(riff, "RF64", 4) == 0 || memcmp(riff, "BW64", 4) == 0);
+    if (!isRiff)
+    {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    info.path = path;
+    bool haveFormat = false;
+    qint64 ds64DataSize = -1; // RF64/BW64: the data size that does not fit the data chunk's 32 bits
+    char chunkHeader[8];
+    while (file.read(chunkHeader, 8) == 8)
+    {
+        const uint32_t chunkSize = ReadLittleEndian<uint32_t>(chunkHeader + 4);
+        const qint64 chunkStart = file.pos();
+
+        if (memcmp(chunkHeader, "fmt ", 4) == 0)
+        {
+            QByteArray fmt = file.read(qMin<uint32_t>(chunkSize, 40));
+            if (fmt.size() < 16)
+            {
+                error = "truncated fmt chunk";
+                return false;
+            }
+            info.audioFormat = ReadLittleEndian<uint16_t>(fmt.constData());
+            info.numChannels = ReadLittleEndian<uint16_t>(fmt.constData() + 2);
+            info.sampleRate = ReadLittleEndian<uint32_t>(fmt.constData() + 4);
+            info.bitsPerSample = ReadLittleEndian<uint16_t>(fmt.constData() + 14);
+            if (info.audioFormat == 0xFFFE && fmt.size() >= 26)
+            {
+                info.audioFormat = ReadLittleEndian<uint16_t>(fmt.constData() + 24); // WAVE_FORMAT_EXTENSIBLE sub-format
+            }
+            haveFormat = true;
+        }
+        else if (memcmp(chunkHeader, "ds64", 4) == 0)
+        {
+            const QByteArray ds64 = file.read(qMin<uint32_t>(chunkSize, 28));
+            if (ds64.size() >= 16)
+            {
+                ds64DataSize = static_cast<qint64>(ReadLittleEndian<uint64_t>(ds64.constData() + 8));
+            }
+        }
+        else if (memcmp(chunkHeader, "data", 4) == 0)
+        {
+            if (!haveFormat)
+            {
+                error = "data chunk before fmt chunk";
+                return false;
+            }
+            // A recorder that was killed leaves a zero size behind, fall back to the file size
+            qint64 dataSize = chunkSize;
+            if (chunkSize == 0xFFFFFFFF && ds64DataSize >= 0)
+            {
+                dataSize = ds64DataSize;
+            }
+            if (dataSize == 0 || dataSize == 0xFFFFFFFF || chunkStart + dataSize > file.size())
+            {
+                dataSize = file.size() - chunkStart;
+            }
+            const int bytesPerFrame = info.numChannels * info.bitsPerSample / 8;
+            if (bytesPerFrame <= 0 || info.sampleRate == 0)
+            {
+                error = "invalid fmt chunk";
+                return false;
+            }
+            info.dataOffset = chunkStart;
+            info.numFrames = dataSize / bytesPerFrame;
+
+            const bool isInteger = info.audioFormat == 1 && (info.bitsPerSample == 16 || info.bitsPerSample == 24 || info.bitsPerSample == 32);
+            const bool isFloat = info.audioFormat == 3 && (info.bitsPerSample == 32 || info.bitsPerSample == 64);
+            if (!isInteger && !isFloat)
+            {
+                error = QString("unsupported sample format %1 with %2 bits").arg(info.audioFormat).arg(info.bitsPerSample);
+                return false;
+            }
+            return true;
+        }
+
+        file.seek(chunkStart + chunkSize + (chunkSize & 1)); // Chunks are padded to an even size
+    }
+
+    error = "no data chunk";
+    return false;
+}
+
+void DecodeMonoFrames(const char *raw, const WavInfo &info, qint64 frames, float *out)
+{
+    const int bytesPerSample = info.bitsPerSample / 8;
+    const float channelScale = 1.0f / info.numChannels;
+    for (qint64 frame = 0; frame < frames; ++frame)
+    {
+        float sum = 0.0f;
+        for (int channel = 0; channel < info.numChannels; ++channel, raw += bytesPerSample)
+        {
+            sum += DecodeSample(raw, info.audioFormat, bytesPerSample);
+        }
+        out[frame] = sum * channelScale;
+    }
+}
+
+void DecodeInterleavedFrames(const char *raw, const WavInfo &info, qint64 frames, float *out)
+{
+    const int bytesPerSample = info.bitsPerSample / 8;
+    const qint64 samples = frames * info.numChannels;
+    for (qint64 i = 0; i < samples; ++i, raw += bytesPerSample)
+    {
+        out[i] = DecodeSample(raw, info.audioFormat, bytesPerSample);
+    }
+}
+
+bool ReadMonoSamples(QFile &file, const WavInfo &info, qint64 firstFrame, qint64 count, float *out, QByteArray &scratch)
+{
+    const qint64 available = ReadRawFrames(file, info, firstFrame, count, scratch);
+    if (available < 0)
+    {
+        return false;
+    }
+    DecodeMonoFrames(scratch.constData(), info, available, out);
+
+    // Zero-pad past the end of the data
+    std::fill(out + available, out + count, 0.0f);
+    return true;
+}
+
+bool ReadInterleavedSamples(QFile &file, const WavInfo &info, qint64 firstFrame, qint64 count, float *out, QByteArray &scratch)
+{
+    const qint64 available = ReadRawFrames(file, info, firstFrame, count, scratch);
+    if (available < 0)
+    {
+        return false;
+    }
+    DecodeInterleavedFrames(scratch.constData(), info, available, out);
+    std::fill(out + available * info.numChannels, out + count * info.numChannels, 0.0f);
+    return true;
+}
+
+bool ReadMonoSamples(QFile &file, const WavInfo &info, qint64 firstFrame, qint64 count, float *out)
+{
+    QByteArray scratch;
+    return ReadMonoSamples(file, info, firstFrame, count, out, scratch);
+}
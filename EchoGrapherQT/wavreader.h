@@ -0,0 +1,39 @@
+#ifndef WAVREADER_H
+#define WAVREADER_H
+
+#include <QFile>
+#include <QString>
+
+// Where the samples of a WAV file live and how to decode them
+struct WavInfo
+{
+    QString path;
+    uint16_t audioFormat = 0; // 1 = integer PCM, 3 = IEEE float
+    uint16_t numChannels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t bitsPerSample = 0;
+    qint64 dataOffset = 0;
+    qint64 numFrames = 0; // Sample frames, one sample per channel
+
+    int bytesPerFrame() const { return numChannels * bitsPerSample / 8; }
+};
+
+// Walks the RIFF chunks, so files with LIST/fact/JUNK chunks or an extensible fmt chunk work too,
+// and RF64/BW64 files longer than 4 GiB through their ds64 chunk.
+// Accepts 16, 24 and 32-bit integer and 32 and 64-bit float samples.
+bool ReadWavInfo(const QString &path, WavInfo &info, QString &error);
+
+// Decodes `count` frames starting at `firstFrame` into mono float, averaging the channels and
+// zero-padding past the end of the data. `scratch` holds the raw bytes and is reused across calls.
+bool ReadMonoSamples(QFile &file, const WavInfo &info, qint64 firstFrame, qint64 count, float *out, QByteArray &scratch);
+bool ReadMonoSamples(QFile &file, const WavInfo &info, qint64 firstFrame, qint64 count, float *out);
+
+// As ReadMonoSamples, but keeps every channel: `out` receives count * numChannels interleaved samples
+bool ReadInterleavedSamples(QFile &file, const WavInfo &info, qint64 firstFrame, qint64 count, float *out, QByteArray &scratch);
+
+// Decode `frames` frames of raw sample data in the layout `info` describes, e.g. straight out of
+// a MappedWavFile; `out` receives `frames` mono or frames * numChannels interleaved samples
+void DecodeMonoFrames(const char *raw, const WavInfo &info, qint64 frames, float *out);
+void DecodeInterleavedFrames(const char *raw, const WavInfo &info, qint64 frames, float *out);
+
+#endif // WAVREADER_H
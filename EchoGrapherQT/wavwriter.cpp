@@ -0,0 +1,292 @@
+#include "wavwriter.h"
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr int BatchAlignment = 4096;                 // Page and logical block size
+    constexpr qint64 PreallocateStep = qint64(64) << 20; // Reserve disk space 64 MiB at a time
+}
+
+WavWriter::WavWriter(int batchBytes)
+    : batchBytes(qMax(BatchAlignment, batchBytes / BatchAlignment * BatchAlignment))
+{
+}
+
+WavWriter::~WavWriter()
+{
+    close();
+}
+
+void WavWriter::setSegmentLimits(double seconds, qint64 bytes)
+{
+    segmentSeconds = qMax(0.0, seconds);
+    segmentBytes = qMax<qint64>(0, bytes);
+}
+
+QString WavWriter::SegmentPath(const QString &path, int segment)
+{
+    const int dot = path.lastIndexOf('.');
+    const int slash = path.lastIndexOf('/');
+    const int split = dot > slash ? dot : path.size();
+    return path.left(split) + QString("_%1").arg(segment, 3, 10, QChar('0')) + path.mid(split);
+}
+
+Rf64WavHeader WavWriter::BuildHeader(uint32_t sampleRate, int channels, qint64 dataBytes)
+{
+    Rf64WavHeader header;
+    header.numChannels = channels;
+    header.sampleRate = sampleRate;
+    header.bitsPerSample = 32; // For 32-bit float data
+    header.audioFormat = 3;    // IEEE float
+    header.byteRate = header.sampleRate * header.numChannels * header.bitsPerSample / 8;
+    header.blockAlign = header.numChannels * header.bitsPerSample / 8;
+
+    const qint64 riffBytes = qint64(sizeof(Rf64WavHeader)) - 8 + dataBytes;
+    if (riffBytes <= qint64(0xFFFFFFFF))
+    {
+        header.chunkSize = static_cast<uint32_t>(riffBytes);
+        header.subchunk2Size = static_cast<uint32_t>(dataBytes);
+        return header;
+    }
+
+    // Too long for RIFF: the JUNK chunk becomes ds64 and carries the real sizes
+    memcpy(header.chunkID, "RF64", 4);
+    memcpy(header.ds64ID, "ds64", 4);
+    header.chunkSize = 0xFFFFFFFF;
+    header.subchunk2Size = 0xFFFFFFFF;
+    header.riffSize = static_cast<uint64_t>(riffBytes);
+    header.dataSize = static_cast<uint64_t>(dataBytes);
+    header.sampleCount = static_cast<uint64_t>(dataBytes / header.blockAlign);
+    return header;
+}
+
+bool WavWriter::openFile(const QString &path, uint32_t sampleRate, int channels)
+{
+    basePath = path;
+    rate = sampleRate;
+    channelCount = channels;
+
+    // Whole frames per segment, by whichever limit comes first
+    segmentSampleLimit = 0;
+    if (isRotating())
+    {
+        const qint64 frameBytes = qint64(channels) * int(sizeof(float));
+        qint64 frames = std::numeric_limits<qint64>::max();
+        if (segmentSeconds > 0.0)
+        {
+            frames = qMin(frames, static_cast<qint64>(segmentSeconds * sampleRate));
+        }
+        if (segmentBytes > 0)
+        {
+            frames = qMin(frames, (segmentBytes - qint64(sizeof(Rf64WavHeader))) / frameBytes);
+        }
+        segmentSampleLimit = qMax<qint64>(1, frames) * channels;
+    }
+
+    batch = static_cast<char *>(qMallocAligned(batchBytes, BatchAlignment));
+    if (!batch)
+    {
+        lastError = "Could not allocate the write batch.";
+        return false;
+    }
+    segments.store(0);
+    if (!startSegment())
+    {
+        qFreeAligned(batch);
+        batch = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// Opens the next file and stages its header placeholder. The first batch starts with it, so
+// every batch lands on a batchBytes boundary.
+bool WavWriter::startSegment()
+{
+    const int segment = segments.load() + 1;
+    file.setFileName(isRotating() ? SegmentPath(basePath, segment) : basePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+    {
+        lastError = file.errorString();
+        return false;
+    }
+    segments.store(segment);
+
+    const Rf64WavHeader header = BuildHeader(rate, channelCount, 0);
+    memcpy(batch, &header, sizeof(Rf64WavHeader));
+    batchFill = sizeof(Rf64WavHeader);
+    syncedFill = 0;
+    fileOffset = 0;
+    allocatedBytes = 0;
+    segmentSamples = 0;
+    sinceSync.start();
+    return true;
+}
+
+// Writes what is staged, patches the header with the final sizes and gives back the reserved space
+void WavWriter::endSegment()
+{
+    if (!file.isOpen())
+    {
+        return;
+    }
+    flushBatch();
+    const Rf64WavHeader header = BuildHeader(rate, channelCount, fileOffset - qint64(sizeof(Rf64WavHeader)));
+    writeAt(reinterpret_cast<const char *>(&header), sizeof(Rf64WavHeader), 0);
+
+#ifdef Q_OS_UNIX
+    if (allocatedBytes > fileOffset && ftruncate(file.handle(), fileOffset) != 0)
+    {
+        setWriteError(QString("ftruncate failed: %1").arg(errno));
+    }
+#endif
+    file.close();
+}
+
+void WavWriter::finishFile()
+{
+    endSegment();
+    qFreeAligned(batch);
+    batch = nullptr;
+    batchFill = 0;
+    syncedFill = 0;
+}
+
+int WavWriter::drain()
+{
+    if (!file.isOpen())
+    {
+        // A segment could not be opened; keep the ring moving so capture never backs up
+        float discard[1024];
+        const int count = ring.pop(discard, 1024);
+        writtenSamples.fetch_add(count);
+        return count;
+    }
+
+    qint64 room = (batchBytes - batchFill) / int(sizeof(float));
+    if (segmentSampleLimit > 0)
+    {
+        room = qMin(room, segmentSampleLimit - segmentSamples);
+    }
+    const int count = ring.pop(reinterpret_cast<float *>(batch + batchFill), static_cast<int>(room));
+    batchFill += count * int(sizeof(float));
+    segmentSamples += count;
+
+    if (segmentSampleLimit > 0 && segmentSamples == segmentSampleLimit)
+    {
+        endSegment();
+        startSegment();
+    }
+    else if (batchFill == batchBytes)
+    {
+        flushBatch();
+    }
+
+    if (headerSyncMs > 0 && sinceSync.elapsed() >= headerSyncMs)
+    {
+        syncHeader();
+    }
+    return count;
+}
+
+bool WavWriter::flushBatch()
+{
+    if (batchFill == 0)
+    {
+        return true;
+    }
+
+    const bool ok = writeStaged();
+    fileOffset += batchFill;
+    batchFill = 0;
+    syncedFill = 0;
+    return ok;
+}
+
+// Writes the staged bytes no sync has written yet, at their place in the batch
+bool WavWriter::writeStaged()
+{
+    if (batchFill == syncedFill)
+    {
+        return true;
+    }
+    preallocate(fileOffset + batchFill);
+    const bool ok = writeAt(batch + syncedFill, batchFill - syncedFill, fileOffset + syncedFill);
+
+    // The header placeholder only ever sits at the start of the first batch
+    const int headerBytes = (fileOffset == 0) ? int(sizeof(Rf64WavHeader)) : 0;
+    writtenSamples.fetch_add((batchFill - qMax(syncedFill, headerBytes)) / int(sizeof(float)));
+    syncedFill = batchFill;
+    return ok;
+}
+
+// Puts the samples staged so far on disk and the matching sizes in the header. The batch keeps
+// them, so the batch still goes out whole at its aligned offset.
+void WavWriter::syncHeader()
+{
+    sinceSync.start();
+    if (!file.isOpen() || !writeStaged())
+    {
+        return;
+    }
+    const Rf64WavHeader header = BuildHeader(rate, channelCount, fileOffset + batchFill - qint64(sizeof(Rf64WavHeader)));
+    writeAt(reinterpret_cast<const char *>(&header), sizeof(Rf64WavHeader), 0);
+}
+
+bool WavWriter::writeAt(const char *data, qint64 size, qint64 offset)
+{
+#ifdef Q_OS_UNIX
+    const int fd = file.handle();
+    while (size > 0)
+    {
+        ssize_t written = pwrite(fd, data, static_cast<size_t>(size), offset);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            setWriteError(QString("pwrite failed: %1").arg(errno));
+            return false;
+        }
+        data += written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+#else
+    if (!file.seek(offset) || file.write(data, size) != size)
+    {
+        setWriteError(file.errorString());
+        return false;
+    }
+    return true;
+#endif
+}
+
+void WavWriter::preallocate(qint64 end)
+{
+#if defined(Q_OS_LINUX)
+    // Reserve extents ahead of the data without changing the visible file size, so the
+    // file system does not have to allocate (and possibly fragment) on every batch
+    while (allocatedBytes < end)
+    {
+        if (fallocate(file.handle(), FALLOC_FL_KEEP_SIZE, allocatedBytes, PreallocateStep) != 0)
+        {
+            allocatedBytes = end; // Not supported on this file system, stop trying
+            break;
+        }
+        allocatedBytes += PreallocateStep;
+    }
+#else
+    allocatedBytes = qMax(allocatedBytes, end);
+#endif
+}
@@ -0,0 +1,122 @@
+#ifndef WAVWRITER_H
+#define WAVWRITER_H
+
+#include "recordingwriter.h"
+
+#include <QElapsedTimer>
+
+// The canonical 44-byte header of a plain WAV file
+struct WAVHeader
+{
+    char chunkID[4] = {'R', 'I', 'F', 'F'};
+    uint32_t chunkSize; // Size of the entire file in bytes minus 8 bytes
+    char format[4] = {'W', 'A', 'V', 'E'};
+    char subchunk1ID[4] = {'f', 'm', 't', ' '};
+    uint32_t subchunk1Size = 16; // PCM header size
+    uint16_t audioFormat = 3;    // PCM = 1 | 3 - IEEE float
+    uint16_t numChannels;        // Mono = 1
+    uint32_t sampleRate;
+    uint32_t byteRate;           // sampleRate * numChannels * bitsPerSample/8
+    uint16_t blockAlign;         // numChannels * bitsPerSample/8
+    uint16_t bitsPerSample = 32; // 8 bits = 8, 16 bits = 16, etc.
+    char subchunk2ID[4] = {'d', 'a', 't', 'a'};
+    uint32_t subchunk2Size; // numSamples * numChannels * bitsPerSample/8
+};
+
+// The header WavWriter writes: WAVHeader with a JUNK chunk that keeps room for an RF64 ds64
+// chunk (EBU Tech 3306). Up to 4 GiB the file stays a plain WAV any reader takes; past that the
+// same 80 bytes are rewritten in place as RF64, with the 64-bit sizes in ds64 and 0xFFFFFFFF
+// in the 32-bit fields, so long takes never need their data moved.
+#pragma pack(push, 1)
+struct Rf64WavHeader
+{
+    char chunkID[4] = {'R', 'I', 'F', 'F'}; // "RF64" past 4 GiB
+    uint32_t chunkSize = 0;                 // Size of the entire file in bytes minus 8 bytes
+    char format[4] = {'W', 'A', 'V', 'E'};
+    char ds64ID[4] = {'J', 'U', 'N', 'K'}; // "ds64" past 4 GiB
+    uint32_t ds64Size = 28;
+    uint64_t riffSize = 0;    // ds64 only: the 64-bit chunkSize
+    uint64_t dataSize = 0;    // ds64 only: the 64-bit subchunk2Size
+    uint64_t sampleCount = 0; // ds64 only: sample frames
+    uint32_t tableLength = 0;
+    char subchunk1ID[4] = {'f', 'm', 't', ' '};
+    uint32_t subchunk1Size = 16;
+    uint16_t audioFormat = 3; // IEEE float
+    uint16_t numChannels = 1;
+    uint32_t sampleRate = 0;
+    uint32_t byteRate = 0;
+    uint16_t blockAlign = 0;
+    uint16_t bitsPerSample = 32;
+    char subchunk2ID[4] = {'d', 'a', 't', 'a'};
+    uint32_t subchunk2Size = 0; // Bytes of sample data
+};
+#pragma pack(pop)
+static_assert(sizeof(Rf64WavHeader) == 80, "Rf64WavHeader must not be padded");
+
+// Writes a 32-bit float WAV file from a background thread (see RecordingWriter).
+// The writer thread coalesces samples into large, buffer-aligned batches and issues them with
+// pwrite() at batch-aligned file offsets, preallocating disk space ahead of the data on Linux.
+// Every headerSyncInterval the staged samples are written and the header sizes patched, so a
+// killed process leaves a valid file that is at most that much short. Optionally the recording
+// is rotated into segments of a fixed duration or size, named by SegmentPath().
+class WavWriter : public RecordingWriter
+{
+public:
+    static constexpr int DefaultBatchBytes = 1 << 20;
+    static constexpr int DefaultHeaderSyncMs = 1000;
+
+    explicit WavWriter(int batchBytes = DefaultBatchBytes);
+    ~WavWriter() override;
+
+    QString fileExtension() const override { return ".wav"; }
+
+    // Set before open(). A new segment starts whenever the current one would exceed either
+    // limit; 0 disables a limit, both 0 writes one file at the path given to open().
+    void setSegmentLimits(double seconds, qint64 bytes);
+    void setHeaderSyncInterval(int milliseconds) { headerSyncMs = milliseconds; } // 0 patches the header on close only
+
+    bool isRotating() const { return segmentSeconds > 0.0 || segmentBytes > 0; }
+    int segmentCount() const { return segments.load(); } // Started so far, including the open one
+    static QString SegmentPath(const QString &path, int segment); // "take.wav", 2 -> "take_002.wav"
+
+    // The header for `dataBytes` of samples, in the RF64 form once the file outgrows 32-bit sizes
+    static Rf64WavHeader BuildHeader(uint32_t sampleRate, int channels, qint64 dataBytes);
+
+protected:
+    bool openFile(const QString &path, uint32_t sampleRate, int channels) override;
+    int minimumRingSamples() const override { return batchBytes / int(sizeof(float)); }
+    int drain() override;
+    void flush() override { flushBatch(); } // Partial last batch
+    void finishFile() override;             // Patches the header sizes
+
+private:
+    bool startSegment();
+    void endSegment();
+    bool flushBatch();
+    bool writeStaged();
+    void syncHeader();
+    bool writeAt(const char *data, qint64 size, qint64 offset);
+    void preallocate(qint64 end);
+
+    const int batchBytes;
+    char *batch = nullptr; // Page-aligned staging buffer of batchBytes
+    int batchFill = 0;     // Bytes currently staged, including the header placeholder in the first batch
+    int syncedFill = 0;    // Staged bytes already written by a header sync
+
+    QString basePath;
+    uint32_t rate = 0;
+    int channelCount = 1;
+    qint64 fileOffset = 0;     // Where the next batch goes
+    qint64 allocatedBytes = 0; // Disk space reserved so far
+
+    double segmentSeconds = 0.0;
+    qint64 segmentBytes = 0;
+    qint64 segmentSampleLimit = 0; // Samples per segment, 0 without rotation
+    qint64 segmentSamples = 0;     // Staged in the open segment
+    std::atomic<int> segments{0};
+
+    int headerSyncMs = DefaultHeaderSyncMs;
+    QElapsedTimer sinceSync;
+};
+
+#endif // WAVWRITER_H
@@ -0,0 +1,276 @@
+// Headless batch spectrogram tool.
+// Takes WAV files or directories of them, computes log-mel spectrograms with the same
+// FrameProcessor the EchoGrapher GUI uses, and writes one .npy matrix (frames x mel bands,
+// little-endian float32, in dB) per input file. Long files are split into chunks that overlap by
+// windowSize - hopSize samples at their edges, and every chunk of every file is processed
+// in parallel across all cores. Inputs are memory-mapped, so mono float recordings are analysed
+// straight from the page cache without being copied.
+
+#include "frameprocessor.h"
+#include "mappedwavfile.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QDirIterator>
+#include <QtConcurrent>
+#include <QFileInfo>
+#include <QMutex>
+#include <QFile>
+#include <QDir>
+
+#include <iostream>
+#include <cstring>
+#include <atomic>
+#include <cmath>
+#include <deque>
+
+using namespace std;
+
+struct AnalysisSettings
+{
+    int windowSize = 512;
+    float windowOverlap = 0.5f;
+    int numMelFilters = 25;
+    double chunkSeconds = 60.0;
+    float floorDb = -80.0f;
+    float referencePower = 1.0f;
+
+    int hopSize() const { return qMax(1, windowSize - static_cast<int>(windowSize * windowOverlap)); }
+};
+
+struct FileJob
+{
+    MappedWavFile input; // Shared read-only by all chunks of the file
+    WavInfo source;
+    QString outputPath;
+    qint64 spectrogramFrames = 0;
+    std::atomic<int> chunksLeft{0};
+    std::atomic<bool> failed{false};
+};
+
+struct ChunkJob
+{
+    FileJob *file;
+    qint64 firstFrame;
+    int frameCount;
+};
+
+QMutex consoleMutex; // Workers report progress concurrently
+
+// NumPy .npy v1.0 header for a C-ordered float32 matrix, padded so the data starts 64-byte aligned
+QByteArray NpyHeader(qint64 rows, int columns)
+{
+    QByteArray dict = QString("{'descr': '<f4', 'fortran_order': False, 'shape': (%1, %2), }").arg(rows).arg(columns).toLatin1();
+    const int unpadded = 10 + dict.size() + 1;
+    dict.append(QByteArray((64 - unpadded % 64) % 64, ' '));
+    dict.append('\n');
+
+    QByteArray header("\x93NUMPY\x01\x00", 8);
+    header.append(static_cast<char>(dict.size() & 0xFF));
+    header.append(static_cast<char>((dict.size() >> 8) & 0xFF));
+    header.append(dict);
+    return header;
+}
+
+void ProcessChunk(const ChunkJob &chunk, const AnalysisSettings &settings)
+{
+    FileJob &job = *chunk.file;
+    if (job.failed.load())
+    {
+        return;
+    }
+
+    const int windowSize = settings.windowSize;
+    const int hopSize = settings.hopSize();
+    const int bands = settings.numMelFilters;
+
+    // Each chunk re-reads windowSize - hopSize samples of its neighbour so frames continue seamlessly
+    const qint64 firstSample = chunk.firstFrame * hopSize;
+    const qint64 sampleCount = qint64(chunk.frameCount - 1) * hopSize + windowSize;
+
+    QVector<float> melFrames(qint64(chunk.frameCount) * bands);
+    job.input.prefetch(firstSample, sampleCount);
+
+    // Every frame lies inside the file, so mono float data can be framed in place
+    QVector<float> samples;
+    const float *chunkSamples = job.source.numChannels == 1 ? job.input.floatFrames(firstSample) : nullptr;
+    if (!chunkSamples)
+    {
+        samples.resize(sampleCount);
+        job.input.readMono(firstSample, sampleCount, samples.data());
+        chunkSamples = samples.constData();
+    }
+
+    // Absolute dB without normalisation, so chunks of one file line up exactly
+    std::unique_ptr<FrameProcessor> processor = FrameProcessor::Create(windowSize, bands, job.source.sampleRate);
+    processor->scale().setFloorDb(settings.floorDb);
+    processor->scale().setReferencePower(settings.referencePower);
+    bool ok = processor->isValid();
+    for (int frame = 0; ok && frame < chunk.frameCount; ++frame)
+    {
+        processor->processSamples(chunkSamples + qint64(frame) * hopSize, melFrames.data() + qint64(frame) * bands);
+    }
+    job.input.release(firstSample, sampleCount);
+
+    if (ok)
+    {
+        // Chunks own disjoint byte ranges of the preallocated output, so they can write concurrently
+        QFile output(job.outputPath);
+        const qint64 offset = NpyHeader(job.spectrogramFrames, bands).size() + chunk.firstFrame * bands * qint64(sizeof(float));
+        ok = output.open(QIODevice::ReadWrite) && output.seek(offset) &&
+             output.write(reinterpret_cast<const char *>(melFrames.constData()), melFrames.size() * qint64(sizeof(float))) == melFrames.size() * qint64(sizeof(float));
+    }
+
+    if (!ok)
+    {
+        job.failed.store(true);
+        QMutexLocker locker(&consoleMutex);
+        cerr << "Error: failed to process " << qPrintable(job.source.path) << endl;
+    }
+    else if (job.chunksLeft.fetch_sub(1) == 1)
+    {
+        QMutexLocker locker(&consoleMutex);
+        cout << qPrintable(job.source.path) << " -> " << qPrintable(job.outputPath) << " (" << job.spectrogramFrames << " frames)" << endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("EchoGrapherBatch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Computes log-mel spectrograms of WAV recordings and writes them as .npy files.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("inputs", "WAV files or directories containing WAV files.", "<input>...");
+    QCommandLineOption outputOption({"o", "output"}, "Output directory (default: next to each input).", "dir");
+    QCommandLineOption windowOption({"w", "window-size"}, "Analysis window size in samples.", "samples", "512");
+    QCommandLineOption overlapOption({"v", "overlap"}, "Window overlap as a fraction.", "fraction", "0.5");
+    QCommandLineOption bandsOption({"m", "mel-bands"}, "Number of mel bands.", "bands", "25");
+    QCommandLineOption jobsOption({"j", "jobs"}, "Worker threads (default: all cores).", "threads", QString::number(QThread::idealThreadCount()));
+    QCommandLineOption chunkOption({"c", "chunk-seconds"}, "Audio per parallel work item.", "seconds", "60");
+    QCommandLineOption floorOption({"f", "floor-db"}, "Lowest output level in dB.", "dB", "-80");
+    QCommandLineOption referenceOption("reference", "Mel energy that maps to 0 dB.", "power", "1");
+    QCommandLineOption recursiveOption({"r", "recursive"}, "Descend into subdirectories.");
+    parser.addOptions({outputOption, windowOption, overlapOption, bandsOption, jobsOption, chunkOption, floorOption, referenceOption, recursiveOption});
+    parser.process(app);
+
+    AnalysisSettings settings;
+    settings.windowSize = parser.value(windowOption).toInt();
+    settings.windowOverlap = parser.value(overlapOption).toFloat();
+    settings.numMelFilters = parser.value(bandsOption).toInt();
+    settings.chunkSeconds = parser.value(chunkOption).toDouble();
+    settings.floorDb = parser.value(floorOption).toFloat();
+    settings.referencePower = parser.value(referenceOption).toFloat();
+    if (settings.windowSize < 2 || settings.numMelFilters < 1 || settings.windowOverlap < 0.0f || settings.windowOverlap >= 1.0f || settings.chunkSeconds <= 0.0 ||
+        settings.referencePower <= 0.0f)
+    {
+        cerr << "Error: invalid analysis settings." << endl;
+        return 1;
+    }
+    if (parser.positionalArguments().isEmpty())
+    {
+        parser.showHelp(1);
+    }
+
+    // Collect input files, keeping each file's path relative to the directory it was found in
+    QList<QPair<QString, QString>> inputs; // (absolute path, output-relative base name)
+    for (const QString &argument : parser.positionalArguments())
+    {
+        QFileInfo info(argument);
+        if (info.isDir())
+        {
+            QDir root(info.absoluteFilePath());
+            QDirIterator it(root.absolutePath(), {"*.wav", "*.WAV"}, QDir::Files,
+                            parser.isSet(recursiveOption) ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+            while (it.hasNext())
+            {
+                const QString path = it.next();
+                inputs.append({path, root.relativeFilePath(path)});
+            }
+        }
+        else if (info.isFile())
+        {
+            inputs.append({info.absoluteFilePath(), info.fileName()});
+        }
+        else
+        {
+            cerr << "Warning: skipping " << qPrintable(argument) << ", no such file or directory" << endl;
+        }
+    }
+
+    const QString outputDir = parser.value(outputOption);
+    const int hopSize = settings.hopSize();
+    std::deque<FileJob> files; // Stable addresses for the chunk jobs
+    QVector<ChunkJob> chunks;
+    int failures = 0;
+
+    for (const auto &input : inputs)
+    {
+        FileJob &job = files.emplace_back();
+        if (!job.input.open(input.first, MappedWavFile::Sequential))
+        {
+            cerr << "Error: " << qPrintable(input.first) << ": " << qPrintable(job.input.errorString()) << endl;
+            files.pop_back();
+            ++failures;
+            continue;
+        }
+        job.source = job.input.wavInfo();
+
+        QString relativeOutput = input.second;
+        relativeOutput.replace(QRegularExpression("\\.wav$", QRegularExpression::CaseInsensitiveOption), ".npy");
+        job.outputPath = outputDir.isEmpty() ? QFileInfo(input.first).absoluteDir().filePath(QFileInfo(relativeOutput).fileName())
+                                             : QDir(outputDir).filePath(relativeOutput);
+        QDir().mkpath(QFileInfo(job.outputPath).absolutePath());
+
+        job.spectrogramFrames = job.source.numFrames < settings.windowSize ? 0 : (job.source.numFrames - settings.windowSize) / hopSize + 1;
+
+        // Create the output at full size up front, chunks then fill in their own rows
+        QFile output(job.outputPath);
+        const QByteArray header = NpyHeader(job.spectrogramFrames, settings.numMelFilters);
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate) || output.write(header) != header.size() ||
+            !output.resize(header.size() + job.spectrogramFrames * settings.numMelFilters * qint64(sizeof(float))))
+        {
+            cerr << "Error: could not create " << qPrintable(job.outputPath) << endl;
+            files.pop_back();
+            ++failures;
+            continue;
+        }
+
+        const int chunkFrames = qMax(1, static_cast<int>(settings.chunkSeconds * job.source.sampleRate / hopSize));
+        for (qint64 first = 0; first < job.spectrogramFrames; first += chunkFrames)
+        {
+            chunks.append({&job, first, static_cast<int>(qMin<qint64>(chunkFrames, job.spectrogramFrames - first))});
+        }
+        job.chunksLeft.store(static_cast<int>((job.spectrogramFrames + chunkFrames - 1) / chunkFrames));
+        if (job.spectrogramFrames == 0)
+        {
+            cout << qPrintable(input.first) << " -> " << qPrintable(job.outputPath) << " (shorter than one window)" << endl;
+        }
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, parser.value(jobsOption).toInt()));
+
+    QElapsedTimer timer;
+    timer.start();
+    QtConcurrent::blockingMap(chunks, [&settings](const ChunkJob &chunk)
+                              { ProcessChunk(chunk, settings); });
+
+    double audioSeconds = 0.0;
+    for (const FileJob &job : files)
+    {
+        failures += job.failed.load() ? 1 : 0;
+        audioSeconds += double(job.source.numFrames) / job.source.sampleRate;
+    }
+    const double elapsedSeconds = timer.elapsed() / 1000.0;
+    cout << files.size() << " file(s), " << audioSeconds << " s of audio in " << elapsedSeconds << " s";
+    if (elapsedSeconds > 0.0)
+    {
+        cout << " (" << audioSeconds / elapsedSeconds << "x real time)";
+    }
+    cout << endl;
+
+    return failures == 0 ? 0 : 1;
+}
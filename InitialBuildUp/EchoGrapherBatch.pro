@@ -0,0 +1,32 @@
+QT       = core concurrent
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+LIBS += -lfftw3f
+
+TARGET = EchoGrapherBatch
+
+# The batch tool runs the exact DSP of the GUI's AudioProcessor
+ECHOGRAPHER_DIR = $$PWD/../EchoGrapherQT
+INCLUDEPATH += $$ECHOGRAPHER_DIR
+
+SOURCES += \
+    EchoGrapherBatch.cpp \
+    $$ECHOGRAPHER_DIR/dspkernels.cpp \
+    $$ECHOGRAPHER_DIR/fftplancache.cpp \
+    $$ECHOGRAPHER_DIR/fixedframeprocessor.cpp \
+    $$ECHOGRAPHER_DIR/frameprocessor.cpp \
+    $$ECHOGRAPHER_DIR/logmelscale.cpp \
+    $$ECHOGRAPHER_DIR/mappedwavfile.cpp \
+    $$ECHOGRAPHER_DIR/melfilterbank.cpp \
+    $$ECHOGRAPHER_DIR/wavreader.cpp
+
+HEADERS += \
+    $$ECHOGRAPHER_DIR/dspkernels.h \
+    $$ECHOGRAPHER_DIR/fftplancache.h \
+    $$ECHOGRAPHER_DIR/fixedframeprocessor.h \
+    $$ECHOGRAPHER_DIR/frameprocessor.h \
+    $$ECHOGRAPHER_DIR/logmelscale.h \
+    $$ECHOGRAPHER_DIR/mappedwavfile.h \
+    $$ECHOGRAPHER_DIR/melfilterbank.h \
+    $$ECHOGRAPHER_DIR/wavreader.h